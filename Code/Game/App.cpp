@@ -1,184 +1,520 @@
-#include "Game/App.h"
-#include "Engine/Core/EventSystem.hpp"
-#include "Engine/Renderer/Renderer.h"
-#include "Engine/Renderer/Camera.h"
-#include "Engine/Window/Window.hpp"
-#include "Engine/Input/InputSystem.h"
-#include "Engine/Audio/AudioSystem.hpp"
-#include "Engine/Core/Vertex_PCU.h"
-#include "Engine/Core/Time.hpp"
-#include "Engine/Core/EngineCommon.h"
-#include "Engine/Core/DevConsole.hpp"
-#include "Engine/Core/Clock.hpp"
-#include "Engine/Core/DebugRender.hpp"
-
-RandomNumberGenerator* g_rng = nullptr; // Created and owned by the App
-App* g_theApp = nullptr;				// Created and owned by Main_Windows.cpp
-Renderer* g_theRenderer = nullptr;		// Created and owned by the App
-AudioSystem* g_theAudio = nullptr;		// Created and owned by the App
-Window* g_theWindow = nullptr;			// Created and owned by the App
-Game* m_theGame;						// Owns the Game instance
-
-
-App::App()
-{
-}
-
-App::~App()
-{
-}
-
-void App::Startup()
-{
-	// Create all Engine Subsystems
-	EventSystemConfig eventSystemConfig;
-	g_theEventSystem = new EventSystem(eventSystemConfig);
-
-	InputSystemConfig inputConfig;
-	g_theInput = new InputSystem(inputConfig);
-
-	WindowConfig windowConfig;
-	windowConfig.m_aspectRatio = 2.f;
-	windowConfig.m_inputSystem = g_theInput;
-	windowConfig.m_windowTitle = "ModelViewer";
-	g_theWindow = new Window(windowConfig);
-
-	RendererConfig rendererConfig;
-	rendererConfig.m_window = g_theWindow;
-	g_theRenderer = new Renderer(rendererConfig);
-
-	DevConsoleConfig devConsoleConfig;
-	devConsoleConfig.m_renderer = g_theRenderer;
-	devConsoleConfig.m_fontName = "Data/Fonts/SquirrelFixedFont";
-	Camera* devConsoleCamera = new Camera();
-	devConsoleCamera->SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y));
-	devConsoleConfig.m_camera = devConsoleCamera;
-	g_theDevConsole = new DevConsole(devConsoleConfig);
-
-	g_theEventSystem->Startup();
-	g_theDevConsole->Startup();
-	g_theInput->Startup();
-	g_theWindow->Startup();
-	g_theRenderer->Startup();
-
-	DebugRenderConfig debugRenderConfig;
-	debugRenderConfig.m_renderer = g_theRenderer;
-	debugRenderConfig.m_fontName = "Data/Fonts/SquirrelFixedFont";
-	DebugRenderSystemStartup(debugRenderConfig);
-
-	m_theGame = new Game(this);
-	m_theGame->StartUp();
-
-	SubscribeToEvents();
-}
-
-void App::Shutdown()
-{
-	m_theGame->Shutdown();
-	delete m_theGame;
-	m_theGame = nullptr;
-
-	DebugRenderSystemShutdown();
-
-	g_theRenderer->Shutdown();
-	g_theWindow->Shutdown();
-	g_theInput->Shutdown();
-	g_theDevConsole->Shutdown();
-	g_theEventSystem->Shutdown();
-
-	delete g_theRenderer;
-	delete g_theEventSystem;
-	delete g_theWindow;
-	delete g_theInput;
-	delete g_theDevConsole;
-
-	g_theRenderer = nullptr;
-	g_theEventSystem = nullptr;
-	g_theWindow = nullptr;
-	g_theInput = nullptr;
-	g_theDevConsole = nullptr;
-}
-
-void App::BeginFrame()
-{
-	Clock::TickSystemClock();
-
-	g_theRenderer->BeginFrame();
-	g_theEventSystem->BeginFrame();
-	g_theWindow->BeginFrame();
-	g_theInput->BeginFrame();
-	g_theDevConsole->BeginFrame();
-
-	DebugRenderBeginFrame();
-}
-
-void App::Render() const
-{
-	g_theRenderer->ClearScreen(Rgba8(150, 150, 150, 255));
-	m_theGame->Render();
-	g_theDevConsole->Render(AABB2(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y)));
-}
-
-void App::Update()
-{
-	if (g_theDevConsole->GetMode() == DevConsoleMode::OPEN_FULL || m_theGame->m_isAttractMode || GetActiveWindow() != Window::s_mainWindow->GetHwnd())
-	{
-		g_theInput->SetCursorMode(CursorMode::POINTER);
-	}
-	else
-	{
-		g_theInput->SetCursorMode(CursorMode::FPS);
-	}
-
-	if (g_theInput->WasKeyJustPressed(KEYCODE_F8)) //Restart press
-	{
-		delete m_game;
-		m_game = new Game(this);
-	}
-
-	if (g_theInput->WasKeyJustPressed(KEYCODE_TILDE))
-	{
-		g_theDevConsole->ToggleMode(DevConsoleMode::OPEN_FULL);
-	}
-
-	m_theGame->Update();
-}
-
-void App::EndFrame()
-{
-	g_theEventSystem->EndFrame();
-	g_theInput->EndFrame();
-	g_theWindow->EndFrame();
-	g_theRenderer->EndFrame();
-	g_theDevConsole->EndFrame();
-
-	DebugRenderEndFrame();
-}
-
-void App::SubscribeToEvents()
-{
-	SubscribeEventCallbackFunction("Quit", HandleQuitRequested);
-}
-
-void App::RunFrame()
-{
-	BeginFrame();	
-	Update();		
-	Render();		
-	EndFrame();
-}
-
-void App::RunMainLoop()
-{
-	while (!IsQuitting())
-	{
-		RunFrame();
-	}
-}
-
-bool App::HandleQuitRequested(EventArgs& args)
-{
-	UNUSED(args);
-	g_theApp->m_isQuitting = true;
-	return true;
-}
+#include "Game/App.h"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/Camera.h"
+#include "Engine/Window/Window.hpp"
+#include "Engine/Input/InputSystem.h"
+#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DebugRender.hpp"
+#include "Game/PerfStats.hpp"
+#include "Game/CommandScript.hpp"
+#include "Game/MemoryTracker.hpp"
+
+RandomNumberGenerator* g_rng = nullptr; // Created and owned by the App
+App* g_theApp = nullptr;				// Created and owned by Main_Windows.cpp
+Renderer* g_theRenderer = nullptr;		// Created and owned by the App
+AudioSystem* g_theAudio = nullptr;		// Created and owned by the App
+Window* g_theWindow = nullptr;			// Created and owned by the App
+Game* m_theGame;						// Owns the Game instance
+
+static PerfStatId const s_frameMillisecondsStat = GetPerfStats().Register("frame_ms", PerfStatType::HISTOGRAM);
+static PerfStatId const s_framesPerSecondStat = GetPerfStats().Register("fps", PerfStatType::GAUGE);
+static PerfStatId const s_cpuPercentStat = GetPerfStats().Register("cpu_percent", PerfStatType::GAUGE);
+static PerfStatId const s_redrawsStat = GetPerfStats().Register("redraws", PerfStatType::COUNTER);
+static PerfStatId const s_processMemoryStat = GetPerfStats().Register("process_memory_mb", PerfStatType::GAUGE);
+
+
+App::App()
+{
+}
+
+App::~App()
+{
+}
+
+void App::Startup()
+{
+	// Create all Engine Subsystems
+	EventSystemConfig eventSystemConfig;
+	g_theEventSystem = new EventSystem(eventSystemConfig);
+
+	InputSystemConfig inputConfig;
+	g_theInput = new InputSystem(inputConfig);
+
+	WindowConfig windowConfig;
+	windowConfig.m_aspectRatio = 2.f;
+	windowConfig.m_inputSystem = g_theInput;
+	windowConfig.m_windowTitle = "ModelViewer";
+	g_theWindow = new Window(windowConfig);
+
+	RendererConfig rendererConfig;
+	rendererConfig.m_window = g_theWindow;
+	g_theRenderer = new Renderer(rendererConfig);
+
+	DevConsoleConfig devConsoleConfig;
+	devConsoleConfig.m_renderer = g_theRenderer;
+	devConsoleConfig.m_fontName = "Data/Fonts/SquirrelFixedFont";
+	Camera* devConsoleCamera = new Camera();
+	devConsoleCamera->SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y));
+	devConsoleConfig.m_camera = devConsoleCamera;
+	g_theDevConsole = new DevConsole(devConsoleConfig);
+
+	g_theEventSystem->Startup();
+	g_theDevConsole->Startup();
+	g_theInput->Startup();
+	g_theWindow->Startup();
+	g_theRenderer->Startup();
+
+	DebugRenderConfig debugRenderConfig;
+	debugRenderConfig.m_renderer = g_theRenderer;
+	debugRenderConfig.m_fontName = "Data/Fonts/SquirrelFixedFont";
+	DebugRenderSystemStartup(debugRenderConfig);
+
+	m_theGame = new Game(this);
+	m_theGame->StartUp();
+
+	// Pacing defaults can be overridden by the model metadata the game just loaded
+	ApplyFramePacingConfig();
+	m_framePacer.Startup();
+
+	SubscribeToEvents();
+}
+
+void App::Shutdown()
+{
+	UnsubscribeCommand("FramePacing", HandleFramePacingCommand);
+	UnsubscribeCommand("PerfStats", HandlePerfStatsCommand);
+	UnsubscribeCommand("MemoryReport", HandleMemoryReportCommand);
+	m_framePacer.Shutdown();
+	GetPerfStats().StopStream();
+
+	m_theGame->Shutdown();
+	delete m_theGame;
+	m_theGame = nullptr;
+	CheckForMemoryLeaks("shutdown");
+	Game::DeleteReloadedTextures();
+	GetMemoryTracker().ReleaseOwner(MemoryOwner::RENDERER_CACHE);
+
+	DebugRenderSystemShutdown();
+
+	g_theRenderer->Shutdown();
+	g_theWindow->Shutdown();
+	g_theInput->Shutdown();
+	g_theDevConsole->Shutdown();
+	g_theEventSystem->Shutdown();
+
+	delete g_theRenderer;
+	delete g_theEventSystem;
+	delete g_theWindow;
+	delete g_theInput;
+	delete g_theDevConsole;
+
+	g_theRenderer = nullptr;
+	g_theEventSystem = nullptr;
+	g_theWindow = nullptr;
+	g_theInput = nullptr;
+	g_theDevConsole = nullptr;
+}
+
+void App::BeginFrame()
+{
+	Clock::TickSystemClock();
+
+	// The renderer's frame begins in RunFrame, once it is known whether this frame redraws
+	g_theEventSystem->BeginFrame();
+	g_theWindow->BeginFrame();
+	g_theInput->BeginFrame();
+	g_theDevConsole->BeginFrame();
+
+	DebugRenderBeginFrame();
+}
+
+void App::Render() const
+{
+	g_theRenderer->ClearScreen(Rgba8(150, 150, 150, 255));
+	m_theGame->Render();
+	g_theDevConsole->Render(AABB2(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y)));
+}
+
+void App::Update()
+{
+	if (g_theDevConsole->GetMode() == DevConsoleMode::OPEN_FULL || m_theGame->m_isAttractMode || GetActiveWindow() != Window::s_mainWindow->GetHwnd())
+	{
+		g_theInput->SetCursorMode(CursorMode::POINTER);
+	}
+	else
+	{
+		g_theInput->SetCursorMode(CursorMode::FPS);
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F8) || m_theGame->IsRestartRequested()) //Restart press
+	{
+		RestartGame();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_TILDE))
+	{
+		g_theDevConsole->ToggleMode(DevConsoleMode::OPEN_FULL);
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F4))
+	{
+		m_isPerfHUDVisible = !m_isPerfHUDVisible;
+	}
+
+	m_theGame->Update();
+
+	std::string pacingText = Stringf("Frame pacing: %s %.0f fps | %s", FramePacer::GetModeName(m_framePacer.GetMode()), m_framePacer.GetTargetFPS(),
+		m_framePacer.GetRecentStats().GetDescription().c_str());
+	DebugAddScreenText(pacingText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.88f), 0.f);
+
+	if (m_isPerfHUDVisible)
+	{
+		AddPerfHUDText();
+	}
+}
+
+void App::AddPerfHUDText() const
+{
+	PerfStats const& perfStats = GetPerfStats();
+	PerfStatFrameValue const& frameMilliseconds = perfStats.GetFrameValue(s_frameMillisecondsStat);
+	std::string hudText = Stringf("Perf (F4): %.1f fps, frame %.2f ms (p50 %.2f, p95 %.2f), CPU %.0f%%, mem %.0f MB",
+		perfStats.GetFrameValue(s_framesPerSecondStat).m_value, frameMilliseconds.m_value, frameMilliseconds.m_p50, frameMilliseconds.m_p95,
+		perfStats.GetFrameValue(s_cpuPercentStat).m_value, perfStats.GetFrameValue(s_processMemoryStat).m_value);
+	DebugAddScreenText(hudText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.85f), 0.f);
+
+	// The remaining stats come from subsystems; list every non-zero counter and gauge compactly
+	std::string subsystemText;
+	for (int statId = 0; statId < perfStats.GetNumStats(); ++statId)
+	{
+		if (statId == s_frameMillisecondsStat || statId == s_framesPerSecondStat || statId == s_cpuPercentStat || statId == s_processMemoryStat)
+		{
+			continue;
+		}
+		PerfStatFrameValue const& frameValue = perfStats.GetFrameValue(statId);
+		if (frameValue.m_value == 0.0)
+		{
+			continue;
+		}
+		subsystemText += Stringf("%s%s %.4g", subsystemText.empty() ? "" : ", ", perfStats.GetName(statId).c_str(), frameValue.m_value);
+	}
+	if (perfStats.IsStreaming())
+	{
+		subsystemText += Stringf(" | streaming to %s", perfStats.GetStreamFilePath().c_str());
+	}
+	DebugAddScreenText(subsystemText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.82f), 0.f);
+}
+
+void App::EndFrame(bool didRedraw)
+{
+	g_theEventSystem->EndFrame();
+	g_theInput->EndFrame();
+	g_theWindow->EndFrame();
+	// Paired with the renderer's BeginFrame in RunFrame; skipping it skips Present, leaving the last frame on screen
+	if (didRedraw)
+	{
+		g_theRenderer->EndFrame();
+	}
+	g_theDevConsole->EndFrame();
+
+	DebugRenderEndFrame();
+}
+
+void App::SubscribeToEvents()
+{
+	SubscribeCommand("Quit", HandleQuitRequested);
+	SubscribeCommand("FramePacing", HandleFramePacingCommand);
+	SubscribeCommand("PerfStats", HandlePerfStatsCommand);
+	SubscribeCommand("MemoryReport", HandleMemoryReportCommand);
+}
+
+Game* App::GetGame() const
+{
+	return m_theGame;
+}
+
+void App::ApplyFramePacingConfig()
+{
+	FramePacingMode pacingMode = FramePacingMode::CAPPED;
+	FramePacer::ParseModeName(g_gameConfigBlackboard.GetValue("framePacing", "capped"), pacingMode);
+	m_framePacer.SetMode(pacingMode);
+	m_framePacer.SetTargetFPS(g_gameConfigBlackboard.GetValue("targetFPS", 60.f));
+}
+
+void App::RestartGame()
+{
+	m_theGame->Shutdown();
+	delete m_theGame;
+	m_theGame = nullptr;
+	CheckForMemoryLeaks("restart");
+	DebugRenderClear();
+	m_theGame = new Game(this);
+	m_theGame->StartUp();
+}
+
+void App::SampleInputWhileWaiting()
+{
+	// Keep pumping messages and reading input during pacing waits; key edges still resolve in the next full frame
+	g_theWindow->BeginFrame();
+	g_theInput->BeginFrame();
+	m_theGame->SampleInput();
+}
+
+bool App::ShouldRedraw() const
+{
+	if (m_framePacer.GetMode() != FramePacingMode::ON_DEMAND)
+	{
+		return true;
+	}
+	return m_theGame->IsRedrawNeeded() || g_theDevConsole->GetMode() == DevConsoleMode::OPEN_FULL;
+}
+
+void App::RecordFrameStats(bool didRedraw)
+{
+	PerfStats& perfStats = GetPerfStats();
+	double frameSeconds = m_framePacer.GetLastFrameSeconds();
+	perfStats.Sample(s_frameMillisecondsStat, frameSeconds * 1000.0);
+	perfStats.Set(s_framesPerSecondStat, (frameSeconds > 0.0) ? 1.0 / frameSeconds : 0.0);
+	perfStats.Set(s_cpuPercentStat, (frameSeconds > 0.0) ? 100.0 * m_framePacer.GetLastFrameCPUSeconds() / frameSeconds : 0.0);
+	perfStats.Set(s_processMemoryStat, static_cast<double>(GetProcessMemoryBytes()) / (1024.0 * 1024.0));
+	perfStats.Add(s_redrawsStat, didRedraw ? 1.0 : 0.0);
+	perfStats.EndFrame();
+}
+
+void App::RunFrame()
+{
+	// Wait before the frame rather than after Present, so input is read and rendered as late as possible
+	m_framePacer.WaitForNextFrame([this]() { SampleInputWhileWaiting(); });
+
+	BeginFrame();	
+	Update();		
+	bool didRedraw = ShouldRedraw();
+	if (didRedraw)
+	{
+		g_theRenderer->BeginFrame();
+		Render();
+	}
+	EndFrame(didRedraw);
+	m_framePacer.EndFrame(didRedraw);
+	RecordFrameStats(didRedraw);
+
+	if (didRedraw)
+	{
+		m_theGame->OnFramePresented();
+	}
+}
+
+void App::RunMainLoop()
+{
+	while (!IsQuitting())
+	{
+		RunFrame();
+	}
+}
+
+bool App::HandleQuitRequested(EventArgs& args)
+{
+	UNUSED(args);
+	g_theApp->m_isQuitting = true;
+	return true;
+}
+
+bool App::HandleFramePacingCommand(EventArgs& args)
+{
+	FramePacer& framePacer = g_theApp->m_framePacer;
+
+	std::string modeName = args.GetValue("mode", "");
+	if (!modeName.empty())
+	{
+		FramePacingMode mode = FramePacingMode::CAPPED;
+		if (!FramePacer::ParseModeName(modeName, mode))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("FramePacing: unknown mode \"%s\"; expected uncapped, capped, or ondemand", modeName.c_str()));
+			return false;
+		}
+		framePacer.SetMode(mode);
+	}
+
+	float targetFPS = args.GetValue("fps", 0.f);
+	if (targetFPS > 0.f)
+	{
+		framePacer.SetTargetFPS(targetFPS);
+	}
+	if (args.GetValue("reset", false))
+	{
+		framePacer.ResetStats();
+	}
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("FramePacing: %s at %.0f fps", FramePacer::GetModeName(framePacer.GetMode()), framePacer.GetTargetFPS()));
+	for (int modeIndex = 0; modeIndex < static_cast<int>(FramePacingMode::COUNT); ++modeIndex)
+	{
+		FramePacingMode mode = static_cast<FramePacingMode>(modeIndex);
+		FramePacingStats const& stats = framePacer.GetStats(mode);
+		if (stats.m_numFrames > 0)
+		{
+			g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %-9s %6d frames: %s", FramePacer::GetModeName(mode), stats.m_numFrames, stats.GetDescription().c_str()));
+		}
+	}
+	return true;
+}
+
+bool App::HandlePerfStatsCommand(EventArgs& args)
+{
+	PerfStats& perfStats = GetPerfStats();
+
+	std::string streamCommand = args.GetValue("stream", "");
+	if (streamCommand == "stop")
+	{
+		perfStats.StopStream();
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, "PerfStats: stream stopped");
+		return true;
+	}
+	if (streamCommand == "start")
+	{
+		std::string formatName = args.GetValue("format", "csv");
+		if (formatName != "csv" && formatName != "json")
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("PerfStats: unknown format \"%s\"; expected csv or json", formatName.c_str()));
+			return false;
+		}
+		PerfStreamFormat format = (formatName == "json") ? PerfStreamFormat::JSON_LINES : PerfStreamFormat::CSV;
+		std::string filePath = args.GetValue("file", (format == PerfStreamFormat::CSV) ? "PerfStats.csv" : "PerfStats.jsonl");
+
+		std::string errorMessage;
+		if (!perfStats.StartStream(filePath, format, errorMessage))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("PerfStats: %s", errorMessage.c_str()));
+			return false;
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("PerfStats: streaming one %s record per frame to \"%s\"", formatName.c_str(), filePath.c_str()));
+		return true;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("PerfStats frame %d (stream=start|stop file=<path> format=csv|json):", perfStats.GetFrameNumber()));
+	for (int statId = 0; statId < perfStats.GetNumStats(); ++statId)
+	{
+		PerfStatFrameValue const& frameValue = perfStats.GetFrameValue(statId);
+		if (perfStats.GetType(statId) == PerfStatType::HISTOGRAM)
+		{
+			g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %-24s mean %.4g, min %.4g, max %.4g, p50 %.4g, p95 %.4g", perfStats.GetName(statId).c_str(),
+				frameValue.m_value, frameValue.m_min, frameValue.m_max, frameValue.m_p50, frameValue.m_p95));
+		}
+		else
+		{
+			g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %-24s %.6g", perfStats.GetName(statId).c_str(), frameValue.m_value));
+		}
+	}
+	return true;
+}
+
+void App::CheckForMemoryLeaks(char const* when)
+{
+	// The renderer cache keeps what it loaded across restarts, so it is checked for growth rather than for leaks
+	MemoryUsage rendererCacheUsage = GetMemoryTracker().GetOwnerUsage(MemoryOwner::RENDERER_CACHE);
+	if (m_lastRendererCacheBytes > 0 && rendererCacheUsage.m_bytes > m_lastRendererCacheBytes)
+	{
+		std::string growthText = Stringf("Memory check at %s: renderer cache grew %.2f MB since the last check, to %.2f MB in %d textures and shaders", when,
+			static_cast<double>(rendererCacheUsage.m_bytes - m_lastRendererCacheBytes) / (1024.0 * 1024.0), static_cast<double>(rendererCacheUsage.m_bytes) / (1024.0 * 1024.0),
+			rendererCacheUsage.m_numAllocations);
+		g_theDevConsole->AddLine(DevConsole::WARNING, growthText);
+		DebuggerPrintf("%s\n", growthText.c_str());
+	}
+	m_lastRendererCacheBytes = rendererCacheUsage.m_bytes;
+
+	// Everything the game owns is released by Game::Shutdown, so whatever is left here leaked
+	std::vector<MemoryAllocation> leaks;
+	int numLeaks = GetMemoryTracker().CheckForLeaks(leaks);
+	if (numLeaks == 0)
+	{
+		return;
+	}
+
+	uint64_t leakedBytes = 0;
+	for (int leakIndex = 0; leakIndex < numLeaks; ++leakIndex)
+	{
+		leakedBytes += leaks[leakIndex].m_bytes;
+	}
+	std::string summary = Stringf("Memory leak check at %s: %d allocations, %.2f MB still tracked", when, numLeaks, static_cast<double>(leakedBytes) / (1024.0 * 1024.0));
+	g_theDevConsole->AddLine(DevConsole::ERROR, summary);
+	DebuggerPrintf("%s\n", summary.c_str());
+	for (int leakIndex = 0; leakIndex < numLeaks; ++leakIndex)
+	{
+		MemoryAllocation const& leak = leaks[leakIndex];
+		std::string leakText = Stringf("  %-9s %-15s %10llu bytes  %s", MemoryTracker::GetCategoryName(leak.m_category), MemoryTracker::GetResourceTypeName(leak.m_type),
+			static_cast<unsigned long long>(leak.m_bytes), leak.m_asset.c_str());
+		g_theDevConsole->AddLine(DevConsole::ERROR, leakText);
+		DebuggerPrintf("%s\n", leakText.c_str());
+	}
+}
+
+bool App::HandleMemoryReportCommand(EventArgs& args)
+{
+	MemoryTracker& memoryTracker = GetMemoryTracker();
+	double const bytesPerMegabyte = 1024.0 * 1024.0;
+
+	MemoryUsage totalUsage = memoryTracker.GetTotalUsage();
+	MemoryUsage leakedUsage = memoryTracker.GetLeakedUsage();
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("MemoryReport (json=<path> resetPeaks=true): %.2f MB tracked, peak %.2f MB, %.2f MB on the GPU, process %.0f MB",
+		static_cast<double>(totalUsage.m_bytes) / bytesPerMegabyte, static_cast<double>(totalUsage.m_peakBytes) / bytesPerMegabyte,
+		static_cast<double>(memoryTracker.GetGPUBytes()) / bytesPerMegabyte, static_cast<double>(GetProcessMemoryBytes()) / bytesPerMegabyte));
+	for (int ownerIndex = 0; ownerIndex < static_cast<int>(MemoryOwner::COUNT); ++ownerIndex)
+	{
+		MemoryOwner owner = static_cast<MemoryOwner>(ownerIndex);
+		MemoryUsage ownerUsage = memoryTracker.GetOwnerUsage(owner);
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  owned by %-14s %9.2f MB (peak %9.2f) in %5d allocations", MemoryTracker::GetOwnerName(owner),
+			static_cast<double>(ownerUsage.m_bytes) / bytesPerMegabyte, static_cast<double>(ownerUsage.m_peakBytes) / bytesPerMegabyte, ownerUsage.m_numAllocations));
+	}
+	for (int categoryIndex = 0; categoryIndex < static_cast<int>(MemoryCategory::COUNT); ++categoryIndex)
+	{
+		MemoryCategory category = static_cast<MemoryCategory>(categoryIndex);
+		MemoryUsage categoryUsage = memoryTracker.GetCategoryUsage(category);
+		std::string typeText;
+		for (int typeIndex = 0; typeIndex < static_cast<int>(MemoryResourceType::COUNT); ++typeIndex)
+		{
+			MemoryResourceType type = static_cast<MemoryResourceType>(typeIndex);
+			MemoryUsage typeUsage = memoryTracker.GetUsage(category, type);
+			if (typeUsage.m_peakBytes > 0)
+			{
+				typeText += Stringf("%s%s %.2f", typeText.empty() ? "" : ", ", MemoryTracker::GetResourceTypeName(type), static_cast<double>(typeUsage.m_bytes) / bytesPerMegabyte);
+			}
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %-9s %9.2f MB (peak %9.2f) in %5d allocations%s%s", MemoryTracker::GetCategoryName(category),
+			static_cast<double>(categoryUsage.m_bytes) / bytesPerMegabyte, static_cast<double>(categoryUsage.m_peakBytes) / bytesPerMegabyte, categoryUsage.m_numAllocations,
+			typeText.empty() ? "" : ": ", typeText.c_str()));
+	}
+
+	std::vector<MemoryAssetUsage> assetUsages = memoryTracker.GetAssetUsages();
+	int numAssetsShown = (static_cast<int>(assetUsages.size()) < 10) ? static_cast<int>(assetUsages.size()) : 10;
+	for (int assetIndex = 0; assetIndex < numAssetsShown; ++assetIndex)
+	{
+		MemoryUsage const& assetUsage = assetUsages[assetIndex].m_usage;
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %9.2f MB (peak %9.2f)  %s", static_cast<double>(assetUsage.m_bytes) / bytesPerMegabyte,
+			static_cast<double>(assetUsage.m_peakBytes) / bytesPerMegabyte, assetUsages[assetIndex].m_asset.c_str()));
+	}
+	if (leakedUsage.m_numAllocations > 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("  leaked across restarts: %.2f MB in %d allocations", static_cast<double>(leakedUsage.m_bytes) / bytesPerMegabyte, leakedUsage.m_numAllocations));
+	}
+
+	std::string jsonFile = args.GetValue("json", "");
+	if (!jsonFile.empty())
+	{
+		std::string errorMessage;
+		if (!memoryTracker.WriteReportJSON(jsonFile, errorMessage))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("MemoryReport: %s", errorMessage.c_str()));
+			return false;
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  wrote \"%s\"", jsonFile.c_str()));
+	}
+	if (args.GetValue("resetPeaks", false))
+	{
+		memoryTracker.ResetPeaks();
+	}
+	return true;
+}
@@ -1,30 +1,44 @@
-#pragma once
-#include "Game/Game.h"
-#include "Engine/Math/Vec2.hpp"
-#include "Engine/Core/EventSystem.hpp"
-
-class App
-{
-public:
-	App();
-	~App();
-	void Startup();
-	void Shutdown();
-	void RunFrame();
-
-	void RunMainLoop();
-	bool IsQuitting() const { return m_isQuitting; }
-	static bool HandleQuitRequested(EventArgs& args);
-	
-private:
-	void BeginFrame();
-	void Update();
-	void Render() const;
-	void EndFrame();
-
-	void SubscribeToEvents();
-
-private:
-	Game* m_game = nullptr;
-	bool  m_isQuitting = false;
+#pragma once
+#include "Game/Game.h"
+#include "Game/FramePacer.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Core/EventSystem.hpp"
+
+class App
+{
+public:
+	App();
+	~App();
+	void Startup();
+	void Shutdown();
+	void RunFrame();
+
+	void RunMainLoop();
+	bool IsQuitting() const { return m_isQuitting; }
+	Game* GetGame() const;
+	void ApplyFramePacingConfig();
+	static bool HandleQuitRequested(EventArgs& args);
+	static bool HandleFramePacingCommand(EventArgs& args);
+	static bool HandlePerfStatsCommand(EventArgs& args);
+	static bool HandleMemoryReportCommand(EventArgs& args);
+	
+private:
+	void BeginFrame();
+	void Update();
+	void Render() const;
+	void EndFrame(bool didRedraw);
+	void SampleInputWhileWaiting();
+	bool ShouldRedraw() const;
+	void RecordFrameStats(bool didRedraw);
+	void AddPerfHUDText() const;
+
+	void SubscribeToEvents();
+	void RestartGame();
+	void CheckForMemoryLeaks(char const* when);
+
+private:
+	bool  m_isQuitting = false;
+	FramePacer m_framePacer;
+	bool  m_isPerfHUDVisible = true;
+	uint64_t m_lastRendererCacheBytes = 0;
 };
\ No newline at end of file
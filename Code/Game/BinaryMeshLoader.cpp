@@ -0,0 +1,716 @@
+#include "Game/BinaryMeshLoader.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/MathUtils.h"
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+BinaryFileReader::BinaryFileReader(size_t blockSizeBytes)
+	: m_buffer(blockSizeBytes)
+{
+}
+
+BinaryFileReader::~BinaryFileReader()
+{
+	Close();
+}
+
+bool BinaryFileReader::Open(std::string const& filePath)
+{
+	Close();
+
+#if defined(_MSC_VER)
+	if (fopen_s(&m_file, filePath.c_str(), "rb") != 0)
+	{
+		m_file = nullptr;
+	}
+#else
+	m_file = fopen(filePath.c_str(), "rb");
+#endif
+	if (m_file == nullptr)
+	{
+		return false;
+	}
+
+#if defined(_MSC_VER)
+	_fseeki64(m_file, 0, SEEK_END);
+	m_fileSize = static_cast<size_t>(_ftelli64(m_file));
+	_fseeki64(m_file, 0, SEEK_SET);
+#else
+	fseeko(m_file, 0, SEEK_END);
+	m_fileSize = static_cast<size_t>(ftello(m_file));
+	fseeko(m_file, 0, SEEK_SET);
+#endif
+
+	m_bufferReadPos = 0;
+	m_bufferEnd = 0;
+	m_fileOffsetOfBuffer = 0;
+	return true;
+}
+
+void BinaryFileReader::Close()
+{
+	if (m_file != nullptr)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+}
+
+bool BinaryFileReader::RefillBuffer(size_t minBytesNeeded)
+{
+	// A request past the end of the file can never be met; refuse it before growing the buffer for it
+	if (minBytesNeeded > GetBytesRemaining())
+	{
+		return false;
+	}
+	if (minBytesNeeded > m_buffer.size())
+	{
+		m_buffer.resize(minBytesNeeded);
+	}
+
+	// Keep the unread tail and top the buffer up behind it with one large read
+	size_t numUnread = m_bufferEnd - m_bufferReadPos;
+	if (numUnread > 0 && m_bufferReadPos > 0)
+	{
+		memmove(m_buffer.data(), m_buffer.data() + m_bufferReadPos, numUnread);
+	}
+	m_fileOffsetOfBuffer += m_bufferReadPos;
+	m_bufferReadPos = 0;
+	m_bufferEnd = numUnread;
+
+	size_t numRead = fread(m_buffer.data() + m_bufferEnd, 1, m_buffer.size() - m_bufferEnd, m_file);
+	m_bufferEnd += numRead;
+	return m_bufferEnd >= minBytesNeeded;
+}
+
+char const* BinaryFileReader::Acquire(size_t numBytes)
+{
+	if (m_bufferEnd - m_bufferReadPos < numBytes && !RefillBuffer(numBytes))
+	{
+		return nullptr;
+	}
+
+	char const* data = m_buffer.data() + m_bufferReadPos;
+	m_bufferReadPos += numBytes;
+	return data;
+}
+
+bool BinaryFileReader::Read(void* out_data, size_t numBytes)
+{
+	char const* data = Acquire(numBytes);
+	if (data == nullptr)
+	{
+		return false;
+	}
+	memcpy(out_data, data, numBytes);
+	return true;
+}
+
+bool BinaryFileReader::Skip(size_t numBytes)
+{
+	while (numBytes > 0)
+	{
+		size_t chunkSize = (numBytes < m_buffer.size()) ? numBytes : m_buffer.size();
+		if (Acquire(chunkSize) == nullptr)
+		{
+			return false;
+		}
+		numBytes -= chunkSize;
+	}
+	return true;
+}
+
+bool BinaryFileReader::ReadLine(std::string& out_line)
+{
+	out_line.clear();
+	for (;;)
+	{
+		char const* character = Acquire(1);
+		if (character == nullptr)
+		{
+			return !out_line.empty();
+		}
+		if (*character == '\n')
+		{
+			break;
+		}
+		if (*character != '\r')
+		{
+			out_line.push_back(*character);
+		}
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+static void AddDefaultSubmesh(ModelData& model)
+{
+	model.m_materials.emplace_back();
+
+	ModelSubmesh submesh;
+	submesh.m_materialIndex = 0;
+	submesh.m_startIndex = 0;
+	submesh.m_indexCount = static_cast<unsigned int>(model.m_indices.size());
+	model.m_submeshes.push_back(submesh);
+}
+
+// -----------------------------------------------------------------------------
+constexpr size_t STL_HEADER_BYTES = 80;
+constexpr size_t STL_TRIANGLE_BYTES = 50;
+
+static bool OpenBinarySTL(BinaryFileReader& reader, std::string const& stlFilePath, uint32_t& out_numTriangles)
+{
+	if (!reader.Open(stlFilePath))
+	{
+		return false;
+	}
+
+	char header[STL_HEADER_BYTES];
+	out_numTriangles = 0;
+	if (!reader.Read(header, STL_HEADER_BYTES) || !reader.Read(&out_numTriangles, sizeof(out_numTriangles)))
+	{
+		DebuggerPrintf("WARNING: STL file \"%s\" is truncated\n", stlFilePath.c_str());
+		return false;
+	}
+
+	if (reader.GetFileSize() != STL_HEADER_BYTES + sizeof(uint32_t) + STL_TRIANGLE_BYTES * static_cast<size_t>(out_numTriangles))
+	{
+		DebuggerPrintf("WARNING: STL file \"%s\" is not a binary STL (ASCII STL is not supported)\n", stlFilePath.c_str());
+		return false;
+	}
+	return true;
+}
+
+static void DecodeSTLTriangle(char const* record, Vec3 out_corners[3], Vec3& out_normal)
+{
+	float values[12];
+	memcpy(values, record, sizeof(values));
+
+	out_corners[0] = Vec3(values[3], values[4], values[5]);
+	out_corners[1] = Vec3(values[6], values[7], values[8]);
+	out_corners[2] = Vec3(values[9], values[10], values[11]);
+
+	out_normal = Vec3(values[0], values[1], values[2]);
+	if (out_normal.GetLengthSquared() < 1e-12f)
+	{
+		out_normal = CrossProduct3D(out_corners[1] - out_corners[0], out_corners[2] - out_corners[0]).GetNormalized();
+	}
+}
+
+// -----------------------------------------------------------------------------
+bool LoadBinarySTLModel(ModelData& out_model, std::string const& stlFilePath)
+{
+	out_model.Clear();
+
+	BinaryFileReader reader;
+	uint32_t numTriangles = 0;
+	if (!OpenBinarySTL(reader, stlFilePath, numTriangles))
+	{
+		return false;
+	}
+
+	// STL stores unshared triangles, so every corner becomes its own vertex
+	out_model.m_verts.resize(static_cast<size_t>(numTriangles) * 3);
+	out_model.m_indices.resize(static_cast<size_t>(numTriangles) * 3);
+
+	for (uint32_t triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		char const* record = reader.Acquire(STL_TRIANGLE_BYTES);
+		if (record == nullptr)
+		{
+			return false;
+		}
+
+		Vec3 corners[3];
+		Vec3 normal;
+		DecodeSTLTriangle(record, corners, normal);
+
+		size_t firstVertIndex = static_cast<size_t>(triangleIndex) * 3;
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			Vertex_PCUTBN& vertex = out_model.m_verts[firstVertIndex + corner];
+			vertex.m_position = corners[corner];
+			vertex.m_color = Rgba8::WHITE;
+			vertex.m_normal = normal;
+			out_model.m_indices[firstVertIndex + corner] = static_cast<unsigned int>(firstVertIndex + corner);
+		}
+	}
+
+	AddDefaultSubmesh(out_model);
+	CalculateModelTangents(out_model);
+	return numTriangles > 0;
+}
+
+// -----------------------------------------------------------------------------
+bool ForEachBinarySTLTriangle(std::string const& stlFilePath, std::function<void(Vertex_PCUTBN const* corners)> const& visitTriangle)
+{
+	BinaryFileReader reader;
+	uint32_t numTriangles = 0;
+	if (!OpenBinarySTL(reader, stlFilePath, numTriangles))
+	{
+		return false;
+	}
+
+	// Tangents are left zero; callers that keep the triangles compute them over whatever subset they gather
+	Vertex_PCUTBN triangleVerts[3];
+	for (uint32_t triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		char const* record = reader.Acquire(STL_TRIANGLE_BYTES);
+		if (record == nullptr)
+		{
+			return false;
+		}
+
+		Vec3 corners[3];
+		Vec3 normal;
+		DecodeSTLTriangle(record, corners, normal);
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			triangleVerts[corner].m_position = corners[corner];
+			triangleVerts[corner].m_color = Rgba8::WHITE;
+			triangleVerts[corner].m_normal = normal;
+		}
+		visitTriangle(triangleVerts);
+	}
+	return numTriangles > 0;
+}
+
+// -----------------------------------------------------------------------------
+enum class PLYScalarType
+{
+	INVALID, INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64
+};
+
+struct PLYProperty
+{
+	std::string		m_name;
+	PLYScalarType	m_type = PLYScalarType::INVALID;
+	bool			m_isList = false;
+	PLYScalarType	m_listCountType = PLYScalarType::INVALID;
+	size_t			m_offset = 0;
+};
+
+static size_t GetPLYScalarSize(PLYScalarType type);
+
+struct PLYElement
+{
+	std::string					m_name;
+	size_t						m_count = 0;
+	std::vector<PLYProperty>	m_properties;
+	size_t						m_fixedStride = 0;
+	bool						m_hasLists = false;
+
+	// The smallest a record can be, with every list empty
+	size_t GetMinRecordSize() const
+	{
+		size_t minRecordSize = m_fixedStride;
+		for (int propertyIndex = 0; propertyIndex < static_cast<int>(m_properties.size()); ++propertyIndex)
+		{
+			if (m_properties[propertyIndex].m_isList)
+			{
+				minRecordSize += GetPLYScalarSize(m_properties[propertyIndex].m_listCountType);
+			}
+		}
+		return minRecordSize;
+	}
+
+	int FindProperty(char const* name) const
+	{
+		for (int propertyIndex = 0; propertyIndex < static_cast<int>(m_properties.size()); ++propertyIndex)
+		{
+			if (m_properties[propertyIndex].m_name == name)
+			{
+				return propertyIndex;
+			}
+		}
+		return -1;
+	}
+};
+
+static PLYScalarType ParsePLYScalarType(std::string const& typeName)
+{
+	if (typeName == "char"   || typeName == "int8")		return PLYScalarType::INT8;
+	if (typeName == "uchar"  || typeName == "uint8")	return PLYScalarType::UINT8;
+	if (typeName == "short"  || typeName == "int16")	return PLYScalarType::INT16;
+	if (typeName == "ushort" || typeName == "uint16")	return PLYScalarType::UINT16;
+	if (typeName == "int"    || typeName == "int32")	return PLYScalarType::INT32;
+	if (typeName == "uint"   || typeName == "uint32")	return PLYScalarType::UINT32;
+	if (typeName == "float"  || typeName == "float32")	return PLYScalarType::FLOAT32;
+	if (typeName == "double" || typeName == "float64")	return PLYScalarType::FLOAT64;
+	return PLYScalarType::INVALID;
+}
+
+static size_t GetPLYScalarSize(PLYScalarType type)
+{
+	switch (type)
+	{
+		case PLYScalarType::INT8:
+		case PLYScalarType::UINT8:		return 1;
+		case PLYScalarType::INT16:
+		case PLYScalarType::UINT16:		return 2;
+		case PLYScalarType::INT32:
+		case PLYScalarType::UINT32:
+		case PLYScalarType::FLOAT32:	return 4;
+		case PLYScalarType::FLOAT64:	return 8;
+		default:						return 0;
+	}
+}
+
+static double ReadPLYScalar(char const* data, PLYScalarType type, bool isBigEndian)
+{
+	unsigned char bytes[8];
+	size_t size = GetPLYScalarSize(type);
+	for (size_t byteIndex = 0; byteIndex < size; ++byteIndex)
+	{
+		bytes[byteIndex] = static_cast<unsigned char>(isBigEndian ? data[size - 1 - byteIndex] : data[byteIndex]);
+	}
+
+	switch (type)
+	{
+		case PLYScalarType::INT8:		{ int8_t value;		memcpy(&value, bytes, 1); return value; }
+		case PLYScalarType::UINT8:		{ uint8_t value;	memcpy(&value, bytes, 1); return value; }
+		case PLYScalarType::INT16:		{ int16_t value;	memcpy(&value, bytes, 2); return value; }
+		case PLYScalarType::UINT16:		{ uint16_t value;	memcpy(&value, bytes, 2); return value; }
+		case PLYScalarType::INT32:		{ int32_t value;	memcpy(&value, bytes, 4); return value; }
+		case PLYScalarType::UINT32:		{ uint32_t value;	memcpy(&value, bytes, 4); return value; }
+		case PLYScalarType::FLOAT32:	{ float value;		memcpy(&value, bytes, 4); return value; }
+		case PLYScalarType::FLOAT64:	{ double value;		memcpy(&value, bytes, 8); return value; }
+		default:						return 0.0;
+	}
+}
+
+// Counts come straight from the file, so they are checked against what is left of it before anything is sized by them
+static bool DoPLYRecordsFit(BinaryFileReader const& reader, size_t numRecords, size_t recordSize)
+{
+	return recordSize == 0 || numRecords <= reader.GetBytesRemaining() / recordSize;
+}
+
+static bool ReadPLYListCount(BinaryFileReader& reader, PLYProperty const& property, bool isBigEndian, size_t& out_count)
+{
+	char const* countData = reader.Acquire(GetPLYScalarSize(property.m_listCountType));
+	if (countData == nullptr)
+	{
+		return false;
+	}
+
+	double count = ReadPLYScalar(countData, property.m_listCountType, isBigEndian);
+	if (count < 0.0)
+	{
+		return false;
+	}
+	out_count = static_cast<size_t>(count);
+	return DoPLYRecordsFit(reader, out_count, GetPLYScalarSize(property.m_type));
+}
+
+static bool ParsePLYHeader(BinaryFileReader& reader, std::vector<PLYElement>& out_elements, bool& out_isBigEndian, std::string const& plyFilePath)
+{
+	std::string line;
+	if (!reader.ReadLine(line) || line != "ply")
+	{
+		DebuggerPrintf("WARNING: \"%s\" is not a PLY file\n", plyFilePath.c_str());
+		return false;
+	}
+
+	bool hasFormat = false;
+	while (reader.ReadLine(line))
+	{
+		std::vector<std::string> tokens;
+		size_t tokenStart = line.find_first_not_of(" \t");
+		while (tokenStart != std::string::npos)
+		{
+			size_t tokenEnd = line.find_first_of(" \t", tokenStart);
+			tokens.push_back(line.substr(tokenStart, tokenEnd - tokenStart));
+			tokenStart = line.find_first_not_of(" \t", tokenEnd);
+		}
+		if (tokens.empty())
+		{
+			continue;
+		}
+
+		if (tokens[0] == "end_header")
+		{
+			return hasFormat;
+		}
+		else if (tokens[0] == "format" && tokens.size() >= 2)
+		{
+			if (tokens[1] == "binary_little_endian")
+			{
+				out_isBigEndian = false;
+			}
+			else if (tokens[1] == "binary_big_endian")
+			{
+				out_isBigEndian = true;
+			}
+			else
+			{
+				DebuggerPrintf("WARNING: PLY file \"%s\" is \"%s\"; only binary PLY is supported\n", plyFilePath.c_str(), tokens[1].c_str());
+				return false;
+			}
+			hasFormat = true;
+		}
+		else if (tokens[0] == "element" && tokens.size() >= 3)
+		{
+			PLYElement element;
+			element.m_name = tokens[1];
+			element.m_count = static_cast<size_t>(strtoull(tokens[2].c_str(), nullptr, 10));
+			out_elements.push_back(element);
+		}
+		else if (tokens[0] == "property" && !out_elements.empty())
+		{
+			PLYElement& element = out_elements.back();
+			PLYProperty property;
+			if (tokens.size() >= 5 && tokens[1] == "list")
+			{
+				property.m_isList = true;
+				property.m_listCountType = ParsePLYScalarType(tokens[2]);
+				property.m_type = ParsePLYScalarType(tokens[3]);
+				property.m_name = tokens[4];
+				element.m_hasLists = true;
+			}
+			else if (tokens.size() >= 3)
+			{
+				property.m_type = ParsePLYScalarType(tokens[1]);
+				property.m_name = tokens[2];
+				property.m_offset = element.m_fixedStride;
+				element.m_fixedStride += GetPLYScalarSize(property.m_type);
+			}
+
+			if (property.m_type == PLYScalarType::INVALID || (property.m_isList && property.m_listCountType == PLYScalarType::INVALID))
+			{
+				DebuggerPrintf("WARNING: PLY file \"%s\" has an unknown property type\n", plyFilePath.c_str());
+				return false;
+			}
+			element.m_properties.push_back(property);
+		}
+	}
+
+	DebuggerPrintf("WARNING: PLY file \"%s\" has no end_header\n", plyFilePath.c_str());
+	return false;
+}
+
+static bool SkipPLYElementRecord(BinaryFileReader& reader, PLYElement const& element, bool isBigEndian)
+{
+	for (int propertyIndex = 0; propertyIndex < static_cast<int>(element.m_properties.size()); ++propertyIndex)
+	{
+		PLYProperty const& property = element.m_properties[propertyIndex];
+		if (!property.m_isList)
+		{
+			if (!reader.Skip(GetPLYScalarSize(property.m_type)))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		size_t count = 0;
+		if (!ReadPLYListCount(reader, property, isBigEndian, count) || !reader.Skip(count * GetPLYScalarSize(property.m_type)))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool ReadPLYVertices(BinaryFileReader& reader, PLYElement const& element, bool isBigEndian, ModelData& out_model, bool& out_hasNormals)
+{
+	if (element.m_hasLists)
+	{
+		return false;
+	}
+
+	int positionProps[3] = { element.FindProperty("x"), element.FindProperty("y"), element.FindProperty("z") };
+	int normalProps[3] = { element.FindProperty("nx"), element.FindProperty("ny"), element.FindProperty("nz") };
+	int colorProps[4] = { element.FindProperty("red"), element.FindProperty("green"), element.FindProperty("blue"), element.FindProperty("alpha") };
+	int uProp = element.FindProperty("u");
+	int vProp = element.FindProperty("v");
+	if (uProp < 0) { uProp = element.FindProperty("s"); }
+	if (vProp < 0) { vProp = element.FindProperty("t"); }
+	if (uProp < 0) { uProp = element.FindProperty("texture_u"); }
+	if (vProp < 0) { vProp = element.FindProperty("texture_v"); }
+
+	if (positionProps[0] < 0 || positionProps[1] < 0 || positionProps[2] < 0)
+	{
+		return false;
+	}
+	out_hasNormals = normalProps[0] >= 0 && normalProps[1] >= 0 && normalProps[2] >= 0;
+	bool hasColors = colorProps[0] >= 0 && colorProps[1] >= 0 && colorProps[2] >= 0;
+	bool hasUVs = uProp >= 0 && vProp >= 0;
+
+	std::vector<PLYProperty> const& properties = element.m_properties;
+	auto readProperty = [&](char const* record, int propertyIndex) -> float
+	{
+		PLYProperty const& property = properties[propertyIndex];
+		return static_cast<float>(ReadPLYScalar(record + property.m_offset, property.m_type, isBigEndian));
+	};
+	auto readColorChannel = [&](char const* record, int propertyIndex) -> unsigned char
+	{
+		float value = readProperty(record, propertyIndex);
+		bool isNormalized = properties[propertyIndex].m_type == PLYScalarType::FLOAT32 || properties[propertyIndex].m_type == PLYScalarType::FLOAT64;
+		return static_cast<unsigned char>(GetClamped(isNormalized ? value * 255.f : value, 0.f, 255.f));
+	};
+
+	out_model.m_verts.resize(element.m_count);
+	for (size_t vertIndex = 0; vertIndex < element.m_count; ++vertIndex)
+	{
+		char const* record = reader.Acquire(element.m_fixedStride);
+		if (record == nullptr)
+		{
+			return false;
+		}
+
+		Vertex_PCUTBN& vertex = out_model.m_verts[vertIndex];
+		vertex.m_position = Vec3(readProperty(record, positionProps[0]), readProperty(record, positionProps[1]), readProperty(record, positionProps[2]));
+		vertex.m_color = Rgba8::WHITE;
+		if (out_hasNormals)
+		{
+			vertex.m_normal = Vec3(readProperty(record, normalProps[0]), readProperty(record, normalProps[1]), readProperty(record, normalProps[2]));
+		}
+		if (hasColors)
+		{
+			vertex.m_color.r = readColorChannel(record, colorProps[0]);
+			vertex.m_color.g = readColorChannel(record, colorProps[1]);
+			vertex.m_color.b = readColorChannel(record, colorProps[2]);
+			vertex.m_color.a = (colorProps[3] >= 0) ? readColorChannel(record, colorProps[3]) : 255;
+		}
+		if (hasUVs)
+		{
+			vertex.m_uvTexCoords = Vec2(readProperty(record, uProp), readProperty(record, vProp));
+		}
+	}
+	return true;
+}
+
+static bool ReadPLYFaces(BinaryFileReader& reader, PLYElement const& element, bool isBigEndian, ModelData& out_model)
+{
+	int indexListProp = element.FindProperty("vertex_indices");
+	if (indexListProp < 0)
+	{
+		indexListProp = element.FindProperty("vertex_index");
+	}
+	if (indexListProp < 0 || !element.m_properties[indexListProp].m_isList)
+	{
+		return false;
+	}
+
+	unsigned int numVerts = static_cast<unsigned int>(out_model.m_verts.size());
+	std::vector<unsigned int> faceIndices;
+	out_model.m_indices.reserve(element.m_count * 3);
+
+	for (size_t faceIndex = 0; faceIndex < element.m_count; ++faceIndex)
+	{
+		for (int propertyIndex = 0; propertyIndex < static_cast<int>(element.m_properties.size()); ++propertyIndex)
+		{
+			PLYProperty const& property = element.m_properties[propertyIndex];
+			size_t itemSize = GetPLYScalarSize(property.m_type);
+			if (!property.m_isList)
+			{
+				if (!reader.Skip(itemSize))
+				{
+					return false;
+				}
+				continue;
+			}
+
+			size_t count = 0;
+			if (!ReadPLYListCount(reader, property, isBigEndian, count))
+			{
+				return false;
+			}
+			char const* listData = reader.Acquire(count * itemSize);
+			if (listData == nullptr)
+			{
+				return false;
+			}
+			if (propertyIndex != indexListProp)
+			{
+				continue;
+			}
+
+			faceIndices.clear();
+			for (size_t corner = 0; corner < count; ++corner)
+			{
+				unsigned int vertIndex = static_cast<unsigned int>(ReadPLYScalar(listData + corner * itemSize, property.m_type, isBigEndian));
+				if (vertIndex >= numVerts)
+				{
+					return false;
+				}
+				faceIndices.push_back(vertIndex);
+			}
+
+			// Fan-triangulate polygons
+			for (size_t corner = 1; corner + 1 < faceIndices.size(); ++corner)
+			{
+				out_model.m_indices.push_back(faceIndices[0]);
+				out_model.m_indices.push_back(faceIndices[corner]);
+				out_model.m_indices.push_back(faceIndices[corner + 1]);
+			}
+		}
+	}
+	return true;
+}
+
+bool LoadBinaryPLYModel(ModelData& out_model, std::string const& plyFilePath)
+{
+	out_model.Clear();
+
+	BinaryFileReader reader;
+	if (!reader.Open(plyFilePath))
+	{
+		return false;
+	}
+
+	std::vector<PLYElement> elements;
+	bool isBigEndian = false;
+	if (!ParsePLYHeader(reader, elements, isBigEndian, plyFilePath))
+	{
+		return false;
+	}
+
+	bool hasNormals = false;
+	for (int elementIndex = 0; elementIndex < static_cast<int>(elements.size()); ++elementIndex)
+	{
+		PLYElement const& element = elements[elementIndex];
+		if (!DoPLYRecordsFit(reader, element.m_count, element.GetMinRecordSize()))
+		{
+			DebuggerPrintf("WARNING: PLY file \"%s\" declares %llu \"%s\" records, more than the rest of the file holds\n", plyFilePath.c_str(),
+				static_cast<unsigned long long>(element.m_count), element.m_name.c_str());
+			return false;
+		}
+
+		bool isElementRead = true;
+		if (element.m_name == "vertex")
+		{
+			isElementRead = ReadPLYVertices(reader, element, isBigEndian, out_model, hasNormals);
+		}
+		else if (element.m_name == "face")
+		{
+			isElementRead = ReadPLYFaces(reader, element, isBigEndian, out_model);
+		}
+		else if (!element.m_hasLists)
+		{
+			isElementRead = reader.Skip(element.m_count * element.m_fixedStride);
+		}
+		else
+		{
+			for (size_t recordIndex = 0; recordIndex < element.m_count && isElementRead; ++recordIndex)
+			{
+				isElementRead = SkipPLYElementRecord(reader, element, isBigEndian);
+			}
+		}
+
+		if (!isElementRead)
+		{
+			DebuggerPrintf("WARNING: PLY file \"%s\" has a malformed \"%s\" element\n", plyFilePath.c_str(), element.m_name.c_str());
+			return false;
+		}
+	}
+
+	AddDefaultSubmesh(out_model);
+	if (!hasNormals)
+	{
+		CalculateModelNormals(out_model);
+	}
+	CalculateModelTangents(out_model);
+	return !out_model.m_indices.empty();
+}
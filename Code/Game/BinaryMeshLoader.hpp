@@ -0,0 +1,45 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include <functional>
+#include <stdio.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Sequential reader that pulls a file through a large fixed buffer, so importers can
+// consume records straight out of memory instead of issuing one small read per field.
+// -----------------------------------------------------------------------------
+class BinaryFileReader
+{
+public:
+	BinaryFileReader(size_t blockSizeBytes = 4 * 1024 * 1024);
+	~BinaryFileReader();
+
+	bool Open(std::string const& filePath);
+	void Close();
+
+	bool Read(void* out_data, size_t numBytes);
+	bool Skip(size_t numBytes);
+	bool ReadLine(std::string& out_line);
+	char const* Acquire(size_t numBytes);
+
+	size_t GetFileSize() const { return m_fileSize; }
+	size_t GetBytesConsumed() const { return m_fileOffsetOfBuffer + m_bufferReadPos; }
+	size_t GetBytesRemaining() const { return m_fileSize - GetBytesConsumed(); }
+
+private:
+	bool RefillBuffer(size_t minBytesNeeded);
+
+private:
+	FILE*				m_file = nullptr;
+	size_t				m_fileSize = 0;
+	std::vector<char>	m_buffer;
+	size_t				m_bufferReadPos = 0;
+	size_t				m_bufferEnd = 0;
+	size_t				m_fileOffsetOfBuffer = 0;
+};
+// -----------------------------------------------------------------------------
+bool LoadBinarySTLModel(ModelData& out_model, std::string const& stlFilePath);
+bool LoadBinaryPLYModel(ModelData& out_model, std::string const& plyFilePath);
+
+// Streams a binary STL one triangle at a time through a fixed buffer, without building a model
+bool ForEachBinarySTLTriangle(std::string const& stlFilePath, std::function<void(Vertex_PCUTBN const* corners)> const& visitTriangle);
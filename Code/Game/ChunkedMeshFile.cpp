@@ -0,0 +1,524 @@
+#include "Game/ChunkedMeshFile.hpp"
+#include "Game/BinaryMeshLoader.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <float.h>
+#include <filesystem>
+#include <functional>
+#include <math.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Spill files are kept open for one group of chunks per pass over the source
+constexpr int MAX_OPEN_SPILL_FILES = 256;
+constexpr size_t SPILL_FILE_BUFFER_BYTES = 64 * 1024;
+
+// -----------------------------------------------------------------------------
+AABB3 ChunkedMeshChunkInfo::GetBounds() const
+{
+	return AABB3(m_boundsMins[0], m_boundsMins[1], m_boundsMins[2], m_boundsMaxs[0], m_boundsMaxs[1], m_boundsMaxs[2]);
+}
+
+// -----------------------------------------------------------------------------
+static FILE* OpenChunkedMeshFile(std::string const& filePath, char const* mode)
+{
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, filePath.c_str(), mode) != 0)
+	{
+		file = nullptr;
+	}
+#else
+	file = fopen(filePath.c_str(), mode);
+#endif
+	return file;
+}
+
+static bool SeekChunkedMeshFile(FILE* file, uint64_t offset)
+{
+#if defined(_MSC_VER)
+	return _fseeki64(file, static_cast<long long>(offset), SEEK_SET) == 0;
+#else
+	return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+static uint64_t AlignPageOffset(uint64_t offset)
+{
+	return (offset + CHUNKED_MESH_PAGE_ALIGNMENT - 1) & ~(CHUNKED_MESH_PAGE_ALIGNMENT - 1);
+}
+
+// -----------------------------------------------------------------------------
+// Visits every triangle of the source once per call; a pass can be repeated as often as needed
+using ChunkedMeshTriangleVisitor = std::function<void(Vertex_PCUTBN const* corners)>;
+using ChunkedMeshTriangleSource = std::function<bool(ChunkedMeshTriangleVisitor const& visitTriangle)>;
+
+// -----------------------------------------------------------------------------
+// Fine uniform grid over the model bounds; triangles are counted per cell and the cells are then grouped into chunks
+struct ChunkGrid
+{
+	Vec3	m_mins;
+	Vec3	m_cellsPerUnit;
+	int		m_dims[3] = { 1, 1, 1 };
+
+	void Initialize(AABB3 const& bounds, double numCells)
+	{
+		Vec3 size = bounds.m_maxs - bounds.m_mins;
+		float largestSize = std::max(size.x, std::max(size.y, size.z));
+		float minSize = std::max(largestSize * 1e-3f, 1e-6f);
+		float extents[3] = { std::max(size.x, minSize), std::max(size.y, minSize), std::max(size.z, minSize) };
+		double cellSize = cbrt(static_cast<double>(extents[0]) * extents[1] * extents[2] / std::max(numCells, 1.0));
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			m_dims[axis] = std::max(1, std::min(static_cast<int>(ceil(extents[axis] / cellSize)), 1024));
+		}
+		m_mins = bounds.m_mins;
+		m_cellsPerUnit = Vec3(m_dims[0] / extents[0], m_dims[1] / extents[1], m_dims[2] / extents[2]);
+	}
+
+	int GetNumCells() const
+	{
+		return m_dims[0] * m_dims[1] * m_dims[2];
+	}
+
+	int GetCellIndex(int cellX, int cellY, int cellZ) const
+	{
+		return (cellZ * m_dims[1] + cellY) * m_dims[0] + cellX;
+	}
+
+	int GetCellIndex(Vec3 const& position) const
+	{
+		Vec3 cellPosition = position - m_mins;
+		int cellX = std::max(0, std::min(static_cast<int>(cellPosition.x * m_cellsPerUnit.x), m_dims[0] - 1));
+		int cellY = std::max(0, std::min(static_cast<int>(cellPosition.y * m_cellsPerUnit.y), m_dims[1] - 1));
+		int cellZ = std::max(0, std::min(static_cast<int>(cellPosition.z * m_cellsPerUnit.z), m_dims[2] - 1));
+		return GetCellIndex(cellX, cellY, cellZ);
+	}
+};
+
+// -----------------------------------------------------------------------------
+// Splits a box of grid cells at its triangle median along the longest side until each piece fits
+// in one chunk. Scans fill a thin shell of the grid, so splitting by count rather than by volume
+// keeps chunks near the target size whether the model is a surface or a solid.
+static void SplitCellsIntoChunks(ChunkGrid const& grid, std::vector<uint64_t> const& cellTriangleCounts, int const cellMins[3], int const cellMaxs[3],
+	uint64_t trianglesPerChunk, std::vector<int>& inout_cellChunkIndices, std::vector<uint64_t>& inout_chunkTriangleCounts)
+{
+	int longestAxis = 0;
+	for (int axis = 1; axis < 3; ++axis)
+	{
+		if (cellMaxs[axis] - cellMins[axis] > cellMaxs[longestAxis] - cellMins[longestAxis])
+		{
+			longestAxis = axis;
+		}
+	}
+
+	// Triangles per slab of cells along the longest axis
+	int numSlabs = cellMaxs[longestAxis] - cellMins[longestAxis];
+	std::vector<uint64_t> slabTriangleCounts(numSlabs, 0);
+	uint64_t numTriangles = 0;
+	for (int cellZ = cellMins[2]; cellZ < cellMaxs[2]; ++cellZ)
+	{
+		for (int cellY = cellMins[1]; cellY < cellMaxs[1]; ++cellY)
+		{
+			for (int cellX = cellMins[0]; cellX < cellMaxs[0]; ++cellX)
+			{
+				int cellCoords[3] = { cellX, cellY, cellZ };
+				uint64_t cellTriangleCount = cellTriangleCounts[grid.GetCellIndex(cellX, cellY, cellZ)];
+				slabTriangleCounts[cellCoords[longestAxis] - cellMins[longestAxis]] += cellTriangleCount;
+				numTriangles += cellTriangleCount;
+			}
+		}
+	}
+	if (numTriangles == 0)
+	{
+		return;
+	}
+
+	if (numTriangles <= trianglesPerChunk || numSlabs == 1)
+	{
+		int chunkIndex = static_cast<int>(inout_chunkTriangleCounts.size());
+		inout_chunkTriangleCounts.push_back(numTriangles);
+		for (int cellZ = cellMins[2]; cellZ < cellMaxs[2]; ++cellZ)
+		{
+			for (int cellY = cellMins[1]; cellY < cellMaxs[1]; ++cellY)
+			{
+				for (int cellX = cellMins[0]; cellX < cellMaxs[0]; ++cellX)
+				{
+					inout_cellChunkIndices[grid.GetCellIndex(cellX, cellY, cellZ)] = chunkIndex;
+				}
+			}
+		}
+		return;
+	}
+
+	int splitSlab = 1;
+	uint64_t trianglesBelowSplit = slabTriangleCounts[0];
+	while (splitSlab < numSlabs - 1 && trianglesBelowSplit + slabTriangleCounts[splitSlab] <= numTriangles / 2)
+	{
+		trianglesBelowSplit += slabTriangleCounts[splitSlab];
+		++splitSlab;
+	}
+
+	int lowerMaxs[3] = { cellMaxs[0], cellMaxs[1], cellMaxs[2] };
+	int upperMins[3] = { cellMins[0], cellMins[1], cellMins[2] };
+	lowerMaxs[longestAxis] = cellMins[longestAxis] + splitSlab;
+	upperMins[longestAxis] = cellMins[longestAxis] + splitSlab;
+	SplitCellsIntoChunks(grid, cellTriangleCounts, cellMins, lowerMaxs, trianglesPerChunk, inout_cellChunkIndices, inout_chunkTriangleCounts);
+	SplitCellsIntoChunks(grid, cellTriangleCounts, upperMins, cellMaxs, trianglesPerChunk, inout_cellChunkIndices, inout_chunkTriangleCounts);
+}
+
+// -----------------------------------------------------------------------------
+static Vec3 GetTriangleCentroid(Vertex_PCUTBN const* corners)
+{
+	return (corners[0].m_position + corners[1].m_position + corners[2].m_position) * (1.f / 3.f);
+}
+
+static void ExpandBounds(float mins[3], float maxs[3], Vec3 const& position)
+{
+	float values[3] = { position.x, position.y, position.z };
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		mins[axis] = std::min(mins[axis], values[axis]);
+		maxs[axis] = std::max(maxs[axis], values[axis]);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Shares bit-identical corners inside one chunk; triangle soups from STL and unwelded loaders shrink the most
+static void WeldChunkVerts(std::vector<Vertex_PCUTBN> const& cornerVerts, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices)
+{
+	size_t tableSize = 1;
+	while (tableSize < cornerVerts.size() * 2)
+	{
+		tableSize <<= 1;
+	}
+	std::vector<unsigned int> table(tableSize, 0xFFFFFFFFu);
+
+	out_verts.clear();
+	out_indices.resize(cornerVerts.size());
+	for (int cornerIndex = 0; cornerIndex < static_cast<int>(cornerVerts.size()); ++cornerIndex)
+	{
+		Vertex_PCUTBN const& vertex = cornerVerts[cornerIndex];
+		unsigned char const* bytes = reinterpret_cast<unsigned char const*>(&vertex);
+		uint64_t hash = 14695981039346656037ull;
+		for (size_t byteIndex = 0; byteIndex < sizeof(Vertex_PCUTBN); ++byteIndex)
+		{
+			hash = (hash ^ bytes[byteIndex]) * 1099511628211ull;
+		}
+
+		size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+		while (table[slot] != 0xFFFFFFFFu && memcmp(&out_verts[table[slot]], &vertex, sizeof(Vertex_PCUTBN)) != 0)
+		{
+			slot = (slot + 1) & (tableSize - 1);
+		}
+		if (table[slot] == 0xFFFFFFFFu)
+		{
+			table[slot] = static_cast<unsigned int>(out_verts.size());
+			out_verts.push_back(vertex);
+		}
+		out_indices[cornerIndex] = table[slot];
+	}
+}
+
+// -----------------------------------------------------------------------------
+static bool WriteChunkPage(FILE* outputFile, uint64_t& inout_fileOffset, std::vector<Vertex_PCUTBN> const& cornerVerts, bool calculateTangents, ChunkedMeshChunkInfo& out_chunk)
+{
+	ModelData chunkModel;
+	WeldChunkVerts(cornerVerts, chunkModel.m_verts, chunkModel.m_indices);
+	if (calculateTangents)
+	{
+		CalculateModelTangents(chunkModel);
+	}
+
+	out_chunk.m_fileOffset = AlignPageOffset(inout_fileOffset);
+	out_chunk.m_numVerts = static_cast<uint32_t>(chunkModel.m_verts.size());
+	out_chunk.m_numIndices = static_cast<uint32_t>(chunkModel.m_indices.size());
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		out_chunk.m_boundsMins[axis] = FLT_MAX;
+		out_chunk.m_boundsMaxs[axis] = -FLT_MAX;
+	}
+	for (int vertIndex = 0; vertIndex < static_cast<int>(chunkModel.m_verts.size()); ++vertIndex)
+	{
+		ExpandBounds(out_chunk.m_boundsMins, out_chunk.m_boundsMaxs, chunkModel.m_verts[vertIndex].m_position);
+	}
+
+	if (!SeekChunkedMeshFile(outputFile, out_chunk.m_fileOffset)
+		|| fwrite(chunkModel.m_verts.data(), sizeof(Vertex_PCUTBN), chunkModel.m_verts.size(), outputFile) != chunkModel.m_verts.size()
+		|| fwrite(chunkModel.m_indices.data(), sizeof(unsigned int), chunkModel.m_indices.size(), outputFile) != chunkModel.m_indices.size())
+	{
+		return false;
+	}
+	inout_fileOffset = out_chunk.m_fileOffset + out_chunk.GetPageBytes();
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+static bool WriteChunkedMesh(ChunkedMeshTriangleSource const& triangleSource, bool calculateTangents, std::string const& chunkedFile, int trianglesPerChunk,
+	ChunkedMeshImportStats& out_stats, std::string& out_errorMessage)
+{
+	// Pass 1: bounds and triangle count
+	ChunkedMeshHeader header;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		header.m_boundsMins[axis] = FLT_MAX;
+		header.m_boundsMaxs[axis] = -FLT_MAX;
+	}
+	bool isSourceRead = triangleSource([&header](Vertex_PCUTBN const* corners)
+	{
+		for (int corner = 0; corner < 3; ++corner)
+		{
+			ExpandBounds(header.m_boundsMins, header.m_boundsMaxs, corners[corner].m_position);
+		}
+		++header.m_numTriangles;
+	});
+	++out_stats.m_numSourcePasses;
+	if (!isSourceRead || header.m_numTriangles == 0)
+	{
+		out_errorMessage = "the source model could not be read or has no triangles";
+		return false;
+	}
+
+	// Pass 2: count triangles on a grid a few dozen cells per chunk fine, then group the cells into chunks
+	ChunkGrid grid;
+	AABB3 bounds(header.m_boundsMins[0], header.m_boundsMins[1], header.m_boundsMins[2], header.m_boundsMaxs[0], header.m_boundsMaxs[1], header.m_boundsMaxs[2]);
+	grid.Initialize(bounds, std::min(64.0 * static_cast<double>(header.m_numTriangles) / static_cast<double>(trianglesPerChunk), 4.0 * 1024.0 * 1024.0));
+	std::vector<uint64_t> cellTriangleCounts(grid.GetNumCells(), 0);
+	triangleSource([&grid, &cellTriangleCounts](Vertex_PCUTBN const* corners)
+	{
+		++cellTriangleCounts[grid.GetCellIndex(GetTriangleCentroid(corners))];
+	});
+	++out_stats.m_numSourcePasses;
+
+	std::vector<int> cellChunkIndices(grid.GetNumCells(), -1);
+	std::vector<uint64_t> chunkTriangleCounts;
+	int const gridMins[3] = { 0, 0, 0 };
+	SplitCellsIntoChunks(grid, cellTriangleCounts, gridMins, grid.m_dims, static_cast<uint64_t>(trianglesPerChunk), cellChunkIndices, chunkTriangleCounts);
+	header.m_numChunks = static_cast<uint32_t>(chunkTriangleCounts.size());
+	std::vector<ChunkedMeshChunkInfo> chunks(header.m_numChunks);
+
+	FILE* outputFile = OpenChunkedMeshFile(chunkedFile, "wb");
+	if (outputFile == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\" for writing", chunkedFile.c_str());
+		return false;
+	}
+
+	// Remaining passes: spill one group of chunks to temporary files, then weld and page each one out
+	uint64_t fileOffset = sizeof(ChunkedMeshHeader) + sizeof(ChunkedMeshChunkInfo) * chunks.size();
+	bool isWriteOk = true;
+	std::vector<Vertex_PCUTBN> cornerVerts;
+	for (int firstChunkIndex = 0; isWriteOk && firstChunkIndex < static_cast<int>(chunks.size()); firstChunkIndex += MAX_OPEN_SPILL_FILES)
+	{
+		int numGroupChunks = std::min(MAX_OPEN_SPILL_FILES, static_cast<int>(chunks.size()) - firstChunkIndex);
+		std::vector<FILE*> spillFiles(numGroupChunks, nullptr);
+		std::vector<std::string> spillFilePaths(numGroupChunks);
+		for (int groupIndex = 0; groupIndex < numGroupChunks; ++groupIndex)
+		{
+			spillFilePaths[groupIndex] = Stringf("%s.spill%d", chunkedFile.c_str(), firstChunkIndex + groupIndex);
+			spillFiles[groupIndex] = OpenChunkedMeshFile(spillFilePaths[groupIndex], "w+b");
+			if (spillFiles[groupIndex] == nullptr)
+			{
+				out_errorMessage = Stringf("could not create spill file \"%s\"", spillFilePaths[groupIndex].c_str());
+				isWriteOk = false;
+				break;
+			}
+			setvbuf(spillFiles[groupIndex], nullptr, _IOFBF, SPILL_FILE_BUFFER_BYTES);
+		}
+
+		if (isWriteOk)
+		{
+			triangleSource([&](Vertex_PCUTBN const* corners)
+			{
+				int groupIndex = cellChunkIndices[grid.GetCellIndex(GetTriangleCentroid(corners))] - firstChunkIndex;
+				if (groupIndex >= 0 && groupIndex < numGroupChunks && fwrite(corners, sizeof(Vertex_PCUTBN), 3, spillFiles[groupIndex]) != 3)
+				{
+					isWriteOk = false;
+				}
+			});
+			++out_stats.m_numSourcePasses;
+			if (!isWriteOk)
+			{
+				out_errorMessage = "writing a spill file failed; the disk may be full";
+			}
+		}
+
+		for (int groupIndex = 0; groupIndex < numGroupChunks; ++groupIndex)
+		{
+			FILE* spillFile = spillFiles[groupIndex];
+			if (spillFile == nullptr)
+			{
+				continue;
+			}
+
+			if (isWriteOk)
+			{
+				cornerVerts.resize(static_cast<size_t>(chunkTriangleCounts[firstChunkIndex + groupIndex]) * 3);
+				rewind(spillFile);
+				isWriteOk = fread(cornerVerts.data(), sizeof(Vertex_PCUTBN), cornerVerts.size(), spillFile) == cornerVerts.size();
+
+				ChunkedMeshChunkInfo& chunk = chunks[firstChunkIndex + groupIndex];
+				isWriteOk = isWriteOk && WriteChunkPage(outputFile, fileOffset, cornerVerts, calculateTangents, chunk);
+				if (!isWriteOk)
+				{
+					out_errorMessage = Stringf("writing chunk %d to \"%s\" failed", firstChunkIndex + groupIndex, chunkedFile.c_str());
+				}
+				out_stats.m_maxChunkTriangles = std::max(out_stats.m_maxChunkTriangles, static_cast<int>(chunk.m_numIndices / 3));
+			}
+			fclose(spillFile);
+			std::error_code errorCode;
+			std::filesystem::remove(spillFilePaths[groupIndex], errorCode);
+		}
+	}
+
+	// The header and chunk table go in last, once every page offset is known
+	isWriteOk = isWriteOk && SeekChunkedMeshFile(outputFile, 0)
+		&& fwrite(&header, sizeof(header), 1, outputFile) == 1
+		&& fwrite(chunks.data(), sizeof(ChunkedMeshChunkInfo), chunks.size(), outputFile) == chunks.size();
+	isWriteOk = (fclose(outputFile) == 0) && isWriteOk;
+	if (!isWriteOk)
+	{
+		if (out_errorMessage.empty())
+		{
+			out_errorMessage = Stringf("writing \"%s\" failed", chunkedFile.c_str());
+		}
+		std::error_code errorCode;
+		std::filesystem::remove(chunkedFile, errorCode);
+		return false;
+	}
+
+	out_stats.m_numTriangles = header.m_numTriangles;
+	out_stats.m_numChunks = static_cast<int>(header.m_numChunks);
+	out_stats.m_fileBytes = fileOffset;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+bool ImportChunkedMesh(std::string const& sourceFile, ModelFileFormat sourceFormat, std::string const& chunkedFile, int trianglesPerChunk,
+	ChunkedMeshImportStats& out_stats, std::string& out_errorMessage)
+{
+	double startTime = GetCurrentTimeSeconds();
+	out_stats = ChunkedMeshImportStats();
+	trianglesPerChunk = std::max(trianglesPerChunk, 256);
+
+	bool isImported = false;
+	if (sourceFormat == ModelFileFormat::STL)
+	{
+		ChunkedMeshTriangleSource stlSource = [&sourceFile](ChunkedMeshTriangleVisitor const& visitTriangle)
+		{
+			return ForEachBinarySTLTriangle(sourceFile, visitTriangle);
+		};
+		isImported = WriteChunkedMesh(stlSource, true, chunkedFile, trianglesPerChunk, out_stats, out_errorMessage);
+	}
+	else if (sourceFormat == ModelFileFormat::OBJ)
+	{
+		ChunkedMeshTriangleSource objSource = [&sourceFile](ChunkedMeshTriangleVisitor const& visitTriangle)
+		{
+			return ForEachOBJTriangle(sourceFile, visitTriangle);
+		};
+		isImported = WriteChunkedMesh(objSource, true, chunkedFile, trianglesPerChunk, out_stats, out_errorMessage);
+	}
+	else
+	{
+		// PLY and GLB only have whole-model loaders, so they are chunked from memory
+		ModelData model;
+		if (!LoadModelFile(model, sourceFile, sourceFormat))
+		{
+			out_errorMessage = Stringf("failed to load \"%s\"", sourceFile.c_str());
+			return false;
+		}
+
+		ChunkedMeshTriangleSource modelSource = [&model](ChunkedMeshTriangleVisitor const& visitTriangle)
+		{
+			Vertex_PCUTBN corners[3];
+			for (size_t index = 0; index + 2 < model.m_indices.size(); index += 3)
+			{
+				corners[0] = model.m_verts[model.m_indices[index]];
+				corners[1] = model.m_verts[model.m_indices[index + 1]];
+				corners[2] = model.m_verts[model.m_indices[index + 2]];
+				visitTriangle(corners);
+			}
+			return true;
+		};
+		isImported = WriteChunkedMesh(modelSource, false, chunkedFile, trianglesPerChunk, out_stats, out_errorMessage);
+	}
+
+	out_stats.m_seconds = GetCurrentTimeSeconds() - startTime;
+	return isImported;
+}
+
+// -----------------------------------------------------------------------------
+bool ReadChunkedMeshTable(std::string const& chunkedFile, ChunkedMeshHeader& out_header, std::vector<ChunkedMeshChunkInfo>& out_chunks, std::string& out_errorMessage)
+{
+	std::error_code errorCode;
+	uint64_t fileSize = static_cast<uint64_t>(std::filesystem::file_size(chunkedFile, errorCode));
+	FILE* file = errorCode ? nullptr : OpenChunkedMeshFile(chunkedFile, "rb");
+	if (file == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\"", chunkedFile.c_str());
+		return false;
+	}
+
+	bool isHeaderRead = fread(&out_header, sizeof(out_header), 1, file) == 1;
+	if (!isHeaderRead || out_header.m_magic != CHUNKED_MESH_MAGIC || out_header.m_version != CHUNKED_MESH_VERSION || out_header.m_vertexSize != sizeof(Vertex_PCUTBN))
+	{
+		fclose(file);
+		out_errorMessage = Stringf("\"%s\" is not a version %u chunked mesh file", chunkedFile.c_str(), CHUNKED_MESH_VERSION);
+		return false;
+	}
+
+	// The count comes from the file, so it is checked against the file before anything is sized by it
+	uint64_t tableBytes = static_cast<uint64_t>(out_header.m_numChunks) * sizeof(ChunkedMeshChunkInfo);
+	if (tableBytes > fileSize - sizeof(out_header))
+	{
+		fclose(file);
+		out_errorMessage = Stringf("\"%s\" claims %u chunks, more than the file holds", chunkedFile.c_str(), out_header.m_numChunks);
+		return false;
+	}
+
+	out_chunks.resize(out_header.m_numChunks);
+	bool isTableRead = fread(out_chunks.data(), sizeof(ChunkedMeshChunkInfo), out_chunks.size(), file) == out_chunks.size();
+	fclose(file);
+	if (!isTableRead)
+	{
+		out_errorMessage = Stringf("\"%s\" has a truncated chunk table", chunkedFile.c_str());
+		return false;
+	}
+
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(out_chunks.size()); ++chunkIndex)
+	{
+		ChunkedMeshChunkInfo const& chunk = out_chunks[chunkIndex];
+		if (chunk.m_fileOffset > fileSize || chunk.GetPageBytes() > fileSize - chunk.m_fileOffset)
+		{
+			out_errorMessage = Stringf("\"%s\" is truncated at chunk %d", chunkedFile.c_str(), chunkIndex);
+			return false;
+		}
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+bool ReadChunkedMeshPage(FILE* file, ChunkedMeshChunkInfo const& chunk, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices)
+{
+	out_verts.resize(chunk.m_numVerts);
+	out_indices.resize(chunk.m_numIndices);
+	if (!SeekChunkedMeshFile(file, chunk.m_fileOffset)
+		|| fread(out_verts.data(), sizeof(Vertex_PCUTBN), out_verts.size(), file) != out_verts.size()
+		|| fread(out_indices.data(), sizeof(unsigned int), out_indices.size(), file) != out_indices.size())
+	{
+		return false;
+	}
+
+	// A damaged page must not reach the GPU with indices past its own vertices
+	for (int index = 0; index < static_cast<int>(out_indices.size()); ++index)
+	{
+		if (out_indices[index] >= chunk.m_numVerts)
+		{
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Chunked mesh files (.cmsh) hold a model cut into spatial chunks. Each chunk is a self-contained
+// page of Vertex_PCUTBN verts followed by 32-bit local indices, aligned so a viewer can read
+// any one chunk with a single seek and read without touching the rest of the file.
+// -----------------------------------------------------------------------------
+constexpr uint32_t CHUNKED_MESH_MAGIC = 0x48534D43; // "CMSH"
+constexpr uint32_t CHUNKED_MESH_VERSION = 1;
+constexpr uint64_t CHUNKED_MESH_PAGE_ALIGNMENT = 4096;
+// -----------------------------------------------------------------------------
+struct ChunkedMeshHeader
+{
+	uint32_t	m_magic = CHUNKED_MESH_MAGIC;
+	uint32_t	m_version = CHUNKED_MESH_VERSION;
+	uint32_t	m_vertexSize = sizeof(Vertex_PCUTBN);
+	uint32_t	m_numChunks = 0;
+	uint64_t	m_numTriangles = 0;
+	float		m_boundsMins[3] = {};
+	float		m_boundsMaxs[3] = {};
+};
+// -----------------------------------------------------------------------------
+// One entry of the chunk table that follows the header
+struct ChunkedMeshChunkInfo
+{
+	uint64_t	m_fileOffset = 0;
+	uint32_t	m_numVerts = 0;
+	uint32_t	m_numIndices = 0;
+	float		m_boundsMins[3] = {};
+	float		m_boundsMaxs[3] = {};
+
+	uint64_t GetPageBytes() const { return static_cast<uint64_t>(m_numVerts) * sizeof(Vertex_PCUTBN) + static_cast<uint64_t>(m_numIndices) * sizeof(unsigned int); }
+	AABB3	 GetBounds() const;
+};
+// -----------------------------------------------------------------------------
+struct ChunkedMeshImportStats
+{
+	uint64_t	m_numTriangles = 0;
+	int			m_numChunks = 0;
+	int			m_maxChunkTriangles = 0;
+	int			m_numSourcePasses = 0;
+	uint64_t	m_fileBytes = 0;
+	double		m_seconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+// Cuts a model into spatial chunks of at most about trianglesPerChunk triangles and writes them as a
+// chunked mesh file. Binary STL and OBJ are streamed from disk in passes and spilled per chunk, so
+// the whole mesh is never resident (OBJ keeps its position, uv and normal arrays, which faces
+// index into); PLY and GLB are loaded once in memory and then chunked.
+bool ImportChunkedMesh(std::string const& sourceFile, ModelFileFormat sourceFormat, std::string const& chunkedFile, int trianglesPerChunk,
+	ChunkedMeshImportStats& out_stats, std::string& out_errorMessage);
+
+// Reads the header and chunk table; the chunk pages stay on disk
+bool ReadChunkedMeshTable(std::string const& chunkedFile, ChunkedMeshHeader& out_header, std::vector<ChunkedMeshChunkInfo>& out_chunks, std::string& out_errorMessage);
+
+// Reads one chunk page from an open chunked mesh file
+bool ReadChunkedMeshPage(FILE* file, ChunkedMeshChunkInfo const& chunk, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices);
@@ -0,0 +1,259 @@
+#include "Game/ClusteredLighting.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+ClusteredLighting::ClusteredLighting()
+{
+	m_clusterLightLists.resize(static_cast<size_t>(NUM_LIGHT_CLUSTERS) * MAX_LIGHTS_PER_CLUSTER);
+	m_clusterLightCounts.resize(NUM_LIGHT_CLUSTERS);
+	m_clusterRanges.resize(static_cast<size_t>(NUM_LIGHT_CLUSTERS) * 2);
+	m_lightBinRanges.reserve(MAX_LOCAL_LIGHTS);
+	m_flatLightIndices.reserve(MAX_CLUSTER_LIGHT_INDICES);
+	m_packedLightIndices.reserve(MAX_CLUSTER_LIGHT_INDICES / 2);
+}
+
+// -----------------------------------------------------------------------------
+int ClusteredLighting::GetClusterLightIndex(int clusterIndex, int listIndex) const
+{
+	unsigned int flatIndex = m_clusterRanges[clusterIndex * 2] + static_cast<unsigned int>(listIndex);
+	unsigned int packed = m_packedLightIndices[flatIndex >> 1];
+	return static_cast<int>((flatIndex & 1) ? (packed >> 16) : (packed & 0xFFFF));
+}
+
+// -----------------------------------------------------------------------------
+int ClusteredLighting::GetDepthSlice(float viewDepth) const
+{
+	float slice = logf(viewDepth) * m_depthSliceScale + m_depthSliceBias;
+	return std::max(0, std::min(static_cast<int>(floorf(slice)), LIGHT_CLUSTERS_Z - 1));
+}
+
+// -----------------------------------------------------------------------------
+static void GetLightBoundingSphere(LocalLight const& light, Vec3& out_center, float& out_radius)
+{
+	out_center = light.m_position;
+	out_radius = light.m_radius;
+	if (light.m_type != LocalLightType::SPOT || light.m_outerConeDegrees >= 90.f)
+	{
+		return;
+	}
+
+	// Smallest sphere around the cone: wide cones are bounded by their cap circle, narrow ones
+	// by the sphere through the apex and the cap rim
+	float halfAngle = ConvertDegreesToRadians(GetClamped(light.m_outerConeDegrees, 0.f, 90.f));
+	float cosHalfAngle = cosf(halfAngle);
+	if (halfAngle > 0.25f * 3.14159265f)
+	{
+		out_center = light.m_position + light.m_direction * (light.m_radius * cosHalfAngle);
+		out_radius = light.m_radius * sinf(halfAngle);
+	}
+	else
+	{
+		out_radius = light.m_radius / (2.f * cosHalfAngle);
+		out_center = light.m_position + light.m_direction * out_radius;
+	}
+}
+
+// -----------------------------------------------------------------------------
+void ClusteredLighting::ComputeLightBinRange(LocalLight const& light, ViewFrustum const& frustum, LightBinRange& out_range) const
+{
+	out_range = LightBinRange();
+
+	Vec3 center;
+	float radius = 0.f;
+	GetLightBoundingSphere(light, center, radius);
+
+	Vec3 toCenter = center - frustum.m_position;
+	float viewDepth = DotProduct3D(toCenter, frustum.m_forward);
+	float viewRight = -DotProduct3D(toCenter, frustum.m_left);
+	float viewUp = DotProduct3D(toCenter, frustum.m_up);
+	if (viewDepth + radius < frustum.m_near || viewDepth - radius > frustum.m_far)
+	{
+		return;
+	}
+
+	// Column c spans tile planes c and c + 1; it is touched unless the sphere is fully outside either
+	int minX = LIGHT_CLUSTERS_X;
+	int maxX = -1;
+	for (int columnIndex = 0; columnIndex < LIGHT_CLUSTERS_X; ++columnIndex)
+	{
+		float distanceToMin = m_columnPlanes[columnIndex][0] * viewRight + m_columnPlanes[columnIndex][1] * viewDepth;
+		float distanceToMax = m_columnPlanes[columnIndex + 1][0] * viewRight + m_columnPlanes[columnIndex + 1][1] * viewDepth;
+		if (distanceToMin >= -radius && distanceToMax <= radius)
+		{
+			minX = std::min(minX, columnIndex);
+			maxX = columnIndex;
+		}
+	}
+
+	int minY = LIGHT_CLUSTERS_Y;
+	int maxY = -1;
+	for (int rowIndex = 0; rowIndex < LIGHT_CLUSTERS_Y; ++rowIndex)
+	{
+		float distanceToMin = m_rowPlanes[rowIndex][0] * viewUp + m_rowPlanes[rowIndex][1] * viewDepth;
+		float distanceToMax = m_rowPlanes[rowIndex + 1][0] * viewUp + m_rowPlanes[rowIndex + 1][1] * viewDepth;
+		if (distanceToMin >= -radius && distanceToMax <= radius)
+		{
+			minY = std::min(minY, rowIndex);
+			maxY = rowIndex;
+		}
+	}
+
+	if (maxX < 0 || maxY < 0)
+	{
+		return;
+	}
+
+	out_range.m_minX = minX;
+	out_range.m_maxX = maxX;
+	out_range.m_minY = minY;
+	out_range.m_maxY = maxY;
+	out_range.m_minZ = GetDepthSlice(std::max(viewDepth - radius, frustum.m_near));
+	out_range.m_maxZ = GetDepthSlice(std::min(viewDepth + radius, frustum.m_far));
+}
+
+// -----------------------------------------------------------------------------
+int ClusteredLighting::GetNumIndicesWithClusterCap(int clusterCap) const
+{
+	int numIndices = 0;
+	for (int clusterIndex = 0; clusterIndex < NUM_LIGHT_CLUSTERS; ++clusterIndex)
+	{
+		numIndices += std::min(m_clusterLightCounts[clusterIndex], clusterCap);
+	}
+	return numIndices;
+}
+
+// -----------------------------------------------------------------------------
+static void SetTilePlanes(float out_planes[][2], int numTiles, float projectionScale)
+{
+	// The plane through the eye at ndc = coord * depth * scale has normal (1, -k) / |(1, -k)|, k = ndc / scale
+	for (int planeIndex = 0; planeIndex <= numTiles; ++planeIndex)
+	{
+		float ndc = -1.f + 2.f * static_cast<float>(planeIndex) / static_cast<float>(numTiles);
+		float slope = ndc / projectionScale;
+		float inverseLength = 1.f / sqrtf(1.f + slope * slope);
+		out_planes[planeIndex][0] = inverseLength;
+		out_planes[planeIndex][1] = -slope * inverseLength;
+	}
+}
+
+// -----------------------------------------------------------------------------
+void ClusteredLighting::BuildClusters(ViewFrustum const& frustum, std::vector<LocalLight> const& lights)
+{
+	double buildStartTime = GetCurrentTimeSeconds();
+
+	float scaleY = 1.f / tanf(0.5f * ConvertDegreesToRadians(frustum.m_fovDegrees));
+	float scaleX = scaleY / frustum.m_aspect;
+	float logDepthRange = logf(frustum.m_far / frustum.m_near);
+
+	m_depthSliceScale = static_cast<float>(LIGHT_CLUSTERS_Z) / logDepthRange;
+	m_depthSliceBias = -static_cast<float>(LIGHT_CLUSTERS_Z) * logf(frustum.m_near) / logDepthRange;
+
+	SetTilePlanes(m_columnPlanes, LIGHT_CLUSTERS_X, scaleX);
+	SetTilePlanes(m_rowPlanes, LIGHT_CLUSTERS_Y, scaleY);
+
+	// Light setup: the cluster range each light's bounding sphere covers
+	int numLights = std::min(static_cast<int>(lights.size()), MAX_LOCAL_LIGHTS);
+	m_lightBinRanges.resize(numLights);
+	ParallelFor(numLights, 64, [&](int beginIndex, int endIndex)
+	{
+		for (int lightIndex = beginIndex; lightIndex < endIndex; ++lightIndex)
+		{
+			ComputeLightBinRange(lights[lightIndex], frustum, m_lightBinRanges[lightIndex]);
+		}
+	});
+
+	// Binning: one task per depth slice, so each task owns its clusters outright
+	std::vector<int> droppedPerSlice(LIGHT_CLUSTERS_Z, 0);
+	ParallelFor(LIGHT_CLUSTERS_Z, 1, [&](int beginSlice, int endSlice)
+	{
+		for (int sliceIndex = beginSlice; sliceIndex < endSlice; ++sliceIndex)
+		{
+			int firstCluster = GetClusterIndex(0, 0, sliceIndex);
+			std::fill(m_clusterLightCounts.begin() + firstCluster, m_clusterLightCounts.begin() + firstCluster + LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y, 0);
+
+			for (int lightIndex = 0; lightIndex < numLights; ++lightIndex)
+			{
+				LightBinRange const& range = m_lightBinRanges[lightIndex];
+				if (sliceIndex < range.m_minZ || sliceIndex > range.m_maxZ)
+				{
+					continue;
+				}
+
+				for (int y = range.m_minY; y <= range.m_maxY; ++y)
+				{
+					for (int x = range.m_minX; x <= range.m_maxX; ++x)
+					{
+						int clusterIndex = GetClusterIndex(x, y, sliceIndex);
+						int& count = m_clusterLightCounts[clusterIndex];
+						if (count >= MAX_LIGHTS_PER_CLUSTER)
+						{
+							++droppedPerSlice[sliceIndex];
+							continue;
+						}
+						m_clusterLightLists[static_cast<size_t>(clusterIndex) * MAX_LIGHTS_PER_CLUSTER + count] = static_cast<unsigned short>(lightIndex);
+						++count;
+					}
+				}
+			}
+		}
+	});
+
+	// Compaction into the flat range and index arrays
+	m_numDroppedIndices = 0;
+	for (int sliceIndex = 0; sliceIndex < LIGHT_CLUSTERS_Z; ++sliceIndex)
+	{
+		m_numDroppedIndices += droppedPerSlice[sliceIndex];
+	}
+
+	// Over budget, every cluster is capped at the same length so the loss is spread across the view
+	// instead of starving whichever clusters come last
+	int clusterCap = MAX_LIGHTS_PER_CLUSTER;
+	if (GetNumIndicesWithClusterCap(clusterCap) > MAX_CLUSTER_LIGHT_INDICES)
+	{
+		int lowCap = 0;
+		int highCap = MAX_LIGHTS_PER_CLUSTER;
+		while (highCap - lowCap > 1)
+		{
+			int midCap = (lowCap + highCap) / 2;
+			if (GetNumIndicesWithClusterCap(midCap) <= MAX_CLUSTER_LIGHT_INDICES)
+			{
+				lowCap = midCap;
+			}
+			else
+			{
+				highCap = midCap;
+			}
+		}
+		clusterCap = lowCap;
+	}
+
+	std::vector<unsigned short>& flatIndices = m_flatLightIndices;
+	flatIndices.clear();
+	for (int clusterIndex = 0; clusterIndex < NUM_LIGHT_CLUSTERS; ++clusterIndex)
+	{
+		int count = m_clusterLightCounts[clusterIndex];
+		if (count > clusterCap)
+		{
+			m_numDroppedIndices += count - clusterCap;
+			count = clusterCap;
+		}
+
+		m_clusterRanges[clusterIndex * 2] = static_cast<unsigned int>(flatIndices.size());
+		m_clusterRanges[clusterIndex * 2 + 1] = static_cast<unsigned int>(count);
+		unsigned short const* clusterList = &m_clusterLightLists[static_cast<size_t>(clusterIndex) * MAX_LIGHTS_PER_CLUSTER];
+		flatIndices.insert(flatIndices.end(), clusterList, clusterList + count);
+	}
+	m_numLightIndices = static_cast<int>(flatIndices.size());
+
+	m_packedLightIndices.assign((flatIndices.size() + 1) / 2, 0);
+	for (int flatIndex = 0; flatIndex < m_numLightIndices; ++flatIndex)
+	{
+		m_packedLightIndices[flatIndex >> 1] |= static_cast<unsigned int>(flatIndices[flatIndex]) << ((flatIndex & 1) * 16);
+	}
+
+	m_buildSeconds = GetCurrentTimeSeconds() - buildStartTime;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "Game/ViewFrustum.hpp"
+#include "Engine/Math/Vec3.h"
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class LocalLightType
+{
+	POINT,
+	SPOT,
+};
+// -----------------------------------------------------------------------------
+struct LocalLight
+{
+	LocalLightType	m_type = LocalLightType::POINT;
+	Vec3			m_position = Vec3::ZERO;
+	float			m_radius = 1.f;
+	Vec3			m_color = Vec3(1.f, 1.f, 1.f);
+	float			m_intensity = 1.f;
+	Vec3			m_direction = Vec3(1.f, 0.f, 0.f);
+	float			m_innerConeDegrees = 20.f;
+	float			m_outerConeDegrees = 30.f;
+};
+// -----------------------------------------------------------------------------
+constexpr int LIGHT_CLUSTERS_X = 16;
+constexpr int LIGHT_CLUSTERS_Y = 8;
+constexpr int LIGHT_CLUSTERS_Z = 24;
+constexpr int NUM_LIGHT_CLUSTERS = LIGHT_CLUSTERS_X * LIGHT_CLUSTERS_Y * LIGHT_CLUSTERS_Z;
+constexpr int MAX_LIGHTS_PER_CLUSTER = 128;
+constexpr int MAX_LOCAL_LIGHTS = 1024;
+constexpr int MAX_CLUSTER_LIGHT_INDICES = 32768;	// Total over all clusters; past this every cluster is capped evenly
+// -----------------------------------------------------------------------------
+// Clustered light assignment. The view frustum is split into a 16x8x24 grid (exponential depth
+// slices); each light's bounding sphere is binned into the clusters it touches. Light setup
+// runs in parallel over lights and binning in parallel over depth slices, so no two tasks write
+// the same cluster. The outputs are flat arrays:
+//   ranges:  (offset, count) per cluster, x fastest, then y, then z
+//   indices: uint16 light indices packed two per uint
+// This is light binning only: the lists are not uploaded and no shader loops over them, so local
+// lights do not yet shade the model. Renderer-free, so it can be built and benchmarked headless.
+// -----------------------------------------------------------------------------
+class ClusteredLighting
+{
+public:
+	ClusteredLighting();
+
+	void BuildClusters(ViewFrustum const& frustum, std::vector<LocalLight> const& lights);
+
+	std::vector<unsigned int> const&	GetClusterRanges() const { return m_clusterRanges; }
+	std::vector<unsigned int> const&	GetPackedLightIndices() const { return m_packedLightIndices; }
+
+	int GetClusterIndex(int x, int y, int z) const { return (z * LIGHT_CLUSTERS_Y + y) * LIGHT_CLUSTERS_X + x; }
+	int GetClusterLightCount(int clusterIndex) const { return static_cast<int>(m_clusterRanges[clusterIndex * 2 + 1]); }
+	int GetClusterLightIndex(int clusterIndex, int listIndex) const;
+
+	int		GetNumLightIndices() const { return m_numLightIndices; }
+	int		GetNumDroppedIndices() const { return m_numDroppedIndices; }
+	double	GetBuildSeconds() const { return m_buildSeconds; }
+
+private:
+	struct LightBinRange
+	{
+		int m_minX = 0;
+		int m_maxX = -1;
+		int m_minY = 0;
+		int m_maxY = -1;
+		int m_minZ = 0;
+		int m_maxZ = -1;
+	};
+
+	int  GetDepthSlice(float viewDepth) const;
+	void ComputeLightBinRange(LocalLight const& light, ViewFrustum const& frustum, LightBinRange& out_range) const;
+	int  GetNumIndicesWithClusterCap(int clusterCap) const;
+
+private:
+	std::vector<LightBinRange>			m_lightBinRanges;
+	std::vector<unsigned short>			m_clusterLightLists;	// MAX_LIGHTS_PER_CLUSTER slots per cluster
+	std::vector<int>					m_clusterLightCounts;
+	std::vector<unsigned short>			m_flatLightIndices;
+	std::vector<unsigned int>			m_clusterRanges;
+	std::vector<unsigned int>			m_packedLightIndices;
+
+	// Tile boundary planes through the eye: signed distance = a * viewX + b * viewDepth
+	float	m_columnPlanes[LIGHT_CLUSTERS_X + 1][2] = {};
+	float	m_rowPlanes[LIGHT_CLUSTERS_Y + 1][2] = {};
+
+	// slice = floor(log(depth) * scale + bias)
+	float	m_depthSliceScale = 1.f;
+	float	m_depthSliceBias = 0.f;
+
+	int		m_numLightIndices = 0;
+	int		m_numDroppedIndices = 0;
+	double	m_buildSeconds = 0.0;
+};
@@ -0,0 +1,420 @@
+#include "Game/CommandScript.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include <ctype.h>
+#include <iostream>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+struct CommandTableEntry
+{
+	std::string							m_name;
+	std::vector<EventCallbackFunction>	m_callbacks;
+};
+
+// Entries are never removed, so command indices resolved by a parsed script stay valid across unsubscribes and game restarts
+struct CommandTable
+{
+	std::vector<CommandTableEntry>		m_entries;
+	std::unordered_map<uint32_t, int>	m_indexByHash;
+};
+
+static CommandTable& GetCommandTable()
+{
+	static CommandTable s_commandTable;
+	return s_commandTable;
+}
+
+static bool AreNamesEqualIgnoringCase(std::string const& nameA, std::string const& nameB)
+{
+	if (nameA.size() != nameB.size())
+	{
+		return false;
+	}
+	for (int charIndex = 0; charIndex < static_cast<int>(nameA.size()); ++charIndex)
+	{
+		if (tolower(static_cast<unsigned char>(nameA[charIndex])) != tolower(static_cast<unsigned char>(nameB[charIndex])))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t HashCommandName(std::string const& commandName)
+{
+	// FNV-1a over the lowercased name; event names are case-insensitive
+	uint32_t hash = 2166136261u;
+	for (int charIndex = 0; charIndex < static_cast<int>(commandName.size()); ++charIndex)
+	{
+		hash ^= static_cast<uint32_t>(tolower(static_cast<unsigned char>(commandName[charIndex])));
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+int FindCommandIndex(std::string const& commandName)
+{
+	CommandTable const& table = GetCommandTable();
+	auto found = table.m_indexByHash.find(HashCommandName(commandName));
+	if (found == table.m_indexByHash.end() || !AreNamesEqualIgnoringCase(table.m_entries[found->second].m_name, commandName))
+	{
+		return -1;
+	}
+	return found->second;
+}
+
+void SubscribeCommand(std::string const& commandName, EventCallbackFunction callback)
+{
+	SubscribeEventCallbackFunction(commandName, callback);
+
+	CommandTable& table = GetCommandTable();
+	int commandIndex = FindCommandIndex(commandName);
+	if (commandIndex < 0)
+	{
+		uint32_t hash = HashCommandName(commandName);
+		auto found = table.m_indexByHash.find(hash);
+		GUARANTEE_OR_DIE(found == table.m_indexByHash.end(), Stringf("Command \"%s\" has the same name hash as \"%s\"; rename one of them",
+			commandName.c_str(), (found != table.m_indexByHash.end()) ? table.m_entries[found->second].m_name.c_str() : ""));
+		commandIndex = static_cast<int>(table.m_entries.size());
+		table.m_entries.push_back(CommandTableEntry());
+		table.m_entries.back().m_name = commandName;
+		table.m_indexByHash[hash] = commandIndex;
+	}
+	table.m_entries[commandIndex].m_callbacks.push_back(callback);
+}
+
+void UnsubscribeCommand(std::string const& commandName, EventCallbackFunction callback)
+{
+	UnsubscribeEventCallbackFunction(commandName, callback);
+
+	int commandIndex = FindCommandIndex(commandName);
+	if (commandIndex < 0)
+	{
+		return;
+	}
+	std::vector<EventCallbackFunction>& callbacks = GetCommandTable().m_entries[commandIndex].m_callbacks;
+	for (int callbackIndex = 0; callbackIndex < static_cast<int>(callbacks.size()); ++callbackIndex)
+	{
+		if (callbacks[callbackIndex] == callback)
+		{
+			callbacks.erase(callbacks.begin() + callbackIndex);
+			return;
+		}
+	}
+}
+
+bool DispatchCommand(int commandIndex, EventArgs& args)
+{
+	// Indexed rather than iterated, since a callback may unsubscribe itself (e.g. a game restart)
+	std::vector<EventCallbackFunction> const& callbacks = GetCommandTable().m_entries[commandIndex].m_callbacks;
+	for (int callbackIndex = 0; callbackIndex < static_cast<int>(callbacks.size()); ++callbackIndex)
+	{
+		if (callbacks[callbackIndex](args))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+bool ParseScriptLine(std::string const& line, int lineNumber, std::vector<ScriptCommand>& out_commands, std::string& out_errorMessage)
+{
+	static char const* const WHITESPACE = " \t\r\n";
+	size_t position = line.find_first_not_of(WHITESPACE);
+	if (position == std::string::npos || line[position] == '#' || line.compare(position, 2, "//") == 0)
+	{
+		return true;
+	}
+
+	ScriptCommand command;
+	command.m_lineNumber = lineNumber;
+	size_t nameEnd = line.find_first_of(WHITESPACE, position);
+	command.m_name = line.substr(position, nameEnd - position);
+	position = nameEnd;
+	while ((position = line.find_first_not_of(WHITESPACE, position)) != std::string::npos)
+	{
+		size_t equalsPosition = line.find('=', position);
+		size_t tokenEnd = line.find_first_of(WHITESPACE, position);
+		if (equalsPosition == std::string::npos || equalsPosition > tokenEnd || equalsPosition == position)
+		{
+			out_errorMessage = Stringf("line %d: expected key=value, found \"%s\"", lineNumber, line.substr(position, tokenEnd - position).c_str());
+			return false;
+		}
+
+		std::string key = line.substr(position, equalsPosition - position);
+		position = equalsPosition + 1;
+		if (position < line.size() && line[position] == '"')
+		{
+			size_t closingQuote = line.find('"', position + 1);
+			if (closingQuote == std::string::npos)
+			{
+				out_errorMessage = Stringf("line %d: unterminated quote in %s=", lineNumber, key.c_str());
+				return false;
+			}
+			command.m_args.SetValue(key, line.substr(position + 1, closingQuote - position - 1));
+			position = closingQuote + 1;
+		}
+		else
+		{
+			size_t valueEnd = line.find_first_of(WHITESPACE, position);
+			command.m_args.SetValue(key, line.substr(position, valueEnd - position));
+			position = valueEnd;
+		}
+	}
+
+	if (AreNamesEqualIgnoringCase(command.m_name, "Wait"))
+	{
+		command.m_type = ScriptCommandType::WAIT;
+		command.m_numWaitFrames = command.m_args.GetValue("frames", 1);
+	}
+	else
+	{
+		command.m_commandIndex = FindCommandIndex(command.m_name);
+		command.m_type = (command.m_commandIndex >= 0) ? ScriptCommandType::COMMAND : ScriptCommandType::EVENT;
+	}
+	out_commands.push_back(command);
+	return true;
+}
+
+bool ExecuteScriptCommand(ScriptCommand const& command)
+{
+	// Callbacks get a copy, so a command replays with the same arguments however often it runs
+	EventArgs args = command.m_args;
+	switch (command.m_type)
+	{
+	case ScriptCommandType::COMMAND:	return DispatchCommand(command.m_commandIndex, args);
+	case ScriptCommandType::EVENT:		return FireEvent(command.m_name, args);
+	default:							return true;
+	}
+}
+
+bool ExecuteCommandLine(std::string const& commandLine, std::string& out_errorMessage)
+{
+	std::vector<ScriptCommand> commands;
+	if (!ParseScriptLine(commandLine, 1, commands, out_errorMessage))
+	{
+		return false;
+	}
+	return commands.empty() || ExecuteScriptCommand(commands[0]);
+}
+
+bool ParseCommandVec3(std::string const& text, Vec3& out_vector)
+{
+	float components[3] = {};
+	char const* cursor = text.c_str();
+	for (int componentIndex = 0; componentIndex < 3; ++componentIndex)
+	{
+		char* componentEnd = nullptr;
+		components[componentIndex] = strtof(cursor, &componentEnd);
+		if (componentEnd == cursor || (componentIndex < 2 && *componentEnd != ','))
+		{
+			return false;
+		}
+		cursor = componentEnd + ((componentIndex < 2) ? 1 : 0);
+	}
+	if (*cursor != '\0')
+	{
+		return false;
+	}
+	out_vector = Vec3(components[0], components[1], components[2]);
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+// One reader per process, since there is only one stdin. A blocking console read cannot be
+// cancelled, so the thread is detached and shares nothing but this state with its scripts.
+// -----------------------------------------------------------------------------
+struct CommandScript::StdinLines
+{
+	std::mutex					m_mutex;
+	std::vector<std::string>	m_lines;
+	bool						m_isAtEnd = false;
+};
+
+bool CommandScript::StartFile(std::string const& scriptFile, int numPasses, int commandsPerFrame, std::string& out_errorMessage)
+{
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	fopen_s(&file, scriptFile.c_str(), "rb");
+#else
+	file = fopen(scriptFile.c_str(), "rb");
+#endif
+	if (file == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\"", scriptFile.c_str());
+		return false;
+	}
+	std::string text;
+	char buffer[65536];
+	size_t numRead = 0;
+	while ((numRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		text.append(buffer, numRead);
+	}
+	fclose(file);
+
+	// Parse everything up front so a typo fails the script before any of it runs
+	std::vector<ScriptCommand> commands;
+	int lineNumber = 1;
+	for (size_t lineStart = 0; lineStart < text.size(); ++lineNumber)
+	{
+		size_t lineEnd = text.find('\n', lineStart);
+		if (lineEnd == std::string::npos)
+		{
+			lineEnd = text.size();
+		}
+		std::string errorMessage;
+		if (!ParseScriptLine(text.substr(lineStart, lineEnd - lineStart), lineNumber, commands, errorMessage))
+		{
+			out_errorMessage = Stringf("\"%s\" %s", scriptFile.c_str(), errorMessage.c_str());
+			return false;
+		}
+		lineStart = lineEnd + 1;
+	}
+
+	Start(scriptFile, numPasses, commandsPerFrame);
+	m_commands.swap(commands);
+	return true;
+}
+
+void CommandScript::StartStdin(int commandsPerFrame)
+{
+	Start("stdin", 1, commandsPerFrame);
+	m_stdinLines = GetStdinLines();
+}
+
+void CommandScript::Start(std::string const& sourceName, int numPasses, int commandsPerFrame)
+{
+	m_commands.clear();
+	m_sourceName = sourceName;
+	m_nextCommandIndex = 0;
+	m_numPasses = (numPasses > 0) ? numPasses : 1;
+	m_commandsPerFrame = (commandsPerFrame > 0) ? commandsPerFrame : 1;
+	m_numWaitFramesLeft = 0;
+	m_isRunning = true;
+	m_startTime = GetCurrentTimeSeconds();
+	m_stats = CommandScriptStats();
+	m_stdinLines.reset();
+}
+
+void CommandScript::Stop()
+{
+	// Leaves the commands in place; Stop can be called from a command the script is running
+	m_isRunning = false;
+	m_stats.m_elapsedSeconds = GetCurrentTimeSeconds() - m_startTime;
+}
+
+bool CommandScript::Update()
+{
+	if (!m_isRunning)
+	{
+		return false;
+	}
+	++m_stats.m_numFrames;
+	if (m_stdinLines)
+	{
+		TakeStdinLines();
+	}
+	if (m_numWaitFramesLeft > 0)
+	{
+		--m_numWaitFramesLeft;
+		return true;
+	}
+
+	for (int numRunThisFrame = 0; numRunThisFrame < m_commandsPerFrame && m_isRunning; )
+	{
+		if (m_nextCommandIndex == static_cast<int>(m_commands.size()))
+		{
+			if (m_stdinLines)
+			{
+				std::lock_guard<std::mutex> lock(m_stdinLines->m_mutex);
+				if (!m_stdinLines->m_isAtEnd || !m_stdinLines->m_lines.empty())
+				{
+					return true;
+				}
+			}
+			++m_stats.m_numPassesDone;
+			if (m_stats.m_numPassesDone < m_numPasses)
+			{
+				m_nextCommandIndex = 0;
+				continue;
+			}
+			Stop();
+			return false;
+		}
+
+		ScriptCommand const& command = m_commands[m_nextCommandIndex++];
+		if (command.m_type == ScriptCommandType::WAIT)
+		{
+			m_numWaitFramesLeft = command.m_numWaitFrames - 1;
+			if (command.m_numWaitFrames > 0)
+			{
+				return true;
+			}
+			continue;
+		}
+
+		int lineNumber = command.m_lineNumber;
+		std::string commandName = command.m_name;
+		double dispatchStartTime = GetCurrentTimeSeconds();
+		bool didSucceed = ExecuteScriptCommand(command);
+		m_stats.m_dispatchSeconds += GetCurrentTimeSeconds() - dispatchStartTime;
+		++m_stats.m_numCommandsRun;
+		++numRunThisFrame;
+		if (!didSucceed)
+		{
+			++m_stats.m_numCommandsFailed;
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Script \"%s\" line %d: %s failed", m_sourceName.c_str(), lineNumber, commandName.c_str()));
+		}
+	}
+	return m_isRunning;
+}
+
+void CommandScript::TakeStdinLines()
+{
+	std::vector<std::string> lines;
+	{
+		std::lock_guard<std::mutex> lock(m_stdinLines->m_mutex);
+		lines.swap(m_stdinLines->m_lines);
+	}
+	for (int lineIndex = 0; lineIndex < static_cast<int>(lines.size()); ++lineIndex)
+	{
+		std::string errorMessage;
+		if (!ParseScriptLine(lines[lineIndex], ++m_numStdinLinesTaken, m_commands, errorMessage))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Script \"stdin\" %s", errorMessage.c_str()));
+		}
+	}
+}
+
+std::shared_ptr<CommandScript::StdinLines> CommandScript::GetStdinLines()
+{
+	static std::shared_ptr<StdinLines> s_stdinLines;
+	if (s_stdinLines)
+	{
+		return s_stdinLines;
+	}
+
+	s_stdinLines = std::make_shared<StdinLines>();
+	std::shared_ptr<StdinLines> stdinLines = s_stdinLines;
+	std::thread([stdinLines]()
+	{
+		std::string line;
+		while (std::getline(std::cin, line))
+		{
+			std::lock_guard<std::mutex> lock(stdinLines->m_mutex);
+			stdinLines->m_lines.push_back(line);
+		}
+		std::lock_guard<std::mutex> lock(stdinLines->m_mutex);
+		stdinLines->m_isAtEnd = true;
+	}).detach();
+	return s_stdinLines;
+}
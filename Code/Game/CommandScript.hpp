@@ -0,0 +1,97 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Math/Vec3.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Commands subscribed through here reach the event system as usual and are also mirrored in a
+// table keyed by a hash of their lowercased name, so a script resolves each name once when it
+// is parsed and every later call goes straight to the callbacks.
+// -----------------------------------------------------------------------------
+void	 SubscribeCommand(std::string const& commandName, EventCallbackFunction callback);
+void	 UnsubscribeCommand(std::string const& commandName, EventCallbackFunction callback);
+uint32_t HashCommandName(std::string const& commandName);
+int		 FindCommandIndex(std::string const& commandName);			// -1 when nothing was subscribed through SubscribeCommand under that name
+bool	 DispatchCommand(int commandIndex, EventArgs& args);		// Stops at the first callback that returns true, like FireEvent
+
+// -----------------------------------------------------------------------------
+enum class ScriptCommandType
+{
+	COMMAND,		// Resolved into the command table
+	EVENT,			// Not in the table (e.g. the engine's own console commands); fired by name
+	WAIT,			// "Wait frames=<n>" yields to the next frame n times
+};
+// -----------------------------------------------------------------------------
+struct ScriptCommand
+{
+	ScriptCommandType	m_type = ScriptCommandType::EVENT;
+	std::string			m_name;
+	int					m_commandIndex = -1;
+	int					m_numWaitFrames = 0;
+	int					m_lineNumber = 0;
+	EventArgs			m_args;
+};
+
+// Parses "Name key=value key=\"quoted value\"", appending nothing for blank lines and # or // comments
+bool ParseScriptLine(std::string const& line, int lineNumber, std::vector<ScriptCommand>& out_commands, std::string& out_errorMessage);
+bool ExecuteScriptCommand(ScriptCommand const& command);
+bool ExecuteCommandLine(std::string const& commandLine, std::string& out_errorMessage);
+bool ParseCommandVec3(std::string const& text, Vec3& out_vector);		// "x,y,z"
+
+// -----------------------------------------------------------------------------
+struct CommandScriptStats
+{
+	int		m_numCommandsRun = 0;
+	int		m_numCommandsFailed = 0;
+	int		m_numFrames = 0;
+	int		m_numPassesDone = 0;
+	double	m_dispatchSeconds = 0.0;
+	double	m_elapsedSeconds = 0.0;
+
+	double GetCommandsPerSecond() const { return (m_dispatchSeconds > 0.0) ? static_cast<double>(m_numCommandsRun) / m_dispatchSeconds : 0.0; }
+};
+// -----------------------------------------------------------------------------
+// Plays a parsed script back over frames: each Update runs commands in order until a Wait, the
+// per-frame batch limit, or the end of the script. Nothing in the playback depends on frame
+// timing, so the same script always issues the same commands on the same frames.
+// -----------------------------------------------------------------------------
+class CommandScript
+{
+public:
+	bool StartFile(std::string const& scriptFile, int numPasses, int commandsPerFrame, std::string& out_errorMessage);
+	void StartStdin(int commandsPerFrame);
+	void Stop();
+
+	// Returns false once the script has finished or was stopped
+	bool Update();
+
+	bool						IsRunning() const { return m_isRunning; }
+	std::string const&			GetSourceName() const { return m_sourceName; }
+	int							GetNumCommands() const { return static_cast<int>(m_commands.size()); }
+	int							GetNextCommandIndex() const { return m_nextCommandIndex; }
+	int							GetNumPasses() const { return m_numPasses; }
+	CommandScriptStats const&	GetStats() const { return m_stats; }
+
+private:
+	struct StdinLines;
+	static std::shared_ptr<StdinLines> GetStdinLines();
+
+	void Start(std::string const& sourceName, int numPasses, int commandsPerFrame);
+	void TakeStdinLines();
+
+private:
+	std::vector<ScriptCommand>	m_commands;
+	std::string					m_sourceName;
+	int							m_nextCommandIndex = 0;
+	int							m_numPasses = 1;
+	int							m_commandsPerFrame = 1;
+	int							m_numWaitFramesLeft = 0;
+	bool						m_isRunning = false;
+	double						m_startTime = 0.0;
+	CommandScriptStats			m_stats;
+
+	std::shared_ptr<StdinLines>	m_stdinLines;
+	int							m_numStdinLinesTaken = 0;
+};
@@ -1,18 +1,18 @@
-//-----------------------------------------------------------------------------------------------
-// EngineBuildPreferences.hpp
-//
-// Defines build preferences that the Engine should use when building for this particular game.
-//
-// Note that this file is an exception to the rule "engine code shall not know about game code".
-//	Purpose: Each game can now direct the engine via #defines to build differently for that game.
-//	Downside: ALL games must now have this Code/Game/EngineBuildPreferences.hpp file.
-//
-
-#define ENGINE_DISABLE_AUDIO	// (If uncommented) Disables AudioSystem code and fmod linkage.
-
-//Define ENGINE_DEBUG_RENDERER if this is a Debug configuration and link debug libraries if it is.
-#if defined(_DEBUG)
-#define ENGINE_DEBUG_RENDER
-#endif
-
-
+//-----------------------------------------------------------------------------------------------
+// EngineBuildPreferences.hpp
+//
+// Defines build preferences that the Engine should use when building for this particular game.
+//
+// Note that this file is an exception to the rule "engine code shall not know about game code".
+//	Purpose: Each game can now direct the engine via #defines to build differently for that game.
+//	Downside: ALL games must now have this Code/Game/EngineBuildPreferences.hpp file.
+//
+
+#define ENGINE_DISABLE_AUDIO	// (If uncommented) Disables AudioSystem code and fmod linkage.
+
+//Define ENGINE_DEBUG_RENDERER if this is a Debug configuration and link debug libraries if it is.
+#if defined(_DEBUG)
+#define ENGINE_DEBUG_RENDER
+#endif
+
+
@@ -0,0 +1,252 @@
+#include "Game/FramePacer.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <math.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#if !defined(CREATE_WAITABLE_TIMER_HIGH_RESOLUTION)
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <chrono>
+#include <ctime>
+#include <thread>
+#endif
+
+// Sleeps are only trusted to within this much of the deadline; the rest is spun.
+// A high-resolution waitable timer wakes far more precisely than Sleep at a 1 ms timer period.
+constexpr double FRAME_PACER_SPIN_SECONDS = 0.002;
+constexpr double FRAME_PACER_PRECISE_SPIN_SECONDS = 0.0005;
+// Longest single sleep, so input keeps being sampled while waiting
+constexpr double FRAME_PACER_INPUT_SAMPLE_SECONDS = 0.002;
+// How often the on-screen stats window rolls over
+constexpr double FRAME_PACER_RECENT_WINDOW_SECONDS = 1.0;
+
+// -----------------------------------------------------------------------------
+static double GetProcessCPUSeconds()
+{
+#if defined(_WIN32)
+	FILETIME creationTime;
+	FILETIME exitTime;
+	FILETIME kernelTime;
+	FILETIME userTime;
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+	{
+		return 0.0;
+	}
+	ULARGE_INTEGER kernel;
+	kernel.LowPart = kernelTime.dwLowDateTime;
+	kernel.HighPart = kernelTime.dwHighDateTime;
+	ULARGE_INTEGER user;
+	user.LowPart = userTime.dwLowDateTime;
+	user.HighPart = userTime.dwHighDateTime;
+	return static_cast<double>(kernel.QuadPart + user.QuadPart) * 1.0e-7;
+#else
+	return static_cast<double>(std::clock()) / static_cast<double>(CLOCKS_PER_SEC);
+#endif
+}
+
+static void SleepForSeconds(double seconds, void* waitableTimer)
+{
+#if defined(_WIN32)
+	if (waitableTimer != nullptr)
+	{
+		LARGE_INTEGER dueTime;
+		dueTime.QuadPart = -static_cast<LONGLONG>(seconds * 1.0e7);
+		if (SetWaitableTimer(waitableTimer, &dueTime, 0, nullptr, nullptr, FALSE))
+		{
+			WaitForSingleObject(waitableTimer, INFINITE);
+			return;
+		}
+	}
+	Sleep(static_cast<DWORD>(seconds * 1000.0));
+#else
+	UNUSED(waitableTimer);
+	std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(seconds * 1.0e6)));
+#endif
+}
+
+static void YieldWhileSpinning()
+{
+#if defined(_WIN32)
+	YieldProcessor();
+#else
+	std::this_thread::yield();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void FramePacingStats::AddFrame(double frameSeconds, double cpuSeconds, bool didRedraw)
+{
+	++m_numFrames;
+	m_numRedraws += didRedraw ? 1 : 0;
+	m_wallSeconds += frameSeconds;
+	m_cpuSeconds += cpuSeconds;
+
+	double deviation = frameSeconds - m_meanFrameSeconds;
+	m_meanFrameSeconds += deviation / static_cast<double>(m_numFrames);
+	m_sumSquaredDeviations += deviation * (frameSeconds - m_meanFrameSeconds);
+}
+
+double FramePacingStats::GetFrameSecondsVariance() const
+{
+	return (m_numFrames > 1) ? m_sumSquaredDeviations / static_cast<double>(m_numFrames - 1) : 0.0;
+}
+
+double FramePacingStats::GetFrameSecondsStdDev() const
+{
+	return sqrt(GetFrameSecondsVariance());
+}
+
+double FramePacingStats::GetCPUPercent() const
+{
+	return (m_wallSeconds > 0.0) ? 100.0 * m_cpuSeconds / m_wallSeconds : 0.0;
+}
+
+std::string FramePacingStats::GetDescription() const
+{
+	double redrawsPerSecond = (m_wallSeconds > 0.0) ? static_cast<double>(m_numRedraws) / m_wallSeconds : 0.0;
+	return Stringf("frame %.2f ms (stddev %.2f ms, variance %.3f ms^2), %.1f redraws/s, CPU %.1f%% of a core",
+		m_meanFrameSeconds * 1000.0, GetFrameSecondsStdDev() * 1000.0, GetFrameSecondsVariance() * 1.0e6, redrawsPerSecond, GetCPUPercent());
+}
+
+// -----------------------------------------------------------------------------
+void FramePacer::Startup()
+{
+#if defined(_WIN32)
+	// Default scheduler granularity is ~15.6 ms, far too coarse to sleep toward a frame deadline
+	m_isTimerPeriodRaised = (timeBeginPeriod(1) == TIMERR_NOERROR);
+	m_waitableTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+#endif
+	m_spinSeconds = (m_waitableTimer != nullptr) ? FRAME_PACER_PRECISE_SPIN_SECONDS : FRAME_PACER_SPIN_SECONDS;
+	m_lastFrameStartTime = GetCurrentTimeSeconds();
+	m_nextFrameTime = m_lastFrameStartTime;
+	m_lastCPUSeconds = GetProcessCPUSeconds();
+}
+
+void FramePacer::Shutdown()
+{
+#if defined(_WIN32)
+	if (m_isTimerPeriodRaised)
+	{
+		timeEndPeriod(1);
+		m_isTimerPeriodRaised = false;
+	}
+	if (m_waitableTimer != nullptr)
+	{
+		CloseHandle(m_waitableTimer);
+		m_waitableTimer = nullptr;
+	}
+#endif
+}
+
+void FramePacer::SetMode(FramePacingMode mode)
+{
+	m_mode = mode;
+	m_nextFrameTime = GetCurrentTimeSeconds();
+}
+
+void FramePacer::SetTargetFPS(float targetFPS)
+{
+	m_targetFPS = (targetFPS > 1.f) ? targetFPS : 1.f;
+	m_nextFrameTime = GetCurrentTimeSeconds();
+}
+
+void FramePacer::WaitForNextFrame(std::function<void()> const& sampleInput)
+{
+	if (m_mode == FramePacingMode::UNCAPPED)
+	{
+		return;
+	}
+
+	double frameSeconds = 1.0 / static_cast<double>(m_targetFPS);
+	double now = GetCurrentTimeSeconds();
+	m_nextFrameTime += frameSeconds;
+	if (m_nextFrameTime < now - frameSeconds)
+	{
+		// We fell more than a frame behind (hitch, breakpoint); re-anchor instead of rushing to catch up
+		m_nextFrameTime = now;
+	}
+
+	for (;;)
+	{
+		now = GetCurrentTimeSeconds();
+		double remainingSeconds = m_nextFrameTime - now;
+		if (remainingSeconds <= 0.0)
+		{
+			break;
+		}
+
+		double sleepSeconds = remainingSeconds - m_spinSeconds;
+		if (sleepSeconds >= 0.001)
+		{
+			sleepSeconds = (sleepSeconds < FRAME_PACER_INPUT_SAMPLE_SECONDS) ? sleepSeconds : FRAME_PACER_INPUT_SAMPLE_SECONDS;
+			SleepForSeconds(sleepSeconds, m_waitableTimer);
+			if (sampleInput)
+			{
+				sampleInput();
+			}
+			continue;
+		}
+		YieldWhileSpinning();
+	}
+}
+
+void FramePacer::EndFrame(bool didRedraw)
+{
+	double now = GetCurrentTimeSeconds();
+	double cpuSeconds = GetProcessCPUSeconds();
+	double frameSeconds = now - m_lastFrameStartTime;
+	double frameCPUSeconds = cpuSeconds - m_lastCPUSeconds;
+	m_lastFrameStartTime = now;
+	m_lastCPUSeconds = cpuSeconds;
+	m_lastFrameSeconds = frameSeconds;
+	m_lastFrameCPUSeconds = frameCPUSeconds;
+
+	m_statsPerMode[static_cast<int>(m_mode)].AddFrame(frameSeconds, frameCPUSeconds, didRedraw);
+	m_windowStats.AddFrame(frameSeconds, frameCPUSeconds, didRedraw);
+	if (m_windowStats.m_wallSeconds >= FRAME_PACER_RECENT_WINDOW_SECONDS)
+	{
+		m_recentStats = m_windowStats;
+		m_windowStats = FramePacingStats();
+	}
+}
+
+void FramePacer::ResetStats()
+{
+	for (int modeIndex = 0; modeIndex < static_cast<int>(FramePacingMode::COUNT); ++modeIndex)
+	{
+		m_statsPerMode[modeIndex] = FramePacingStats();
+	}
+	m_windowStats = FramePacingStats();
+	m_recentStats = FramePacingStats();
+}
+
+// -----------------------------------------------------------------------------
+char const* FramePacer::GetModeName(FramePacingMode mode)
+{
+	switch (mode)
+	{
+		case FramePacingMode::UNCAPPED:		return "uncapped";
+		case FramePacingMode::CAPPED:		return "capped";
+		case FramePacingMode::ON_DEMAND:	return "ondemand";
+		default:							return "unknown";
+	}
+}
+
+bool FramePacer::ParseModeName(std::string const& modeName, FramePacingMode& out_mode)
+{
+	for (int modeIndex = 0; modeIndex < static_cast<int>(FramePacingMode::COUNT); ++modeIndex)
+	{
+		if (modeName == GetModeName(static_cast<FramePacingMode>(modeIndex)))
+		{
+			out_mode = static_cast<FramePacingMode>(modeIndex);
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <functional>
+#include <string>
+// -----------------------------------------------------------------------------
+enum class FramePacingMode
+{
+	UNCAPPED,
+	CAPPED,
+	ON_DEMAND,
+	COUNT
+};
+// -----------------------------------------------------------------------------
+// Frame interval mean/variance (Welford) and process CPU time over a run of frames
+struct FramePacingStats
+{
+	int		m_numFrames = 0;
+	int		m_numRedraws = 0;
+	double	m_meanFrameSeconds = 0.0;
+	double	m_sumSquaredDeviations = 0.0;
+	double	m_wallSeconds = 0.0;
+	double	m_cpuSeconds = 0.0;
+
+	void	AddFrame(double frameSeconds, double cpuSeconds, bool didRedraw);
+	double	GetFrameSecondsVariance() const;
+	double	GetFrameSecondsStdDev() const;
+	double	GetCPUPercent() const;
+	std::string GetDescription() const;
+};
+// -----------------------------------------------------------------------------
+// Paces the main loop. CAPPED and ON_DEMAND wait for a deadline at the target rate by sleeping
+// most of the way (high-resolution waitable timer, or Sleep at a 1 ms timer period) and spinning the rest. ON_DEMAND additionally lets
+// the app skip rendering frames where nothing changed. The wait happens before the frame starts,
+// so input is sampled and the frame rendered as close to presentation as possible.
+// -----------------------------------------------------------------------------
+class FramePacer
+{
+public:
+	void Startup();
+	void Shutdown();
+
+	void SetMode(FramePacingMode mode);
+	void SetTargetFPS(float targetFPS);
+	FramePacingMode GetMode() const { return m_mode; }
+	float GetTargetFPS() const { return m_targetFPS; }
+
+	// sampleInput runs between sleep slices so input keeps being read while we wait
+	void WaitForNextFrame(std::function<void()> const& sampleInput);
+	void EndFrame(bool didRedraw);
+
+	FramePacingStats const& GetStats(FramePacingMode mode) const { return m_statsPerMode[static_cast<int>(mode)]; }
+	FramePacingStats const& GetRecentStats() const { return m_recentStats; }
+	double GetLastFrameSeconds() const { return m_lastFrameSeconds; }
+	double GetLastFrameCPUSeconds() const { return m_lastFrameCPUSeconds; }
+	void ResetStats();
+
+	static char const* GetModeName(FramePacingMode mode);
+	static bool ParseModeName(std::string const& modeName, FramePacingMode& out_mode);
+
+private:
+	FramePacingMode		m_mode = FramePacingMode::CAPPED;
+	float				m_targetFPS = 60.f;
+	double				m_nextFrameTime = 0.0;
+	double				m_lastFrameStartTime = 0.0;
+	double				m_lastCPUSeconds = 0.0;
+	double				m_lastFrameSeconds = 0.0;
+	double				m_lastFrameCPUSeconds = 0.0;
+	bool				m_isTimerPeriodRaised = false;
+	void*				m_waitableTimer = nullptr;
+	double				m_spinSeconds = 0.002;
+
+	FramePacingStats	m_statsPerMode[static_cast<int>(FramePacingMode::COUNT)];
+	FramePacingStats	m_windowStats;
+	FramePacingStats	m_recentStats;
+};
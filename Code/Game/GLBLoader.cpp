@@ -0,0 +1,673 @@
+#include "Game/GLBLoader.hpp"
+#include "Game/JsonValue.hpp"
+#include "Game/MemoryMappedFile.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/MathUtils.h"
+#include <filesystem>
+#include <fstream>
+#include <stdint.h>
+#include <string.h>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+constexpr uint32_t GLB_MAGIC = 0x46546C67;		// "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;	// "JSON"
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;	// "BIN\0"
+
+constexpr int GLTF_BYTE = 5120;
+constexpr int GLTF_UNSIGNED_BYTE = 5121;
+constexpr int GLTF_SHORT = 5122;
+constexpr int GLTF_UNSIGNED_SHORT = 5123;
+constexpr int GLTF_UNSIGNED_INT = 5125;
+constexpr int GLTF_FLOAT = 5126;
+constexpr int GLTF_MODE_TRIANGLES = 4;
+
+// -----------------------------------------------------------------------------
+// Column-major 4x4, matching the layout glTF stores node matrices in
+struct GLTFMatrix
+{
+	float m_values[16] = { 1.f, 0.f, 0.f, 0.f,  0.f, 1.f, 0.f, 0.f,  0.f, 0.f, 1.f, 0.f,  0.f, 0.f, 0.f, 1.f };
+
+	GLTFMatrix operator*(GLTFMatrix const& rhs) const
+	{
+		GLTFMatrix result;
+		for (int column = 0; column < 4; ++column)
+		{
+			for (int row = 0; row < 4; ++row)
+			{
+				float sum = 0.f;
+				for (int k = 0; k < 4; ++k)
+				{
+					sum += m_values[k * 4 + row] * rhs.m_values[column * 4 + k];
+				}
+				result.m_values[column * 4 + row] = sum;
+			}
+		}
+		return result;
+	}
+
+	Vec3 TransformPosition(Vec3 const& position) const
+	{
+		return Vec3(
+			m_values[0] * position.x + m_values[4] * position.y + m_values[8] * position.z + m_values[12],
+			m_values[1] * position.x + m_values[5] * position.y + m_values[9] * position.z + m_values[13],
+			m_values[2] * position.x + m_values[6] * position.y + m_values[10] * position.z + m_values[14]);
+	}
+
+	Vec3 TransformVector(Vec3 const& vector) const
+	{
+		return Vec3(
+			m_values[0] * vector.x + m_values[4] * vector.y + m_values[8] * vector.z,
+			m_values[1] * vector.x + m_values[5] * vector.y + m_values[9] * vector.z,
+			m_values[2] * vector.x + m_values[6] * vector.y + m_values[10] * vector.z);
+	}
+
+	// Cofactor of the upper 3x3; transforms normals correctly under non-uniform scale (up to length)
+	GLTFMatrix GetNormalMatrix() const
+	{
+		Vec3 columnI(m_values[0], m_values[1], m_values[2]);
+		Vec3 columnJ(m_values[4], m_values[5], m_values[6]);
+		Vec3 columnK(m_values[8], m_values[9], m_values[10]);
+		Vec3 cofactorI = CrossProduct3D(columnJ, columnK);
+		Vec3 cofactorJ = CrossProduct3D(columnK, columnI);
+		Vec3 cofactorK = CrossProduct3D(columnI, columnJ);
+
+		// The cofactor rows become the columns of the normal matrix
+		GLTFMatrix normalMatrix;
+		normalMatrix.m_values[0] = cofactorI.x;	normalMatrix.m_values[4] = cofactorI.y;	normalMatrix.m_values[8] = cofactorI.z;
+		normalMatrix.m_values[1] = cofactorJ.x;	normalMatrix.m_values[5] = cofactorJ.y;	normalMatrix.m_values[9] = cofactorJ.z;
+		normalMatrix.m_values[2] = cofactorK.x;	normalMatrix.m_values[6] = cofactorK.y;	normalMatrix.m_values[10] = cofactorK.z;
+		return normalMatrix;
+	}
+
+	float GetDeterminant3x3() const
+	{
+		Vec3 columnI(m_values[0], m_values[1], m_values[2]);
+		Vec3 columnJ(m_values[4], m_values[5], m_values[6]);
+		Vec3 columnK(m_values[8], m_values[9], m_values[10]);
+		return DotProduct3D(columnI, CrossProduct3D(columnJ, columnK));
+	}
+};
+
+// -----------------------------------------------------------------------------
+struct GLTFAccessorView
+{
+	unsigned char const*	m_data = nullptr;
+	int						m_count = 0;
+	int						m_componentType = 0;
+	int						m_numComponents = 0;
+	size_t					m_stride = 0;
+	bool					m_isNormalized = false;
+
+	bool IsValid() const { return m_data != nullptr; }
+
+	float ReadFloat(int elementIndex, int componentIndex) const
+	{
+		unsigned char const* element = m_data + m_stride * static_cast<size_t>(elementIndex);
+		switch (m_componentType)
+		{
+			case GLTF_FLOAT:			{ float value;		memcpy(&value, element + componentIndex * 4, 4); return value; }
+			case GLTF_UNSIGNED_BYTE:	{ uint8_t value = element[componentIndex];						return m_isNormalized ? value / 255.f : value; }
+			case GLTF_BYTE:				{ int8_t value;		memcpy(&value, element + componentIndex, 1); return m_isNormalized ? GetClamped(value / 127.f, -1.f, 1.f) : value; }
+			case GLTF_UNSIGNED_SHORT:	{ uint16_t value;	memcpy(&value, element + componentIndex * 2, 2); return m_isNormalized ? value / 65535.f : value; }
+			case GLTF_SHORT:			{ int16_t value;	memcpy(&value, element + componentIndex * 2, 2); return m_isNormalized ? GetClamped(value / 32767.f, -1.f, 1.f) : value; }
+			default:					return 0.f;
+		}
+	}
+
+	unsigned int ReadIndex(int elementIndex) const
+	{
+		unsigned char const* element = m_data + m_stride * static_cast<size_t>(elementIndex);
+		switch (m_componentType)
+		{
+			case GLTF_UNSIGNED_BYTE:	return element[0];
+			case GLTF_UNSIGNED_SHORT:	{ uint16_t value; memcpy(&value, element, 2); return value; }
+			case GLTF_UNSIGNED_INT:		{ uint32_t value; memcpy(&value, element, 4); return value; }
+			default:					return 0;
+		}
+	}
+};
+
+// -----------------------------------------------------------------------------
+struct GLBDocument
+{
+	std::string				m_filePath;
+	JsonValue				m_json;
+	unsigned char const*	m_binData = nullptr;
+	size_t					m_binSize = 0;
+};
+
+// -----------------------------------------------------------------------------
+static int GetGLTFComponentSize(int componentType)
+{
+	switch (componentType)
+	{
+		case GLTF_BYTE:
+		case GLTF_UNSIGNED_BYTE:	return 1;
+		case GLTF_SHORT:
+		case GLTF_UNSIGNED_SHORT:	return 2;
+		case GLTF_UNSIGNED_INT:
+		case GLTF_FLOAT:			return 4;
+		default:					return 0;
+	}
+}
+
+static int GetGLTFNumComponents(std::string const& accessorType)
+{
+	if (accessorType == "SCALAR")	return 1;
+	if (accessorType == "VEC2")		return 2;
+	if (accessorType == "VEC3")		return 3;
+	if (accessorType == "VEC4")		return 4;
+	if (accessorType == "MAT4")		return 16;
+	return 0;
+}
+
+static bool GetBufferViewBytes(GLBDocument const& document, int bufferViewIndex, unsigned char const*& out_data, size_t& out_length, size_t& out_stride)
+{
+	JsonValue const& bufferView = document.m_json["bufferViews"][bufferViewIndex];
+	if (bufferView.IsNull() || bufferView["buffer"].GetInt(-1) != 0 || document.m_binData == nullptr)
+	{
+		return false;
+	}
+
+	size_t byteOffset = static_cast<size_t>(bufferView["byteOffset"].GetNumber(0.0));
+	out_length = static_cast<size_t>(bufferView["byteLength"].GetNumber(0.0));
+	out_stride = static_cast<size_t>(bufferView["byteStride"].GetNumber(0.0));
+	if (byteOffset + out_length > document.m_binSize)
+	{
+		return false;
+	}
+
+	out_data = document.m_binData + byteOffset;
+	return true;
+}
+
+// Compared byte for byte, since an edited texture often keeps its size and copied files keep their write times
+static bool DoesFileHoldBytes(std::string const& filePath, unsigned char const* data, size_t length)
+{
+	MemoryMappedFile file;
+	if (!file.Open(filePath))
+	{
+		return false;
+	}
+	return file.GetSize() == length && memcmp(file.GetData(), data, length) == 0;
+}
+
+static GLTFAccessorView GetAccessorView(GLBDocument const& document, int accessorIndex)
+{
+	GLTFAccessorView view;
+	JsonValue const& accessor = document.m_json["accessors"][accessorIndex];
+	if (accessor.IsNull() || accessor.HasKey("sparse"))
+	{
+		return view;
+	}
+
+	unsigned char const* viewData = nullptr;
+	size_t viewLength = 0;
+	size_t viewStride = 0;
+	if (!GetBufferViewBytes(document, accessor["bufferView"].GetInt(-1), viewData, viewLength, viewStride))
+	{
+		return view;
+	}
+
+	int componentType = accessor["componentType"].GetInt(0);
+	int numComponents = GetGLTFNumComponents(accessor["type"].GetString(""));
+	size_t elementSize = static_cast<size_t>(GetGLTFComponentSize(componentType) * numComponents);
+	size_t stride = (viewStride != 0) ? viewStride : elementSize;
+	size_t accessorOffset = static_cast<size_t>(accessor["byteOffset"].GetNumber(0.0));
+	int count = accessor["count"].GetInt(0);
+	if (elementSize == 0 || count <= 0 || accessorOffset + stride * static_cast<size_t>(count - 1) + elementSize > viewLength)
+	{
+		return view;
+	}
+
+	view.m_data = viewData + accessorOffset;
+	view.m_count = count;
+	view.m_componentType = componentType;
+	view.m_numComponents = numComponents;
+	view.m_stride = stride;
+	view.m_isNormalized = accessor["normalized"].GetBool(false);
+	return view;
+}
+
+static GLTFMatrix GetNodeLocalTransform(JsonValue const& node)
+{
+	GLTFMatrix localTransform;
+	JsonValue const& matrix = node["matrix"];
+	if (matrix.GetNumElements() == 16)
+	{
+		for (int valueIndex = 0; valueIndex < 16; ++valueIndex)
+		{
+			localTransform.m_values[valueIndex] = matrix[valueIndex].GetFloat(0.f);
+		}
+		return localTransform;
+	}
+
+	// T * R * S
+	JsonValue const& translation = node["translation"];
+	JsonValue const& rotation = node["rotation"];
+	JsonValue const& scale = node["scale"];
+	float qx = rotation[0].GetFloat(0.f);
+	float qy = rotation[1].GetFloat(0.f);
+	float qz = rotation[2].GetFloat(0.f);
+	float qw = rotation[3].GetFloat(1.f);
+	float sx = scale[0].GetFloat(1.f);
+	float sy = scale[1].GetFloat(1.f);
+	float sz = scale[2].GetFloat(1.f);
+
+	localTransform.m_values[0] = (1.f - 2.f * (qy * qy + qz * qz)) * sx;
+	localTransform.m_values[1] = (2.f * (qx * qy + qz * qw)) * sx;
+	localTransform.m_values[2] = (2.f * (qx * qz - qy * qw)) * sx;
+	localTransform.m_values[4] = (2.f * (qx * qy - qz * qw)) * sy;
+	localTransform.m_values[5] = (1.f - 2.f * (qx * qx + qz * qz)) * sy;
+	localTransform.m_values[6] = (2.f * (qy * qz + qx * qw)) * sy;
+	localTransform.m_values[8] = (2.f * (qx * qz + qy * qw)) * sz;
+	localTransform.m_values[9] = (2.f * (qy * qz - qx * qw)) * sz;
+	localTransform.m_values[10] = (1.f - 2.f * (qx * qx + qy * qy)) * sz;
+	localTransform.m_values[12] = translation[0].GetFloat(0.f);
+	localTransform.m_values[13] = translation[1].GetFloat(0.f);
+	localTransform.m_values[14] = translation[2].GetFloat(0.f);
+	return localTransform;
+}
+
+// -----------------------------------------------------------------------------
+class GLBModelBuilder
+{
+public:
+	GLBModelBuilder(GLBDocument const& document, ModelData& out_model)
+		: m_document(document)
+		, m_model(out_model)
+	{
+	}
+
+	bool Build();
+
+private:
+	void AddNode(int nodeIndex, GLTFMatrix const& parentTransform, int depth);
+	void AddPrimitive(JsonValue const& primitive, GLTFMatrix const& worldTransform);
+	int  GetOrCreateMaterial(int gltfMaterialIndex);
+	std::string GetImageFile(int textureIndex);
+	void FinishSubmeshes();
+
+private:
+	GLBDocument const&						m_document;
+	ModelData&								m_model;
+	std::unordered_map<int, int>			m_materialIndexByGLTFIndex;
+	std::unordered_map<int, std::string>	m_imageFileByImageIndex;
+	std::vector<std::vector<unsigned int>>	m_materialTriangleIndices;
+	bool									m_isMissingNormals = false;
+	bool									m_isMissingTangents = false;
+};
+
+bool GLBModelBuilder::Build()
+{
+	JsonValue const& json = m_document.m_json;
+	JsonValue const& scene = json["scenes"][json["scene"].GetInt(0)];
+
+	if (!scene.IsNull())
+	{
+		JsonValue const& rootNodes = scene["nodes"];
+		for (int rootIndex = 0; rootIndex < rootNodes.GetNumElements(); ++rootIndex)
+		{
+			AddNode(rootNodes[rootIndex].GetInt(-1), GLTFMatrix(), 0);
+		}
+	}
+	else
+	{
+		// No scene: every node that is nobody's child is a root
+		JsonValue const& nodes = json["nodes"];
+		std::vector<bool> isChild(nodes.GetNumElements(), false);
+		for (int nodeIndex = 0; nodeIndex < nodes.GetNumElements(); ++nodeIndex)
+		{
+			JsonValue const& children = nodes[nodeIndex]["children"];
+			for (int childIndex = 0; childIndex < children.GetNumElements(); ++childIndex)
+			{
+				int child = children[childIndex].GetInt(-1);
+				if (child >= 0 && child < static_cast<int>(isChild.size()))
+				{
+					isChild[child] = true;
+				}
+			}
+		}
+		for (int nodeIndex = 0; nodeIndex < nodes.GetNumElements(); ++nodeIndex)
+		{
+			if (!isChild[nodeIndex])
+			{
+				AddNode(nodeIndex, GLTFMatrix(), 0);
+			}
+		}
+	}
+
+	FinishSubmeshes();
+
+	if (m_isMissingNormals)
+	{
+		CalculateModelNormals(m_model);
+	}
+	if (m_isMissingTangents || m_isMissingNormals)
+	{
+		CalculateModelTangents(m_model);
+	}
+	return !m_model.m_indices.empty();
+}
+
+void GLBModelBuilder::AddNode(int nodeIndex, GLTFMatrix const& parentTransform, int depth)
+{
+	constexpr int MAX_NODE_DEPTH = 128;
+	JsonValue const& node = m_document.m_json["nodes"][nodeIndex];
+	if (node.IsNull() || depth > MAX_NODE_DEPTH)
+	{
+		return;
+	}
+
+	GLTFMatrix worldTransform = parentTransform * GetNodeLocalTransform(node);
+
+	JsonValue const& mesh = m_document.m_json["meshes"][node["mesh"].GetInt(-1)];
+	JsonValue const& primitives = mesh["primitives"];
+	for (int primitiveIndex = 0; primitiveIndex < primitives.GetNumElements(); ++primitiveIndex)
+	{
+		AddPrimitive(primitives[primitiveIndex], worldTransform);
+	}
+
+	JsonValue const& children = node["children"];
+	for (int childIndex = 0; childIndex < children.GetNumElements(); ++childIndex)
+	{
+		AddNode(children[childIndex].GetInt(-1), worldTransform, depth + 1);
+	}
+}
+
+void GLBModelBuilder::AddPrimitive(JsonValue const& primitive, GLTFMatrix const& worldTransform)
+{
+	if (primitive["mode"].GetInt(GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+	{
+		DebuggerPrintf("WARNING: \"%s\" has a non-triangle primitive, skipping it\n", m_document.m_filePath.c_str());
+		return;
+	}
+
+	JsonValue const& attributes = primitive["attributes"];
+	GLTFAccessorView positions = GetAccessorView(m_document, attributes["POSITION"].GetInt(-1));
+	if (!positions.IsValid() || positions.m_numComponents != 3)
+	{
+		DebuggerPrintf("WARNING: \"%s\" has a primitive without usable positions, skipping it\n", m_document.m_filePath.c_str());
+		return;
+	}
+
+	GLTFAccessorView normals = GetAccessorView(m_document, attributes["NORMAL"].GetInt(-1));
+	GLTFAccessorView tangents = GetAccessorView(m_document, attributes["TANGENT"].GetInt(-1));
+	GLTFAccessorView uvs = GetAccessorView(m_document, attributes["TEXCOORD_0"].GetInt(-1));
+	GLTFAccessorView colors = GetAccessorView(m_document, attributes["COLOR_0"].GetInt(-1));
+	bool hasNormals = normals.IsValid() && normals.m_count == positions.m_count && normals.m_numComponents == 3;
+	bool hasTangents = hasNormals && tangents.IsValid() && tangents.m_count == positions.m_count && tangents.m_numComponents == 4;
+	bool hasUVs = uvs.IsValid() && uvs.m_count == positions.m_count && uvs.m_numComponents == 2;
+	bool hasColors = colors.IsValid() && colors.m_count == positions.m_count && colors.m_numComponents >= 3;
+	m_isMissingNormals |= !hasNormals;
+	m_isMissingTangents |= !hasTangents;
+
+	GLTFMatrix normalMatrix = worldTransform.GetNormalMatrix();
+	bool isMirrored = worldTransform.GetDeterminant3x3() < 0.f;
+	float mirrorSign = isMirrored ? -1.f : 1.f;
+
+	unsigned int baseVertex = static_cast<unsigned int>(m_model.m_verts.size());
+	m_model.m_verts.resize(m_model.m_verts.size() + static_cast<size_t>(positions.m_count));
+	for (int vertIndex = 0; vertIndex < positions.m_count; ++vertIndex)
+	{
+		Vertex_PCUTBN& vertex = m_model.m_verts[baseVertex + vertIndex];
+		vertex.m_position = worldTransform.TransformPosition(Vec3(positions.ReadFloat(vertIndex, 0), positions.ReadFloat(vertIndex, 1), positions.ReadFloat(vertIndex, 2)));
+		vertex.m_color = Rgba8::WHITE;
+
+		if (hasNormals)
+		{
+			Vec3 normal(normals.ReadFloat(vertIndex, 0), normals.ReadFloat(vertIndex, 1), normals.ReadFloat(vertIndex, 2));
+			vertex.m_normal = (normalMatrix.TransformVector(normal) * mirrorSign).GetNormalized();
+		}
+		if (hasTangents)
+		{
+			Vec3 tangent(tangents.ReadFloat(vertIndex, 0), tangents.ReadFloat(vertIndex, 1), tangents.ReadFloat(vertIndex, 2));
+			float handedness = tangents.ReadFloat(vertIndex, 3) * mirrorSign;
+			vertex.m_tangent = worldTransform.TransformVector(tangent).GetNormalized();
+
+			// glTF's bitangent points along +v with v running down the image; our UVs run up, so it flips
+			vertex.m_bitangent = CrossProduct3D(vertex.m_normal, vertex.m_tangent) * -handedness;
+		}
+		if (hasUVs)
+		{
+			vertex.m_uvTexCoords = Vec2(uvs.ReadFloat(vertIndex, 0), 1.f - uvs.ReadFloat(vertIndex, 1));
+		}
+		if (hasColors)
+		{
+			vertex.m_color.r = static_cast<unsigned char>(GetClamped(colors.ReadFloat(vertIndex, 0), 0.f, 1.f) * 255.f);
+			vertex.m_color.g = static_cast<unsigned char>(GetClamped(colors.ReadFloat(vertIndex, 1), 0.f, 1.f) * 255.f);
+			vertex.m_color.b = static_cast<unsigned char>(GetClamped(colors.ReadFloat(vertIndex, 2), 0.f, 1.f) * 255.f);
+			if (colors.m_numComponents == 4)
+			{
+				vertex.m_color.a = static_cast<unsigned char>(GetClamped(colors.ReadFloat(vertIndex, 3), 0.f, 1.f) * 255.f);
+			}
+		}
+	}
+
+	int materialIndex = GetOrCreateMaterial(primitive["material"].GetInt(-1));
+	std::vector<unsigned int>& triangleIndices = m_materialTriangleIndices[materialIndex];
+	size_t firstNewIndex = triangleIndices.size();
+
+	GLTFAccessorView indices = GetAccessorView(m_document, primitive["indices"].GetInt(-1));
+	if (indices.IsValid())
+	{
+		int numIndices = indices.m_count - (indices.m_count % 3);
+		if (indices.m_componentType == GLTF_UNSIGNED_INT && indices.m_stride == sizeof(uint32_t) && baseVertex == 0)
+		{
+			// Tightly packed 32-bit indices need no conversion; copy them straight out of the mapped file
+			unsigned int const* sourceIndices = reinterpret_cast<unsigned int const*>(indices.m_data);
+			triangleIndices.insert(triangleIndices.end(), sourceIndices, sourceIndices + numIndices);
+		}
+		else
+		{
+			triangleIndices.reserve(triangleIndices.size() + static_cast<size_t>(numIndices));
+			for (int index = 0; index < numIndices; ++index)
+			{
+				triangleIndices.push_back(baseVertex + indices.ReadIndex(index));
+			}
+		}
+	}
+	else
+	{
+		for (int index = 0; index + 2 < positions.m_count; index += 3)
+		{
+			triangleIndices.push_back(baseVertex + index);
+			triangleIndices.push_back(baseVertex + index + 1);
+			triangleIndices.push_back(baseVertex + index + 2);
+		}
+	}
+
+	// Drop triangles with out-of-range indices, and restore CCW winding under mirroring transforms
+	unsigned int numVerts = static_cast<unsigned int>(m_model.m_verts.size());
+	size_t writeIndex = firstNewIndex;
+	for (size_t readIndex = firstNewIndex; readIndex + 2 < triangleIndices.size(); readIndex += 3)
+	{
+		unsigned int indexA = triangleIndices[readIndex];
+		unsigned int indexB = triangleIndices[readIndex + 1];
+		unsigned int indexC = triangleIndices[readIndex + 2];
+		if (indexA < baseVertex || indexB < baseVertex || indexC < baseVertex || indexA >= numVerts || indexB >= numVerts || indexC >= numVerts)
+		{
+			continue;
+		}
+		triangleIndices[writeIndex] = indexA;
+		triangleIndices[writeIndex + 1] = isMirrored ? indexC : indexB;
+		triangleIndices[writeIndex + 2] = isMirrored ? indexB : indexC;
+		writeIndex += 3;
+	}
+	triangleIndices.resize(writeIndex);
+}
+
+int GLBModelBuilder::GetOrCreateMaterial(int gltfMaterialIndex)
+{
+	auto found = m_materialIndexByGLTFIndex.find(gltfMaterialIndex);
+	if (found != m_materialIndexByGLTFIndex.end())
+	{
+		return found->second;
+	}
+
+	int materialIndex = static_cast<int>(m_model.m_materials.size());
+	m_materialIndexByGLTFIndex[gltfMaterialIndex] = materialIndex;
+	m_materialTriangleIndices.emplace_back();
+	m_model.m_materials.emplace_back();
+
+	JsonValue const& gltfMaterial = m_document.m_json["materials"][gltfMaterialIndex];
+	if (!gltfMaterial.IsNull())
+	{
+		ModelMaterial& material = m_model.m_materials.back();
+		material.m_name = gltfMaterial["name"].GetString(Stringf("material%d", gltfMaterialIndex));
+		material.m_diffuseMapFile = GetImageFile(gltfMaterial["pbrMetallicRoughness"]["baseColorTexture"]["index"].GetInt(-1));
+		material.m_normalMapFile = GetImageFile(gltfMaterial["normalTexture"]["index"].GetInt(-1));
+	}
+	return materialIndex;
+}
+
+std::string GLBModelBuilder::GetImageFile(int textureIndex)
+{
+	int imageIndex = m_document.m_json["textures"][textureIndex]["source"].GetInt(-1);
+	JsonValue const& image = m_document.m_json["images"][imageIndex];
+	if (image.IsNull())
+	{
+		return "";
+	}
+
+	auto found = m_imageFileByImageIndex.find(imageIndex);
+	if (found != m_imageFileByImageIndex.end())
+	{
+		return found->second;
+	}
+
+	std::string imageFile;
+	std::string uri = image["uri"].GetString("");
+	if (!uri.empty())
+	{
+		if (uri.compare(0, 5, "data:") == 0)
+		{
+			DebuggerPrintf("WARNING: \"%s\" uses a data: URI image, which is not supported\n", m_document.m_filePath.c_str());
+		}
+		else
+		{
+			imageFile = (std::filesystem::path(m_document.m_filePath).parent_path() / uri).lexically_normal().generic_string();
+		}
+	}
+	else
+	{
+		// The texture cache loads by path, so embedded images are extracted next to the .glb, and
+		// rewritten only when the bytes differ so an unchanged image does not look edited to the hot reloader
+		unsigned char const* imageData = nullptr;
+		size_t imageLength = 0;
+		size_t imageStride = 0;
+		if (GetBufferViewBytes(m_document, image["bufferView"].GetInt(-1), imageData, imageLength, imageStride))
+		{
+			std::string extension = (image["mimeType"].GetString("") == "image/jpeg") ? ".jpg" : ".png";
+			imageFile = Stringf("%s.image%d%s", m_document.m_filePath.c_str(), imageIndex, extension.c_str());
+
+			if (!DoesFileHoldBytes(imageFile, imageData, imageLength))
+			{
+				std::ofstream imageStream(imageFile, std::ios::binary | std::ios::trunc);
+				imageStream.write(reinterpret_cast<char const*>(imageData), static_cast<std::streamsize>(imageLength));
+				if (!imageStream)
+				{
+					DebuggerPrintf("WARNING: Failed to extract embedded image to \"%s\"\n", imageFile.c_str());
+					imageFile.clear();
+				}
+			}
+		}
+	}
+
+	m_imageFileByImageIndex[imageIndex] = imageFile;
+	return imageFile;
+}
+
+void GLBModelBuilder::FinishSubmeshes()
+{
+	for (int materialIndex = 0; materialIndex < static_cast<int>(m_materialTriangleIndices.size()); ++materialIndex)
+	{
+		std::vector<unsigned int> const& triangleIndices = m_materialTriangleIndices[materialIndex];
+		if (triangleIndices.empty())
+		{
+			continue;
+		}
+
+		ModelSubmesh submesh;
+		submesh.m_materialIndex = materialIndex;
+		submesh.m_startIndex = static_cast<unsigned int>(m_model.m_indices.size());
+		submesh.m_indexCount = static_cast<unsigned int>(triangleIndices.size());
+		m_model.m_submeshes.push_back(submesh);
+		m_model.m_indices.insert(m_model.m_indices.end(), triangleIndices.begin(), triangleIndices.end());
+	}
+}
+
+// -----------------------------------------------------------------------------
+bool LoadGLBModel(ModelData& out_model, std::string const& glbFilePath)
+{
+	out_model.Clear();
+
+	MemoryMappedFile file;
+	if (!file.Open(glbFilePath))
+	{
+		return false;
+	}
+
+	unsigned char const* data = file.GetData();
+	size_t size = file.GetSize();
+
+	uint32_t header[3];
+	if (size < sizeof(header))
+	{
+		DebuggerPrintf("WARNING: \"%s\" is too small to be a GLB file\n", glbFilePath.c_str());
+		return false;
+	}
+	memcpy(header, data, sizeof(header));
+	if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size)
+	{
+		DebuggerPrintf("WARNING: \"%s\" is not a glTF 2.0 binary file\n", glbFilePath.c_str());
+		return false;
+	}
+
+	GLBDocument document;
+	document.m_filePath = glbFilePath;
+
+	size_t chunkOffset = sizeof(header);
+	bool hasJson = false;
+	while (chunkOffset + 8 <= header[2])
+	{
+		uint32_t chunkHeader[2];
+		memcpy(chunkHeader, data + chunkOffset, sizeof(chunkHeader));
+		size_t chunkLength = chunkHeader[0];
+		unsigned char const* chunkData = data + chunkOffset + 8;
+		if (chunkOffset + 8 + chunkLength > header[2])
+		{
+			break;
+		}
+
+		if (chunkHeader[1] == GLB_CHUNK_JSON && !hasJson)
+		{
+			std::string errorMessage;
+			if (!JsonValue::Parse(document.m_json, reinterpret_cast<char const*>(chunkData), chunkLength, &errorMessage))
+			{
+				DebuggerPrintf("WARNING: \"%s\" has invalid JSON (%s)\n", glbFilePath.c_str(), errorMessage.c_str());
+				return false;
+			}
+			hasJson = true;
+		}
+		else if (chunkHeader[1] == GLB_CHUNK_BIN && document.m_binData == nullptr)
+		{
+			document.m_binData = chunkData;
+			document.m_binSize = chunkLength;
+		}
+
+		// Chunks are 4-byte aligned
+		chunkOffset += 8 + ((chunkLength + 3) & ~static_cast<size_t>(3));
+	}
+
+	if (!hasJson)
+	{
+		DebuggerPrintf("WARNING: \"%s\" has no JSON chunk\n", glbFilePath.c_str());
+		return false;
+	}
+
+	GLBModelBuilder builder(document, out_model);
+	return builder.Build();
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include <string>
+// -----------------------------------------------------------------------------
+// Loads a binary glTF 2.0 (.glb) file. The file is memory-mapped and accessors are read in
+// place; the scene's node hierarchy is flattened into one mesh, grouped by material.
+// Embedded images are written next to the .glb so they can go through the texture cache.
+// -----------------------------------------------------------------------------
+bool LoadGLBModel(ModelData& out_model, std::string const& glbFilePath);
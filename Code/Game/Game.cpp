@@ -1,408 +1,2325 @@
-#include "Game/Game.h"
-#include "Game/GameCommon.h"
-#include "Game/App.h"
-#include "Game/Player.hpp"
-
-#include "Engine/Input/InputSystem.h"
-#include "Engine/Renderer/Renderer.h"
-#include "Engine/Window/Window.hpp"
-#include "Engine/Audio/AudioSystem.hpp"
-#include "Engine/Core/Rgba8.h"
-#include "Engine/Core/Vertex_PCU.h"
-#include "Engine/Core/EngineCommon.h"
-#include "Engine/Core/DevConsole.hpp"
-#include "Engine/Core/Time.hpp"
-#include "Engine/Core/VertexUtils.h"
-#include "Engine/Core/DebugRender.hpp"
-#include "Engine/Core/OBJLoader.hpp"
-#include "Engine/Math/MathUtils.h"
-#include "Engine/Math/AABB3.hpp"
-
-Game::Game(App* owner)
-	: m_app(owner)
-{
-}
-
-Game::~Game()
-{
-}
-
-void Game::StartUp()
-{
-	// Load MetaData from XML
-	LoadXMLMetaData("Data/Models/Woman.xml");
-	std::string womanOBJFile = g_gameConfigBlackboard.GetValue("objFile", "");
-	std::string phongShader = g_gameConfigBlackboard.GetValue("shader", "");
-	std::string diffuseMap = g_gameConfigBlackboard.GetValue("diffuseMap", "");
-	std::string normalMap = g_gameConfigBlackboard.GetValue("normalMap", "");
-	float unitsPerMeter = g_gameConfigBlackboard.GetValue("unitsPerMeter", 0.f);
-	std::string orientationX = g_gameConfigBlackboard.GetValue("x", "left");
-	std::string orientationY = g_gameConfigBlackboard.GetValue("y", "up");
-	std::string orientationZ = g_gameConfigBlackboard.GetValue("z", "forward");
-
-	// Create and push back the entities
-	m_player = new Player(this, Vec3(-1.f, 0.f, 0.5f));
-
-	// Get Blinn Phong shader
-	m_shader = g_theRenderer->CreateOrGetShader(phongShader.c_str(), VertexType::VERTEX_PCUTBN);
-
-	// Get model Textures
-	m_womanDiffuseTexture = g_theRenderer->CreateOrGetTextureFromFile(diffuseMap.c_str());
-	m_womanNormalTexture = g_theRenderer->CreateOrGetTextureFromFile(normalMap.c_str());
-
-	// Load the model
-	bool loaded = LoadOBJMeshFile(m_modelMeshVerts, "Data/Models/cube_vni.obj");
-	GUARANTEE_OR_DIE(loaded, "Failed to load cube_vni.obj!");
-
-	bool wloaded = LoadOBJMeshFile(m_modelMeshVerts, womanOBJFile.c_str());
-	GUARANTEE_OR_DIE(wloaded, "Failed to load Woman.obj!");
-
-	// Scale and orient the model
-	m_modelToWorldTransform.Append(Mat44::MakeUniformScale3D(unitsPerMeter));
-	m_modelToWorldTransform.Append(ApplyOrientation(orientationX, orientationY, orientationZ));
-
-	// Create buffers
-	CreateBuffers();
-
-	// Adding a plus crosshair with infinite duration
-	DebugAddScreenText("+", AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 20.f, Vec2::ONEHALF, -1.f);
-
-	// Initialize the grid
-	InitializeGrid();
-}
-
-void Game::CreateBuffers()
-{
-	// Create buffers and copy to GPU
-	m_modelVBO = g_theRenderer->CreateVertexBuffer(static_cast<unsigned int>(m_modelMeshVerts.size()) * sizeof(Vertex_PCUTBN), sizeof(Vertex_PCUTBN));
-	//m_modelIBO = g_theRenderer->CreateIndexBuffer(static_cast<unsigned int>(m_modelMeshIndices.size()) * sizeof(unsigned int), sizeof(unsigned int));
-	g_theRenderer->CopyCPUToGPU(m_modelMeshVerts.data(), m_modelVBO->GetSize(), m_modelVBO);
-	//g_theRenderer->CopyCPUToGPU(m_modelMeshIndices.data(), m_modelIBO->GetSize(), m_modelIBO);
-}
-
-void Game::LoadXMLMetaData(char const* filePath)
-{
-	XmlDocument metaDataXML;
-	XmlError result = metaDataXML.LoadFile(filePath);
-	if (result == tinyxml2::XML_SUCCESS)
-	{
-		XmlElement* rootElement = metaDataXML.RootElement();
-		if (rootElement)
-		{
-			g_gameConfigBlackboard.PopulateFromXmlElementAttributes(*rootElement);
-		}
-		else
-		{
-			DebuggerPrintf("WARNING: MetaData file \"%s\" was invalid (missing root element)\n", filePath);
-		}
-	}
-	else
-	{
-		DebuggerPrintf("WARNING: Failed to load MetaData from file \"%s\"\n", filePath);
-	}
-}
-
-Mat44 Game::ApplyOrientation(std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ)
-{
-	Mat44 orientationTransform = Mat44();
-	Vec3 xAxis, yAxis, zAxis;
-
-	if (orientationX == "left") 
-	{
-		xAxis = Vec3::YAXE;
-	}
-	else if (orientationX == "right") 
-	{
-		xAxis = -Vec3::YAXE;
-	}
-
-	if (orientationY == "up") 
-	{
-		yAxis = Vec3::ZAXE;  
-	}
-	else if (orientationY == "down") 
-	{
-		yAxis = -Vec3::ZAXE; 
-	}
-
-	if (orientationZ == "forward") 
-	{
-		zAxis = Vec3::XAXE;  
-	}
-	else if (orientationZ == "backward") 
-	{
-		zAxis = -Vec3::XAXE;
-	}
-
-	Mat44 orientationMatrix;
-	orientationMatrix.m_values[Mat44::Ix] = xAxis.x;
-	orientationMatrix.m_values[Mat44::Iy] = xAxis.y;
-	orientationMatrix.m_values[Mat44::Iz] = xAxis.z;
-
-	orientationMatrix.m_values[Mat44::Jx] = yAxis.x;
-	orientationMatrix.m_values[Mat44::Jy] = yAxis.y;
-	orientationMatrix.m_values[Mat44::Jz] = yAxis.z;
-
-	orientationMatrix.m_values[Mat44::Kx] = zAxis.x;
-	orientationMatrix.m_values[Mat44::Ky] = zAxis.y;
-	orientationMatrix.m_values[Mat44::Kz] = zAxis.z;
-
-	return orientationMatrix;
-}
-
-void Game::Update()
-{
-	// Setting clock time variables
-	double deltaSeconds = m_gameClock.GetDeltaSeconds();
-
-	// Set debug text
-	std::string debugText = Stringf("Debug Mode [%d]: %s", m_debugInt, GetDebugRenderModeDesc(m_debugInt));
-	DebugAddScreenText(debugText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.97f), 0.f);
-	g_theRenderer->SetPerFrameConstants(m_debugInt, 0.f);
-
-	UpdatePlayer(static_cast<float>(deltaSeconds));
-
-	AdjustForPauseAndTimeDistortion(static_cast<float>(deltaSeconds));
-	KeyInputPresses();
-
-	UpdateCameras();
-}
-
-void Game::Render() const
-{
-	if (m_isAttractMode == true)
-	{
-	}
-	if (m_isAttractMode == false)
-	{
-		g_theRenderer->BeginCamera(m_player->GetPlayerCamera());
-		g_theRenderer->ClearScreen(Rgba8(70, 70, 70, 255));
-		RenderGrid();
-		RenderModel();
-		g_theRenderer->EndCamera(m_player->GetPlayerCamera());
-
-		DebugRenderWorld(m_player->GetPlayerCamera());
-		DebugRenderScreen(m_screenCamera);
-	}
-}
-
-void Game::Shutdown()
-{
-	delete m_player;
-	m_player = nullptr;
-
-	delete m_modelVBO;
-	m_modelVBO = nullptr;
-}
-
-void Game::InitializeGrid()
-{
-	// Layout
-	for (int gridIndex = 0; gridIndex < 100; ++gridIndex)
-	{
-		AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.01f + gridIndex, -0.005f, 50.f, -49.99f + gridIndex, 0.005f), Rgba8::DARKGRAY);
-		AddVertsForAABB3D(m_gridVerts, AABB3(-50.01f + gridIndex, -50.0f, -0.005f, -49.99f + gridIndex, 50.f, 0.005f), Rgba8::DARKGRAY);
-	}
-
-	// Y axis
-	for (int x = 0; x < 105; x += 5)
-	{
-		if (x == 50)
-		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::GREEN);
-		}
-		else
-		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::SEAWEED);
-		}
-	}
-
-	// X axis
-	for (int y = 0; y < 105; y += 5)
-	{
-		if (y == 50)
-		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::RED);
-		}
-		else
-		{
-			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::DARKRED);
-		}
-	}
-}
-
-void Game::KeyInputPresses()
-{
-	// Attract Mode
-	if (g_theInput->WasKeyJustPressed(' '))
-	{
-		m_isAttractMode = false;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC))
-	{
-		m_isAttractMode = true;
-	}
-
-	// Debug Visualization Keys
-	DebugVisuals();
-}
-
-void Game::AdjustForPauseAndTimeDistortion(float deltaSeconds) {
-
-	UNUSED(deltaSeconds);
-
-	if (g_theInput->IsKeyDown('T'))
-	{
-		m_gameClock.SetTimeScale(0.1);
-	}
-	else
-	{
-		m_gameClock.SetTimeScale(1.0);
-	}
-
-	if (g_theInput->WasKeyJustPressed('P'))
-	{
-		m_gameClock.TogglePause();
-	}
-
-	if (g_theInput->WasKeyJustPressed('O'))
-	{
-		m_gameClock.StepSingleFrame();
-	}
-
-	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC) && m_isAttractMode)
-	{
-		g_theEventSystem->FireEvent("Quit");
-	}
-}
-
-void Game::UpdateCameras()
-{
-	m_screenCamera.SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y));
-}
-
-void Game::UpdatePlayer(float deltaSeconds)
-{
-	if (m_player != nullptr)
-	{
-		m_player->Update(deltaSeconds);
-	}
-}
-
-void Game::RenderGrid() const
-{
-	g_theRenderer->SetModelConstants();
-	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
-	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
-	g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
-	g_theRenderer->BindTexture(nullptr);
-	g_theRenderer->BindShader(nullptr);
-	g_theRenderer->DrawVertexArray(m_gridVerts);
-}
-
-void Game::RenderModel() const
-{
-	if (!m_modelVBO)
-	{
-		return;
-	}
-
-	g_theRenderer->SetModelConstants(m_modelToWorldTransform);
-	g_theRenderer->SetLightingConstants(m_sunDirection, m_sunIntensity, m_ambientIntensity);
-	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
-	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
-	g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
-	g_theRenderer->BindSampler(SamplerMode::POINT_CLAMP, 0);
-	g_theRenderer->BindSampler(SamplerMode::BILINEAR_WRAP, 1);
-	g_theRenderer->BindSampler(SamplerMode::BILINEAR_WRAP, 2);
-	g_theRenderer->BindTexture(m_womanDiffuseTexture, 0);
-	g_theRenderer->BindTexture(m_womanNormalTexture, 1);
-	g_theRenderer->BindShader(m_shader);
-	g_theRenderer->DrawVertexArray(m_modelMeshVerts);
-}
-
-void Game::DebugVisuals()
-{
-	if (g_theInput->WasKeyJustPressed('0'))
-	{
-		m_debugInt = 0;
-	}
-	if (g_theInput->WasKeyJustPressed('1'))
-	{
-		m_debugInt = 1;
-	}
-	if (g_theInput->WasKeyJustPressed('2'))
-	{
-		m_debugInt = 2;
-	}
-	if (g_theInput->WasKeyJustPressed('3'))
-	{
-		m_debugInt = 3;
-	}
-	if (g_theInput->WasKeyJustPressed('7'))
-	{
-		m_debugInt = 7;
-	}
-	if (g_theInput->WasKeyJustPressed('8'))
-	{
-		m_debugInt = 8;
-	}
-	if (g_theInput->WasKeyJustPressed('9'))
-	{
-		m_debugInt = 9;
-	}
-
-	if (g_theInput->WasKeyJustPressed('K'))
-	{
-		m_debugInt = 10;
-	}
-	if (g_theInput->WasKeyJustPressed('L'))
-	{
-		m_debugInt = 11;
-	}
-
-	// Debug Tangent/Bitangent/Normal
-	if (g_theInput->WasKeyJustPressed('T'))
-	{
-		m_debugInt = 4;
-	}
-	if (g_theInput->WasKeyJustPressed('B'))
-	{
-		m_debugInt = 5;
-	}
-	if (g_theInput->WasKeyJustPressed('N'))
-	{
-		m_debugInt = 6;
-	}
-
-	// Debug Specular/Glossiness/Emissive
-	// Need to enable Nums Lock to use numpad keys
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD0))
-	{
-		m_debugInt = 14;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD1))
-	{
-		m_debugInt = 15;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD2))
-	{
-		m_debugInt = 16;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD3))
-	{
-		m_debugInt = 17;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD4))
-	{
-		m_debugInt = 18;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD5))
-	{
-		m_debugInt = 19;
-	}
-	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD6))
-	{
-		m_debugInt = 20;
-	}
-}
+#include "Game/Game.h"
+#include "Game/GameCommon.h"
+#include "Game/App.h"
+#include "Game/Player.hpp"
+#include "Game/ModelHotReloader.hpp"
+#include "Game/ModelTransform.hpp"
+#include "Game/PerfStats.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Game/PNGWriter.hpp"
+#include "Game/MeshAnalyzer.hpp"
+#include "Game/MemoryTracker.hpp"
+
+#include "Engine/Input/InputSystem.h"
+#include "Engine/Renderer/Renderer.h"
+#include "Engine/Renderer/Texture.hpp"
+#include "Engine/Window/Window.hpp"
+#include "Engine/Audio/AudioSystem.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/VertexUtils.h"
+#include "Engine/Core/DebugRender.hpp"
+#include "Engine/Core/Image.hpp"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/AABB3.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <random>
+
+constexpr char const* MODEL_METADATA_FILE = "Data/Models/Woman.xml";
+
+static PerfStatId const s_drawCallsStat = GetPerfStats().Register("draw_calls", PerfStatType::COUNTER);
+static PerfStatId const s_trianglesDrawnStat = GetPerfStats().Register("triangles_drawn", PerfStatType::COUNTER);
+static PerfStatId const s_uploadBytesStat = GetPerfStats().Register("upload_bytes", PerfStatType::COUNTER);
+static PerfStatId const s_hotReloadsStat = GetPerfStats().Register("hot_reloads", PerfStatType::COUNTER);
+static PerfStatId const s_modelVertsStat = GetPerfStats().Register("model_verts", PerfStatType::GAUGE);
+static PerfStatId const s_modelTrianglesStat = GetPerfStats().Register("model_triangles", PerfStatType::GAUGE);
+static PerfStatId const s_occludedClustersStat = GetPerfStats().Register("occluded_clusters", PerfStatType::GAUGE);
+static PerfStatId const s_frustumCulledClustersStat = GetPerfStats().Register("frustum_culled_clusters", PerfStatType::GAUGE);
+static PerfStatId const s_occlusionMillisecondsStat = GetPerfStats().Register("occlusion_ms", PerfStatType::HISTOGRAM);
+static PerfStatId const s_localLightsStat = GetPerfStats().Register("local_lights", PerfStatType::GAUGE);
+static PerfStatId const s_lightIndicesStat = GetPerfStats().Register("light_indices", PerfStatType::GAUGE);
+static PerfStatId const s_lightBinningMillisecondsStat = GetPerfStats().Register("light_binning_ms", PerfStatType::HISTOGRAM);
+static PerfStatId const s_shadowCullMillisecondsStat = GetPerfStats().Register("shadow_cull_ms", PerfStatType::HISTOGRAM);
+static PerfStatId const s_shadowCasterStats[NUM_SHADOW_CASCADES] =
+{
+	GetPerfStats().Register("shadow_casters_0", PerfStatType::GAUGE),
+	GetPerfStats().Register("shadow_casters_1", PerfStatType::GAUGE),
+	GetPerfStats().Register("shadow_casters_2", PerfStatType::GAUGE),
+	GetPerfStats().Register("shadow_casters_3", PerfStatType::GAUGE),
+};
+static PerfStatId const s_streamedResidentMegabytesStat = GetPerfStats().Register("streamed_resident_mb", PerfStatType::GAUGE);
+static PerfStatId const s_chunkHitRateStat = GetPerfStats().Register("chunk_hit_rate", PerfStatType::GAUGE);
+static PerfStatId const s_sectionMillisecondsStat = GetPerfStats().Register("section_ms", PerfStatType::HISTOGRAM);
+static PerfStatId const s_trackedMegabytesStat = GetPerfStats().Register("tracked_mb", PerfStatType::GAUGE);
+static PerfStatId const s_trackedGPUMegabytesStat = GetPerfStats().Register("tracked_gpu_mb", PerfStatType::GAUGE);
+
+static double GetImportThroughputMBPerSecond(std::string const& modelFile, double seconds)
+{
+	std::error_code errorCode;
+	uintmax_t fileSize = std::filesystem::file_size(modelFile, errorCode);
+	if (errorCode || seconds <= 0.0)
+	{
+		return 0.0;
+	}
+	return (static_cast<double>(fileSize) / (1024.0 * 1024.0)) / seconds;
+}
+
+// Scatters point and spot lights through a box, aiming spots at its center; the seed makes a set reproducible
+static void AddRandomLocalLights(std::vector<LocalLight>& out_lights, int numLights, float spotFraction, unsigned int seed, AABB3 const& bounds)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	Vec3 boundsSize = bounds.m_maxs - bounds.m_mins;
+	Vec3 boundsCenter = bounds.m_mins + boundsSize * 0.5f;
+	float boundsRadius = boundsSize.GetLength() * 0.5f;
+
+	for (int lightIndex = 0; lightIndex < numLights; ++lightIndex)
+	{
+		LocalLight light;
+		light.m_position = bounds.m_mins + Vec3(boundsSize.x * unit(random), boundsSize.y * unit(random), boundsSize.z * unit(random));
+		light.m_radius = boundsRadius * Interpolate(0.1f, 0.4f, unit(random));
+		light.m_color = Vec3(Interpolate(0.3f, 1.f, unit(random)), Interpolate(0.3f, 1.f, unit(random)), Interpolate(0.3f, 1.f, unit(random)));
+		light.m_intensity = Interpolate(0.5f, 2.f, unit(random));
+		if (unit(random) < spotFraction)
+		{
+			light.m_type = LocalLightType::SPOT;
+			light.m_direction = (boundsCenter - light.m_position).GetNormalized();
+			light.m_outerConeDegrees = Interpolate(15.f, 45.f, unit(random));
+			light.m_innerConeDegrees = light.m_outerConeDegrees * 0.75f;
+		}
+		out_lights.push_back(light);
+	}
+}
+
+// Model transforms are a uniform scale of an axis remap, so the inverse of the linear part is its transpose over the squared scale
+static Vec3 TransformWorldToModel(Mat44 const& modelToWorld, Vec3 const& worldVector)
+{
+	Vec3 iBasis = modelToWorld.GetIBasis3D();
+	float inverseScaleSquared = 1.f / iBasis.GetLengthSquared();
+	return Vec3(DotProduct3D(worldVector, iBasis), DotProduct3D(worldVector, modelToWorld.GetJBasis3D()), DotProduct3D(worldVector, modelToWorld.GetKBasis3D())) * inverseScaleSquared;
+}
+
+static float GetSectionAxisCenter(SectionAxis axis, AABB3 const& worldBounds)
+{
+	SectionPlane plane;
+	plane.m_axis = axis;
+	return DotProduct3D(plane.GetWorldNormal(), (worldBounds.m_mins + worldBounds.m_maxs) * 0.5f);
+}
+
+// Textures and shaders belong to the renderer's cache, which keeps them across game restarts, so they are counted against the
+// cache from the first time the game asks for them until the renderer shuts down. Textures are RGBA8 without mips
+static void TrackTexture(Texture const* texture, std::string const& textureFile)
+{
+	if (texture != nullptr)
+	{
+		uint64_t numTexels = static_cast<uint64_t>(texture->GetDimensions().x) * static_cast<uint64_t>(texture->GetDimensions().y);
+		GetMemoryTracker().Track(texture, MemoryCategory::TEXTURE, MemoryResourceType::TEXTURE, numTexels * 4, textureFile, MemoryOwner::RENDERER_CACHE);
+	}
+}
+
+// The renderer doesn't report compiled shader sizes, so a shader counts as the size of its HLSL source
+static Shader* CreateOrGetTrackedShader(std::string const& shaderName)
+{
+	Shader* shader = g_theRenderer->CreateOrGetShader(shaderName.c_str(), VertexType::VERTEX_PCUTBN);
+	std::filesystem::path shaderFile(shaderName);
+	if (!shaderFile.has_extension())
+	{
+		shaderFile += ".hlsl";
+	}
+	std::error_code errorCode;
+	uintmax_t shaderFileSize = std::filesystem::file_size(shaderFile, errorCode);
+	uint64_t numBytes = (errorCode || shaderFileSize == 0) ? 1 : static_cast<uint64_t>(shaderFileSize);
+	GetMemoryTracker().Track(shader, MemoryCategory::SHADER, MemoryResourceType::SHADER, numBytes, shaderName, MemoryOwner::RENDERER_CACHE);
+	return shader;
+}
+
+// The renderer caches textures by path and has no way to reload one, so an edited texture is reloaded into a new texture
+// that stands in for its path from then on, including across game restarts
+static std::map<std::string, Texture*>& GetReloadedTextures()
+{
+	static std::map<std::string, Texture*> s_reloadedTextures;
+	return s_reloadedTextures;
+}
+
+static Texture* CreateOrGetModelTexture(std::string const& textureFile)
+{
+	if (textureFile.empty())
+	{
+		return nullptr;
+	}
+
+	auto found = GetReloadedTextures().find(textureFile);
+	if (found != GetReloadedTextures().end())
+	{
+		return found->second;
+	}
+	Texture* texture = g_theRenderer->CreateOrGetTextureFromFile(textureFile.c_str());
+	TrackTexture(texture, textureFile);
+	return texture;
+}
+
+// Replaces the path's previous reload, if any; the caller rebinds every material that held it
+static Texture* ReloadModelTexture(std::string const& textureFile)
+{
+	Image image(textureFile.c_str());
+	Texture* texture = g_theRenderer->CreateTextureFromImage(image);
+	Texture*& reloadedTexture = GetReloadedTextures()[textureFile];
+	if (reloadedTexture != nullptr)
+	{
+		GetMemoryTracker().Release(reloadedTexture);
+		delete reloadedTexture;
+	}
+	TrackTexture(texture, textureFile);
+	reloadedTexture = texture;
+	return texture;
+}
+
+void Game::DeleteReloadedTextures()
+{
+	std::map<std::string, Texture*>& reloadedTextures = GetReloadedTextures();
+	for (auto reloadedIter = reloadedTextures.begin(); reloadedIter != reloadedTextures.end(); ++reloadedIter)
+	{
+		GetMemoryTracker().Release(reloadedIter->second);
+		delete reloadedIter->second;
+	}
+	reloadedTextures.clear();
+}
+
+template <typename T>
+static void DeleteTrackedResource(T*& resource)
+{
+	GetMemoryTracker().Release(resource);
+	delete resource;
+	resource = nullptr;
+}
+
+Game::Game(App* owner)
+	: m_app(owner)
+{
+}
+
+Game::~Game()
+{
+}
+
+void Game::StartUp()
+{
+	// Load MetaData from XML
+	LoadXMLMetaData(MODEL_METADATA_FILE, g_gameConfigBlackboard);
+	std::string womanOBJFile = g_gameConfigBlackboard.GetValue("objFile", "");
+	std::string meshFormat = g_gameConfigBlackboard.GetValue("meshFormat", "");
+	std::string phongShader = g_gameConfigBlackboard.GetValue("shader", "");
+	std::string diffuseMap = g_gameConfigBlackboard.GetValue("diffuseMap", "");
+	std::string normalMap = g_gameConfigBlackboard.GetValue("normalMap", "");
+	float unitsPerMeter = g_gameConfigBlackboard.GetValue("unitsPerMeter", 0.f);
+	std::string orientationX = g_gameConfigBlackboard.GetValue("x", "left");
+	std::string orientationY = g_gameConfigBlackboard.GetValue("y", "up");
+	std::string orientationZ = g_gameConfigBlackboard.GetValue("z", "forward");
+
+	// Create and push back the entities
+	m_player = new Player(this, Vec3(-1.f, 0.f, 0.5f));
+
+	// Get Blinn Phong shader
+	m_shader = CreateOrGetTrackedShader(phongShader);
+
+	// Materials without their own maps fall back to the textures named in the XML
+	m_fallbackDiffuseMap = diffuseMap;
+	m_fallbackNormalMap = normalMap;
+
+	// Scale and orient the model
+	if (unitsPerMeter <= 0.f)
+	{
+		std::string errorMessage = Stringf("Model unitsPerMeter=%g is invalid; it must be greater than zero", unitsPerMeter);
+		g_theDevConsole->AddLine(DevConsole::ERROR, errorMessage);
+		ERROR_RECOVERABLE(errorMessage);
+		unitsPerMeter = 1.f;
+	}
+	m_modelToWorldTransform.Append(Mat44::MakeUniformScale3D(unitsPerMeter));
+	m_modelToWorldTransform.Append(ApplyOrientation(orientationX, orientationY, orientationZ));
+
+	// Static models can have scale and orientation baked into their vertices, leaving an identity model matrix
+	m_isModelTransformBaked = g_gameConfigBlackboard.GetValue("bakeTransform", false);
+	if (m_isModelTransformBaked)
+	{
+		m_modelBakeTransform = m_modelToWorldTransform;
+		m_modelToWorldTransform = Mat44();
+	}
+
+	// Occlusion culling splits the model into clusters and rasterizes the biggest ones as occluders
+	m_isOcclusionCullingEnabled = g_gameConfigBlackboard.GetValue("occlusionCulling", true);
+	m_trianglesPerCluster = g_gameConfigBlackboard.GetValue("trianglesPerCluster", m_trianglesPerCluster);
+	m_occluderTriangleBudget = g_gameConfigBlackboard.GetValue("occluderTriangleBudget", m_occluderTriangleBudget);
+
+	// Load the model; chunked meshes are streamed a page at a time instead
+	ModelFileFormat modelFormat = GetModelFileFormat(womanOBJFile, meshFormat);
+	if (modelFormat == ModelFileFormat::CHUNKED)
+	{
+		OpenStreamedModel(womanOBJFile);
+	}
+	else
+	{
+		bool isLoaded = LoadModel(womanOBJFile, modelFormat);
+		GUARANTEE_OR_DIE(isLoaded, Stringf("Failed to load model \"%s\"!", womanOBJFile.c_str()));
+	}
+
+	// Local lights are binned into view clusters on the CPU each time the view changes. The Blinn-Phong shader has no
+	// clustered lighting path yet, so the binned buffers are not uploaded; the HUD reports the binning
+	int numStartupLights = g_gameConfigBlackboard.GetValue("localLights", 0);
+	AddRandomLocalLights(m_localLights, numStartupLights, g_gameConfigBlackboard.GetValue("spotLightFraction", 0.25f), 1u, GetModelWorldBounds());
+
+	// Sun cascades are only fit and caster-culled on the CPU; nothing draws or samples a shadow map yet, so this is off unless asked for
+	m_isCascadeFittingEnabled = g_gameConfigBlackboard.GetValue("shadowCascadeFitting", false);
+	m_shadowCascades.SetSplitLambda(g_gameConfigBlackboard.GetValue("shadowSplitLambda", 0.95f));
+
+	// Adding a plus crosshair with infinite duration
+	DebugAddScreenText("+", AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 20.f, Vec2::ONEHALF, -1.f);
+
+	// Initialize the grid
+	InitializeGrid();
+
+	// Watch the model's source files so edits show up without restarting
+	StartHotReloader(womanOBJFile, modelFormat);
+
+	SubscribeCommand("BenchmarkModelImport", Event_BenchmarkModelImport);
+	SubscribeCommand("BenchmarkTransformBake", Event_BenchmarkTransformBake);
+	SubscribeCommand("SpawnLights", Event_SpawnLights);
+	SubscribeCommand("ClearLights", Event_ClearLights);
+	SubscribeCommand("BenchmarkLightBinning", Event_BenchmarkLightBinning);
+	SubscribeCommand("CaptureTurntable", Event_CaptureTurntable);
+	SubscribeCommand("CaptureScreenshot", Event_CaptureScreenshot);
+	SubscribeCommand("ImportChunkedMesh", Event_ImportChunkedMesh);
+	SubscribeCommand("AnalyzeMesh", Event_AnalyzeMesh);
+	SubscribeCommand("SectionPlane", Event_SectionPlane);
+	SubscribeCommand("BenchmarkTriangleQueries", Event_BenchmarkTriangleQueries);
+	SubscribeCommand("LoadModel", Event_LoadModel);
+	SubscribeCommand("SetDebugMode", Event_SetDebugMode);
+	SubscribeCommand("SetCameraPose", Event_SetCameraPose);
+	SubscribeCommand("RunScript", Event_RunScript);
+	SubscribeCommand("StopScript", Event_StopScript);
+}
+
+bool Game::LoadModel(std::string const& modelFile, ModelFileFormat modelFormat)
+{
+	double loadStartTime = GetCurrentTimeSeconds();
+
+	// The current model stays up until the new one has parsed
+	ModelData model;
+	if (!LoadModelFile(model, modelFile, modelFormat))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Failed to load model \"%s\"", modelFile.c_str()));
+		return false;
+	}
+
+	double parseEndTime = GetCurrentTimeSeconds();
+	if (m_isModelStreamed)
+	{
+		CloseStreamedModel();
+	}
+
+	m_modelFile = modelFile;
+	m_modelMeshVerts.swap(model.m_verts);
+	m_modelMeshIndices.swap(model.m_indices);
+	m_modelMaterials.swap(model.m_materials);
+	m_modelSubmeshes.swap(model.m_submeshes);
+	m_modelMaterialLibraryFiles.swap(model.m_materialLibraryFiles);
+
+	if (m_isModelTransformBaked)
+	{
+		double bakeStartTime = GetCurrentTimeSeconds();
+		BakeModelTransform(m_modelMeshVerts, m_modelBakeTransform);
+		double bakeSeconds = GetCurrentTimeSeconds() - bakeStartTime;
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  baked transform into %d verts in %.2f ms", static_cast<int>(m_modelMeshVerts.size()), bakeSeconds * 1000.0));
+	}
+
+	double bakeEndTime = GetCurrentTimeSeconds();
+	LoadModelMaterialTextures();
+	DeleteModelBuffers();
+	CreateBuffers();
+	BuildOcclusionClusters();
+	m_modelBVH.Clear();
+	m_measurePoints.clear();
+	m_isSectionDirty = true;
+	m_isRedrawRequested = true;
+
+	double loadEndTime = GetCurrentTimeSeconds();
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Loaded \"%s\": %d verts, %d tris, %d materials, %d draw calls",
+		modelFile.c_str(), static_cast<int>(m_modelMeshVerts.size()), static_cast<int>(m_modelMeshIndices.size()) / 3,
+		static_cast<int>(m_modelMaterials.size()), static_cast<int>(m_modelSubmeshes.size())));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  parse %.2f ms (%.1f MB/s), textures + upload %.2f ms",
+		(parseEndTime - loadStartTime) * 1000.0, GetImportThroughputMBPerSecond(modelFile, parseEndTime - loadStartTime), (loadEndTime - bakeEndTime) * 1000.0));
+	return true;
+}
+
+void Game::OpenStreamedModel(std::string const& chunkedFile)
+{
+	// Pages go to the GPU exactly as stored, so a streamed model keeps its transform in the model matrix
+	if (m_isModelTransformBaked)
+	{
+		m_modelToWorldTransform = m_modelBakeTransform;
+		m_isModelTransformBaked = false;
+	}
+
+	float budgetMegabytes = g_gameConfigBlackboard.GetValue("streamingBudgetMB", 1024.f);
+	std::string errorMessage;
+	bool isOpened = m_streamedModel.Open(chunkedFile, static_cast<uint64_t>(static_cast<double>(budgetMegabytes) * 1024.0 * 1024.0), errorMessage);
+	GUARANTEE_OR_DIE(isOpened, Stringf("Failed to open chunked mesh \"%s\": %s", chunkedFile.c_str(), errorMessage.c_str()));
+	m_streamedModel.SetPrefetchDistance(g_gameConfigBlackboard.GetValue("streamingPrefetchDistance", 5.f));
+	m_streamedChunkVBOs.assign(m_streamedModel.GetNumChunks(), nullptr);
+	m_streamedChunkIBOs.assign(m_streamedModel.GetNumChunks(), nullptr);
+	m_isModelStreamed = true;
+	m_modelFile = chunkedFile;
+	m_modelBVH.Clear();
+	m_isSectionDirty = true;
+
+	// Chunks carry no materials; they all draw with the fallback maps named in the XML
+	m_modelMaterials.assign(1, ModelMaterial());
+	LoadModelMaterialTextures();
+	m_isRedrawRequested = true;
+
+	GetPerfStats().Set(s_modelTrianglesStat, static_cast<double>(m_streamedModel.GetNumTriangles()));
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Streaming \"%s\": %llu tris in %d chunks, %.0f MB budget",
+		chunkedFile.c_str(), static_cast<unsigned long long>(m_streamedModel.GetNumTriangles()), m_streamedModel.GetNumChunks(), budgetMegabytes));
+}
+
+void Game::CloseStreamedModel()
+{
+	m_streamedModel.Close();
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_streamedChunkVBOs.size()); ++chunkIndex)
+	{
+		DeleteTrackedResource(m_streamedChunkVBOs[chunkIndex]);
+		DeleteTrackedResource(m_streamedChunkIBOs[chunkIndex]);
+	}
+	m_streamedChunkVBOs.clear();
+	m_streamedChunkIBOs.clear();
+	m_isModelStreamed = false;
+}
+
+void Game::StartHotReloader(std::string const& modelFile, ModelFileFormat modelFormat)
+{
+	delete m_hotReloader;
+
+	std::vector<std::string> textureFiles;
+	for (int materialIndex = 0; materialIndex < static_cast<int>(m_modelMaterials.size()); ++materialIndex)
+	{
+		textureFiles.push_back(m_modelMaterials[materialIndex].m_diffuseMapFile);
+		textureFiles.push_back(m_modelMaterials[materialIndex].m_normalMapFile);
+	}
+	m_hotReloader = new ModelHotReloader(MODEL_METADATA_FILE, modelFile, modelFormat, m_modelMaterialLibraryFiles, textureFiles);
+	if (m_isModelTransformBaked)
+	{
+		m_hotReloader->SetBakeTransform(m_modelBakeTransform);
+	}
+	m_hotReloader->Start();
+}
+
+bool Game::Event_BenchmarkModelImport(EventArgs& args)
+{
+	std::string modelFile = args.GetValue("file", g_gameConfigBlackboard.GetValue("objFile", ""));
+	ModelFileFormat modelFormat = GetModelFileFormat(modelFile, args.GetValue("format", ""));
+	int numIterations = args.GetValue("iterations", 5);
+
+	double totalSeconds = 0.0;
+	ModelData model;
+	for (int iteration = 0; iteration < numIterations; ++iteration)
+	{
+		double startTime = GetCurrentTimeSeconds();
+		if (!LoadModelFile(model, modelFile, modelFormat))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("BenchmarkModelImport: failed to load \"%s\"", modelFile.c_str()));
+			return false;
+		}
+		totalSeconds += GetCurrentTimeSeconds() - startTime;
+	}
+
+	double averageSeconds = totalSeconds / static_cast<double>(numIterations > 0 ? numIterations : 1);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("BenchmarkModelImport \"%s\": %d tris, %.2f ms avg over %d runs, %.1f MB/s",
+		modelFile.c_str(), model.GetNumTriangles(), averageSeconds * 1000.0, numIterations, GetImportThroughputMBPerSecond(modelFile, averageSeconds)));
+	return true;
+}
+
+bool Game::Event_BenchmarkTransformBake(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr || game->m_modelMeshVerts.empty())
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "BenchmarkTransformBake: no model loaded");
+		return false;
+	}
+
+	int numIterations = args.GetValue("iterations", 10);
+	Mat44 transform = game->m_isModelTransformBaked ? game->m_modelBakeTransform : game->m_modelToWorldTransform;
+	std::vector<Vertex_PCUTBN> const& sourceVerts = game->m_modelMeshVerts;
+	std::vector<Vertex_PCUTBN> verts = sourceVerts;
+
+	// Baking is in place, so each timed pass starts from a fresh copy of the model; otherwise the transform compounds
+	double simdSeconds = 0.0;
+	double scalarSeconds = 0.0;
+	for (int iteration = 0; iteration < numIterations; ++iteration)
+	{
+		verts.assign(sourceVerts.begin(), sourceVerts.end());
+		double startTime = GetCurrentTimeSeconds();
+		BakeModelTransform(verts, transform);
+		simdSeconds += GetCurrentTimeSeconds() - startTime;
+
+		verts.assign(sourceVerts.begin(), sourceVerts.end());
+		startTime = GetCurrentTimeSeconds();
+		BakeModelTransformScalar(verts, transform);
+		scalarSeconds += GetCurrentTimeSeconds() - startTime;
+	}
+
+	double numVertsProcessed = static_cast<double>(verts.size()) * static_cast<double>(numIterations);
+	double megabytesProcessed = numVertsProcessed * sizeof(Vertex_PCUTBN) / (1024.0 * 1024.0);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("BenchmarkTransformBake: %d verts x %d runs", static_cast<int>(verts.size()), numIterations));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  SIMD   %.1f Mverts/s (%.0f MB/s)", numVertsProcessed / simdSeconds / 1.0e6, megabytesProcessed / simdSeconds));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  scalar %.1f Mverts/s (%.0f MB/s)", numVertsProcessed / scalarSeconds / 1.0e6, megabytesProcessed / scalarSeconds));
+	return true;
+}
+
+bool Game::Event_SpawnLights(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	int numLights = args.GetValue("count", 100);
+	float spotFraction = args.GetValue("spotFraction", 0.25f);
+	int seed = args.GetValue("seed", static_cast<int>(game->m_localLights.size()) + 1);
+	int numFreeLights = MAX_LOCAL_LIGHTS - static_cast<int>(game->m_localLights.size());
+	if (numLights > numFreeLights)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("SpawnLights: only %d of %d lights fit (max %d)", numFreeLights, numLights, MAX_LOCAL_LIGHTS));
+		numLights = numFreeLights;
+	}
+
+	AddRandomLocalLights(game->m_localLights, numLights, spotFraction, static_cast<unsigned int>(seed), game->GetModelWorldBounds());
+	game->m_areLightClustersDirty = true;
+	game->m_isRedrawRequested = true;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("SpawnLights: %d local lights", static_cast<int>(game->m_localLights.size())));
+	return true;
+}
+
+bool Game::Event_ClearLights(EventArgs& args)
+{
+	UNUSED(args);
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	game->m_localLights.clear();
+	game->m_areLightClustersDirty = true;
+	game->m_isRedrawRequested = true;
+	return true;
+}
+
+bool Game::Event_BenchmarkLightBinning(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr || game->m_player == nullptr)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "BenchmarkLightBinning: no view to bin against");
+		return false;
+	}
+
+	int numLights = std::max(0, std::min(args.GetValue("lights", 1000), MAX_LOCAL_LIGHTS));
+	int numIterations = args.GetValue("iterations", 100);
+	float spotFraction = args.GetValue("spotFraction", 0.25f);
+
+	std::vector<LocalLight> lights;
+	AddRandomLocalLights(lights, numLights, spotFraction, 1u, game->GetModelWorldBounds());
+
+	ClusteredLighting clusteredLighting;
+	ViewFrustum frustum = game->m_player->GetViewFrustum();
+	double totalSeconds = 0.0;
+	double minSeconds = 0.0;
+	for (int iteration = 0; iteration < numIterations; ++iteration)
+	{
+		clusteredLighting.BuildClusters(frustum, lights);
+		double buildSeconds = clusteredLighting.GetBuildSeconds();
+		totalSeconds += buildSeconds;
+		minSeconds = (iteration == 0) ? buildSeconds : std::min(minSeconds, buildSeconds);
+	}
+
+	int numOccupiedClusters = 0;
+	int maxClusterLights = 0;
+	for (int clusterIndex = 0; clusterIndex < NUM_LIGHT_CLUSTERS; ++clusterIndex)
+	{
+		int clusterLightCount = clusteredLighting.GetClusterLightCount(clusterIndex);
+		numOccupiedClusters += (clusterLightCount > 0) ? 1 : 0;
+		maxClusterLights = std::max(maxClusterLights, clusterLightCount);
+	}
+
+	double averageSeconds = totalSeconds / static_cast<double>(numIterations > 0 ? numIterations : 1);
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("BenchmarkLightBinning: %d lights into %dx%dx%d clusters, %.3f ms avg, %.3f ms min over %d runs (%d threads)",
+		numLights, LIGHT_CLUSTERS_X, LIGHT_CLUSTERS_Y, LIGHT_CLUSTERS_Z, averageSeconds * 1000.0, minSeconds * 1000.0, numIterations, GetParallelForNumThreads()));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %d light indices, %d/%d clusters lit, max %d lights per cluster, %d indices dropped",
+		clusteredLighting.GetNumLightIndices(), numOccupiedClusters, NUM_LIGHT_CLUSTERS, maxClusterLights, clusteredLighting.GetNumDroppedIndices()));
+	return true;
+}
+
+bool Game::Event_CaptureTurntable(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr || game->m_player == nullptr)
+	{
+		return false;
+	}
+
+	TurntableSettings settings;
+	settings.m_numFrames = args.GetValue("frames", settings.m_numFrames);
+	settings.m_width = args.GetValue("width", settings.m_width);
+	settings.m_height = args.GetValue("height", settings.m_height);
+	settings.m_ringSize = args.GetValue("ring", settings.m_ringSize);
+	settings.m_numEncoderThreads = args.GetValue("encoders", settings.m_numEncoderThreads);
+	settings.m_elevationDegrees = args.GetValue("elevation", settings.m_elevationDegrees);
+	settings.m_outputDirectory = args.GetValue("dir", settings.m_outputDirectory);
+
+	std::string errorMessage;
+	if (!game->m_turntableCapture.Start(settings, game->GetModelWorldBounds(), errorMessage))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("CaptureTurntable: %s", errorMessage.c_str()));
+		return false;
+	}
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("CaptureTurntable: %d frames at %dx%d into \"%s\" (software renderer: untextured, per-vertex lighting)",
+		settings.m_numFrames, settings.m_width, settings.m_height, settings.m_outputDirectory.c_str()));
+	return true;
+}
+
+bool Game::Event_CaptureScreenshot(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr || game->m_player == nullptr)
+	{
+		return false;
+	}
+
+	std::string filePath = args.GetValue("file", "Captures/Screenshot.png");
+	CaptureFrame frame;
+	frame.m_width = args.GetValue("width", 1600);
+	frame.m_height = args.GetValue("height", static_cast<int>(static_cast<float>(frame.m_width) / CAMERA_ASPECT));
+	if (frame.m_width <= 0 || frame.m_height <= 0 || frame.m_width > MAX_CAPTURE_SIZE || frame.m_height > MAX_CAPTURE_SIZE)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("CaptureScreenshot: invalid size %dx%d (each side must be 1 to %d)", frame.m_width, frame.m_height, MAX_CAPTURE_SIZE));
+		return false;
+	}
+	frame.m_rgba.resize(static_cast<size_t>(frame.m_width) * frame.m_height * 4);
+
+	ViewFrustum view = game->m_player->GetViewFrustum();
+	view.m_aspect = static_cast<float>(frame.m_width) / static_cast<float>(frame.m_height);
+	game->RenderSoftwareFrame(view, frame);
+
+	std::error_code errorCode;
+	std::filesystem::path parentPath = std::filesystem::path(filePath).parent_path();
+	if (!parentPath.empty())
+	{
+		std::filesystem::create_directories(parentPath, errorCode);
+	}
+	std::string errorMessage;
+	if (!WritePNGFile(filePath, frame.m_rgba.data(), frame.m_width, frame.m_height, errorMessage))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("CaptureScreenshot: %s", errorMessage.c_str()));
+		return false;
+	}
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("CaptureScreenshot: wrote \"%s\" (software renderer: untextured, per-vertex lighting)", filePath.c_str()));
+	return true;
+}
+
+bool Game::Event_ImportChunkedMesh(EventArgs& args)
+{
+	std::string sourceFile = args.GetValue("file", g_gameConfigBlackboard.GetValue("objFile", ""));
+	ModelFileFormat sourceFormat = GetModelFileFormat(sourceFile, args.GetValue("format", ""));
+	std::string chunkedFile = args.GetValue("out", std::filesystem::path(sourceFile).replace_extension(".cmsh").string());
+	int trianglesPerChunk = args.GetValue("trianglesPerChunk", 65536);
+	if (sourceFormat == ModelFileFormat::UNKNOWN || sourceFormat == ModelFileFormat::CHUNKED)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("ImportChunkedMesh: \"%s\" is not an importable model format", sourceFile.c_str()));
+		return false;
+	}
+
+	ChunkedMeshImportStats stats;
+	std::string errorMessage;
+	if (!ImportChunkedMesh(sourceFile, sourceFormat, chunkedFile, trianglesPerChunk, stats, errorMessage))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("ImportChunkedMesh: %s", errorMessage.c_str()));
+		return false;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("ImportChunkedMesh \"%s\" -> \"%s\": %llu tris in %d chunks (max %d tris per chunk)",
+		sourceFile.c_str(), chunkedFile.c_str(), static_cast<unsigned long long>(stats.m_numTriangles), stats.m_numChunks, stats.m_maxChunkTriangles));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  %.1f MB written in %.2f s over %d source passes (%.1f MB/s of source)",
+		static_cast<double>(stats.m_fileBytes) / (1024.0 * 1024.0), stats.m_seconds, stats.m_numSourcePasses, GetImportThroughputMBPerSecond(sourceFile, stats.m_seconds)));
+	return true;
+}
+
+bool Game::Event_AnalyzeMesh(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	std::string modelFile = args.GetValue("file", "");
+	std::string jsonFile = args.GetValue("json", "");
+
+	// Without file= the loaded model is analyzed as it sits in memory, transform bake included
+	ModelData model;
+	std::vector<Vertex_PCUTBN> const* verts = &game->m_modelMeshVerts;
+	std::vector<unsigned int> const* indices = &game->m_modelMeshIndices;
+	std::string sourceName = g_gameConfigBlackboard.GetValue("objFile", "");
+	if (!modelFile.empty())
+	{
+		ModelFileFormat modelFormat = GetModelFileFormat(modelFile, args.GetValue("format", ""));
+		if (modelFormat == ModelFileFormat::UNKNOWN || modelFormat == ModelFileFormat::CHUNKED || !LoadModelFile(model, modelFile, modelFormat))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("AnalyzeMesh: failed to load \"%s\"", modelFile.c_str()));
+			return false;
+		}
+		verts = &model.m_verts;
+		indices = &model.m_indices;
+		sourceName = modelFile;
+	}
+	else if (game->m_isModelStreamed)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "AnalyzeMesh: the streamed model is not in memory; pass file=<source model> instead");
+		return false;
+	}
+
+	MeshAnalysis analysis;
+	AnalyzeMesh(analysis, *verts, *indices);
+
+	g_theDevConsole->AddLine(analysis.HasErrors() ? DevConsole::ERROR : DevConsole::INFO_MAJOR, Stringf("AnalyzeMesh \"%s\": %d verts (%d unique positions, %d unreferenced), %d tris in %.2f ms on %d threads%s",
+		sourceName.c_str(), analysis.m_numVerts, analysis.m_numUniquePositions, analysis.m_numUnreferencedVerts, analysis.m_numTriangles,
+		analysis.m_seconds * 1000.0, analysis.m_numThreads, analysis.HasErrors() ? " - HAS ERRORS" : ""));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  triangles: %d degenerate (%d repeated index, %d collapsed, %d zero area), %d duplicate, %d out of range",
+		analysis.GetNumDegenerateTriangles(), analysis.m_numRepeatedIndexTriangles, analysis.m_numCollapsedTriangles, analysis.m_numZeroAreaTriangles,
+		analysis.m_numDuplicateTriangles, analysis.m_numOutOfRangeTriangles));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  edges: %d total, %d boundary, %d non-manifold, %d inconsistently wound",
+		analysis.m_numEdges, analysis.m_numBoundaryEdges, analysis.m_numNonManifoldEdges, analysis.m_numInconsistentlyWoundEdges));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  bounds (%.3f, %.3f, %.3f) - (%.3f, %.3f, %.3f), UVs (%.3f, %.3f) - (%.3f, %.3f) with %d verts outside [0,1]",
+		analysis.m_bounds.m_mins.x, analysis.m_bounds.m_mins.y, analysis.m_bounds.m_mins.z, analysis.m_bounds.m_maxs.x, analysis.m_bounds.m_maxs.y, analysis.m_bounds.m_maxs.z,
+		analysis.m_uvMins.x, analysis.m_uvMins.y, analysis.m_uvMaxs.x, analysis.m_uvMaxs.y, analysis.m_numVertsOutsideUnitUVs));
+	for (int attributeIndex = 0; attributeIndex < static_cast<int>(MeshAttribute::COUNT); ++attributeIndex)
+	{
+		MeshAttributeIssues const& issues = analysis.m_attributeIssues[attributeIndex];
+		if (issues.m_numNaN > 0 || issues.m_numInfinite > 0 || issues.m_numDenormal > 0)
+		{
+			g_theDevConsole->AddLine((issues.m_numNaN > 0 || issues.m_numInfinite > 0) ? DevConsole::ERROR : DevConsole::INFO_MINOR, Stringf("  %s: %d NaN, %d infinite, %d denormal values",
+				GetMeshAttributeName(static_cast<MeshAttribute>(attributeIndex)), issues.m_numNaN, issues.m_numInfinite, issues.m_numDenormal));
+		}
+	}
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  reuse: %.2f indices per vertex, ACMR %.3f, ATVR %.3f; %d zero-length normals, %d zero-length tangents",
+		analysis.m_indicesPerVertex, analysis.m_averageCacheMissRatio, analysis.m_averageTransformToVertexRatio,
+		analysis.m_numZeroLengthNormals, analysis.m_numZeroLengthTangents));
+
+	if (!jsonFile.empty())
+	{
+		if (!WriteMeshAnalysisJSON(analysis, sourceName, jsonFile))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("AnalyzeMesh: could not write \"%s\"", jsonFile.c_str()));
+			return false;
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  wrote \"%s\"", jsonFile.c_str()));
+	}
+	return true;
+}
+
+bool Game::Event_SectionPlane(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	SectionAxis axis = GetSectionAxisFromName(args.GetValue("axis", "off"));
+	if (axis == SectionAxis::COUNT)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "SectionPlane: axis must be x, y, z, or off");
+		return false;
+	}
+
+	float offset = args.GetValue("offset", GetSectionAxisCenter(axis, game->GetModelWorldBounds()));
+	game->SetSectionPlane(axis, offset);
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("SectionPlane: %s at %.4f", GetSectionAxisName(axis), offset));
+	return true;
+}
+
+bool Game::Event_BenchmarkTriangleQueries(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	if (game->m_isModelStreamed || game->m_modelMeshIndices.empty())
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "BenchmarkTriangleQueries: needs a model loaded in memory");
+		return false;
+	}
+	int numRays = std::max(1, args.GetValue("rays", 10000));
+	int numPlanes = std::max(1, args.GetValue("planes", 32));
+
+	// Rebuild so the build is timed too; queries run in model space, which is where the BVH lives
+	game->m_modelBVH.Clear();
+	game->EnsureModelBVH();
+	TriangleBVH const& bvh = game->m_modelBVH;
+	std::vector<Vertex_PCUTBN> const& verts = game->m_modelMeshVerts;
+	std::vector<unsigned int> const& indices = game->m_modelMeshIndices;
+	AABB3 bounds = bvh.GetBounds();
+	Vec3 extent = bounds.m_maxs - bounds.m_mins;
+	Vec3 center = (bounds.m_mins + bounds.m_maxs) * 0.5f;
+	float radius = std::max(extent.GetLength() * 0.5f, 0.001f);
+
+	// Rays from a sphere around the model toward random points inside its bounds; the fixed seed keeps runs comparable
+	std::mt19937 rng(1u);
+	std::uniform_real_distribution<float> signedUnit(-1.f, 1.f);
+	std::uniform_real_distribution<float> unit(0.f, 1.f);
+	int numHits = 0;
+	double totalRayNodes = 0.0;
+	double totalRayTriangles = 0.0;
+	double totalRaySeconds = 0.0;
+	double maxRaySeconds = 0.0;
+	for (int rayIndex = 0; rayIndex < numRays; ++rayIndex)
+	{
+		Vec3 awayDirection;
+		do
+		{
+			awayDirection = Vec3(signedUnit(rng), signedUnit(rng), signedUnit(rng));
+		} while (awayDirection.GetLengthSquared() > 1.f || awayDirection.GetLengthSquared() < 0.0001f);
+		Vec3 start = center + awayDirection.GetNormalized() * (radius * 1.5f);
+		Vec3 target(bounds.m_mins.x + extent.x * unit(rng), bounds.m_mins.y + extent.y * unit(rng), bounds.m_mins.z + extent.z * unit(rng));
+
+		TriangleRaycastResult result;
+		TriangleQueryStats stats;
+		if (bvh.Raycast(verts, indices, start, (target - start).GetNormalized(), radius * 3.f, result, &stats))
+		{
+			++numHits;
+		}
+		totalRayNodes += stats.m_numNodesVisited;
+		totalRayTriangles += stats.m_numTrianglesTested;
+		totalRaySeconds += stats.m_seconds;
+		maxRaySeconds = std::max(maxRaySeconds, stats.m_seconds);
+	}
+
+	// Evenly spaced cuts through the model along each axis, as the section tool makes them
+	std::vector<Vec3> segmentPoints;
+	double totalCutTriangles = 0.0;
+	double totalPlaneNodes = 0.0;
+	double totalPlaneSeconds = 0.0;
+	double maxPlaneSeconds = 0.0;
+	for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		Vec3 planeNormal(axisIndex == 0 ? 1.f : 0.f, axisIndex == 1 ? 1.f : 0.f, axisIndex == 2 ? 1.f : 0.f);
+		for (int planeIndex = 0; planeIndex < numPlanes; ++planeIndex)
+		{
+			float fraction = (static_cast<float>(planeIndex) + 0.5f) / static_cast<float>(numPlanes);
+			segmentPoints.clear();
+			TriangleQueryStats stats;
+			bvh.IntersectPlane(verts, indices, planeNormal, DotProduct3D(planeNormal, bounds.m_mins + extent * fraction), segmentPoints, &stats);
+			totalCutTriangles += static_cast<double>(segmentPoints.size() / 2);
+			totalPlaneNodes += stats.m_numNodesVisited;
+			totalPlaneSeconds += stats.m_seconds;
+			maxPlaneSeconds = std::max(maxPlaneSeconds, stats.m_seconds);
+		}
+	}
+
+	int numCuts = numPlanes * 3;
+	TriangleBVHStats const& bvhStats = bvh.GetStats();
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("BenchmarkTriangleQueries: %d tris, BVH of %d nodes built in %.2f ms on %d threads",
+		bvhStats.m_numTriangles, bvhStats.m_numNodes, bvhStats.m_buildSeconds * 1000.0, GetParallelForNumThreads()));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  raycast: %d rays, %d hits, %.2f us avg, %.2f us max, %.1f nodes and %.1f triangles tested per ray",
+		numRays, numHits, totalRaySeconds * 1000000.0 / numRays, maxRaySeconds * 1000000.0, totalRayNodes / numRays, totalRayTriangles / numRays));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  section: %d planes, %.3f ms avg, %.3f ms max, %.0f cut triangles and %.0f nodes per plane",
+		numCuts, totalPlaneSeconds * 1000.0 / numCuts, maxPlaneSeconds * 1000.0, totalCutTriangles / numCuts, totalPlaneNodes / numCuts));
+	return true;
+}
+
+bool Game::Event_LoadModel(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	std::string modelFile = args.GetValue("file", "");
+	ModelFileFormat modelFormat = GetModelFileFormat(modelFile, args.GetValue("format", ""));
+	if (modelFormat == ModelFileFormat::UNKNOWN || modelFormat == ModelFileFormat::CHUNKED)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("LoadModel: \"%s\" is not a loadable model format (chunked meshes stream from the XML)", modelFile.c_str()));
+		return false;
+	}
+	if (!game->LoadModel(modelFile, modelFormat))
+	{
+		return false;
+	}
+	game->StartHotReloader(modelFile, modelFormat);
+	return true;
+}
+
+bool Game::Event_SetDebugMode(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	int debugMode = args.GetValue("mode", -1);
+	if (debugMode < 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("SetDebugMode mode=%d (%s)", game->m_debugInt, GetDebugRenderModeDesc(game->m_debugInt)));
+		return true;
+	}
+	if (debugMode >= NUM_DEBUG_RENDER_MODES)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("SetDebugMode: mode must be 0 to %d", NUM_DEBUG_RENDER_MODES - 1));
+		return false;
+	}
+	game->m_debugInt = debugMode;
+	return true;
+}
+
+bool Game::Event_SetCameraPose(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr || game->m_player == nullptr)
+	{
+		return false;
+	}
+
+	Vec3 position = game->m_player->GetRenderPosition();
+	EulerAngles orientation = game->m_player->GetRenderOrientation();
+	std::string positionText = args.GetValue("position", "");
+	std::string yawText = args.GetValue("yaw", "");
+	std::string pitchText = args.GetValue("pitch", "");
+	std::string rollText = args.GetValue("roll", "");
+
+	// Without arguments, print the current pose as a line that can be pasted into a script
+	if (positionText.empty() && yawText.empty() && pitchText.empty() && rollText.empty())
+	{
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("SetCameraPose position=%.4f,%.4f,%.4f yaw=%.3f pitch=%.3f roll=%.3f",
+			position.x, position.y, position.z, orientation.m_yawDegrees, orientation.m_pitchDegrees, orientation.m_rollDegrees));
+		return true;
+	}
+	if (!positionText.empty() && !ParseCommandVec3(positionText, position))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("SetCameraPose: position=\"%s\" is not x,y,z", positionText.c_str()));
+		return false;
+	}
+	orientation.m_yawDegrees = args.GetValue("yaw", orientation.m_yawDegrees);
+	orientation.m_pitchDegrees = args.GetValue("pitch", orientation.m_pitchDegrees);
+	orientation.m_rollDegrees = args.GetValue("roll", orientation.m_rollDegrees);
+	game->m_player->SetPose(position, orientation);
+	return true;
+}
+
+bool Game::Event_RunScript(EventArgs& args)
+{
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	if (game->m_commandScript.IsRunning())
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("RunScript: \"%s\" is still running; StopScript first", game->m_commandScript.GetSourceName().c_str()));
+		return false;
+	}
+
+	std::string scriptFile = args.GetValue("file", "");
+	int numPasses = args.GetValue("repeat", 1);
+	int commandsPerFrame = args.GetValue("batch", 1000);
+	if (scriptFile.empty())
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "RunScript: file=<path> is required (file=- reads stdin)");
+		return false;
+	}
+	if (scriptFile == "-")
+	{
+		game->m_commandScript.StartStdin(commandsPerFrame);
+	}
+	else
+	{
+		std::string errorMessage;
+		if (!game->m_commandScript.StartFile(scriptFile, numPasses, commandsPerFrame, errorMessage))
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("RunScript: %s", errorMessage.c_str()));
+			return false;
+		}
+	}
+	game->m_isQuitAfterScript = args.GetValue("quit", false);
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("RunScript: \"%s\", %d commands x %d passes, up to %d per frame",
+		game->m_commandScript.GetSourceName().c_str(), game->m_commandScript.GetNumCommands(), game->m_commandScript.GetNumPasses(), commandsPerFrame));
+	return true;
+}
+
+bool Game::Event_StopScript(EventArgs& args)
+{
+	UNUSED(args);
+	Game* game = g_theApp->GetGame();
+	if (game == nullptr)
+	{
+		return false;
+	}
+
+	if (!game->m_commandScript.IsRunning())
+	{
+		return true;
+	}
+	game->m_commandScript.Stop();
+	game->m_isQuitAfterScript = false;
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("StopScript: stopped \"%s\" after %d commands", game->m_commandScript.GetSourceName().c_str(), game->m_commandScript.GetStats().m_numCommandsRun));
+	return true;
+}
+
+void Game::LoadModelMaterialTextures()
+{
+	for (int materialIndex = 0; materialIndex < static_cast<int>(m_modelMaterials.size()); ++materialIndex)
+	{
+		ModelMaterial& material = m_modelMaterials[materialIndex];
+		if (material.m_diffuseMapFile.empty())
+		{
+			material.m_diffuseMapFile = m_fallbackDiffuseMap;
+		}
+		if (material.m_normalMapFile.empty())
+		{
+			material.m_normalMapFile = m_fallbackNormalMap;
+		}
+
+		material.m_diffuseTexture = CreateOrGetModelTexture(material.m_diffuseMapFile);
+		material.m_normalTexture = CreateOrGetModelTexture(material.m_normalMapFile);
+	}
+}
+
+void Game::ReloadModelTextures(std::vector<std::string> const& textureFiles)
+{
+	for (int fileIndex = 0; fileIndex < static_cast<int>(textureFiles.size()); ++fileIndex)
+	{
+		std::string const& textureFile = textureFiles[fileIndex];
+		Texture* texture = ReloadModelTexture(textureFile);
+		for (int materialIndex = 0; materialIndex < static_cast<int>(m_modelMaterials.size()); ++materialIndex)
+		{
+			ModelMaterial& material = m_modelMaterials[materialIndex];
+			if (material.m_diffuseMapFile == textureFile)
+			{
+				material.m_diffuseTexture = texture;
+			}
+			if (material.m_normalMapFile == textureFile)
+			{
+				material.m_normalTexture = texture;
+			}
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Hot reload: texture \"%s\" reloaded", textureFile.c_str()));
+	}
+	m_isRedrawRequested = true;
+}
+
+void Game::CreateBuffers()
+{
+	// Create buffers and copy to GPU
+	m_modelVBO = g_theRenderer->CreateVertexBuffer(static_cast<unsigned int>(m_modelMeshVerts.size()) * sizeof(Vertex_PCUTBN), sizeof(Vertex_PCUTBN));
+	m_modelIBO = g_theRenderer->CreateIndexBuffer(static_cast<unsigned int>(m_modelMeshIndices.size()) * sizeof(unsigned int), sizeof(unsigned int));
+	g_theRenderer->CopyCPUToGPU(m_modelMeshVerts.data(), m_modelVBO->GetSize(), m_modelVBO);
+	g_theRenderer->CopyCPUToGPU(m_modelMeshIndices.data(), m_modelIBO->GetSize(), m_modelIBO);
+	GetMemoryTracker().Track(m_modelVBO, MemoryCategory::MESH, MemoryResourceType::VERTEX_BUFFER, m_modelVBO->GetSize(), m_modelFile);
+	GetMemoryTracker().Track(m_modelIBO, MemoryCategory::MESH, MemoryResourceType::INDEX_BUFFER, m_modelIBO->GetSize(), m_modelFile);
+
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Add(s_uploadBytesStat, static_cast<double>(m_modelVBO->GetSize()) + static_cast<double>(m_modelIBO->GetSize()));
+	perfStats.Set(s_modelVertsStat, static_cast<double>(m_modelMeshVerts.size()));
+	perfStats.Set(s_modelTrianglesStat, static_cast<double>(m_modelMeshIndices.size() / 3));
+}
+
+void Game::DeleteModelBuffers()
+{
+	DeleteTrackedResource(m_modelVBO);
+	DeleteTrackedResource(m_modelIBO);
+	DeleteSectionBuffers();
+}
+
+void Game::ClipModelToSectionPlane(Vec3 const& modelNormal, float modelDistance)
+{
+	double clipStartTime = GetCurrentTimeSeconds();
+
+	// Blocks of triangles clip in parallel into their own lists, appended in order so each material keeps one range
+	constexpr int TRIANGLES_PER_CLIP_BLOCK = 16384;
+	std::vector<std::vector<unsigned int>> blockKeptIndices;
+	std::vector<std::vector<Vertex_PCUTBN>> blockSplitVerts;
+	for (int submeshIndex = 0; submeshIndex < static_cast<int>(m_modelSubmeshes.size()); ++submeshIndex)
+	{
+		ModelSubmesh const& submesh = m_modelSubmeshes[submeshIndex];
+		int numTriangles = static_cast<int>(submesh.m_indexCount / 3);
+		int numBlocks = (numTriangles + TRIANGLES_PER_CLIP_BLOCK - 1) / TRIANGLES_PER_CLIP_BLOCK;
+		blockKeptIndices.resize(numBlocks);
+		blockSplitVerts.resize(numBlocks);
+		ParallelFor(numBlocks, 1, [&](int beginBlock, int endBlock)
+		{
+			for (int blockIndex = beginBlock; blockIndex < endBlock; ++blockIndex)
+			{
+				int firstTriangle = blockIndex * TRIANGLES_PER_CLIP_BLOCK;
+				int numBlockTriangles = std::min(TRIANGLES_PER_CLIP_BLOCK, numTriangles - firstTriangle);
+				blockKeptIndices[blockIndex].clear();
+				blockSplitVerts[blockIndex].clear();
+				ClipTrianglesToSectionPlane(m_modelMeshVerts, m_modelMeshIndices, submesh.m_startIndex + static_cast<unsigned int>(firstTriangle) * 3,
+					static_cast<unsigned int>(numBlockTriangles) * 3, modelNormal, modelDistance, blockKeptIndices[blockIndex], blockSplitVerts[blockIndex]);
+			}
+		});
+
+		SectionClipRange range;
+		range.m_materialIndex = submesh.m_materialIndex;
+		range.m_startIndex = static_cast<unsigned int>(m_sectionKeptIndices.size());
+		range.m_startVertex = static_cast<unsigned int>(m_sectionSplitVerts.size());
+		for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+		{
+			m_sectionKeptIndices.insert(m_sectionKeptIndices.end(), blockKeptIndices[blockIndex].begin(), blockKeptIndices[blockIndex].end());
+			m_sectionSplitVerts.insert(m_sectionSplitVerts.end(), blockSplitVerts[blockIndex].begin(), blockSplitVerts[blockIndex].end());
+		}
+		range.m_indexCount = static_cast<unsigned int>(m_sectionKeptIndices.size()) - range.m_startIndex;
+		range.m_vertexCount = static_cast<unsigned int>(m_sectionSplitVerts.size()) - range.m_startVertex;
+		if (range.m_indexCount > 0 || range.m_vertexCount > 0)
+		{
+			m_sectionClipRanges.push_back(range);
+		}
+	}
+
+	// Kept triangles reuse the model's vertex buffer; only their indices and the split pieces are uploaded
+	PerfStats& perfStats = GetPerfStats();
+	if (!m_sectionKeptIndices.empty())
+	{
+		m_sectionIBO = g_theRenderer->CreateIndexBuffer(static_cast<unsigned int>(m_sectionKeptIndices.size()) * sizeof(unsigned int), sizeof(unsigned int));
+		g_theRenderer->CopyCPUToGPU(m_sectionKeptIndices.data(), m_sectionIBO->GetSize(), m_sectionIBO);
+		GetMemoryTracker().Track(m_sectionIBO, MemoryCategory::DEBUG, MemoryResourceType::INDEX_BUFFER, m_sectionIBO->GetSize(), m_modelFile);
+		perfStats.Add(s_uploadBytesStat, static_cast<double>(m_sectionIBO->GetSize()));
+	}
+	if (!m_sectionSplitVerts.empty())
+	{
+		m_sectionSplitVBO = g_theRenderer->CreateVertexBuffer(static_cast<unsigned int>(m_sectionSplitVerts.size()) * sizeof(Vertex_PCUTBN), sizeof(Vertex_PCUTBN));
+		g_theRenderer->CopyCPUToGPU(m_sectionSplitVerts.data(), m_sectionSplitVBO->GetSize(), m_sectionSplitVBO);
+		GetMemoryTracker().Track(m_sectionSplitVBO, MemoryCategory::DEBUG, MemoryResourceType::VERTEX_BUFFER, m_sectionSplitVBO->GetSize(), m_modelFile);
+		perfStats.Add(s_uploadBytesStat, static_cast<double>(m_sectionSplitVBO->GetSize()));
+	}
+	m_sectionClipSeconds = GetCurrentTimeSeconds() - clipStartTime;
+}
+
+void Game::DeleteSectionBuffers()
+{
+	DeleteTrackedResource(m_sectionIBO);
+	DeleteTrackedResource(m_sectionSplitVBO);
+}
+
+void Game::BuildOcclusionClusters()
+{
+	BuildModelClusters(m_modelClusters, m_modelMeshVerts, m_modelMeshIndices, m_modelSubmeshes, m_trianglesPerCluster);
+	SoftwareOcclusionCuller::SelectOccluders(m_occluderClusters, m_modelClusters, m_occluderTriangleBudget);
+	m_clusterOcclusionResults.clear();
+	m_areShadowCascadesDirty = true;
+}
+
+AABB3 Game::GetModelWorldBounds() const
+{
+	AABB3 modelBounds;
+	if (m_isModelStreamed)
+	{
+		modelBounds = m_streamedModel.GetBounds();
+	}
+	else if (m_modelClusters.empty())
+	{
+		return AABB3(-1.f, -1.f, 0.f, 1.f, 1.f, 2.f);
+	}
+	else
+	{
+		modelBounds = m_modelClusters[0].m_bounds;
+	}
+	for (int clusterIndex = 1; clusterIndex < static_cast<int>(m_modelClusters.size()); ++clusterIndex)
+	{
+		AABB3 const& clusterBounds = m_modelClusters[clusterIndex].m_bounds;
+		modelBounds.m_mins = Vec3(std::min(modelBounds.m_mins.x, clusterBounds.m_mins.x), std::min(modelBounds.m_mins.y, clusterBounds.m_mins.y), std::min(modelBounds.m_mins.z, clusterBounds.m_mins.z));
+		modelBounds.m_maxs = Vec3(std::max(modelBounds.m_maxs.x, clusterBounds.m_maxs.x), std::max(modelBounds.m_maxs.y, clusterBounds.m_maxs.y), std::max(modelBounds.m_maxs.z, clusterBounds.m_maxs.z));
+	}
+
+	// Transform all eight corners; the model matrix can swap and mirror axes
+	AABB3 worldBounds;
+	for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		Vec3 corner((cornerIndex & 1) ? modelBounds.m_maxs.x : modelBounds.m_mins.x,
+			(cornerIndex & 2) ? modelBounds.m_maxs.y : modelBounds.m_mins.y,
+			(cornerIndex & 4) ? modelBounds.m_maxs.z : modelBounds.m_mins.z);
+		Vec3 worldCorner = m_modelToWorldTransform.TransformPosition3D(corner);
+		if (cornerIndex == 0)
+		{
+			worldBounds.m_mins = worldCorner;
+			worldBounds.m_maxs = worldCorner;
+			continue;
+		}
+		worldBounds.m_mins = Vec3(std::min(worldBounds.m_mins.x, worldCorner.x), std::min(worldBounds.m_mins.y, worldCorner.y), std::min(worldBounds.m_mins.z, worldCorner.z));
+		worldBounds.m_maxs = Vec3(std::max(worldBounds.m_maxs.x, worldCorner.x), std::max(worldBounds.m_maxs.y, worldCorner.y), std::max(worldBounds.m_maxs.z, worldCorner.z));
+	}
+	return worldBounds;
+}
+
+void Game::LoadXMLMetaData(char const* filePath, NamedStrings& out_metaData)
+{
+	XmlDocument metaDataXML;
+	XmlError result = metaDataXML.LoadFile(filePath);
+	if (result == tinyxml2::XML_SUCCESS)
+	{
+		XmlElement* rootElement = metaDataXML.RootElement();
+		if (rootElement)
+		{
+			out_metaData.PopulateFromXmlElementAttributes(*rootElement);
+		}
+		else
+		{
+			DebuggerPrintf("WARNING: MetaData file \"%s\" was invalid (missing root element)\n", filePath);
+		}
+	}
+	else
+	{
+		DebuggerPrintf("WARNING: Failed to load MetaData from file \"%s\"\n", filePath);
+	}
+}
+
+Mat44 Game::ApplyOrientation(std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ)
+{
+	Mat44 orientationMatrix;
+	std::string errorMessage;
+	if (MakeModelOrientation(orientationMatrix, orientationX, orientationY, orientationZ, errorMessage))
+	{
+		return orientationMatrix;
+	}
+
+	// Reject the whole set rather than leaving an axis zeroed; fall back to the default x=left, y=up, z=forward
+	g_theDevConsole->AddLine(DevConsole::ERROR, errorMessage);
+	ERROR_RECOVERABLE(errorMessage);
+	MakeModelOrientation(orientationMatrix, "left", "up", "forward", errorMessage);
+	return orientationMatrix;
+}
+
+void Game::Update()
+{
+	// Setting clock time variables
+	double deltaSeconds = m_gameClock.GetDeltaSeconds();
+
+	// Scripted commands run first so the rest of the frame sees what they changed
+	UpdateCommandScript();
+
+	// Set debug text
+	std::string debugText = Stringf("Debug Mode [%d]: %s", m_debugInt, GetDebugRenderModeDesc(m_debugInt));
+	DebugAddScreenText(debugText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.97f), 0.f);
+	g_theRenderer->SetPerFrameConstants(m_debugInt, 0.f);
+
+	UpdatePlayer(static_cast<float>(deltaSeconds));
+	UpdateTurntableCapture();
+	UpdateHotReload();
+	UpdateStreamedModel();
+	UpdateOcclusionCulling();
+	UpdateLightClusters();
+	UpdateShadowCascades();
+	UpdateMeasurement();
+	UpdateSectionPlane(static_cast<float>(deltaSeconds));
+	UpdateMemoryTracking();
+
+	AdjustForPauseAndTimeDistortion(static_cast<float>(deltaSeconds));
+	KeyInputPresses();
+
+	UpdateCameras();
+}
+
+void Game::UpdateCommandScript()
+{
+	// A turntable drives the camera itself; the script resumes once the capture finishes
+	if (!m_commandScript.IsRunning() || m_turntableCapture.IsCapturing())
+	{
+		return;
+	}
+
+	if (m_commandScript.Update())
+	{
+		std::string scriptText = Stringf("Script \"%s\": command %d/%d, pass %d/%d", m_commandScript.GetSourceName().c_str(),
+			m_commandScript.GetNextCommandIndex(), m_commandScript.GetNumCommands(), m_commandScript.GetStats().m_numPassesDone + 1, m_commandScript.GetNumPasses());
+		DebugAddScreenText(scriptText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.61f), 0.f);
+		return;
+	}
+
+	// Stopped scripts have already reported themselves
+	CommandScriptStats const& stats = m_commandScript.GetStats();
+	if (stats.m_numPassesDone < m_commandScript.GetNumPasses())
+	{
+		return;
+	}
+	g_theDevConsole->AddLine((stats.m_numCommandsFailed > 0) ? DevConsole::WARNING : DevConsole::INFO_MAJOR, Stringf("Script \"%s\" done: %d commands (%d failed) over %d frames in %.2f s",
+		m_commandScript.GetSourceName().c_str(), stats.m_numCommandsRun, stats.m_numCommandsFailed, stats.m_numFrames, stats.m_elapsedSeconds));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  dispatch %.2f ms total, %.0f commands/s", stats.m_dispatchSeconds * 1000.0, stats.GetCommandsPerSecond()));
+	if (m_isQuitAfterScript)
+	{
+		m_isQuitAfterScript = false;
+		FireEvent("Quit");
+	}
+}
+
+void Game::UpdateHotReload()
+{
+	if (m_hotReloader == nullptr)
+	{
+		return;
+	}
+
+	if (m_hotReloader->ConsumeRestartRequest())
+	{
+		// Streamed meshes are paged from disk and never held whole, so re-importing one goes through a full restart
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, "Hot reload: streamed mesh changed, restarting");
+		m_isRestartRequested = true;
+		return;
+	}
+
+	if (m_hotReloader->ConsumeMetaDataChange())
+	{
+		ApplyReloadedMetaData();
+		if (m_isRestartRequested)
+		{
+			return;
+		}
+	}
+
+	std::vector<std::string> changedTextureFiles;
+	if (m_hotReloader->ConsumeChangedTextures(changedTextureFiles))
+	{
+		ReloadModelTextures(changedTextureFiles);
+	}
+
+	ModelData reloadedModel;
+	if (m_hotReloader->ConsumeReloadedModel(reloadedModel))
+	{
+		ApplyReloadedModel(reloadedModel);
+	}
+}
+
+void Game::UpdateOcclusionCulling()
+{
+	if (!m_isOcclusionCullingEnabled || m_player == nullptr || m_modelClusters.empty())
+	{
+		m_clusterOcclusionResults.clear();
+		DebugAddScreenText("Occlusion culling: off (F3)", AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.94f), 0.f);
+		return;
+	}
+
+	// Results stay valid until the view or the model changes, so a static scene costs nothing
+	if (m_clusterOcclusionResults.size() != m_modelClusters.size() || IsRedrawNeeded())
+	{
+		m_occlusionCuller.BeginFrame(m_player->GetViewFrustum().GetModelToClip(m_modelToWorldTransform));
+		m_occlusionCuller.RasterizeOccluders(m_modelMeshVerts, m_modelMeshIndices, m_occluderClusters);
+		m_occlusionCuller.TestClusters(m_modelClusters, m_clusterOcclusionResults);
+	}
+
+	OcclusionStats const& stats = m_occlusionCuller.GetStats();
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Set(s_occludedClustersStat, stats.m_numOccluded);
+	perfStats.Set(s_frustumCulledClustersStat, stats.m_numOutsideFrustum);
+	perfStats.Sample(s_occlusionMillisecondsStat, (stats.m_rasterSeconds + stats.m_testSeconds) * 1000.0);
+
+	std::string occlusionText = Stringf("Occlusion culling (F3): %d/%d clusters occluded, %d outside frustum, %d occluder tris, raster %.2f ms, test %.2f ms",
+		stats.m_numOccluded, stats.m_numTested, stats.m_numOutsideFrustum, stats.m_numOccluderTriangles, stats.m_rasterSeconds * 1000.0, stats.m_testSeconds * 1000.0);
+	DebugAddScreenText(occlusionText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.94f), 0.f);
+}
+
+void Game::UpdateLightClusters()
+{
+	if (m_player == nullptr)
+	{
+		return;
+	}
+
+	// Clusters live in view space, so they are rebuilt when the view or the light set changes
+	PerfStats& perfStats = GetPerfStats();
+	if (m_areLightClustersDirty || IsRedrawNeeded())
+	{
+		m_clusteredLighting.BuildClusters(m_player->GetViewFrustum(), m_localLights);
+		perfStats.Sample(s_lightBinningMillisecondsStat, m_clusteredLighting.GetBuildSeconds() * 1000.0);
+		m_areLightClustersDirty = false;
+	}
+
+	perfStats.Set(s_localLightsStat, static_cast<double>(m_localLights.size()));
+	perfStats.Set(s_lightIndicesStat, static_cast<double>(m_clusteredLighting.GetNumLightIndices()));
+	if (!m_localLights.empty())
+	{
+		std::string lightText = Stringf("Local lights (binned, not shaded): %d, %d cluster light indices (%d dropped), binning %.2f ms",
+			static_cast<int>(m_localLights.size()), m_clusteredLighting.GetNumLightIndices(), m_clusteredLighting.GetNumDroppedIndices(), m_clusteredLighting.GetBuildSeconds() * 1000.0);
+		DebugAddScreenText(lightText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.79f), 0.f);
+	}
+}
+
+void Game::UpdateShadowCascades()
+{
+	if (!m_isCascadeFittingEnabled || m_player == nullptr)
+	{
+		return;
+	}
+
+	// Cascades follow the view; their caster lists also change when the model does
+	if (m_areShadowCascadesDirty || IsRedrawNeeded())
+	{
+		m_shadowCascades.Fit(m_player->GetViewFrustum(), m_sunDirection, GetModelWorldBounds());
+		m_shadowCascades.CullCasters(m_modelClusters, m_modelToWorldTransform);
+		m_areShadowCascadesDirty = false;
+	}
+
+	ShadowCascadeStats const& stats = m_shadowCascades.GetStats();
+	PerfStats& perfStats = GetPerfStats();
+	double cullSeconds = 0.0;
+	std::string shadowText = "Cascade fit (no shadow map):";
+	for (int cascadeIndex = 0; cascadeIndex < NUM_SHADOW_CASCADES; ++cascadeIndex)
+	{
+		ShadowCascade const& cascade = m_shadowCascades.GetCascade(cascadeIndex);
+		cullSeconds += stats.m_cullSeconds[cascadeIndex];
+		perfStats.Set(s_shadowCasterStats[cascadeIndex], stats.m_numCasters[cascadeIndex]);
+		shadowText += Stringf(" [%.1f-%.1f m: %d casters, %d tris]", cascade.m_splitNear, cascade.m_splitFar, stats.m_numCasters[cascadeIndex], stats.m_numCasterTriangles[cascadeIndex]);
+	}
+	perfStats.Sample(s_shadowCullMillisecondsStat, cullSeconds * 1000.0);
+	shadowText += Stringf(", fit %.3f ms, cull %.3f ms", stats.m_fitSeconds * 1000.0, cullSeconds * 1000.0);
+	DebugAddScreenText(shadowText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.76f), 0.f);
+}
+
+void Game::UpdateTurntableCapture()
+{
+	if (!m_turntableCapture.IsCapturing() || m_player == nullptr)
+	{
+		return;
+	}
+
+	// The live camera follows the orbit while the reference renderer fills the capture ring
+	Vec3 position;
+	EulerAngles orientation;
+	m_turntableCapture.GetNextPose(position, orientation);
+	m_player->SetPose(position, orientation);
+	bool hasMoreFrames = m_turntableCapture.CaptureNextFrame([this](ViewFrustum const& view, CaptureFrame& out_frame)
+	{
+		RenderSoftwareFrame(view, out_frame);
+	});
+
+	TurntableCaptureStats stats = m_turntableCapture.GetStats();
+	if (hasMoreFrames)
+	{
+		std::string captureText = Stringf("Capturing turntable: frame %d/%d, %d written", stats.m_numFramesSubmitted, stats.m_numFrames, stats.m_numFramesWritten);
+		DebugAddScreenText(captureText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.73f), 0.f);
+		return;
+	}
+
+	m_turntableCapture.Finish();
+	stats = m_turntableCapture.GetStats();
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("CaptureTurntable: %d/%d frames written in %.2f s, %.1f frames/s, %.1f MB",
+		stats.m_numFramesWritten, stats.m_numFrames, stats.m_elapsedSeconds, stats.GetFramesPerSecond(), static_cast<double>(stats.m_bytesWritten) / (1024.0 * 1024.0)));
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("  render %.2f ms/frame, encode %.2f ms/frame, stalled on the ring %.2f s",
+		stats.m_renderSeconds * 1000.0 / stats.m_numFrames, stats.m_encodeSeconds * 1000.0 / stats.m_numFrames, stats.m_stallSeconds));
+	if (stats.m_numWriteFailures > 0)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("CaptureTurntable: %d frames could not be written", stats.m_numWriteFailures));
+	}
+}
+
+void Game::UpdateStreamedModel()
+{
+	if (!m_isModelStreamed || m_player == nullptr)
+	{
+		return;
+	}
+
+	std::vector<int> pagedInChunks;
+	std::vector<int> evictedChunks;
+	m_streamedModel.Update(m_player->GetViewFrustum(), m_modelToWorldTransform, pagedInChunks, evictedChunks);
+
+	for (int evictedIndex = 0; evictedIndex < static_cast<int>(evictedChunks.size()); ++evictedIndex)
+	{
+		int chunkIndex = evictedChunks[evictedIndex];
+		DeleteTrackedResource(m_streamedChunkVBOs[chunkIndex]);
+		DeleteTrackedResource(m_streamedChunkIBOs[chunkIndex]);
+	}
+
+	// Each page lives on the GPU once uploaded, so its CPU copy is dropped straight away
+	PerfStats& perfStats = GetPerfStats();
+	for (int pagedInIndex = 0; pagedInIndex < static_cast<int>(pagedInChunks.size()); ++pagedInIndex)
+	{
+		int chunkIndex = pagedInChunks[pagedInIndex];
+		StreamedChunk const& chunk = m_streamedModel.GetChunk(chunkIndex);
+		VertexBuffer* chunkVBO = g_theRenderer->CreateVertexBuffer(static_cast<unsigned int>(chunk.m_verts.size()) * sizeof(Vertex_PCUTBN), sizeof(Vertex_PCUTBN));
+		IndexBuffer* chunkIBO = g_theRenderer->CreateIndexBuffer(static_cast<unsigned int>(chunk.m_indices.size()) * sizeof(unsigned int), sizeof(unsigned int));
+		g_theRenderer->CopyCPUToGPU(chunk.m_verts.data(), chunkVBO->GetSize(), chunkVBO);
+		g_theRenderer->CopyCPUToGPU(chunk.m_indices.data(), chunkIBO->GetSize(), chunkIBO);
+		m_streamedChunkVBOs[chunkIndex] = chunkVBO;
+		m_streamedChunkIBOs[chunkIndex] = chunkIBO;
+		GetMemoryTracker().Track(chunkVBO, MemoryCategory::MESH, MemoryResourceType::VERTEX_BUFFER, chunkVBO->GetSize(), m_modelFile);
+		GetMemoryTracker().Track(chunkIBO, MemoryCategory::MESH, MemoryResourceType::INDEX_BUFFER, chunkIBO->GetSize(), m_modelFile);
+		m_streamedModel.ReleaseChunkPageData(chunkIndex);
+		perfStats.Add(s_uploadBytesStat, static_cast<double>(chunkVBO->GetSize()) + static_cast<double>(chunkIBO->GetSize()));
+	}
+	if (!pagedInChunks.empty() || !evictedChunks.empty())
+	{
+		m_isRedrawRequested = true;
+	}
+
+	OutOfCoreStats const& stats = m_streamedModel.GetStats();
+	double residentMegabytes = static_cast<double>(stats.m_residentBytes) / (1024.0 * 1024.0);
+	perfStats.Set(s_streamedResidentMegabytesStat, residentMegabytes);
+	perfStats.Set(s_chunkHitRateStat, stats.GetHitRate());
+
+	std::string streamingText = Stringf("Streaming: %d/%d chunks resident (%.0f/%.0f MB), %d/%d visible drawn, %d pending, hit rate %.1f%%, page-in %.2f ms avg, %.2f ms max",
+		stats.m_numResidentChunks, stats.m_numChunks, residentMegabytes, static_cast<double>(stats.m_budgetBytes) / (1024.0 * 1024.0),
+		stats.m_numDrawableChunks, stats.m_numVisibleChunks, stats.m_numPendingChunks, stats.GetHitRate() * 100.0,
+		stats.GetAveragePageInSeconds() * 1000.0, stats.m_maxPageInSeconds * 1000.0);
+	DebugAddScreenText(streamingText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.70f), 0.f);
+}
+
+bool Game::EnsureModelBVH()
+{
+	if (m_isModelStreamed || m_modelMeshIndices.empty())
+	{
+		return false;
+	}
+	if (!m_modelBVH.IsBuilt())
+	{
+		m_modelBVH.Build(m_modelMeshVerts, m_modelMeshIndices);
+		TriangleBVHStats const& stats = m_modelBVH.GetStats();
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("Built triangle BVH: %d tris, %d nodes (%d leaves, depth %d) in %.2f ms",
+			stats.m_numTriangles, stats.m_numNodes, stats.m_numLeaves, stats.m_maxDepth, stats.m_buildSeconds * 1000.0));
+	}
+	return m_modelBVH.IsBuilt();
+}
+
+bool Game::RaycastModel(Vec3 const& worldStart, Vec3 const& worldDirection, float maxDistance, TriangleRaycastResult& out_worldHit)
+{
+	out_worldHit = TriangleRaycastResult();
+	if (!EnsureModelBVH())
+	{
+		return false;
+	}
+
+	// Undoing the model transform scales start and direction alike, so the hit distance is the same in both spaces
+	Vec3 modelStart = TransformWorldToModel(m_modelToWorldTransform, worldStart - m_modelToWorldTransform.GetTranslation3D());
+	Vec3 modelDirection = TransformWorldToModel(m_modelToWorldTransform, worldDirection);
+	TriangleRaycastResult modelHit;
+	if (!m_modelBVH.Raycast(m_modelMeshVerts, m_modelMeshIndices, modelStart, modelDirection, maxDistance, modelHit))
+	{
+		return false;
+	}
+
+	out_worldHit = modelHit;
+	out_worldHit.m_position = worldStart + worldDirection * modelHit.m_distance;
+	out_worldHit.m_normal = m_modelToWorldTransform.TransformVectorQuantity3D(modelHit.m_normal).GetNormalized();
+	return true;
+}
+
+void Game::UpdateMeasurement()
+{
+	if (m_player == nullptr || m_isAttractMode)
+	{
+		return;
+	}
+
+	// Nothing is cast until the first pick, so the BVH is only built once the tool is used
+	bool isPickPressed = g_theInput->WasKeyJustPressed('M');
+	if (m_measurePoints.empty() && !isPickPressed)
+	{
+		return;
+	}
+
+	EulerAngles const& eyeOrientation = m_player->GetRenderOrientation();
+	Vec3 eyeDirection = Vec3::MakeFromPolarDegrees(eyeOrientation.m_pitchDegrees, eyeOrientation.m_yawDegrees, 1.f);
+	TriangleRaycastResult crosshairHit;
+	bool isOnModel = RaycastModel(m_player->GetRenderPosition(), eyeDirection, CAMERA_FAR_Z, crosshairHit);
+
+	// M on the model picks the next end point, starting over after two; M off the model clears the measurement
+	if (isPickPressed)
+	{
+		if (!isOnModel || m_measurePoints.size() == 2)
+		{
+			m_measurePoints.clear();
+		}
+		if (isOnModel)
+		{
+			m_measurePoints.push_back(crosshairHit.m_position);
+		}
+		m_isRedrawRequested = true;
+	}
+	if (m_measurePoints.empty())
+	{
+		return;
+	}
+
+	AABB3 worldBounds = GetModelWorldBounds();
+	float markerRadius = 0.004f * (worldBounds.m_maxs - worldBounds.m_mins).GetLength();
+	Rgba8 const measureColor(255, 220, 0, 255);
+	for (int pointIndex = 0; pointIndex < static_cast<int>(m_measurePoints.size()); ++pointIndex)
+	{
+		DebugAddWorldPoint(m_measurePoints[pointIndex], markerRadius, 0.f, measureColor, measureColor, DebugRenderMode::ALWAYS);
+	}
+
+	std::string measureText;
+	if (m_measurePoints.size() == 2)
+	{
+		Vec3 delta = m_measurePoints[1] - m_measurePoints[0];
+		DebugAddWorldLine(m_measurePoints[0], m_measurePoints[1], markerRadius * 0.5f, 0.f, measureColor, measureColor, DebugRenderMode::ALWAYS);
+		measureText = Stringf("Measure: %.4f (dx %.4f, dy %.4f, dz %.4f) - M picks again, M off the model clears",
+			delta.GetLength(), fabsf(delta.x), fabsf(delta.y), fabsf(delta.z));
+	}
+	else if (isOnModel)
+	{
+		Rgba8 const previewColor(255, 220, 0, 120);
+		DebugAddWorldLine(m_measurePoints[0], crosshairHit.m_position, markerRadius * 0.25f, 0.f, previewColor, previewColor, DebugRenderMode::ALWAYS);
+		measureText = Stringf("Measure: %.4f to the crosshair - M picks the second point", (crosshairHit.m_position - m_measurePoints[0]).GetLength());
+	}
+	else
+	{
+		measureText = "Measure: crosshair is off the model - M on the model picks the second point";
+	}
+	DebugAddScreenText(measureText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.67f), 0.f);
+}
+
+void Game::SetSectionPlane(SectionAxis axis, float offset)
+{
+	m_sectionPlane.m_axis = axis;
+	m_sectionPlane.m_offset = offset;
+	m_isSectionDirty = true;
+}
+
+void Game::UpdateSectionPlane(float deltaSeconds)
+{
+	// X cycles off -> x -> y -> z, starting each axis through the middle of the model
+	if (g_theInput->WasKeyJustPressed('X'))
+	{
+		SectionAxis nextAxis = static_cast<SectionAxis>((static_cast<int>(m_sectionPlane.m_axis) + 1) % static_cast<int>(SectionAxis::COUNT));
+		SetSectionPlane(nextAxis, GetSectionAxisCenter(nextAxis, GetModelWorldBounds()));
+	}
+
+	// Up and Down sweep the plane across the model's full extent in four seconds
+	if (m_sectionPlane.IsEnabled())
+	{
+		float sweepDirection = (g_theInput->IsKeyDown(KEYCODE_UPARROW) ? 1.f : 0.f) - (g_theInput->IsKeyDown(KEYCODE_DOWNARROW) ? 1.f : 0.f);
+		if (sweepDirection != 0.f)
+		{
+			AABB3 worldBounds = GetModelWorldBounds();
+			Vec3 worldNormal = m_sectionPlane.GetWorldNormal();
+			float minOffset = DotProduct3D(worldNormal, worldBounds.m_mins);
+			float maxOffset = DotProduct3D(worldNormal, worldBounds.m_maxs);
+			float offset = GetClamped(m_sectionPlane.m_offset + sweepDirection * (maxOffset - minOffset) * 0.25f * deltaSeconds, minOffset, maxOffset);
+			if (offset != m_sectionPlane.m_offset)
+			{
+				SetSectionPlane(m_sectionPlane.m_axis, offset);
+			}
+		}
+	}
+
+	if (m_isSectionDirty)
+	{
+		// The cut and its outline are rebuilt on the CPU whenever the plane moves. The shaders have no clip plane, so the kept
+		// side of every triangle is uploaded instead; the outline only walks BVH nodes straddling the plane. Streamed models have
+		// no resident mesh to cut or BVH to outline from
+		m_sectionSegmentPoints.clear();
+		m_sectionOutlineVerts.clear();
+		m_sectionStats = TriangleQueryStats();
+		m_sectionKeptIndices.clear();
+		m_sectionSplitVerts.clear();
+		m_sectionClipRanges.clear();
+		m_sectionClipSeconds = 0.0;
+		DeleteSectionBuffers();
+		if (m_sectionPlane.IsEnabled() && m_modelVBO != nullptr && EnsureModelBVH())
+		{
+			Vec3 modelNormal;
+			float modelDistance = 0.f;
+			m_sectionPlane.GetModelPlane(m_modelToWorldTransform, modelNormal, modelDistance);
+			ClipModelToSectionPlane(modelNormal, modelDistance);
+			m_modelBVH.IntersectPlane(m_modelMeshVerts, m_modelMeshIndices, modelNormal, modelDistance, m_sectionSegmentPoints, &m_sectionStats);
+
+			AABB3 worldBounds = GetModelWorldBounds();
+			AddVertsForSectionOutline(m_sectionOutlineVerts, m_sectionSegmentPoints, m_modelToWorldTransform, m_sectionPlane.GetWorldNormal(),
+				0.002f * (worldBounds.m_maxs - worldBounds.m_mins).GetLength(), Rgba8(255, 220, 0, 255));
+			GetPerfStats().Sample(s_sectionMillisecondsStat, (m_sectionStats.m_seconds + m_sectionClipSeconds) * 1000.0);
+		}
+		m_isSectionDirty = false;
+		m_isRedrawRequested = true;
+	}
+
+	if (!m_sectionPlane.IsEnabled())
+	{
+		return;
+	}
+	std::string sectionText = m_isModelStreamed
+		? Stringf("Section: %s = %.4f, no cut (streamed models have no resident mesh) - X cycles axis, Up/Down sweeps", GetSectionAxisName(m_sectionPlane.m_axis), m_sectionPlane.m_offset)
+		: Stringf("Section: %s = %.4f, %d triangles cut, clip %.3f ms, outline %d nodes visited in %.3f ms - X cycles axis, Up/Down sweeps",
+			GetSectionAxisName(m_sectionPlane.m_axis), m_sectionPlane.m_offset, static_cast<int>(m_sectionSegmentPoints.size() / 2), m_sectionClipSeconds * 1000.0,
+			m_sectionStats.m_numNodesVisited, m_sectionStats.m_seconds * 1000.0);
+	DebugAddScreenText(sectionText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.64f), 0.f);
+}
+
+void Game::UpdateMemoryTracking()
+{
+	// CPU containers change size in many places, so they are measured once a frame; an unchanged one costs a lookup
+	MemoryTracker& memoryTracker = GetMemoryTracker();
+	memoryTracker.TrackVector(m_modelMeshVerts, MemoryCategory::MESH, m_modelFile);
+	memoryTracker.TrackVector(m_modelMeshIndices, MemoryCategory::MESH, m_modelFile);
+	memoryTracker.TrackVector(m_modelClusters, MemoryCategory::MESH, m_modelFile);
+	memoryTracker.TrackVector(m_occluderClusters, MemoryCategory::MESH, m_modelFile);
+	memoryTracker.TrackVector(m_gridVerts, MemoryCategory::GRID, "grid");
+	memoryTracker.Track(&m_modelBVH, MemoryCategory::DEBUG, MemoryResourceType::CPU_HEAP, m_modelBVH.GetNumBytes(), m_modelFile);
+	memoryTracker.TrackVector(m_sectionSegmentPoints, MemoryCategory::DEBUG, m_modelFile);
+	memoryTracker.TrackVector(m_sectionOutlineVerts, MemoryCategory::DEBUG, m_modelFile);
+	memoryTracker.TrackVector(m_sectionKeptIndices, MemoryCategory::DEBUG, m_modelFile);
+	memoryTracker.TrackVector(m_sectionSplitVerts, MemoryCategory::DEBUG, m_modelFile);
+	memoryTracker.Track(&m_occlusionCuller, MemoryCategory::TRANSIENT, MemoryResourceType::CPU_HEAP, m_occlusionCuller.GetNumBufferBytes(), "occlusion_culler");
+	memoryTracker.TrackVector(m_clusterOcclusionResults, MemoryCategory::TRANSIENT, "occlusion_culler");
+	memoryTracker.Track(&m_softwareRenderer, MemoryCategory::TRANSIENT, MemoryResourceType::CPU_HEAP, m_softwareRenderer.GetNumBufferBytes(), "software_renderer");
+
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Set(s_trackedMegabytesStat, static_cast<double>(memoryTracker.GetTotalUsage().m_bytes) / (1024.0 * 1024.0));
+	perfStats.Set(s_trackedGPUMegabytesStat, static_cast<double>(memoryTracker.GetGPUBytes()) / (1024.0 * 1024.0));
+}
+
+void Game::ReleaseMemoryTracking()
+{
+	MemoryTracker& memoryTracker = GetMemoryTracker();
+	memoryTracker.Release(&m_modelMeshVerts);
+	memoryTracker.Release(&m_modelMeshIndices);
+	memoryTracker.Release(&m_modelClusters);
+	memoryTracker.Release(&m_occluderClusters);
+	memoryTracker.Release(&m_gridVerts);
+	memoryTracker.Release(&m_modelBVH);
+	memoryTracker.Release(&m_sectionSegmentPoints);
+	memoryTracker.Release(&m_sectionOutlineVerts);
+	memoryTracker.Release(&m_sectionKeptIndices);
+	memoryTracker.Release(&m_sectionSplitVerts);
+	memoryTracker.Release(&m_occlusionCuller);
+	memoryTracker.Release(&m_clusterOcclusionResults);
+	memoryTracker.Release(&m_softwareRenderer);
+}
+
+void Game::RenderSoftwareFrame(ViewFrustum const& view, CaptureFrame& out_frame)
+{
+	SoftwareLighting lighting;
+	lighting.m_sunDirection = m_sunDirection;
+	lighting.m_sunIntensity = m_sunIntensity;
+	lighting.m_ambientIntensity = m_ambientIntensity;
+
+	m_softwareRenderer.Resize(out_frame.m_width, out_frame.m_height);
+	m_softwareRenderer.Clear(Rgba8(70, 70, 70, 255));
+	m_softwareRenderer.DrawMesh(m_modelMeshVerts, m_modelMeshIndices, view.GetModelToClip(m_modelToWorldTransform), m_modelToWorldTransform, lighting);
+	memcpy(out_frame.m_rgba.data(), m_softwareRenderer.GetPixels(), out_frame.m_rgba.size());
+}
+
+static bool AreSubmeshLayoutsEqual(std::vector<ModelSubmesh> const& submeshesA, std::vector<ModelSubmesh> const& submeshesB)
+{
+	if (submeshesA.size() != submeshesB.size())
+	{
+		return false;
+	}
+	for (int submeshIndex = 0; submeshIndex < static_cast<int>(submeshesA.size()); ++submeshIndex)
+	{
+		ModelSubmesh const& submeshA = submeshesA[submeshIndex];
+		ModelSubmesh const& submeshB = submeshesB[submeshIndex];
+		if (submeshA.m_materialIndex != submeshB.m_materialIndex || submeshA.m_startIndex != submeshB.m_startIndex || submeshA.m_indexCount != submeshB.m_indexCount)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void Game::ApplyReloadedMetaData()
+{
+	// These feed the geometry and everything built from it at startup, so changing any of them goes through a full restart
+	static char const* const s_restartKeys[] =
+	{
+		"objFile", "meshFormat", "unitsPerMeter", "x", "y", "z", "bakeTransform",
+		"occlusionCulling", "trianglesPerCluster", "occluderTriangleBudget",
+		"localLights", "spotLightFraction", "shadowCascadeFitting", "shadowSplitLambda",
+		"streamingBudgetMB", "streamingPrefetchDistance",
+	};
+
+	NamedStrings metaData;
+	LoadXMLMetaData(MODEL_METADATA_FILE, metaData);
+
+	// The app owns the frame pacer and only reads these at startup, so they are applied here whether or not the game restarts
+	std::string framePacing = metaData.GetValue("framePacing", "capped");
+	std::string targetFPS = metaData.GetValue("targetFPS", "60");
+	if (framePacing != g_gameConfigBlackboard.GetValue("framePacing", "capped") || targetFPS != g_gameConfigBlackboard.GetValue("targetFPS", "60"))
+	{
+		g_gameConfigBlackboard.SetValue("framePacing", framePacing);
+		g_gameConfigBlackboard.SetValue("targetFPS", targetFPS);
+		g_theApp->ApplyFramePacingConfig();
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, "Hot reload: frame pacing settings applied");
+	}
+
+	for (int keyIndex = 0; keyIndex < static_cast<int>(sizeof(s_restartKeys) / sizeof(s_restartKeys[0])); ++keyIndex)
+	{
+		if (metaData.GetValue(s_restartKeys[keyIndex], "") != g_gameConfigBlackboard.GetValue(s_restartKeys[keyIndex], ""))
+		{
+			g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Hot reload: model metadata \"%s\" changed, restarting", s_restartKeys[keyIndex]));
+			m_isRestartRequested = true;
+			return;
+		}
+	}
+
+	// Only the shader and fallback maps changed; rebind them and leave the geometry alone
+	std::string shader = metaData.GetValue("shader", "");
+	std::string diffuseMap = metaData.GetValue("diffuseMap", "");
+	std::string normalMap = metaData.GetValue("normalMap", "");
+	g_gameConfigBlackboard.SetValue("shader", shader);
+	g_gameConfigBlackboard.SetValue("diffuseMap", diffuseMap);
+	g_gameConfigBlackboard.SetValue("normalMap", normalMap);
+	m_shader = CreateOrGetTrackedShader(shader);
+
+	// Materials that took the old fallback are cleared so LoadModelMaterialTextures fills in the new one
+	for (int materialIndex = 0; materialIndex < static_cast<int>(m_modelMaterials.size()); ++materialIndex)
+	{
+		ModelMaterial& material = m_modelMaterials[materialIndex];
+		if (material.m_diffuseMapFile == m_fallbackDiffuseMap)
+		{
+			material.m_diffuseMapFile.clear();
+		}
+		if (material.m_normalMapFile == m_fallbackNormalMap)
+		{
+			material.m_normalMapFile.clear();
+		}
+	}
+	m_fallbackDiffuseMap = diffuseMap;
+	m_fallbackNormalMap = normalMap;
+	LoadModelMaterialTextures();
+	m_isRedrawRequested = true;
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, "Hot reload: shader and fallback maps rebound, geometry unchanged");
+}
+
+void Game::ApplyReloadedModel(ModelData& reloadedModel)
+{
+	GetPerfStats().Add(s_hotReloadsStat, 1.0);
+
+	bool isSameTopology = m_modelVBO != nullptr
+		&& reloadedModel.m_verts.size() == m_modelMeshVerts.size()
+		&& reloadedModel.m_indices == m_modelMeshIndices
+		&& AreSubmeshLayoutsEqual(reloadedModel.m_submeshes, m_modelSubmeshes);
+
+	if (!isSameTopology)
+	{
+		m_modelMeshVerts.swap(reloadedModel.m_verts);
+		m_modelMeshIndices.swap(reloadedModel.m_indices);
+		m_modelMaterials.swap(reloadedModel.m_materials);
+		m_modelSubmeshes.swap(reloadedModel.m_submeshes);
+		LoadModelMaterialTextures();
+
+		DeleteModelBuffers();
+		CreateBuffers();
+		BuildOcclusionClusters();
+		m_modelBVH.Clear();
+		m_isSectionDirty = true;
+		m_isRedrawRequested = true;
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Hot reload: mesh rebuilt with %d vertices", static_cast<int>(m_modelMeshVerts.size())));
+		return;
+	}
+
+	// Same topology; an MTL edit reparses the model but only changes its materials, which rebind without touching the buffers
+	m_modelMaterials.swap(reloadedModel.m_materials);
+	m_modelSubmeshes.swap(reloadedModel.m_submeshes);
+	LoadModelMaterialTextures();
+	m_isRedrawRequested = true;
+
+	// Find the span of vertices that actually changed
+	std::vector<Vertex_PCUTBN>& reloadedMeshVerts = reloadedModel.m_verts;
+	int numVerts = static_cast<int>(m_modelMeshVerts.size());
+	int firstDirtyIndex = 0;
+	while (firstDirtyIndex < numVerts && memcmp(&m_modelMeshVerts[firstDirtyIndex], &reloadedMeshVerts[firstDirtyIndex], sizeof(Vertex_PCUTBN)) == 0)
+	{
+		++firstDirtyIndex;
+	}
+	if (firstDirtyIndex == numVerts)
+	{
+		g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, "Hot reload: materials rebound, geometry unchanged");
+		return;
+	}
+
+	int lastDirtyIndex = numVerts - 1;
+	while (lastDirtyIndex > firstDirtyIndex && memcmp(&m_modelMeshVerts[lastDirtyIndex], &reloadedMeshVerts[lastDirtyIndex], sizeof(Vertex_PCUTBN)) == 0)
+	{
+		--lastDirtyIndex;
+	}
+
+	m_modelMeshVerts.swap(reloadedMeshVerts);
+	BuildOcclusionClusters();
+	m_modelBVH.Clear();
+	m_isSectionDirty = true;
+
+	// CopyCPUToGPU has no offset parameter, so the buffer is rewritten whole; untouched reloads are skipped above
+	g_theRenderer->CopyCPUToGPU(m_modelMeshVerts.data(), m_modelVBO->GetSize(), m_modelVBO);
+	GetPerfStats().Add(s_uploadBytesStat, static_cast<double>(m_modelVBO->GetSize()));
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, Stringf("Hot reload: vertices %d-%d changed", firstDirtyIndex, lastDirtyIndex));
+}
+
+void Game::Render() const
+{
+	if (m_isAttractMode == true)
+	{
+	}
+	if (m_isAttractMode == false)
+	{
+		g_theRenderer->BeginCamera(m_player->GetPlayerCamera());
+		g_theRenderer->ClearScreen(Rgba8(70, 70, 70, 255));
+		RenderGrid();
+		RenderModel();
+		RenderSectionOutline();
+		g_theRenderer->EndCamera(m_player->GetPlayerCamera());
+
+		DebugRenderWorld(m_player->GetPlayerCamera());
+		DebugRenderScreen(m_screenCamera);
+	}
+}
+
+void Game::Shutdown()
+{
+	UnsubscribeCommand("BenchmarkModelImport", Event_BenchmarkModelImport);
+	UnsubscribeCommand("BenchmarkTransformBake", Event_BenchmarkTransformBake);
+	UnsubscribeCommand("SpawnLights", Event_SpawnLights);
+	UnsubscribeCommand("ClearLights", Event_ClearLights);
+	UnsubscribeCommand("BenchmarkLightBinning", Event_BenchmarkLightBinning);
+	UnsubscribeCommand("CaptureTurntable", Event_CaptureTurntable);
+	UnsubscribeCommand("CaptureScreenshot", Event_CaptureScreenshot);
+	UnsubscribeCommand("ImportChunkedMesh", Event_ImportChunkedMesh);
+	UnsubscribeCommand("AnalyzeMesh", Event_AnalyzeMesh);
+	UnsubscribeCommand("SectionPlane", Event_SectionPlane);
+	UnsubscribeCommand("BenchmarkTriangleQueries", Event_BenchmarkTriangleQueries);
+	UnsubscribeCommand("LoadModel", Event_LoadModel);
+	UnsubscribeCommand("SetDebugMode", Event_SetDebugMode);
+	UnsubscribeCommand("SetCameraPose", Event_SetCameraPose);
+	UnsubscribeCommand("RunScript", Event_RunScript);
+	UnsubscribeCommand("StopScript", Event_StopScript);
+
+	m_turntableCapture.Finish();
+
+	delete m_hotReloader;
+	m_hotReloader = nullptr;
+
+	delete m_player;
+	m_player = nullptr;
+
+	DeleteModelBuffers();
+	ReleaseMemoryTracking();
+	CloseStreamedModel();
+}
+
+void Game::InitializeGrid()
+{
+	// Layout
+	for (int gridIndex = 0; gridIndex < 100; ++gridIndex)
+	{
+		AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.01f + gridIndex, -0.005f, 50.f, -49.99f + gridIndex, 0.005f), Rgba8::DARKGRAY);
+		AddVertsForAABB3D(m_gridVerts, AABB3(-50.01f + gridIndex, -50.0f, -0.005f, -49.99f + gridIndex, 50.f, 0.005f), Rgba8::DARKGRAY);
+	}
+
+	// Y axis
+	for (int x = 0; x < 105; x += 5)
+	{
+		if (x == 50)
+		{
+			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::GREEN);
+		}
+		else
+		{
+			AddVertsForAABB3D(m_gridVerts, AABB3(-50.05f + x, -50.f, -0.05f, -49.95f + x, 50.f, 0.05f), Rgba8::SEAWEED);
+		}
+	}
+
+	// X axis
+	for (int y = 0; y < 105; y += 5)
+	{
+		if (y == 50)
+		{
+			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::RED);
+		}
+		else
+		{
+			AddVertsForAABB3D(m_gridVerts, AABB3(-50.f, -50.05f + y, -0.05f, 50.f, -49.95f + y, 0.05f), Rgba8::DARKRED);
+		}
+	}
+}
+
+void Game::KeyInputPresses()
+{
+	// Attract Mode
+	if (g_theInput->WasKeyJustPressed(' '))
+	{
+		m_isAttractMode = false;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC))
+	{
+		m_isAttractMode = true;
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_F3))
+	{
+		m_isOcclusionCullingEnabled = !m_isOcclusionCullingEnabled;
+		m_isRedrawRequested = true;
+	}
+
+	// Debug Visualization Keys
+	DebugVisuals();
+}
+
+void Game::AdjustForPauseAndTimeDistortion(float deltaSeconds) {
+
+	UNUSED(deltaSeconds);
+
+	if (g_theInput->IsKeyDown('T'))
+	{
+		m_gameClock.SetTimeScale(0.1);
+	}
+	else
+	{
+		m_gameClock.SetTimeScale(1.0);
+	}
+
+	if (g_theInput->WasKeyJustPressed('P'))
+	{
+		m_gameClock.TogglePause();
+	}
+
+	if (g_theInput->WasKeyJustPressed('O'))
+	{
+		m_gameClock.StepSingleFrame();
+	}
+
+	if (g_theInput->WasKeyJustPressed(KEYCODE_ESC) && m_isAttractMode)
+	{
+		g_theEventSystem->FireEvent("Quit");
+	}
+}
+
+void Game::UpdateCameras()
+{
+	m_screenCamera.SetOrthoView(Vec2::ZERO, Vec2(SCREEN_SIZE_X, SCREEN_SIZE_Y));
+}
+
+void Game::UpdatePlayer(float deltaSeconds)
+{
+	if (m_player != nullptr)
+	{
+		m_player->Update(deltaSeconds);
+
+		std::string latencyText = Stringf("Player step %.0f Hz, input-to-present latency %.1f ms (avg %.1f ms)", 1.f / PLAYER_FIXED_STEP_SECONDS,
+			m_player->GetLastInputLatencySeconds() * 1000.f, m_player->GetAverageInputLatencySeconds() * 1000.f);
+		DebugAddScreenText(latencyText, AABB2(0.f, 0.f, SCREEN_SIZE_X, SCREEN_SIZE_Y), 10.f, Vec2(0.0f, 0.91f), 0.f);
+	}
+}
+
+void Game::SampleInput()
+{
+	// Extra samples between frames; Player::Update takes the frame's own sample
+	if (m_player != nullptr)
+	{
+		m_player->SampleInput();
+	}
+}
+
+void Game::OnFramePresented()
+{
+	m_isRedrawRequested = false;
+	m_presentedDebugInt = m_debugInt;
+	m_presentedAttractMode = m_isAttractMode;
+	if (m_player != nullptr)
+	{
+		m_player->OnFramePresented();
+		m_presentedCameraPosition = m_player->GetRenderPosition();
+		m_presentedCameraOrientation = m_player->GetRenderOrientation();
+	}
+}
+
+bool Game::IsRedrawNeeded() const
+{
+	if (m_isRedrawRequested || m_debugInt != m_presentedDebugInt || m_isAttractMode != m_presentedAttractMode)
+	{
+		return true;
+	}
+	if (m_player == nullptr)
+	{
+		return false;
+	}
+
+	EulerAngles const& orientation = m_player->GetRenderOrientation();
+	return m_player->GetRenderPosition() != m_presentedCameraPosition
+		|| orientation.m_yawDegrees != m_presentedCameraOrientation.m_yawDegrees
+		|| orientation.m_pitchDegrees != m_presentedCameraOrientation.m_pitchDegrees
+		|| orientation.m_rollDegrees != m_presentedCameraOrientation.m_rollDegrees;
+}
+
+void Game::RenderGrid() const
+{
+	g_theRenderer->SetModelConstants();
+	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
+	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
+	g_theRenderer->BindTexture(nullptr);
+	g_theRenderer->BindShader(nullptr);
+	g_theRenderer->DrawVertexArray(m_gridVerts);
+
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Add(s_drawCallsStat, 1.0);
+	perfStats.Add(s_trianglesDrawnStat, static_cast<double>(m_gridVerts.size() / 3));
+	perfStats.Add(s_uploadBytesStat, static_cast<double>(m_gridVerts.size() * sizeof(Vertex_PCU)));
+}
+
+void Game::RenderModel() const
+{
+	if (!m_modelVBO && !m_isModelStreamed)
+	{
+		return;
+	}
+
+	g_theRenderer->SetModelConstants(m_modelToWorldTransform);
+	g_theRenderer->SetLightingConstants(m_sunDirection, m_sunIntensity, m_ambientIntensity);
+	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
+	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_BACK);
+	g_theRenderer->SetDepthMode(DepthMode::READ_WRITE_LESS_EQUAL);
+	g_theRenderer->BindSampler(SamplerMode::POINT_CLAMP, 0);
+	g_theRenderer->BindSampler(SamplerMode::BILINEAR_WRAP, 1);
+	g_theRenderer->BindSampler(SamplerMode::BILINEAR_WRAP, 2);
+	g_theRenderer->BindShader(m_shader);
+
+	if (m_isModelStreamed)
+	{
+		RenderStreamedModel();
+		return;
+	}
+	if (m_sectionPlane.IsEnabled())
+	{
+		RenderSectionedModel();
+		return;
+	}
+
+	// One draw per material range; textures are only rebound when the material changes
+	int boundMaterialIndex = -1;
+	if (m_clusterOcclusionResults.empty() || m_clusterOcclusionResults.size() != m_modelClusters.size())
+	{
+		for (int submeshIndex = 0; submeshIndex < static_cast<int>(m_modelSubmeshes.size()); ++submeshIndex)
+		{
+			ModelSubmesh const& submesh = m_modelSubmeshes[submeshIndex];
+			DrawModelRange(submesh.m_materialIndex, submesh.m_startIndex, submesh.m_indexCount, boundMaterialIndex);
+		}
+		return;
+	}
+
+	// With culling results, skip hidden clusters and merge runs of visible neighbours into one draw
+	int pendingSubmeshIndex = -1;
+	unsigned int pendingStartIndex = 0;
+	unsigned int pendingIndexCount = 0;
+	for (int clusterIndex = 0; clusterIndex < static_cast<int>(m_modelClusters.size()); ++clusterIndex)
+	{
+		if (m_clusterOcclusionResults[clusterIndex] != OcclusionResult::VISIBLE)
+		{
+			continue;
+		}
+
+		ModelCluster const& cluster = m_modelClusters[clusterIndex];
+		if (cluster.m_submeshIndex == pendingSubmeshIndex && cluster.m_startIndex == pendingStartIndex + pendingIndexCount)
+		{
+			pendingIndexCount += cluster.m_indexCount;
+			continue;
+		}
+
+		if (pendingIndexCount > 0)
+		{
+			DrawModelRange(m_modelSubmeshes[pendingSubmeshIndex].m_materialIndex, pendingStartIndex, pendingIndexCount, boundMaterialIndex);
+		}
+		pendingSubmeshIndex = cluster.m_submeshIndex;
+		pendingStartIndex = cluster.m_startIndex;
+		pendingIndexCount = cluster.m_indexCount;
+	}
+	if (pendingIndexCount > 0)
+	{
+		DrawModelRange(m_modelSubmeshes[pendingSubmeshIndex].m_materialIndex, pendingStartIndex, pendingIndexCount, boundMaterialIndex);
+	}
+}
+
+void Game::RenderStreamedModel() const
+{
+	ModelMaterial const& material = m_modelMaterials[0];
+	g_theRenderer->BindTexture(material.m_diffuseTexture, 0);
+	g_theRenderer->BindTexture(material.m_normalTexture, 1);
+
+	// One draw per resident chunk in the frustum, front to back
+	PerfStats& perfStats = GetPerfStats();
+	std::vector<int> const& drawableChunks = m_streamedModel.GetDrawableChunks();
+	for (int drawableIndex = 0; drawableIndex < static_cast<int>(drawableChunks.size()); ++drawableIndex)
+	{
+		int chunkIndex = drawableChunks[drawableIndex];
+		if (m_streamedChunkVBOs[chunkIndex] == nullptr)
+		{
+			continue;
+		}
+
+		unsigned int indexCount = m_streamedModel.GetChunk(chunkIndex).m_info.m_numIndices;
+		g_theRenderer->DrawIndexedVertexBuffer(m_streamedChunkVBOs[chunkIndex], m_streamedChunkIBOs[chunkIndex], indexCount, 0);
+		perfStats.Add(s_drawCallsStat, 1.0);
+		perfStats.Add(s_trianglesDrawnStat, static_cast<double>(indexCount / 3));
+	}
+}
+
+void Game::RenderSectionedModel() const
+{
+	// Occlusion results are skipped: the occluders are the whole model, so cut-away parts would hide what the cut reveals.
+	// Backfaces stay culled, so the model's interior shows through the open cut
+	int boundMaterialIndex = -1;
+	PerfStats& perfStats = GetPerfStats();
+	for (int rangeIndex = 0; rangeIndex < static_cast<int>(m_sectionClipRanges.size()); ++rangeIndex)
+	{
+		SectionClipRange const& range = m_sectionClipRanges[rangeIndex];
+		if (range.m_materialIndex != boundMaterialIndex)
+		{
+			ModelMaterial const& material = m_modelMaterials[range.m_materialIndex];
+			g_theRenderer->BindTexture(material.m_diffuseTexture, 0);
+			g_theRenderer->BindTexture(material.m_normalTexture, 1);
+			boundMaterialIndex = range.m_materialIndex;
+		}
+
+		if (range.m_indexCount > 0 && m_sectionIBO != nullptr)
+		{
+			g_theRenderer->DrawIndexedVertexBuffer(m_modelVBO, m_sectionIBO, range.m_indexCount, range.m_startIndex);
+			perfStats.Add(s_drawCallsStat, 1.0);
+			perfStats.Add(s_trianglesDrawnStat, static_cast<double>(range.m_indexCount / 3));
+		}
+		if (range.m_vertexCount > 0 && m_sectionSplitVBO != nullptr)
+		{
+			g_theRenderer->DrawVertexBuffer(m_sectionSplitVBO, static_cast<int>(range.m_vertexCount), static_cast<int>(range.m_startVertex));
+			perfStats.Add(s_drawCallsStat, 1.0);
+			perfStats.Add(s_trianglesDrawnStat, static_cast<double>(range.m_vertexCount / 3));
+		}
+	}
+}
+
+void Game::RenderSectionOutline() const
+{
+	if (m_sectionOutlineVerts.empty())
+	{
+		return;
+	}
+
+	// Already in world space and lying in the cut, so it is depth tested against the cut model like any other geometry
+	g_theRenderer->SetModelConstants();
+	g_theRenderer->SetBlendMode(BlendMode::OPAQUE);
+	g_theRenderer->SetRasterizerMode(RasterizerMode::SOLID_CULL_NONE);
+	g_theRenderer->SetDepthMode(DepthMode::READ_ONLY_LESS_EQUAL);
+	g_theRenderer->BindTexture(nullptr);
+	g_theRenderer->BindShader(nullptr);
+	g_theRenderer->DrawVertexArray(m_sectionOutlineVerts);
+
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Add(s_drawCallsStat, 1.0);
+	perfStats.Add(s_trianglesDrawnStat, static_cast<double>(m_sectionOutlineVerts.size() / 3));
+	perfStats.Add(s_uploadBytesStat, static_cast<double>(m_sectionOutlineVerts.size() * sizeof(Vertex_PCU)));
+}
+
+void Game::DrawModelRange(int materialIndex, unsigned int startIndex, unsigned int indexCount, int& boundMaterialIndex) const
+{
+	if (materialIndex != boundMaterialIndex)
+	{
+		ModelMaterial const& material = m_modelMaterials[materialIndex];
+		g_theRenderer->BindTexture(material.m_diffuseTexture, 0);
+		g_theRenderer->BindTexture(material.m_normalTexture, 1);
+		boundMaterialIndex = materialIndex;
+	}
+	g_theRenderer->DrawIndexedVertexBuffer(m_modelVBO, m_modelIBO, indexCount, startIndex);
+
+	PerfStats& perfStats = GetPerfStats();
+	perfStats.Add(s_drawCallsStat, 1.0);
+	perfStats.Add(s_trianglesDrawnStat, static_cast<double>(indexCount / 3));
+}
+
+void Game::DebugVisuals()
+{
+	if (g_theInput->WasKeyJustPressed('0'))
+	{
+		m_debugInt = 0;
+	}
+	if (g_theInput->WasKeyJustPressed('1'))
+	{
+		m_debugInt = 1;
+	}
+	if (g_theInput->WasKeyJustPressed('2'))
+	{
+		m_debugInt = 2;
+	}
+	if (g_theInput->WasKeyJustPressed('3'))
+	{
+		m_debugInt = 3;
+	}
+	if (g_theInput->WasKeyJustPressed('7'))
+	{
+		m_debugInt = 7;
+	}
+	if (g_theInput->WasKeyJustPressed('8'))
+	{
+		m_debugInt = 8;
+	}
+	if (g_theInput->WasKeyJustPressed('9'))
+	{
+		m_debugInt = 9;
+	}
+
+	if (g_theInput->WasKeyJustPressed('K'))
+	{
+		m_debugInt = 10;
+	}
+	if (g_theInput->WasKeyJustPressed('L'))
+	{
+		m_debugInt = 11;
+	}
+
+	// Debug Tangent/Bitangent/Normal
+	if (g_theInput->WasKeyJustPressed('T'))
+	{
+		m_debugInt = 4;
+	}
+	if (g_theInput->WasKeyJustPressed('B'))
+	{
+		m_debugInt = 5;
+	}
+	if (g_theInput->WasKeyJustPressed('N'))
+	{
+		m_debugInt = 6;
+	}
+
+	// Debug Specular/Glossiness/Emissive
+	// Need to enable Nums Lock to use numpad keys
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD0))
+	{
+		m_debugInt = 14;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD1))
+	{
+		m_debugInt = 15;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD2))
+	{
+		m_debugInt = 16;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD3))
+	{
+		m_debugInt = 17;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD4))
+	{
+		m_debugInt = 18;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD5))
+	{
+		m_debugInt = 19;
+	}
+	if (g_theInput->WasKeyJustPressed(KEYCODE_NUMPAD6))
+	{
+		m_debugInt = 20;
+	}
+}
@@ -1,65 +1,196 @@
-#pragma once
-#include "Game/GameCommon.h"
-#include "Engine/Renderer/Camera.h"
-#include "Engine/Core/Clock.hpp"
-#include "Engine/Core/Vertex_PCU.h"
-#include "Engine/Core/Vertex_PCUTBN.hpp"
-#include <string>
-// -----------------------------------------------------------------------------
-class Player;
-class VertexBuffer;
-class IndexBuffer;
-class Shader;
-class Texture;
-// -----------------------------------------------------------------------------
-class Game
-{
-public:
-	App* m_app;
-	Game(App* owner);
-	~Game();
-	void StartUp();
-	void CreateBuffers();
-	void LoadXMLMetaData(char const* filePath);
-
-	Mat44 ApplyOrientation(std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ);
-
-	void Update();
-	void UpdateCameras();
-	void UpdatePlayer(float deltaSeconds);
-
-	void Render() const;
-	void RenderGrid() const;
-	void RenderModel() const;
-	void DebugVisuals();
-
-	void Shutdown();
-
-	void InitializeGrid();
-	void KeyInputPresses();
-	void AdjustForPauseAndTimeDistortion(float deltaSeconds);
-	bool		m_isAttractMode = true;
-
-private:
-	Camera		m_screenCamera;
-	Camera      m_gameWorldCamera;
-	Clock		m_gameClock;
-	Mat44		m_modelToWorldTransform = Mat44();
-
-	Player* m_player = nullptr;
-	Shader* m_shader = nullptr;
-	int m_debugInt = 0;
-	Vec3 m_sunDirection = Vec3(3.f, 1.f, -2.f);
-	float m_sunIntensity = 0.35f;
-	float m_ambientIntensity = 0.25f;
-
-	std::vector<Vertex_PCU> m_gridVerts;
-
-	// Model Loading
-	std::vector<Vertex_PCUTBN> m_modelMeshVerts;
-	std::vector<unsigned int>  m_modelMeshIndices;
-	VertexBuffer* m_modelVBO = nullptr;
-	IndexBuffer* m_modelIBO = nullptr;
-	Texture* m_womanDiffuseTexture = nullptr;
-	Texture* m_womanNormalTexture = nullptr;
+#pragma once
+#include "Game/GameCommon.h"
+#include "Engine/Renderer/Camera.h"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/EventSystem.hpp"
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Game/ModelLoader.hpp"
+#include "Game/SoftwareOcclusionCuller.hpp"
+#include "Game/ClusteredLighting.hpp"
+#include "Game/ShadowCascades.hpp"
+#include "Game/SoftwareRenderer.hpp"
+#include "Game/TurntableCapture.hpp"
+#include "Game/OutOfCoreMesh.hpp"
+#include "Game/TriangleBVH.hpp"
+#include "Game/SectionPlane.hpp"
+#include "Game/CommandScript.hpp"
+#include <string>
+// -----------------------------------------------------------------------------
+class Player;
+class VertexBuffer;
+class IndexBuffer;
+class Shader;
+class Texture;
+class ModelHotReloader;
+// -----------------------------------------------------------------------------
+class Game
+{
+public:
+	App* m_app;
+	Game(App* owner);
+	~Game();
+	void StartUp();
+	bool LoadModel(std::string const& modelFile, ModelFileFormat modelFormat);
+	void OpenStreamedModel(std::string const& chunkedFile);
+	void CloseStreamedModel();
+	void StartHotReloader(std::string const& modelFile, ModelFileFormat modelFormat);
+	void LoadModelMaterialTextures();
+	void CreateBuffers();
+	void DeleteModelBuffers();
+	void ClipModelToSectionPlane(Vec3 const& modelNormal, float modelDistance);
+	void DeleteSectionBuffers();
+	void ReloadModelTextures(std::vector<std::string> const& textureFiles);
+	void BuildOcclusionClusters();
+	AABB3 GetModelWorldBounds() const;
+	void LoadXMLMetaData(char const* filePath, NamedStrings& out_metaData);
+
+	Mat44 ApplyOrientation(std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ);
+
+	void Update();
+	void UpdateCommandScript();
+	void UpdateHotReload();
+	void UpdateOcclusionCulling();
+	void UpdateLightClusters();
+	void UpdateShadowCascades();
+	void UpdateTurntableCapture();
+	void UpdateStreamedModel();
+	void UpdateMeasurement();
+	void UpdateSectionPlane(float deltaSeconds);
+	void UpdateMemoryTracking();
+	void ReleaseMemoryTracking();
+	void SetSectionPlane(SectionAxis axis, float offset);
+	bool EnsureModelBVH();
+	bool RaycastModel(Vec3 const& worldStart, Vec3 const& worldDirection, float maxDistance, TriangleRaycastResult& out_worldHit);
+	void ApplyReloadedMetaData();
+	void ApplyReloadedModel(ModelData& reloadedModel);
+	bool IsRestartRequested() const { return m_isRestartRequested; }
+	bool IsRedrawNeeded() const;
+	void UpdateCameras();
+	void UpdatePlayer(float deltaSeconds);
+	void SampleInput();
+	void OnFramePresented();
+
+	void Render() const;
+	void RenderGrid() const;
+	void RenderModel() const;
+	void RenderStreamedModel() const;
+	void RenderSectionedModel() const;
+	void RenderSectionOutline() const;
+	void DrawModelRange(int materialIndex, unsigned int startIndex, unsigned int indexCount, int& boundMaterialIndex) const;
+	void RenderSoftwareFrame(ViewFrustum const& view, CaptureFrame& out_frame);
+	void DebugVisuals();
+
+	void Shutdown();
+	static void DeleteReloadedTextures();		// Call before the renderer shuts down
+
+	static bool Event_BenchmarkModelImport(EventArgs& args);
+	static bool Event_BenchmarkTransformBake(EventArgs& args);
+	static bool Event_SpawnLights(EventArgs& args);
+	static bool Event_ClearLights(EventArgs& args);
+	static bool Event_BenchmarkLightBinning(EventArgs& args);
+	static bool Event_CaptureTurntable(EventArgs& args);
+	static bool Event_CaptureScreenshot(EventArgs& args);
+	static bool Event_ImportChunkedMesh(EventArgs& args);
+	static bool Event_AnalyzeMesh(EventArgs& args);
+	static bool Event_SectionPlane(EventArgs& args);
+	static bool Event_BenchmarkTriangleQueries(EventArgs& args);
+	static bool Event_LoadModel(EventArgs& args);
+	static bool Event_SetDebugMode(EventArgs& args);
+	static bool Event_SetCameraPose(EventArgs& args);
+	static bool Event_RunScript(EventArgs& args);
+	static bool Event_StopScript(EventArgs& args);
+
+	void InitializeGrid();
+	void KeyInputPresses();
+	void AdjustForPauseAndTimeDistortion(float deltaSeconds);
+	bool		m_isAttractMode = true;
+
+private:
+	Camera		m_screenCamera;
+	Camera      m_gameWorldCamera;
+	Clock		m_gameClock;
+	Mat44		m_modelToWorldTransform = Mat44();
+	Mat44		m_modelBakeTransform = Mat44();
+	bool		m_isModelTransformBaked = false;
+
+	Player* m_player = nullptr;
+	Shader* m_shader = nullptr;
+	int m_debugInt = 0;
+	Vec3 m_sunDirection = Vec3(3.f, 1.f, -2.f);
+	float m_sunIntensity = 0.35f;
+	float m_ambientIntensity = 0.25f;
+
+	std::vector<Vertex_PCU> m_gridVerts;
+
+	// Model Loading
+	std::string m_modelFile;
+	std::vector<Vertex_PCUTBN> m_modelMeshVerts;
+	std::vector<unsigned int>  m_modelMeshIndices;
+	std::vector<ModelMaterial> m_modelMaterials;
+	std::vector<ModelSubmesh>  m_modelSubmeshes;
+	std::vector<std::string>   m_modelMaterialLibraryFiles;
+	VertexBuffer* m_modelVBO = nullptr;
+	IndexBuffer* m_modelIBO = nullptr;
+	std::string m_fallbackDiffuseMap;
+	std::string m_fallbackNormalMap;
+
+	// Occlusion Culling
+	SoftwareOcclusionCuller		 m_occlusionCuller;
+	std::vector<ModelCluster>	 m_modelClusters;
+	std::vector<ModelCluster>	 m_occluderClusters;
+	std::vector<OcclusionResult> m_clusterOcclusionResults;
+	bool m_isOcclusionCullingEnabled = true;
+	int m_trianglesPerCluster = 4096;
+	int m_occluderTriangleBudget = 16384;
+
+	// Clustered Lighting
+	std::vector<LocalLight> m_localLights;
+	ClusteredLighting		m_clusteredLighting;
+	bool m_areLightClustersDirty = true;
+
+	// Sun Shadow Cascade Fitting (CPU only; no shadow map is rendered)
+	ShadowCascades	m_shadowCascades;
+	bool m_isCascadeFittingEnabled = false;
+	bool m_areShadowCascadesDirty = true;
+
+	// Capture
+	TurntableCapture	m_turntableCapture;
+	SoftwareRenderer	m_softwareRenderer;
+
+	// Out-of-core Streaming
+	OutOfCoreMesh				m_streamedModel;
+	std::vector<VertexBuffer*>	m_streamedChunkVBOs;
+	std::vector<IndexBuffer*>	m_streamedChunkIBOs;
+	bool m_isModelStreamed = false;
+
+	// Measurement and Section Plane; the BVH is built on first use and dropped whenever the mesh changes
+	TriangleBVH				m_modelBVH;
+	std::vector<Vec3>		m_measurePoints;
+	SectionPlane			m_sectionPlane;
+	std::vector<Vec3>		m_sectionSegmentPoints;
+	std::vector<Vertex_PCU>	m_sectionOutlineVerts;
+	TriangleQueryStats		m_sectionStats;
+	std::vector<unsigned int>		m_sectionKeptIndices;
+	std::vector<Vertex_PCUTBN>		m_sectionSplitVerts;
+	std::vector<SectionClipRange>	m_sectionClipRanges;
+	IndexBuffer*	m_sectionIBO = nullptr;			// Indexes m_modelVBO
+	VertexBuffer*	m_sectionSplitVBO = nullptr;
+	double			m_sectionClipSeconds = 0.0;
+	bool m_isSectionDirty = true;
+
+	// Scripting
+	CommandScript	m_commandScript;
+	bool m_isQuitAfterScript = false;
+
+	// On-demand redraw: what the last presented frame showed
+	bool		m_isRedrawRequested = true;
+	Vec3		m_presentedCameraPosition;
+	EulerAngles m_presentedCameraOrientation;
+	int			m_presentedDebugInt = -1;
+	bool		m_presentedAttractMode = true;
+
+	// Hot Reloading
+	ModelHotReloader* m_hotReloader = nullptr;
+	bool m_isRestartRequested = false;
 };
\ No newline at end of file
@@ -1,28 +1,35 @@
-#pragma once
-#include "Engine/Math/RandomNumberGenerator.h"
-
-class App;
-class Renderer;
-class InputSystem;
-class AudioSystem;
-class Window;
-struct Vec2;
-struct Rgba8;
-
-constexpr float SCREEN_SIZE_X = 1600.f;
-constexpr float SCREEN_SIZE_Y = 800.f;
-constexpr float SCREEN_CENTER_X = SCREEN_SIZE_X / 2.f;
-constexpr float SCREEN_CENTER_Y = SCREEN_SIZE_Y / 2.f;
-
-constexpr int STARTTRIANGLE_VERTS = 3;
-
-extern App* g_theApp;
-extern Renderer* g_theRenderer;
-extern RandomNumberGenerator* g_rng;
-extern InputSystem* g_theInput;
-extern AudioSystem* g_theAudio;
-extern Window* g_theWindow;
-
-void DebugDrawRing(Vec2 const& center, float radius, float thickness, Rgba8 const& color);
-void DebugDrawLine(Vec2 const& start, Vec2 const& end, float thickness, Rgba8 const& color);
-char const* GetDebugRenderModeDesc(int debugRenderMode);
+#pragma once
+#include "Engine/Math/RandomNumberGenerator.h"
+
+class App;
+class Renderer;
+class InputSystem;
+class AudioSystem;
+class Window;
+struct Vec2;
+struct Rgba8;
+
+constexpr float SCREEN_SIZE_X = 1600.f;
+constexpr float SCREEN_SIZE_Y = 800.f;
+constexpr float SCREEN_CENTER_X = SCREEN_SIZE_X / 2.f;
+constexpr float SCREEN_CENTER_Y = SCREEN_SIZE_Y / 2.f;
+
+constexpr int STARTTRIANGLE_VERTS = 3;
+
+constexpr float CAMERA_FOV_DEGREES = 60.f;
+constexpr float CAMERA_ASPECT = SCREEN_SIZE_X / SCREEN_SIZE_Y;
+constexpr float CAMERA_NEAR_Z = 0.1f;
+constexpr float CAMERA_FAR_Z = 300.f;
+constexpr int MAX_CAPTURE_SIZE = 16384;			// Largest screenshot width or height, in pixels
+constexpr int NUM_DEBUG_RENDER_MODES = 21;		// Modes 0-20 of the shader's debug switch, described by GetDebugRenderModeDesc
+
+extern App* g_theApp;
+extern Renderer* g_theRenderer;
+extern RandomNumberGenerator* g_rng;
+extern InputSystem* g_theInput;
+extern AudioSystem* g_theAudio;
+extern Window* g_theWindow;
+
+void DebugDrawRing(Vec2 const& center, float radius, float thickness, Rgba8 const& color);
+void DebugDrawLine(Vec2 const& start, Vec2 const& end, float thickness, Rgba8 const& color);
+char const* GetDebugRenderModeDesc(int debugRenderMode);
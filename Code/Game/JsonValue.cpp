@@ -0,0 +1,407 @@
+#include "Game/JsonValue.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+static JsonValue const s_nullJsonValue;
+
+// -----------------------------------------------------------------------------
+class JsonParser
+{
+public:
+	JsonParser(char const* text, size_t length)
+		: m_cursor(text)
+		, m_end(text + length)
+	{
+	}
+
+	bool ParseDocument(JsonValue& out_value)
+	{
+		SkipWhitespace();
+		if (!ParseValue(out_value, 0))
+		{
+			return false;
+		}
+		SkipWhitespace();
+		if (m_cursor != m_end)
+		{
+			return Fail("unexpected characters after the root value");
+		}
+		return true;
+	}
+
+	std::string m_errorMessage;
+
+private:
+	bool Fail(char const* message)
+	{
+		if (m_errorMessage.empty())
+		{
+			m_errorMessage = message;
+		}
+		return false;
+	}
+
+	void SkipWhitespace()
+	{
+		while (m_cursor < m_end && (*m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\n' || *m_cursor == '\r'))
+		{
+			++m_cursor;
+		}
+	}
+
+	bool ConsumeLiteral(char const* literal)
+	{
+		size_t literalLength = strlen(literal);
+		if (static_cast<size_t>(m_end - m_cursor) < literalLength || strncmp(m_cursor, literal, literalLength) != 0)
+		{
+			return false;
+		}
+		m_cursor += literalLength;
+		return true;
+	}
+
+	bool ParseValue(JsonValue& out_value, int depth)
+	{
+		constexpr int MAX_NESTING_DEPTH = 256;
+		if (depth > MAX_NESTING_DEPTH)
+		{
+			return Fail("nesting too deep");
+		}
+		if (m_cursor >= m_end)
+		{
+			return Fail("unexpected end of document");
+		}
+
+		switch (*m_cursor)
+		{
+			case '{':	return ParseObject(out_value, depth);
+			case '[':	return ParseArray(out_value, depth);
+			case '"':	out_value.m_type = JsonType::STRING; return ParseString(out_value.m_string);
+			case 't':	out_value.m_type = JsonType::BOOLEAN; out_value.m_bool = true;  return ConsumeLiteral("true")  || Fail("bad literal");
+			case 'f':	out_value.m_type = JsonType::BOOLEAN; out_value.m_bool = false; return ConsumeLiteral("false") || Fail("bad literal");
+			case 'n':	out_value.m_type = JsonType::NUL; return ConsumeLiteral("null") || Fail("bad literal");
+			default:	return ParseNumber(out_value);
+		}
+	}
+
+	bool ParseNumber(JsonValue& out_value)
+	{
+		// strtod needs a terminated buffer; numbers are short, so copy the candidate characters
+		char numberText[64];
+		int numChars = 0;
+		while (m_cursor + numChars < m_end && numChars < 63 && strchr("+-0123456789.eE", m_cursor[numChars]) != nullptr)
+		{
+			numberText[numChars] = m_cursor[numChars];
+			++numChars;
+		}
+		numberText[numChars] = '\0';
+
+		char* parseEnd = nullptr;
+		out_value.m_type = JsonType::NUMBER;
+		out_value.m_number = strtod(numberText, &parseEnd);
+		if (numChars == 0 || parseEnd != numberText + numChars)
+		{
+			return Fail("invalid number");
+		}
+		m_cursor += numChars;
+		return true;
+	}
+
+	static void AppendUTF8(std::string& out_string, unsigned int codePoint)
+	{
+		if (codePoint < 0x80)
+		{
+			out_string.push_back(static_cast<char>(codePoint));
+		}
+		else if (codePoint < 0x800)
+		{
+			out_string.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+			out_string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else if (codePoint < 0x10000)
+		{
+			out_string.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+			out_string.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			out_string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+		else
+		{
+			out_string.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+			out_string.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+			out_string.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+			out_string.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+		}
+	}
+
+	bool ParseHex4(unsigned int& out_value)
+	{
+		if (m_end - m_cursor < 4)
+		{
+			return Fail("truncated \\u escape");
+		}
+		out_value = 0;
+		for (int digit = 0; digit < 4; ++digit)
+		{
+			char character = *m_cursor++;
+			out_value <<= 4;
+			if (character >= '0' && character <= '9')		out_value |= static_cast<unsigned int>(character - '0');
+			else if (character >= 'a' && character <= 'f')	out_value |= static_cast<unsigned int>(character - 'a' + 10);
+			else if (character >= 'A' && character <= 'F')	out_value |= static_cast<unsigned int>(character - 'A' + 10);
+			else return Fail("invalid \\u escape");
+		}
+		return true;
+	}
+
+	bool ParseString(std::string& out_string)
+	{
+		++m_cursor;
+		out_string.clear();
+		while (m_cursor < m_end && *m_cursor != '"')
+		{
+			char character = *m_cursor++;
+			if (character != '\\')
+			{
+				out_string.push_back(character);
+				continue;
+			}
+			if (m_cursor >= m_end)
+			{
+				break;
+			}
+
+			char escape = *m_cursor++;
+			switch (escape)
+			{
+				case '"':	out_string.push_back('"');	break;
+				case '\\':	out_string.push_back('\\');	break;
+				case '/':	out_string.push_back('/');	break;
+				case 'b':	out_string.push_back('\b');	break;
+				case 'f':	out_string.push_back('\f');	break;
+				case 'n':	out_string.push_back('\n');	break;
+				case 'r':	out_string.push_back('\r');	break;
+				case 't':	out_string.push_back('\t');	break;
+				case 'u':
+				{
+					unsigned int codePoint = 0;
+					if (!ParseHex4(codePoint))
+					{
+						return false;
+					}
+					if (codePoint >= 0xD800 && codePoint <= 0xDBFF && m_end - m_cursor >= 6 && m_cursor[0] == '\\' && m_cursor[1] == 'u')
+					{
+						m_cursor += 2;
+						unsigned int lowSurrogate = 0;
+						if (!ParseHex4(lowSurrogate))
+						{
+							return false;
+						}
+						codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+					}
+					AppendUTF8(out_string, codePoint);
+					break;
+				}
+				default:
+					return Fail("invalid escape sequence");
+			}
+		}
+
+		if (m_cursor >= m_end)
+		{
+			return Fail("unterminated string");
+		}
+		++m_cursor;
+		return true;
+	}
+
+	bool ParseArray(JsonValue& out_value, int depth)
+	{
+		++m_cursor;
+		out_value.m_type = JsonType::ARRAY;
+		SkipWhitespace();
+		if (m_cursor < m_end && *m_cursor == ']')
+		{
+			++m_cursor;
+			return true;
+		}
+
+		for (;;)
+		{
+			out_value.m_elements.emplace_back();
+			SkipWhitespace();
+			if (!ParseValue(out_value.m_elements.back(), depth + 1))
+			{
+				return false;
+			}
+			SkipWhitespace();
+			if (m_cursor < m_end && *m_cursor == ',')
+			{
+				++m_cursor;
+				continue;
+			}
+			if (m_cursor < m_end && *m_cursor == ']')
+			{
+				++m_cursor;
+				return true;
+			}
+			return Fail("expected ',' or ']' in array");
+		}
+	}
+
+	bool ParseObject(JsonValue& out_value, int depth)
+	{
+		++m_cursor;
+		out_value.m_type = JsonType::OBJECT;
+		SkipWhitespace();
+		if (m_cursor < m_end && *m_cursor == '}')
+		{
+			++m_cursor;
+			return true;
+		}
+
+		for (;;)
+		{
+			SkipWhitespace();
+			if (m_cursor >= m_end || *m_cursor != '"')
+			{
+				return Fail("expected a member name");
+			}
+			out_value.m_members.emplace_back();
+			std::pair<std::string, JsonValue>& member = out_value.m_members.back();
+			if (!ParseString(member.first))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (m_cursor >= m_end || *m_cursor != ':')
+			{
+				return Fail("expected ':' after member name");
+			}
+			++m_cursor;
+			SkipWhitespace();
+			if (!ParseValue(member.second, depth + 1))
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (m_cursor < m_end && *m_cursor == ',')
+			{
+				++m_cursor;
+				continue;
+			}
+			if (m_cursor < m_end && *m_cursor == '}')
+			{
+				++m_cursor;
+				return true;
+			}
+			return Fail("expected ',' or '}' in object");
+		}
+	}
+
+private:
+	char const* m_cursor = nullptr;
+	char const* m_end = nullptr;
+};
+
+// -----------------------------------------------------------------------------
+bool JsonValue::Parse(JsonValue& out_value, char const* text, size_t length, std::string* out_errorMessage)
+{
+	out_value = JsonValue();
+	JsonParser parser(text, length);
+	if (parser.ParseDocument(out_value))
+	{
+		return true;
+	}
+
+	if (out_errorMessage != nullptr)
+	{
+		*out_errorMessage = parser.m_errorMessage;
+	}
+	out_value = JsonValue();
+	return false;
+}
+
+bool JsonValue::GetBool(bool defaultValue) const
+{
+	return (m_type == JsonType::BOOLEAN) ? m_bool : defaultValue;
+}
+
+double JsonValue::GetNumber(double defaultValue) const
+{
+	return (m_type == JsonType::NUMBER) ? m_number : defaultValue;
+}
+
+float JsonValue::GetFloat(float defaultValue) const
+{
+	return (m_type == JsonType::NUMBER) ? static_cast<float>(m_number) : defaultValue;
+}
+
+int JsonValue::GetInt(int defaultValue) const
+{
+	return (m_type == JsonType::NUMBER) ? static_cast<int>(m_number) : defaultValue;
+}
+
+std::string JsonValue::GetString(std::string const& defaultValue) const
+{
+	return (m_type == JsonType::STRING) ? m_string : defaultValue;
+}
+
+int JsonValue::GetNumElements() const
+{
+	return static_cast<int>(m_elements.size());
+}
+
+JsonValue const& JsonValue::operator[](int index) const
+{
+	if (index < 0 || index >= static_cast<int>(m_elements.size()))
+	{
+		return s_nullJsonValue;
+	}
+	return m_elements[index];
+}
+
+JsonValue const& JsonValue::operator[](char const* key) const
+{
+	for (int memberIndex = 0; memberIndex < static_cast<int>(m_members.size()); ++memberIndex)
+	{
+		if (m_members[memberIndex].first == key)
+		{
+			return m_members[memberIndex].second;
+		}
+	}
+	return s_nullJsonValue;
+}
+
+bool JsonValue::HasKey(char const* key) const
+{
+	return !(*this)[key].IsNull();
+}
+
+// -----------------------------------------------------------------------------
+std::string GetJSONString(std::string const& text)
+{
+	std::string escaped = "\"";
+	for (int charIndex = 0; charIndex < static_cast<int>(text.size()); ++charIndex)
+	{
+		char character = text[charIndex];
+		if (character == '"' || character == '\\')
+		{
+			escaped += '\\';
+			escaped += character;
+		}
+		else if (static_cast<unsigned char>(character) < 0x20)
+		{
+			char escapeCode[8];
+			snprintf(escapeCode, sizeof(escapeCode), "\\u%04x", static_cast<unsigned int>(character));
+			escaped += escapeCode;
+		}
+		else
+		{
+			escaped += character;
+		}
+	}
+	return escaped + "\"";
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class JsonType
+{
+	NUL,
+	BOOLEAN,
+	NUMBER,
+	STRING,
+	ARRAY,
+	OBJECT,
+};
+// -----------------------------------------------------------------------------
+// Read-only JSON document node. Missing keys and out-of-range indices return a shared
+// null value, so lookups like json["a"][0]["b"].GetInt(-1) never need to be guarded.
+// -----------------------------------------------------------------------------
+class JsonValue
+{
+public:
+	static bool Parse(JsonValue& out_value, char const* text, size_t length, std::string* out_errorMessage = nullptr);
+
+	JsonType GetType() const { return m_type; }
+	bool IsNull() const { return m_type == JsonType::NUL; }
+	bool IsArray() const { return m_type == JsonType::ARRAY; }
+	bool IsObject() const { return m_type == JsonType::OBJECT; }
+
+	bool		GetBool(bool defaultValue) const;
+	double		GetNumber(double defaultValue) const;
+	float		GetFloat(float defaultValue) const;
+	int			GetInt(int defaultValue) const;
+	std::string GetString(std::string const& defaultValue) const;
+
+	int GetNumElements() const;
+	JsonValue const& operator[](int index) const;
+	JsonValue const& operator[](char const* key) const;
+	bool HasKey(char const* key) const;
+
+private:
+	friend class JsonParser;
+
+	JsonType										m_type = JsonType::NUL;
+	bool											m_bool = false;
+	double											m_number = 0.0;
+	std::string										m_string;
+	std::vector<JsonValue>							m_elements;
+	std::vector<std::pair<std::string, JsonValue>>	m_members;
+};
+// -----------------------------------------------------------------------------
+// Quoted and escaped for writing into a JSON document
+std::string GetJSONString(std::string const& text);
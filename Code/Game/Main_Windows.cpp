@@ -1,32 +1,65 @@
-#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
-#include <windows.h>			// #include this (massive, platform-specific) header in VERY few places (and .CPPs only)
-#include <Engine/Core/EngineCommon.h>
-#include <math.h>
-#include <cassert>
-#include <crtdbg.h>
-#include "App.h"
-#include "Engine/Input/InputSystem.h"
-
-extern HDC g_displayDeviceContext;
-extern App* g_theApp;				// Created and owned by Main_Windows.cpp
-
-//-----------------------------------------------------------------------------------------------
-int WINAPI WinMain(HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int)
-{
-	UNUSED(commandLineString);
-	UNUSED(applicationInstanceHandle);
-
-	g_theApp = new App();
-	g_theApp->Startup();
-
-	// Program main loop; keep running frames until it's time to quit
-	g_theApp->RunMainLoop();
-
-	g_theApp->Shutdown();
-	delete g_theApp;
-	g_theApp = nullptr;
-
-	return 0;
-}
-
-
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>			// #include this (massive, platform-specific) header in VERY few places (and .CPPs only)
+#include <Engine/Core/EngineCommon.h>
+#include <math.h>
+#include <string.h>
+#include <cassert>
+#include <crtdbg.h>
+#include "App.h"
+#include "Game/MeshAnalyzer.hpp"
+#include "Game/CommandScript.hpp"
+#include "Engine/Input/InputSystem.h"
+#include "Engine/Core/DevConsole.hpp"
+
+extern HDC g_displayDeviceContext;
+extern App* g_theApp;				// Created and owned by Main_Windows.cpp
+
+//-----------------------------------------------------------------------------------------------
+int WINAPI WinMain(HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int)
+{
+	UNUSED(applicationInstanceHandle);
+
+	// Batch mode: "Game.exe AnalyzeMesh file=<model> [json=<path>]" runs headless and exits without opening a window
+	if (strncmp(commandLineString, "AnalyzeMesh", 11) == 0)
+	{
+		std::string report;
+		int exitCode = RunMeshAnalyzerCommandLine(commandLineString, report);
+
+		// A GUI-subsystem process only has a stdout when it was redirected; otherwise borrow the launching console
+		HANDLE outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+		if ((outputHandle == NULL || outputHandle == INVALID_HANDLE_VALUE) && AttachConsole(ATTACH_PARENT_PROCESS))
+		{
+			outputHandle = GetStdHandle(STD_OUTPUT_HANDLE);
+		}
+		if (!report.empty() && outputHandle != NULL && outputHandle != INVALID_HANDLE_VALUE)
+		{
+			DWORD numWritten = 0;
+			WriteFile(outputHandle, report.data(), static_cast<DWORD>(report.size()), &numWritten, NULL);
+		}
+		return exitCode;
+	}
+
+	g_theApp = new App();
+	g_theApp->Startup();
+
+	// Scripted mode: "Game.exe RunScript file=<script> [repeat=<n>] [batch=<n>] [quit=true]" plays the script once the game is up
+	if (strncmp(commandLineString, "RunScript", 9) == 0)
+	{
+		std::string errorMessage;
+		if (!ExecuteCommandLine(commandLineString, errorMessage) && !errorMessage.empty())
+		{
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Command line: %s", errorMessage.c_str()));
+		}
+	}
+
+	// Program main loop; keep running frames until it's time to quit
+	g_theApp->RunMainLoop();
+
+	g_theApp->Shutdown();
+	delete g_theApp;
+	g_theApp = nullptr;
+
+	return 0;
+}
+
+
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+// -----------------------------------------------------------------------------
+// Read-only view of a whole file mapped into the address space. Pages are faulted in
+// by the OS on first touch, so large assets can be read without an upfront copy.
+// -----------------------------------------------------------------------------
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() = default;
+	~MemoryMappedFile();
+	MemoryMappedFile(MemoryMappedFile const& copy) = delete;
+	MemoryMappedFile& operator=(MemoryMappedFile const& copy) = delete;
+
+	bool Open(std::string const& filePath);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	unsigned char const* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	unsigned char const*	m_data = nullptr;
+	size_t					m_size = 0;
+	void*					m_fileHandle = nullptr;
+	void*					m_mappingHandle = nullptr;
+};
@@ -0,0 +1,330 @@
+#include "Game/MemoryTracker.hpp"
+#include "Game/JsonValue.hpp"
+#include "Game/PerfStats.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+MemoryTracker& GetMemoryTracker()
+{
+	static MemoryTracker s_memoryTracker;
+	return s_memoryTracker;
+}
+
+static void AddToUsage(MemoryUsage& usage, int64_t deltaBytes, int deltaAllocations)
+{
+	usage.m_bytes = static_cast<uint64_t>(static_cast<int64_t>(usage.m_bytes) + deltaBytes);
+	usage.m_numAllocations += deltaAllocations;
+	usage.m_peakBytes = (usage.m_bytes > usage.m_peakBytes) ? usage.m_bytes : usage.m_peakBytes;
+}
+
+static std::string GetUsageJSON(MemoryUsage const& usage)
+{
+	return Stringf("{ \"bytes\": %llu, \"peakBytes\": %llu, \"allocations\": %d }",
+		static_cast<unsigned long long>(usage.m_bytes), static_cast<unsigned long long>(usage.m_peakBytes), usage.m_numAllocations);
+}
+
+// -----------------------------------------------------------------------------
+char const* MemoryTracker::GetCategoryName(MemoryCategory category)
+{
+	switch (category)
+	{
+	case MemoryCategory::MESH:		return "mesh";
+	case MemoryCategory::TEXTURE:	return "texture";
+	case MemoryCategory::SHADER:	return "shader";
+	case MemoryCategory::GRID:		return "grid";
+	case MemoryCategory::DEBUG:		return "debug";
+	case MemoryCategory::TRANSIENT:	return "transient";
+	default:						return "unknown";
+	}
+}
+
+char const* MemoryTracker::GetResourceTypeName(MemoryResourceType type)
+{
+	switch (type)
+	{
+	case MemoryResourceType::CPU_HEAP:			return "cpu_heap";
+	case MemoryResourceType::VERTEX_BUFFER:		return "vertex_buffer";
+	case MemoryResourceType::INDEX_BUFFER:		return "index_buffer";
+	case MemoryResourceType::CONSTANT_BUFFER:	return "constant_buffer";
+	case MemoryResourceType::TEXTURE:			return "texture";
+	case MemoryResourceType::SHADER:			return "shader";
+	default:									return "unknown";
+	}
+}
+
+char const* MemoryTracker::GetOwnerName(MemoryOwner owner)
+{
+	switch (owner)
+	{
+	case MemoryOwner::GAME:				return "game";
+	case MemoryOwner::RENDERER_CACHE:	return "renderer_cache";
+	default:							return "unknown";
+	}
+}
+
+// -----------------------------------------------------------------------------
+void MemoryTracker::Track(void const* resource, MemoryCategory category, MemoryResourceType type, uint64_t bytes, std::string const& asset, MemoryOwner owner)
+{
+	if (resource == nullptr)
+	{
+		return;
+	}
+	if (bytes == 0)
+	{
+		Release(resource);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_allocations.find(resource);
+	if (found != m_allocations.end())
+	{
+		MemoryAllocation& allocation = found->second;
+		if (allocation.m_bytes == bytes && allocation.m_category == category && allocation.m_type == type && allocation.m_owner == owner && allocation.m_asset == asset)
+		{
+			return;
+		}
+		AddToUsages(allocation, -static_cast<int64_t>(allocation.m_bytes), -1);
+		m_allocations.erase(found);
+	}
+
+	MemoryAllocation allocation;
+	allocation.m_resource = resource;
+	allocation.m_category = category;
+	allocation.m_type = type;
+	allocation.m_owner = owner;
+	allocation.m_bytes = bytes;
+	allocation.m_asset = asset;
+	AddToUsages(allocation, static_cast<int64_t>(bytes), 1);
+	m_allocations[resource] = allocation;
+}
+
+void MemoryTracker::Release(void const* resource)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto found = m_allocations.find(resource);
+	if (found == m_allocations.end())
+	{
+		return;
+	}
+	AddToUsages(found->second, -static_cast<int64_t>(found->second.m_bytes), -1);
+	m_allocations.erase(found);
+}
+
+void MemoryTracker::ReleaseOwner(MemoryOwner owner)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto allocation = m_allocations.begin(); allocation != m_allocations.end();)
+	{
+		if (allocation->second.m_owner != owner)
+		{
+			++allocation;
+			continue;
+		}
+		AddToUsages(allocation->second, -static_cast<int64_t>(allocation->second.m_bytes), -1);
+		allocation = m_allocations.erase(allocation);
+	}
+}
+
+void MemoryTracker::AddToUsages(MemoryAllocation const& allocation, int64_t deltaBytes, int deltaAllocations)
+{
+	int categoryIndex = static_cast<int>(allocation.m_category);
+	AddToUsage(m_usages[categoryIndex][static_cast<int>(allocation.m_type)], deltaBytes, deltaAllocations);
+	AddToUsage(m_categoryUsages[categoryIndex], deltaBytes, deltaAllocations);
+	AddToUsage(m_ownerUsages[static_cast<int>(allocation.m_owner)], deltaBytes, deltaAllocations);
+	AddToUsage(m_totalUsage, deltaBytes, deltaAllocations);
+	AddToUsage(m_assetUsages[allocation.m_asset], deltaBytes, deltaAllocations);
+}
+
+// -----------------------------------------------------------------------------
+MemoryUsage MemoryTracker::GetTotalUsage() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_totalUsage;
+}
+
+MemoryUsage MemoryTracker::GetCategoryUsage(MemoryCategory category) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_categoryUsages[static_cast<int>(category)];
+}
+
+MemoryUsage MemoryTracker::GetUsage(MemoryCategory category, MemoryResourceType type) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_usages[static_cast<int>(category)][static_cast<int>(type)];
+}
+
+MemoryUsage MemoryTracker::GetOwnerUsage(MemoryOwner owner) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_ownerUsages[static_cast<int>(owner)];
+}
+
+uint64_t MemoryTracker::GetGPUBytes() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	uint64_t gpuBytes = 0;
+	for (int categoryIndex = 0; categoryIndex < static_cast<int>(MemoryCategory::COUNT); ++categoryIndex)
+	{
+		for (int typeIndex = 0; typeIndex < static_cast<int>(MemoryResourceType::COUNT); ++typeIndex)
+		{
+			if (static_cast<MemoryResourceType>(typeIndex) != MemoryResourceType::CPU_HEAP)
+			{
+				gpuBytes += m_usages[categoryIndex][typeIndex].m_bytes;
+			}
+		}
+	}
+	return gpuBytes;
+}
+
+MemoryUsage MemoryTracker::GetLeakedUsage() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_leakedUsage;
+}
+
+std::vector<MemoryAssetUsage> MemoryTracker::GetAssetUsages() const
+{
+	std::vector<MemoryAssetUsage> assetUsages;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		assetUsages.reserve(m_assetUsages.size());
+		for (auto const& assetUsage : m_assetUsages)
+		{
+			assetUsages.push_back(MemoryAssetUsage{ assetUsage.first, assetUsage.second });
+		}
+	}
+
+	// Ties broken by name so reports diff cleanly from run to run
+	std::sort(assetUsages.begin(), assetUsages.end(), [](MemoryAssetUsage const& usageA, MemoryAssetUsage const& usageB)
+	{
+		if (usageA.m_usage.m_bytes != usageB.m_usage.m_bytes)
+		{
+			return usageA.m_usage.m_bytes > usageB.m_usage.m_bytes;
+		}
+		if (usageA.m_usage.m_peakBytes != usageB.m_usage.m_peakBytes)
+		{
+			return usageA.m_usage.m_peakBytes > usageB.m_usage.m_peakBytes;
+		}
+		return usageA.m_asset < usageB.m_asset;
+	});
+	return assetUsages;
+}
+
+void MemoryTracker::ResetPeaks()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (int categoryIndex = 0; categoryIndex < static_cast<int>(MemoryCategory::COUNT); ++categoryIndex)
+	{
+		for (int typeIndex = 0; typeIndex < static_cast<int>(MemoryResourceType::COUNT); ++typeIndex)
+		{
+			m_usages[categoryIndex][typeIndex].m_peakBytes = m_usages[categoryIndex][typeIndex].m_bytes;
+		}
+		m_categoryUsages[categoryIndex].m_peakBytes = m_categoryUsages[categoryIndex].m_bytes;
+	}
+	for (int ownerIndex = 0; ownerIndex < static_cast<int>(MemoryOwner::COUNT); ++ownerIndex)
+	{
+		m_ownerUsages[ownerIndex].m_peakBytes = m_ownerUsages[ownerIndex].m_bytes;
+	}
+	m_totalUsage.m_peakBytes = m_totalUsage.m_bytes;
+	for (auto& assetUsage : m_assetUsages)
+	{
+		assetUsage.second.m_peakBytes = assetUsage.second.m_bytes;
+	}
+}
+
+int MemoryTracker::CheckForLeaks(std::vector<MemoryAllocation>& out_leaks)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	int numLeaks = 0;
+	for (auto allocation = m_allocations.begin(); allocation != m_allocations.end();)
+	{
+		if (allocation->second.m_owner != MemoryOwner::GAME)
+		{
+			++allocation;
+			continue;
+		}
+		out_leaks.push_back(allocation->second);
+		AddToUsages(allocation->second, -static_cast<int64_t>(allocation->second.m_bytes), -1);
+		AddToUsage(m_leakedUsage, static_cast<int64_t>(allocation->second.m_bytes), 1);
+		allocation = m_allocations.erase(allocation);
+		++numLeaks;
+	}
+
+	std::sort(out_leaks.end() - numLeaks, out_leaks.end(), [](MemoryAllocation const& leakA, MemoryAllocation const& leakB)
+	{
+		return leakA.m_bytes > leakB.m_bytes;
+	});
+	return numLeaks;
+}
+
+// -----------------------------------------------------------------------------
+std::string MemoryTracker::GetReportJSON() const
+{
+	std::vector<MemoryAssetUsage> assetUsages = GetAssetUsages();
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::string json = "{\n";
+	json += Stringf("\t\"processBytes\": %llu,\n", GetProcessMemoryBytes());
+	json += Stringf("\t\"total\": %s,\n", GetUsageJSON(m_totalUsage).c_str());
+	json += Stringf("\t\"leaked\": %s,\n", GetUsageJSON(m_leakedUsage).c_str());
+	json += "\t\"owners\": {";
+	for (int ownerIndex = 0; ownerIndex < static_cast<int>(MemoryOwner::COUNT); ++ownerIndex)
+	{
+		json += Stringf("%s\n\t\t\"%s\": %s", (ownerIndex > 0) ? "," : "", GetOwnerName(static_cast<MemoryOwner>(ownerIndex)), GetUsageJSON(m_ownerUsages[ownerIndex]).c_str());
+	}
+	json += "\n\t},\n";
+	json += "\t\"categories\": {\n";
+	for (int categoryIndex = 0; categoryIndex < static_cast<int>(MemoryCategory::COUNT); ++categoryIndex)
+	{
+		MemoryUsage const& categoryUsage = m_categoryUsages[categoryIndex];
+		json += Stringf("\t\t\"%s\": { \"bytes\": %llu, \"peakBytes\": %llu, \"allocations\": %d, \"types\": {", GetCategoryName(static_cast<MemoryCategory>(categoryIndex)),
+			static_cast<unsigned long long>(categoryUsage.m_bytes), static_cast<unsigned long long>(categoryUsage.m_peakBytes), categoryUsage.m_numAllocations);
+		for (int typeIndex = 0; typeIndex < static_cast<int>(MemoryResourceType::COUNT); ++typeIndex)
+		{
+			json += Stringf("%s\n\t\t\t\"%s\": %s", (typeIndex > 0) ? "," : "", GetResourceTypeName(static_cast<MemoryResourceType>(typeIndex)),
+				GetUsageJSON(m_usages[categoryIndex][typeIndex]).c_str());
+		}
+		json += Stringf("\n\t\t} }%s\n", (categoryIndex + 1 < static_cast<int>(MemoryCategory::COUNT)) ? "," : "");
+	}
+	json += "\t},\n";
+	json += "\t\"assets\": [";
+	for (int assetIndex = 0; assetIndex < static_cast<int>(assetUsages.size()); ++assetIndex)
+	{
+		MemoryUsage const& assetUsage = assetUsages[assetIndex].m_usage;
+		json += Stringf("%s\n\t\t{ \"asset\": %s, \"bytes\": %llu, \"peakBytes\": %llu, \"allocations\": %d }", (assetIndex > 0) ? "," : "", GetJSONString(assetUsages[assetIndex].m_asset).c_str(),
+			static_cast<unsigned long long>(assetUsage.m_bytes), static_cast<unsigned long long>(assetUsage.m_peakBytes), assetUsage.m_numAllocations);
+	}
+	json += assetUsages.empty() ? "]\n" : "\n\t]\n";
+	json += "}\n";
+	return json;
+}
+
+bool MemoryTracker::WriteReportJSON(std::string const& jsonFile, std::string& out_errorMessage) const
+{
+	std::string json = GetReportJSON();
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, jsonFile.c_str(), "wb") != 0)
+	{
+		file = nullptr;
+	}
+#else
+	file = fopen(jsonFile.c_str(), "wb");
+#endif
+	if (file == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\" for writing", jsonFile.c_str());
+		return false;
+	}
+	bool isWritten = fwrite(json.data(), 1, json.size(), file) == json.size();
+	fclose(file);
+	if (!isWritten)
+	{
+		out_errorMessage = Stringf("could not write \"%s\"", jsonFile.c_str());
+	}
+	return isWritten;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class MemoryCategory
+{
+	MESH,			// Model geometry and everything derived from it (clusters, streamed chunks)
+	TEXTURE,
+	SHADER,
+	GRID,
+	DEBUG,			// Measurement and section tools
+	TRANSIENT,		// Per-frame scratch and constant buffers
+	COUNT,
+};
+// -----------------------------------------------------------------------------
+enum class MemoryResourceType
+{
+	CPU_HEAP,
+	VERTEX_BUFFER,
+	INDEX_BUFFER,
+	CONSTANT_BUFFER,
+	TEXTURE,
+	SHADER,
+	COUNT,
+};
+// -----------------------------------------------------------------------------
+enum class MemoryOwner
+{
+	GAME,			// Released by Game::Shutdown; anything left afterwards leaked
+	RENDERER_CACHE,	// Textures and shaders the renderer caches by name and keeps until it shuts down
+	COUNT,
+};
+// -----------------------------------------------------------------------------
+struct MemoryUsage
+{
+	uint64_t	m_bytes = 0;
+	uint64_t	m_peakBytes = 0;
+	int			m_numAllocations = 0;
+};
+// -----------------------------------------------------------------------------
+struct MemoryAllocation
+{
+	void const*			m_resource = nullptr;
+	MemoryCategory		m_category = MemoryCategory::TRANSIENT;
+	MemoryResourceType	m_type = MemoryResourceType::CPU_HEAP;
+	MemoryOwner			m_owner = MemoryOwner::GAME;
+	uint64_t			m_bytes = 0;
+	std::string			m_asset;
+};
+// -----------------------------------------------------------------------------
+struct MemoryAssetUsage
+{
+	std::string	m_asset;
+	MemoryUsage	m_usage;
+};
+// -----------------------------------------------------------------------------
+// Process-wide accounting of the memory the game owns, keyed by the resource that holds it (a
+// buffer, texture, or container) and tagged with a category and the asset it was made for.
+// Nothing here allocates for the caller; owners report what they hold when it changes. The
+// tracker outlives game restarts, so anything the game still owns after it shuts down leaked;
+// the renderer cache is reported apart, since it keeps what it loaded across restarts.
+// -----------------------------------------------------------------------------
+class MemoryTracker
+{
+public:
+	// Records or resizes the allocation held by resource; zero bytes releases it
+	void Track(void const* resource, MemoryCategory category, MemoryResourceType type, uint64_t bytes, std::string const& asset, MemoryOwner owner = MemoryOwner::GAME);
+	void Release(void const* resource);
+	void ReleaseOwner(MemoryOwner owner);
+
+	template <typename T>
+	void TrackVector(std::vector<T> const& vector, MemoryCategory category, std::string const& asset)
+	{
+		Track(&vector, category, MemoryResourceType::CPU_HEAP, static_cast<uint64_t>(vector.capacity()) * sizeof(T), asset);
+	}
+
+	MemoryUsage GetTotalUsage() const;
+	MemoryUsage GetCategoryUsage(MemoryCategory category) const;
+	MemoryUsage GetUsage(MemoryCategory category, MemoryResourceType type) const;
+	MemoryUsage GetOwnerUsage(MemoryOwner owner) const;
+	uint64_t	GetGPUBytes() const;
+	MemoryUsage GetLeakedUsage() const;
+	std::vector<MemoryAssetUsage> GetAssetUsages() const;		// Largest first
+	void ResetPeaks();
+
+	// Moves every live allocation the game owns into out_leaks and stops tracking it; returns how many there were
+	int CheckForLeaks(std::vector<MemoryAllocation>& out_leaks);
+
+	std::string GetReportJSON() const;
+	bool WriteReportJSON(std::string const& jsonFile, std::string& out_errorMessage) const;
+
+	static char const* GetCategoryName(MemoryCategory category);
+	static char const* GetResourceTypeName(MemoryResourceType type);
+	static char const* GetOwnerName(MemoryOwner owner);
+
+private:
+	void AddToUsages(MemoryAllocation const& allocation, int64_t deltaBytes, int deltaAllocations);
+
+private:
+	mutable std::mutex										m_mutex;
+	std::unordered_map<void const*, MemoryAllocation>		m_allocations;
+	std::unordered_map<std::string, MemoryUsage>			m_assetUsages;
+	MemoryUsage m_usages[static_cast<int>(MemoryCategory::COUNT)][static_cast<int>(MemoryResourceType::COUNT)];
+	MemoryUsage m_categoryUsages[static_cast<int>(MemoryCategory::COUNT)];
+	MemoryUsage m_ownerUsages[static_cast<int>(MemoryOwner::COUNT)];
+	MemoryUsage m_totalUsage;
+	MemoryUsage m_leakedUsage;
+};
+// -----------------------------------------------------------------------------
+MemoryTracker& GetMemoryTracker();
@@ -0,0 +1,833 @@
+#include "Game/MeshAnalyzer.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Game/JsonValue.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <atomic>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+// Reductions split their range into blocks of this size, each with its own partial result. The size is
+// fixed rather than derived from the thread count, so even the per-block cache simulation is reproducible.
+constexpr int ITEMS_PER_BLOCK = 65536;
+
+// Digit width of each radix sort pass
+constexpr int RADIX_BITS = 11;
+constexpr int RADIX_SIZE = 1 << RADIX_BITS;
+
+// Post-transform vertex cache simulated for the ACMR and ATVR reuse statistics
+constexpr int VERTEX_CACHE_SIZE = 32;
+
+// Direct-mapped table remembering when each recently missed vertex entered the cache, so most lookups skip
+// the compare against the whole cache. Must be a power of two.
+constexpr int VERTEX_CACHE_LOOKUP_SIZE = 256;
+
+// A triangle counts as zero area when its height is below this fraction of its longest edge
+constexpr double ZERO_AREA_RELATIVE_HEIGHT = 1e-6;
+constexpr float ZERO_LENGTH_SQUARED = 1e-12f;
+
+// -----------------------------------------------------------------------------
+static char const* s_meshAttributeNames[static_cast<int>(MeshAttribute::COUNT)] = { "position", "uv", "tangent", "bitangent", "normal" };
+
+// -----------------------------------------------------------------------------
+bool MeshAnalysis::HasErrors() const
+{
+	if (m_numOutOfRangeTriangles > 0)
+	{
+		return true;
+	}
+	for (int attributeIndex = 0; attributeIndex < static_cast<int>(MeshAttribute::COUNT); ++attributeIndex)
+	{
+		if (m_attributeIssues[attributeIndex].m_numNaN > 0 || m_attributeIssues[attributeIndex].m_numInfinite > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+char const* GetMeshAttributeName(MeshAttribute attribute)
+{
+	return s_meshAttributeNames[static_cast<int>(attribute)];
+}
+
+// -----------------------------------------------------------------------------
+// Runs task over fixed blocks of [0, numItems) in parallel, giving each block its own partial result to fill in
+template <typename PartialType, typename TaskType>
+static void ParallelReduce(int numItems, std::vector<PartialType>& out_partials, TaskType const& task)
+{
+	int numBlocks = std::max(1, (numItems + ITEMS_PER_BLOCK - 1) / ITEMS_PER_BLOCK);
+	out_partials.assign(numBlocks, PartialType());
+	ParallelFor(numBlocks, 1, [&](int beginBlock, int endBlock)
+	{
+		for (int blockIndex = beginBlock; blockIndex < endBlock; ++blockIndex)
+		{
+			int beginIndex = blockIndex * ITEMS_PER_BLOCK;
+			int endIndex = std::min(numItems, beginIndex + ITEMS_PER_BLOCK);
+			task(beginIndex, endIndex, out_partials[blockIndex]);
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+static void ClassifyFloat(float value, MeshAttributeIssues& issues)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t exponent = (bits >> 23) & 0xFF;
+	uint32_t mantissa = bits & 0x7FFFFF;
+	if (exponent == 0xFF)
+	{
+		if (mantissa != 0)
+		{
+			++issues.m_numNaN;
+		}
+		else
+		{
+			++issues.m_numInfinite;
+		}
+	}
+	else if (exponent == 0 && mantissa != 0)
+	{
+		++issues.m_numDenormal;
+	}
+}
+
+static void ClassifyVec3(Vec3 const& value, MeshAttributeIssues& issues)
+{
+	ClassifyFloat(value.x, issues);
+	ClassifyFloat(value.y, issues);
+	ClassifyFloat(value.z, issues);
+}
+
+// True for exactly the values ClassifyFloat counts: NaN, infinite or denormal
+static bool IsSpecialFloat(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t magnitude = bits & 0x7FFFFFFFu;
+	return magnitude != 0 && magnitude - 0x00800000u >= 0x7F000000u;
+}
+
+// Branch-free check of every attribute, so clean verts skip the per-value classification
+static bool HasSpecialFloats(Vertex_PCUTBN const& vert)
+{
+	return IsSpecialFloat(vert.m_position.x) | IsSpecialFloat(vert.m_position.y) | IsSpecialFloat(vert.m_position.z)
+		| IsSpecialFloat(vert.m_uvTexCoords.x) | IsSpecialFloat(vert.m_uvTexCoords.y)
+		| IsSpecialFloat(vert.m_tangent.x) | IsSpecialFloat(vert.m_tangent.y) | IsSpecialFloat(vert.m_tangent.z)
+		| IsSpecialFloat(vert.m_bitangent.x) | IsSpecialFloat(vert.m_bitangent.y) | IsSpecialFloat(vert.m_bitangent.z)
+		| IsSpecialFloat(vert.m_normal.x) | IsSpecialFloat(vert.m_normal.y) | IsSpecialFloat(vert.m_normal.z);
+}
+
+// -----------------------------------------------------------------------------
+// Positions are welded on their exact bits, with -0 folded into +0 so the two compare equal
+struct PositionKey
+{
+	uint32_t m_bits[3];
+
+	bool operator==(PositionKey const& other) const { return m_bits[0] == other.m_bits[0] && m_bits[1] == other.m_bits[1] && m_bits[2] == other.m_bits[2]; }
+};
+
+static PositionKey GetPositionKey(Vec3 const& position)
+{
+	PositionKey key;
+	float const components[3] = { position.x, position.y, position.z };
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		memcpy(&key.m_bits[axis], &components[axis], sizeof(uint32_t));
+		if (key.m_bits[axis] == 0x80000000u)
+		{
+			key.m_bits[axis] = 0;
+		}
+	}
+	return key;
+}
+
+static uint32_t HashPositionKey(PositionKey const& key)
+{
+	// Float bits of nearby positions differ mostly in their high bits, so every step mixes high into low
+	uint32_t hash = 0x811C9DC5u;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		hash = (hash ^ key.m_bits[axis]) * 0x85EBCA6Bu;
+		hash ^= hash >> 13;
+	}
+	hash *= 0xC2B2AE35u;
+	return hash ^ (hash >> 16);
+}
+
+// -----------------------------------------------------------------------------
+struct VertexScanPartial
+{
+	Vec3				m_mins = Vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vec3				m_maxs = Vec3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	Vec2				m_uvMins = Vec2(FLT_MAX, FLT_MAX);
+	Vec2				m_uvMaxs = Vec2(-FLT_MAX, -FLT_MAX);
+	int					m_numVertsOutsideUnitUVs = 0;
+	MeshAttributeIssues	m_attributeIssues[static_cast<int>(MeshAttribute::COUNT)];
+	int					m_numZeroLengthNormals = 0;
+	int					m_numZeroLengthTangents = 0;
+};
+
+struct TriangleScanPartial
+{
+	int					m_numOutOfRangeTriangles = 0;
+	int					m_numRepeatedIndexTriangles = 0;
+	int					m_numCollapsedTriangles = 0;
+	int					m_numZeroAreaTriangles = 0;
+	int64_t				m_numCacheMisses = 0;
+};
+
+struct TopologyScanPartial
+{
+	int					m_numUniquePositions = 0;
+	int					m_numUnreferencedVerts = 0;
+	int					m_numDuplicateTriangles = 0;
+	int					m_numEdges = 0;
+	int					m_numBoundaryEdges = 0;
+	int					m_numNonManifoldEdges = 0;
+	int					m_numInconsistentlyWoundEdges = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Stable LSD radix sort on bits [firstBit, endBit) of each key. Every pass counts and scatters the same
+// fixed blocks, each into its own slice of every digit's range, so the order never depends on the threads.
+static void RadixSortKeys(std::vector<uint64_t>& keys, int firstBit, int endBit)
+{
+	int numKeys = static_cast<int>(keys.size());
+	int numBlocks = std::max(1, (numKeys + ITEMS_PER_BLOCK - 1) / ITEMS_PER_BLOCK);
+	std::vector<uint64_t> sortedKeys(numKeys);
+	std::vector<uint32_t> blockOffsets(static_cast<size_t>(numBlocks) * RADIX_SIZE);
+
+	for (int shift = firstBit; shift < endBit; shift += RADIX_BITS)
+	{
+		uint64_t digitMask = (1ull << std::min(RADIX_BITS, endBit - shift)) - 1;
+		ParallelFor(numBlocks, 1, [&](int beginBlock, int endBlock)
+		{
+			for (int blockIndex = beginBlock; blockIndex < endBlock; ++blockIndex)
+			{
+				uint32_t* counts = &blockOffsets[static_cast<size_t>(blockIndex) * RADIX_SIZE];
+				std::fill(counts, counts + RADIX_SIZE, 0u);
+				int endIndex = std::min(numKeys, (blockIndex + 1) * ITEMS_PER_BLOCK);
+				for (int keyIndex = blockIndex * ITEMS_PER_BLOCK; keyIndex < endIndex; ++keyIndex)
+				{
+					++counts[(keys[keyIndex] >> shift) & digitMask];
+				}
+			}
+		});
+
+		uint32_t total = 0;
+		for (int digit = 0; digit < RADIX_SIZE; ++digit)
+		{
+			for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+			{
+				uint32_t& offset = blockOffsets[static_cast<size_t>(blockIndex) * RADIX_SIZE + digit];
+				uint32_t count = offset;
+				offset = total;
+				total += count;
+			}
+		}
+
+		ParallelFor(numBlocks, 1, [&](int beginBlock, int endBlock)
+		{
+			for (int blockIndex = beginBlock; blockIndex < endBlock; ++blockIndex)
+			{
+				uint32_t* offsets = &blockOffsets[static_cast<size_t>(blockIndex) * RADIX_SIZE];
+				int endIndex = std::min(numKeys, (blockIndex + 1) * ITEMS_PER_BLOCK);
+				for (int keyIndex = blockIndex * ITEMS_PER_BLOCK; keyIndex < endIndex; ++keyIndex)
+				{
+					uint64_t key = keys[keyIndex];
+					sortedKeys[offsets[(key >> shift) & digitMask]++] = key;
+				}
+			}
+		});
+		keys.swap(sortedKeys);
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Checks every attribute and welds positions into out_canonicalVerts, where each vertex maps to the
+// lowest-indexed vertex with its position. Verts are radix sorted by position hash (stable, so each
+// hash run is in index order) and only verts within a run ever compare positions.
+static void ScanVerts(MeshAnalysis& out_analysis, std::vector<Vertex_PCUTBN> const& verts, std::vector<uint32_t>& out_canonicalVerts)
+{
+	int numVerts = static_cast<int>(verts.size());
+	out_canonicalVerts.resize(numVerts);
+
+	// (position hash << 32 | vertex index)
+	std::vector<uint64_t> weldKeys(numVerts);
+
+	std::vector<VertexScanPartial> partials;
+	ParallelReduce(numVerts, partials, [&](int beginIndex, int endIndex, VertexScanPartial& partial)
+	{
+		for (int vertIndex = beginIndex; vertIndex < endIndex; ++vertIndex)
+		{
+			Vertex_PCUTBN const& vert = verts[vertIndex];
+			Vec3 const& position = vert.m_position;
+			Vec2 const& uv = vert.m_uvTexCoords;
+
+			if (HasSpecialFloats(vert))
+			{
+				ClassifyVec3(position, partial.m_attributeIssues[static_cast<int>(MeshAttribute::POSITION)]);
+				ClassifyFloat(uv.x, partial.m_attributeIssues[static_cast<int>(MeshAttribute::UV)]);
+				ClassifyFloat(uv.y, partial.m_attributeIssues[static_cast<int>(MeshAttribute::UV)]);
+				ClassifyVec3(vert.m_tangent, partial.m_attributeIssues[static_cast<int>(MeshAttribute::TANGENT)]);
+				ClassifyVec3(vert.m_bitangent, partial.m_attributeIssues[static_cast<int>(MeshAttribute::BITANGENT)]);
+				ClassifyVec3(vert.m_normal, partial.m_attributeIssues[static_cast<int>(MeshAttribute::NORMAL)]);
+			}
+
+			if (isfinite(position.x) && isfinite(position.y) && isfinite(position.z))
+			{
+				partial.m_mins = Vec3(std::min(partial.m_mins.x, position.x), std::min(partial.m_mins.y, position.y), std::min(partial.m_mins.z, position.z));
+				partial.m_maxs = Vec3(std::max(partial.m_maxs.x, position.x), std::max(partial.m_maxs.y, position.y), std::max(partial.m_maxs.z, position.z));
+			}
+			if (isfinite(uv.x) && isfinite(uv.y))
+			{
+				partial.m_uvMins = Vec2(std::min(partial.m_uvMins.x, uv.x), std::min(partial.m_uvMins.y, uv.y));
+				partial.m_uvMaxs = Vec2(std::max(partial.m_uvMaxs.x, uv.x), std::max(partial.m_uvMaxs.y, uv.y));
+				if (uv.x < 0.f || uv.x > 1.f || uv.y < 0.f || uv.y > 1.f)
+				{
+					++partial.m_numVertsOutsideUnitUVs;
+				}
+			}
+			if (vert.m_normal.GetLengthSquared() <= ZERO_LENGTH_SQUARED)
+			{
+				++partial.m_numZeroLengthNormals;
+			}
+			if (vert.m_tangent.GetLengthSquared() <= ZERO_LENGTH_SQUARED)
+			{
+				++partial.m_numZeroLengthTangents;
+			}
+
+			weldKeys[vertIndex] = (static_cast<uint64_t>(HashPositionKey(GetPositionKey(position))) << 32) | static_cast<uint32_t>(vertIndex);
+		}
+	});
+
+	RadixSortKeys(weldKeys, 32, 64);
+
+	// Blocks start at the first hash run beginning inside them and finish the last run they begin
+	ParallelFor(numVerts, ITEMS_PER_BLOCK, [&](int beginIndex, int endIndex)
+	{
+		// Distinct positions seen in the current run; more than one only on a hash collision
+		std::vector<PositionKey> runPositions;
+		std::vector<uint32_t> runOwners;
+
+		int keyIndex = beginIndex;
+		while (keyIndex > 0 && keyIndex < numVerts && (weldKeys[keyIndex] >> 32) == (weldKeys[keyIndex - 1] >> 32))
+		{
+			++keyIndex;
+		}
+		while (keyIndex < endIndex)
+		{
+			uint32_t runHash = static_cast<uint32_t>(weldKeys[keyIndex] >> 32);
+			uint32_t firstVertIndex = static_cast<uint32_t>(weldKeys[keyIndex]);
+			out_canonicalVerts[firstVertIndex] = firstVertIndex;
+			++keyIndex;
+			if (keyIndex == numVerts || static_cast<uint32_t>(weldKeys[keyIndex] >> 32) != runHash)
+			{
+				continue;
+			}
+
+			runPositions.assign(1, GetPositionKey(verts[firstVertIndex].m_position));
+			runOwners.assign(1, firstVertIndex);
+			for (; keyIndex < numVerts && static_cast<uint32_t>(weldKeys[keyIndex] >> 32) == runHash; ++keyIndex)
+			{
+				uint32_t vertIndex = static_cast<uint32_t>(weldKeys[keyIndex]);
+				PositionKey key = GetPositionKey(verts[vertIndex].m_position);
+				int ownerIndex = 0;
+				while (ownerIndex < static_cast<int>(runPositions.size()) && !(runPositions[ownerIndex] == key))
+				{
+					++ownerIndex;
+				}
+				if (ownerIndex == static_cast<int>(runPositions.size()))
+				{
+					runPositions.push_back(key);
+					runOwners.push_back(vertIndex);
+				}
+				out_canonicalVerts[vertIndex] = runOwners[ownerIndex];
+			}
+		}
+	});
+
+	Vec3 mins(FLT_MAX, FLT_MAX, FLT_MAX);
+	Vec3 maxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	Vec2 uvMins(FLT_MAX, FLT_MAX);
+	Vec2 uvMaxs(-FLT_MAX, -FLT_MAX);
+	for (int blockIndex = 0; blockIndex < static_cast<int>(partials.size()); ++blockIndex)
+	{
+		VertexScanPartial const& partial = partials[blockIndex];
+		mins = Vec3(std::min(mins.x, partial.m_mins.x), std::min(mins.y, partial.m_mins.y), std::min(mins.z, partial.m_mins.z));
+		maxs = Vec3(std::max(maxs.x, partial.m_maxs.x), std::max(maxs.y, partial.m_maxs.y), std::max(maxs.z, partial.m_maxs.z));
+		uvMins = Vec2(std::min(uvMins.x, partial.m_uvMins.x), std::min(uvMins.y, partial.m_uvMins.y));
+		uvMaxs = Vec2(std::max(uvMaxs.x, partial.m_uvMaxs.x), std::max(uvMaxs.y, partial.m_uvMaxs.y));
+		out_analysis.m_numVertsOutsideUnitUVs += partial.m_numVertsOutsideUnitUVs;
+		out_analysis.m_numZeroLengthNormals += partial.m_numZeroLengthNormals;
+		out_analysis.m_numZeroLengthTangents += partial.m_numZeroLengthTangents;
+		for (int attributeIndex = 0; attributeIndex < static_cast<int>(MeshAttribute::COUNT); ++attributeIndex)
+		{
+			out_analysis.m_attributeIssues[attributeIndex].m_numNaN += partial.m_attributeIssues[attributeIndex].m_numNaN;
+			out_analysis.m_attributeIssues[attributeIndex].m_numInfinite += partial.m_attributeIssues[attributeIndex].m_numInfinite;
+			out_analysis.m_attributeIssues[attributeIndex].m_numDenormal += partial.m_attributeIssues[attributeIndex].m_numDenormal;
+		}
+	}
+
+	// With no finite values at all the ranges collapse to zero rather than reporting FLT_MAX
+	out_analysis.m_bounds = (mins.x <= maxs.x) ? AABB3(mins, maxs) : AABB3(Vec3(), Vec3());
+	out_analysis.m_uvMins = (uvMins.x <= uvMaxs.x) ? uvMins : Vec2();
+	out_analysis.m_uvMaxs = (uvMins.x <= uvMaxs.x) ? uvMaxs : Vec2();
+}
+
+// -----------------------------------------------------------------------------
+static bool IsZeroAreaTriangle(Vec3 const& a, Vec3 const& b, Vec3 const& c)
+{
+	double abX = static_cast<double>(b.x) - a.x, abY = static_cast<double>(b.y) - a.y, abZ = static_cast<double>(b.z) - a.z;
+	double acX = static_cast<double>(c.x) - a.x, acY = static_cast<double>(c.y) - a.y, acZ = static_cast<double>(c.z) - a.z;
+	double bcX = acX - abX, bcY = acY - abY, bcZ = acZ - abZ;
+	double crossX = abY * acZ - abZ * acY;
+	double crossY = abZ * acX - abX * acZ;
+	double crossZ = abX * acY - abY * acX;
+	double twiceAreaSquared = crossX * crossX + crossY * crossY + crossZ * crossZ;
+	double longestEdgeSquared = std::max(abX * abX + abY * abY + abZ * abZ, std::max(acX * acX + acY * acY + acZ * acZ, bcX * bcX + bcY * bcY + bcZ * bcZ));
+
+	// Twice the area is the longest edge times the height on it
+	return twiceAreaSquared <= ZERO_AREA_RELATIVE_HEIGHT * ZERO_AREA_RELATIVE_HEIGHT * longestEdgeSquared * longestEdgeSquared;
+}
+
+// -----------------------------------------------------------------------------
+// Each valid triangle stores its three edges at their lower welded vertex, as
+// (upper vertex << 33 | opposite vertex << 2 | is the triangle's low-middle edge << 1 | runs lower-to-upper).
+// A triangle's low-middle edge names all three of its corners, so duplicate triangles come out of the same
+// sorted per-vertex list as the edges do.
+struct MeshTopology
+{
+	std::vector<uint32_t>	m_edgeOffsets;
+	std::vector<uint64_t>	m_edges;
+};
+
+// Also reports whether the winding visits the corners as low, middle, high (in some rotation)
+static void GetSortedCorners(uint32_t const corners[3], uint32_t& out_low, uint32_t& out_middle, uint32_t& out_high, bool& out_isLowMiddleHighWinding)
+{
+	out_low = std::min(corners[0], std::min(corners[1], corners[2]));
+	out_high = std::max(corners[0], std::max(corners[1], corners[2]));
+	out_middle = corners[0] ^ corners[1] ^ corners[2] ^ out_low ^ out_high;
+	out_isLowMiddleHighWinding = (corners[0] == out_low) ? (corners[1] == out_middle) : (corners[1] == out_low) ? (corners[2] == out_middle) : (corners[0] == out_middle);
+}
+
+static uint64_t GetEdgeEntry(uint32_t upper, uint32_t opposite, bool isLowMiddleEdge, bool isForward)
+{
+	return (static_cast<uint64_t>(upper) << 33) | (static_cast<uint64_t>(opposite) << 2) | (isLowMiddleEdge ? 2u : 0u) | (isForward ? 1u : 0u);
+}
+
+static void PrefixSumCounts(std::vector<std::atomic<uint32_t>>& counts, std::vector<uint32_t>& out_offsets)
+{
+	int numCounts = static_cast<int>(counts.size());
+	out_offsets.resize(numCounts + 1);
+	uint32_t total = 0;
+	for (int countIndex = 0; countIndex < numCounts; ++countIndex)
+	{
+		out_offsets[countIndex] = total;
+		total += counts[countIndex].load(std::memory_order_relaxed);
+		counts[countIndex].store(0, std::memory_order_relaxed);
+	}
+	out_offsets[numCounts] = total;
+}
+
+// -----------------------------------------------------------------------------
+// Classifies every triangle, simulates the vertex cache over the index order, and counting-sorts
+// the edges of the valid ones into per-vertex lists
+static void ScanTriangles(MeshAnalysis& out_analysis, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices,
+	std::vector<uint32_t> const& canonicalVerts, std::vector<std::atomic<unsigned char>>& out_isVertReferenced, MeshTopology& out_topology)
+{
+	int numVerts = static_cast<int>(verts.size());
+	int numTriangles = static_cast<int>(indices.size() / 3);
+	std::vector<unsigned char> isTriangleValid(numTriangles, 0);
+
+	// Counts double as scatter cursors once they have been turned into offsets
+	std::vector<std::atomic<uint32_t>> edgeCounts(numVerts);
+
+	std::vector<TriangleScanPartial> partials;
+	ParallelReduce(numTriangles, partials, [&](int beginIndex, int endIndex, TriangleScanPartial& partial)
+	{
+		// Each block starts with a cold cache, as if it were its own draw
+		uint32_t cache[VERTEX_CACHE_SIZE];
+		std::fill(cache, cache + VERTEX_CACHE_SIZE, 0xFFFFFFFFu);
+		int cacheHead = 0;
+		uint32_t numBlockCacheMisses = 0;
+		uint32_t lookupVerts[VERTEX_CACHE_LOOKUP_SIZE];
+		uint32_t lookupMissNumbers[VERTEX_CACHE_LOOKUP_SIZE];
+		std::fill(lookupVerts, lookupVerts + VERTEX_CACHE_LOOKUP_SIZE, 0xFFFFFFFFu);
+
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; ++triangleIndex)
+		{
+			uint32_t const* corners = &indices[static_cast<size_t>(triangleIndex) * 3];
+			if (corners[0] >= static_cast<uint32_t>(numVerts) || corners[1] >= static_cast<uint32_t>(numVerts) || corners[2] >= static_cast<uint32_t>(numVerts))
+			{
+				++partial.m_numOutOfRangeTriangles;
+				continue;
+			}
+
+			for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+			{
+				uint32_t vertIndex = corners[cornerIndex];
+				out_isVertReferenced[vertIndex].store(1, std::memory_order_relaxed);
+
+				// A vertex still in the lookup entered the cache at its last miss, and stays for VERTEX_CACHE_SIZE more misses.
+				// Otherwise it may have been bumped from the lookup, so check the cache itself.
+				uint32_t lookupSlot = vertIndex & (VERTEX_CACHE_LOOKUP_SIZE - 1);
+				bool isCached = false;
+				if (lookupVerts[lookupSlot] == vertIndex)
+				{
+					isCached = numBlockCacheMisses - lookupMissNumbers[lookupSlot] <= static_cast<uint32_t>(VERTEX_CACHE_SIZE);
+				}
+				else
+				{
+					// Branch-free so the compare over the whole cache vectorizes
+					int numCacheMatches = 0;
+					for (int cacheIndex = 0; cacheIndex < VERTEX_CACHE_SIZE; ++cacheIndex)
+					{
+						numCacheMatches += (cache[cacheIndex] == vertIndex) ? 1 : 0;
+					}
+					isCached = numCacheMatches > 0;
+				}
+				if (!isCached)
+				{
+					++partial.m_numCacheMisses;
+					cache[cacheHead] = vertIndex;
+					cacheHead = (cacheHead + 1) % VERTEX_CACHE_SIZE;
+					lookupVerts[lookupSlot] = vertIndex;
+					lookupMissNumbers[lookupSlot] = numBlockCacheMisses;
+					++numBlockCacheMisses;
+				}
+			}
+
+			if (corners[0] == corners[1] || corners[1] == corners[2] || corners[0] == corners[2])
+			{
+				++partial.m_numRepeatedIndexTriangles;
+				continue;
+			}
+
+			uint32_t const welded[3] = { canonicalVerts[corners[0]], canonicalVerts[corners[1]], canonicalVerts[corners[2]] };
+			if (welded[0] == welded[1] || welded[1] == welded[2] || welded[0] == welded[2])
+			{
+				++partial.m_numCollapsedTriangles;
+				continue;
+			}
+
+			// Slivers are still reported as degenerate, but they stay part of the surface for the edge and duplicate checks
+			if (IsZeroAreaTriangle(verts[corners[0]].m_position, verts[corners[1]].m_position, verts[corners[2]].m_position))
+			{
+				++partial.m_numZeroAreaTriangles;
+			}
+
+			// Low stores the low-middle and low-high edges, middle stores the middle-high one
+			isTriangleValid[triangleIndex] = 1;
+			uint32_t low, middle, high;
+			bool isLowMiddleHighWinding;
+			GetSortedCorners(welded, low, middle, high, isLowMiddleHighWinding);
+			edgeCounts[low].fetch_add(2, std::memory_order_relaxed);
+			edgeCounts[middle].fetch_add(1, std::memory_order_relaxed);
+		}
+	});
+
+	int64_t numCacheMisses = 0;
+	for (int blockIndex = 0; blockIndex < static_cast<int>(partials.size()); ++blockIndex)
+	{
+		TriangleScanPartial const& partial = partials[blockIndex];
+		out_analysis.m_numOutOfRangeTriangles += partial.m_numOutOfRangeTriangles;
+		out_analysis.m_numRepeatedIndexTriangles += partial.m_numRepeatedIndexTriangles;
+		out_analysis.m_numCollapsedTriangles += partial.m_numCollapsedTriangles;
+		out_analysis.m_numZeroAreaTriangles += partial.m_numZeroAreaTriangles;
+		numCacheMisses += partial.m_numCacheMisses;
+	}
+	int numInRangeTriangles = numTriangles - out_analysis.m_numOutOfRangeTriangles;
+	out_analysis.m_averageCacheMissRatio = (numInRangeTriangles > 0) ? static_cast<double>(numCacheMisses) / static_cast<double>(numInRangeTriangles) : 0.0;
+
+	PrefixSumCounts(edgeCounts, out_topology.m_edgeOffsets);
+	out_topology.m_edges.resize(out_topology.m_edgeOffsets.back());
+
+	ParallelFor(numTriangles, ITEMS_PER_BLOCK, [&](int beginIndex, int endIndex)
+	{
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; ++triangleIndex)
+		{
+			if (!isTriangleValid[triangleIndex])
+			{
+				continue;
+			}
+
+			uint32_t const* corners = &indices[static_cast<size_t>(triangleIndex) * 3];
+			uint32_t const welded[3] = { canonicalVerts[corners[0]], canonicalVerts[corners[1]], canonicalVerts[corners[2]] };
+			uint32_t low, middle, high;
+			bool isLowMiddleHighWinding;
+			GetSortedCorners(welded, low, middle, high, isLowMiddleHighWinding);
+
+			// Winding low, middle, high runs the low-middle and middle-high edges forward and the low-high edge backward
+			uint32_t lowSlot = out_topology.m_edgeOffsets[low] + edgeCounts[low].fetch_add(2, std::memory_order_relaxed);
+			uint32_t middleSlot = out_topology.m_edgeOffsets[middle] + edgeCounts[middle].fetch_add(1, std::memory_order_relaxed);
+			out_topology.m_edges[lowSlot] = GetEdgeEntry(middle, high, true, isLowMiddleHighWinding);
+			out_topology.m_edges[lowSlot + 1] = GetEdgeEntry(high, middle, false, !isLowMiddleHighWinding);
+			out_topology.m_edges[middleSlot] = GetEdgeEntry(high, low, false, isLowMiddleHighWinding);
+		}
+	});
+}
+
+// -----------------------------------------------------------------------------
+// Sorts each welded vertex's short edge list, so uses of the same edge sit in runs and copies of the same
+// triangle's low-middle edge sit next to each other
+static void ScanTopology(MeshAnalysis& out_analysis, std::vector<uint32_t> const& canonicalVerts, std::vector<std::atomic<unsigned char>> const& isVertReferenced, MeshTopology& topology)
+{
+	int numVerts = static_cast<int>(canonicalVerts.size());
+	std::vector<TopologyScanPartial> partials;
+	ParallelReduce(numVerts, partials, [&](int beginIndex, int endIndex, TopologyScanPartial& partial)
+	{
+		for (int vertIndex = beginIndex; vertIndex < endIndex; ++vertIndex)
+		{
+			if (isVertReferenced[vertIndex].load(std::memory_order_relaxed) == 0)
+			{
+				++partial.m_numUnreferencedVerts;
+			}
+			if (canonicalVerts[vertIndex] != static_cast<uint32_t>(vertIndex))
+			{
+				continue;
+			}
+			++partial.m_numUniquePositions;
+
+			uint64_t* edgesBegin = topology.m_edges.data() + topology.m_edgeOffsets[vertIndex];
+			uint64_t* edgesEnd = topology.m_edges.data() + topology.m_edgeOffsets[vertIndex + 1];
+			std::sort(edgesBegin, edgesEnd);
+			for (uint64_t* runBegin = edgesBegin; runBegin != edgesEnd; )
+			{
+				uint64_t* runEnd = runBegin;
+				int numForwardUses = 0;
+				while (runEnd != edgesEnd && (*runEnd >> 33) == (*runBegin >> 33))
+				{
+					numForwardUses += static_cast<int>(*runEnd & 1u);
+					if ((*runEnd & 2u) != 0 && runEnd != runBegin && (*runEnd >> 1) == (*(runEnd - 1) >> 1))
+					{
+						++partial.m_numDuplicateTriangles;
+					}
+					++runEnd;
+				}
+
+				int numUses = static_cast<int>(runEnd - runBegin);
+				++partial.m_numEdges;
+				if (numUses == 1)
+				{
+					++partial.m_numBoundaryEdges;
+				}
+				else if (numUses > 2)
+				{
+					++partial.m_numNonManifoldEdges;
+				}
+				else if (numForwardUses != 1)
+				{
+					++partial.m_numInconsistentlyWoundEdges;
+				}
+				runBegin = runEnd;
+			}
+		}
+	});
+
+	for (int blockIndex = 0; blockIndex < static_cast<int>(partials.size()); ++blockIndex)
+	{
+		TopologyScanPartial const& partial = partials[blockIndex];
+		out_analysis.m_numUniquePositions += partial.m_numUniquePositions;
+		out_analysis.m_numUnreferencedVerts += partial.m_numUnreferencedVerts;
+		out_analysis.m_numDuplicateTriangles += partial.m_numDuplicateTriangles;
+		out_analysis.m_numEdges += partial.m_numEdges;
+		out_analysis.m_numBoundaryEdges += partial.m_numBoundaryEdges;
+		out_analysis.m_numNonManifoldEdges += partial.m_numNonManifoldEdges;
+		out_analysis.m_numInconsistentlyWoundEdges += partial.m_numInconsistentlyWoundEdges;
+	}
+}
+
+// -----------------------------------------------------------------------------
+void AnalyzeMesh(MeshAnalysis& out_analysis, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices)
+{
+	double startTime = GetCurrentTimeSeconds();
+	out_analysis = MeshAnalysis();
+	out_analysis.m_numVerts = static_cast<int>(verts.size());
+	out_analysis.m_numTriangles = static_cast<int>(indices.size() / 3);
+	out_analysis.m_numThreads = GetParallelForNumThreads();
+
+	std::vector<uint32_t> canonicalVerts;
+	ScanVerts(out_analysis, verts, canonicalVerts);
+
+	std::vector<std::atomic<unsigned char>> isVertReferenced(verts.size());
+	MeshTopology topology;
+	ScanTriangles(out_analysis, verts, indices, canonicalVerts, isVertReferenced, topology);
+	ScanTopology(out_analysis, canonicalVerts, isVertReferenced, topology);
+
+	int numReferencedVerts = out_analysis.m_numVerts - out_analysis.m_numUnreferencedVerts;
+	if (numReferencedVerts > 0)
+	{
+		int numInRangeTriangles = out_analysis.m_numTriangles - out_analysis.m_numOutOfRangeTriangles;
+		out_analysis.m_indicesPerVertex = static_cast<double>(numInRangeTriangles) * 3.0 / static_cast<double>(numReferencedVerts);
+		out_analysis.m_averageTransformToVertexRatio = out_analysis.m_averageCacheMissRatio * static_cast<double>(numInRangeTriangles) / static_cast<double>(numReferencedVerts);
+	}
+	out_analysis.m_seconds = GetCurrentTimeSeconds() - startTime;
+}
+
+// -----------------------------------------------------------------------------
+std::string GetMeshAnalysisJSON(MeshAnalysis const& analysis, std::string const& sourceName)
+{
+	std::string json = "{\n";
+	json += Stringf("\t\"source\": %s,\n", GetJSONString(sourceName).c_str());
+	json += Stringf("\t\"hasErrors\": %s,\n", analysis.HasErrors() ? "true" : "false");
+	json += Stringf("\t\"verts\": %d,\n", analysis.m_numVerts);
+	json += Stringf("\t\"triangles\": %d,\n", analysis.m_numTriangles);
+	json += Stringf("\t\"uniquePositions\": %d,\n", analysis.m_numUniquePositions);
+	json += Stringf("\t\"unreferencedVerts\": %d,\n", analysis.m_numUnreferencedVerts);
+	json += Stringf("\t\"bounds\": { \"mins\": [%.9g, %.9g, %.9g], \"maxs\": [%.9g, %.9g, %.9g] },\n",
+		analysis.m_bounds.m_mins.x, analysis.m_bounds.m_mins.y, analysis.m_bounds.m_mins.z, analysis.m_bounds.m_maxs.x, analysis.m_bounds.m_maxs.y, analysis.m_bounds.m_maxs.z);
+	json += Stringf("\t\"uvs\": { \"mins\": [%.9g, %.9g], \"maxs\": [%.9g, %.9g], \"vertsOutsideUnitSquare\": %d },\n",
+		analysis.m_uvMins.x, analysis.m_uvMins.y, analysis.m_uvMaxs.x, analysis.m_uvMaxs.y, analysis.m_numVertsOutsideUnitUVs);
+
+	json += "\t\"attributes\": {\n";
+	for (int attributeIndex = 0; attributeIndex < static_cast<int>(MeshAttribute::COUNT); ++attributeIndex)
+	{
+		MeshAttributeIssues const& issues = analysis.m_attributeIssues[attributeIndex];
+		json += Stringf("\t\t\"%s\": { \"nan\": %d, \"infinite\": %d, \"denormal\": %d }%s\n", s_meshAttributeNames[attributeIndex],
+			issues.m_numNaN, issues.m_numInfinite, issues.m_numDenormal, (attributeIndex + 1 < static_cast<int>(MeshAttribute::COUNT)) ? "," : "");
+	}
+	json += "\t},\n";
+	json += Stringf("\t\"zeroLengthNormals\": %d,\n", analysis.m_numZeroLengthNormals);
+	json += Stringf("\t\"zeroLengthTangents\": %d,\n", analysis.m_numZeroLengthTangents);
+
+	json += Stringf("\t\"triangleIssues\": { \"outOfRange\": %d, \"degenerate\": %d, \"repeatedIndex\": %d, \"collapsed\": %d, \"zeroArea\": %d, \"duplicate\": %d },\n",
+		analysis.m_numOutOfRangeTriangles, analysis.GetNumDegenerateTriangles(), analysis.m_numRepeatedIndexTriangles, analysis.m_numCollapsedTriangles,
+		analysis.m_numZeroAreaTriangles, analysis.m_numDuplicateTriangles);
+	json += Stringf("\t\"edges\": { \"total\": %d, \"boundary\": %d, \"nonManifold\": %d, \"inconsistentWinding\": %d },\n",
+		analysis.m_numEdges, analysis.m_numBoundaryEdges, analysis.m_numNonManifoldEdges, analysis.m_numInconsistentlyWoundEdges);
+	json += Stringf("\t\"reuse\": { \"indicesPerVertex\": %.4f, \"acmr\": %.4f, \"atvr\": %.4f, \"cacheSize\": %d },\n",
+		analysis.m_indicesPerVertex, analysis.m_averageCacheMissRatio, analysis.m_averageTransformToVertexRatio, VERTEX_CACHE_SIZE);
+	json += Stringf("\t\"seconds\": %.6f,\n", analysis.m_seconds);
+	json += Stringf("\t\"threads\": %d\n", analysis.m_numThreads);
+	json += "}\n";
+	return json;
+}
+
+bool WriteMeshAnalysisJSON(MeshAnalysis const& analysis, std::string const& sourceName, std::string const& jsonFile)
+{
+	std::string json = GetMeshAnalysisJSON(analysis, sourceName);
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, jsonFile.c_str(), "wb") != 0)
+	{
+		file = nullptr;
+	}
+#else
+	file = fopen(jsonFile.c_str(), "wb");
+#endif
+	if (file == nullptr)
+	{
+		return false;
+	}
+	bool isWritten = fwrite(json.data(), 1, json.size(), file) == json.size();
+	fclose(file);
+	return isWritten;
+}
+
+// -----------------------------------------------------------------------------
+// Splits a command line on spaces, keeping double-quoted runs (e.g. paths with spaces) together
+static std::vector<std::string> SplitCommandLine(std::string const& commandLine)
+{
+	std::vector<std::string> tokens;
+	std::string token;
+	bool isQuoted = false;
+	bool hasToken = false;
+	for (int charIndex = 0; charIndex < static_cast<int>(commandLine.size()); ++charIndex)
+	{
+		char character = commandLine[charIndex];
+		if (character == '"')
+		{
+			isQuoted = !isQuoted;
+			hasToken = true;
+		}
+		else if ((character == ' ' || character == '\t') && !isQuoted)
+		{
+			if (hasToken)
+			{
+				tokens.push_back(token);
+			}
+			token.clear();
+			hasToken = false;
+		}
+		else
+		{
+			token += character;
+			hasToken = true;
+		}
+	}
+	if (hasToken)
+	{
+		tokens.push_back(token);
+	}
+	return tokens;
+}
+
+int RunMeshAnalyzerCommandLine(std::string const& commandLine, std::string& out_report)
+{
+	std::vector<std::string> tokens = SplitCommandLine(commandLine);
+	std::string modelFile;
+	std::string formatName;
+	std::string jsonFile;
+	for (int tokenIndex = 1; tokenIndex < static_cast<int>(tokens.size()); ++tokenIndex)
+	{
+		std::string const& token = tokens[tokenIndex];
+		size_t equalsIndex = token.find('=');
+		std::string key = token.substr(0, equalsIndex);
+		std::string value = (equalsIndex != std::string::npos) ? token.substr(equalsIndex + 1) : "";
+		if (key == "file")
+		{
+			modelFile = value;
+		}
+		else if (key == "format")
+		{
+			formatName = value;
+		}
+		else if (key == "json")
+		{
+			jsonFile = value;
+		}
+		else
+		{
+			out_report = Stringf("AnalyzeMesh: unknown argument \"%s\"; usage: AnalyzeMesh file=<model> [format=<name>] [json=<path>]\n", token.c_str());
+			return 1;
+		}
+	}
+
+	ModelFileFormat modelFormat = GetModelFileFormat(modelFile, formatName);
+	if (modelFile.empty() || modelFormat == ModelFileFormat::UNKNOWN || modelFormat == ModelFileFormat::CHUNKED)
+	{
+		out_report = Stringf("AnalyzeMesh: \"%s\" is not a loadable model; usage: AnalyzeMesh file=<model> [format=<name>] [json=<path>]\n", modelFile.c_str());
+		return 1;
+	}
+
+	ModelData model;
+	if (!LoadModelFile(model, modelFile, modelFormat))
+	{
+		out_report = Stringf("AnalyzeMesh: failed to load \"%s\"\n", modelFile.c_str());
+		return 1;
+	}
+
+	MeshAnalysis analysis;
+	AnalyzeMesh(analysis, model.m_verts, model.m_indices);
+	if (jsonFile.empty())
+	{
+		out_report = GetMeshAnalysisJSON(analysis, modelFile);
+	}
+	else
+	{
+		if (!WriteMeshAnalysisJSON(analysis, modelFile, jsonFile))
+		{
+			out_report = Stringf("AnalyzeMesh: could not write \"%s\"\n", jsonFile.c_str());
+			return 1;
+		}
+	}
+	return analysis.HasErrors() ? 2 : 0;
+}
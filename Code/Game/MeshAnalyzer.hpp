@@ -0,0 +1,74 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class MeshAttribute
+{
+	POSITION,
+	UV,
+	TANGENT,
+	BITANGENT,
+	NORMAL,
+	COUNT
+};
+// -----------------------------------------------------------------------------
+struct MeshAttributeIssues
+{
+	int m_numNaN = 0;
+	int m_numInfinite = 0;
+	int m_numDenormal = 0;
+};
+// -----------------------------------------------------------------------------
+// Topology is measured on positions, so verts split only by UV or normal seams still share edges
+struct MeshAnalysis
+{
+	int					m_numVerts = 0;
+	int					m_numTriangles = 0;
+	int					m_numUniquePositions = 0;
+	int					m_numUnreferencedVerts = 0;
+
+	AABB3				m_bounds;
+	Vec2				m_uvMins;
+	Vec2				m_uvMaxs;
+	int					m_numVertsOutsideUnitUVs = 0;
+	MeshAttributeIssues	m_attributeIssues[static_cast<int>(MeshAttribute::COUNT)];
+	int					m_numZeroLengthNormals = 0;
+	int					m_numZeroLengthTangents = 0;
+
+	int					m_numOutOfRangeTriangles = 0;
+	int					m_numRepeatedIndexTriangles = 0;
+	int					m_numCollapsedTriangles = 0;
+	int					m_numZeroAreaTriangles = 0;
+	int					m_numDuplicateTriangles = 0;
+
+	int					m_numEdges = 0;
+	int					m_numBoundaryEdges = 0;
+	int					m_numNonManifoldEdges = 0;
+	int					m_numInconsistentlyWoundEdges = 0;
+
+	double				m_indicesPerVertex = 0.0;
+	double				m_averageCacheMissRatio = 0.0;
+	double				m_averageTransformToVertexRatio = 0.0;
+
+	double				m_seconds = 0.0;
+	int					m_numThreads = 0;
+
+	int  GetNumDegenerateTriangles() const { return m_numRepeatedIndexTriangles + m_numCollapsedTriangles + m_numZeroAreaTriangles; }
+	bool HasErrors() const;
+};
+// -----------------------------------------------------------------------------
+// Scans a mesh with parallel passes over fixed blocks whose partial results are merged in block
+// order, so the report is the same however many threads ran it.
+void AnalyzeMesh(MeshAnalysis& out_analysis, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices);
+
+char const* GetMeshAttributeName(MeshAttribute attribute);
+std::string GetMeshAnalysisJSON(MeshAnalysis const& analysis, std::string const& sourceName);
+bool		WriteMeshAnalysisJSON(MeshAnalysis const& analysis, std::string const& sourceName, std::string const& jsonFile);
+
+// Batch mode for "AnalyzeMesh file=<model> [format=<name>] [json=<path>]": loads and analyzes the
+// model, then writes the JSON report to json= or hands it back in out_report. Returns the process
+// exit code: 0 when the mesh is clean, 1 when it could not be analyzed, 2 when it has errors.
+int RunMeshAnalyzerCommandLine(std::string const& commandLine, std::string& out_report);
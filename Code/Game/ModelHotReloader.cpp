@@ -0,0 +1,215 @@
+#include "Game/ModelHotReloader.hpp"
+#include "Game/ModelTransform.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include <chrono>
+
+// Files are polled rather than watched with OS change notifications so the same code runs on every
+// platform we build for. A change is only acted on once the write time has been stable for one full
+// poll, which keeps us from parsing a file the exporter is still writing.
+constexpr std::chrono::milliseconds HOT_RELOAD_POLL_INTERVAL(250);
+
+ModelHotReloader::ModelHotReloader(std::string const& metaDataFile, std::string const& meshFile, ModelFileFormat meshFormat,
+	std::vector<std::string> const& materialLibraryFiles, std::vector<std::string> const& textureFiles)
+	: m_meshFile(meshFile)
+	, m_meshFormat(meshFormat)
+{
+	// Streamed chunked meshes are never parsed whole, so re-importing one goes through a restart
+	AddWatchedFile(metaDataFile, WatchedFileType::METADATA);
+	AddWatchedFile(meshFile, (meshFormat == ModelFileFormat::CHUNKED) ? WatchedFileType::RESTART : WatchedFileType::MESH);
+	for (int fileIndex = 0; fileIndex < static_cast<int>(materialLibraryFiles.size()); ++fileIndex)
+	{
+		AddWatchedFile(materialLibraryFiles[fileIndex], WatchedFileType::MATERIAL_LIBRARY);
+	}
+	for (int fileIndex = 0; fileIndex < static_cast<int>(textureFiles.size()); ++fileIndex)
+	{
+		AddWatchedFile(textureFiles[fileIndex], WatchedFileType::TEXTURE);
+	}
+}
+
+ModelHotReloader::~ModelHotReloader()
+{
+	Stop();
+}
+
+void ModelHotReloader::Start()
+{
+	if (m_watchThread.joinable())
+	{
+		return;
+	}
+
+	m_isStopping = false;
+	m_watchThread = std::thread(&ModelHotReloader::WatchThreadMain, this);
+}
+
+void ModelHotReloader::Stop()
+{
+	if (!m_watchThread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_stopMutex);
+		m_isStopping = true;
+	}
+	m_stopCondition.notify_all();
+	m_watchThread.join();
+}
+
+void ModelHotReloader::SetBakeTransform(Mat44 const& bakeTransform)
+{
+	// Only valid before Start(); the watch thread reads these without locking
+	m_bakeTransform = bakeTransform;
+	m_isBakingTransform = true;
+}
+
+bool ModelHotReloader::ConsumeReloadedModel(ModelData& out_model)
+{
+	std::lock_guard<std::mutex> lock(m_pendingMeshMutex);
+	if (!m_hasPendingModel)
+	{
+		return false;
+	}
+
+	std::swap(out_model, m_pendingModel);
+	m_pendingModel.Clear();
+	m_hasPendingModel = false;
+	return true;
+}
+
+bool ModelHotReloader::ConsumeChangedTextures(std::vector<std::string>& out_textureFiles)
+{
+	std::lock_guard<std::mutex> lock(m_pendingMeshMutex);
+	if (m_changedTextureFiles.empty())
+	{
+		return false;
+	}
+
+	out_textureFiles.swap(m_changedTextureFiles);
+	m_changedTextureFiles.clear();
+	return true;
+}
+
+bool ModelHotReloader::ConsumeMetaDataChange()
+{
+	return m_isMetaDataChanged.exchange(false);
+}
+
+bool ModelHotReloader::ConsumeRestartRequest()
+{
+	return m_isRestartRequested.exchange(false);
+}
+
+void ModelHotReloader::AddWatchedFile(std::string const& filePath, WatchedFileType type)
+{
+	if (filePath.empty())
+	{
+		return;
+	}
+
+	// Materials often share a texture; watch each path once
+	for (int fileIndex = 0; fileIndex < static_cast<int>(m_watchedFiles.size()); ++fileIndex)
+	{
+		if (m_watchedFiles[fileIndex].m_path == filePath)
+		{
+			return;
+		}
+	}
+
+	WatchedFile watchedFile;
+	watchedFile.m_path = filePath;
+	watchedFile.m_type = type;
+
+	std::error_code errorCode;
+	watchedFile.m_lastWriteTime = std::filesystem::last_write_time(filePath, errorCode);
+	if (errorCode)
+	{
+		DebuggerPrintf("WARNING: Hot reload cannot watch \"%s\" (%s)\n", filePath.c_str(), errorCode.message().c_str());
+	}
+	m_watchedFiles.push_back(watchedFile);
+}
+
+void ModelHotReloader::WatchThreadMain()
+{
+	std::unique_lock<std::mutex> lock(m_stopMutex);
+	while (!m_isStopping)
+	{
+		m_stopCondition.wait_for(lock, HOT_RELOAD_POLL_INTERVAL);
+		if (m_isStopping)
+		{
+			break;
+		}
+
+		lock.unlock();
+		PollWatchedFiles();
+		lock.lock();
+	}
+}
+
+void ModelHotReloader::PollWatchedFiles()
+{
+	bool isMeshReady = false;
+	std::vector<std::string> changedTextureFiles;
+
+	for (int fileIndex = 0; fileIndex < static_cast<int>(m_watchedFiles.size()); ++fileIndex)
+	{
+		WatchedFile& watchedFile = m_watchedFiles[fileIndex];
+
+		std::error_code errorCode;
+		std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(watchedFile.m_path, errorCode);
+		if (errorCode)
+		{
+			// Exporters often delete and recreate the file; try again next poll
+			continue;
+		}
+
+		if (writeTime != watchedFile.m_lastWriteTime)
+		{
+			watchedFile.m_lastWriteTime = writeTime;
+			watchedFile.m_isPendingChange = true;
+			continue;
+		}
+
+		if (!watchedFile.m_isPendingChange)
+		{
+			continue;
+		}
+
+		watchedFile.m_isPendingChange = false;
+		switch (watchedFile.m_type)
+		{
+		case WatchedFileType::METADATA:			m_isMetaDataChanged = true; break;
+		case WatchedFileType::MESH:				isMeshReady = true; break;
+		case WatchedFileType::MATERIAL_LIBRARY:	isMeshReady = true; break;
+		case WatchedFileType::TEXTURE:			changedTextureFiles.push_back(watchedFile.m_path); break;
+		default:								m_isRestartRequested = true; break;
+		}
+	}
+
+	if (!changedTextureFiles.empty())
+	{
+		std::lock_guard<std::mutex> lock(m_pendingMeshMutex);
+		m_changedTextureFiles.insert(m_changedTextureFiles.end(), changedTextureFiles.begin(), changedTextureFiles.end());
+	}
+	if (!isMeshReady || m_isRestartRequested)
+	{
+		return;
+	}
+
+	// Parse on this thread so the main loop only has to swap buffers
+	ModelData model;
+	if (!LoadModelFile(model, m_meshFile, m_meshFormat))
+	{
+		DebuggerPrintf("WARNING: Hot reload failed to parse \"%s\", keeping the previous mesh\n", m_meshFile.c_str());
+		return;
+	}
+	if (m_isBakingTransform)
+	{
+		BakeModelTransform(model.m_verts, m_bakeTransform);
+	}
+
+	std::lock_guard<std::mutex> lock(m_pendingMeshMutex);
+	std::swap(m_pendingModel, model);
+	m_hasPendingModel = true;
+}
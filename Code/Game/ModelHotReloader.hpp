@@ -0,0 +1,73 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class WatchedFileType
+{
+	METADATA,
+	MESH,
+	MATERIAL_LIBRARY,
+	TEXTURE,
+	RESTART,		// A streamed chunked mesh, which is never parsed whole
+};
+// -----------------------------------------------------------------------------
+struct WatchedFile
+{
+	std::string						m_path;
+	std::filesystem::file_time_type m_lastWriteTime;
+	WatchedFileType					m_type = WatchedFileType::RESTART;
+	bool							m_isPendingChange = false;
+};
+// -----------------------------------------------------------------------------
+// Watches the model's metadata, mesh, material, and texture files on a background thread.
+// Mesh and material library edits are re-parsed on that thread and handed to the main thread
+// ready to swap in; texture and metadata edits are reported for the main thread to apply.
+// Only an edit to a streamed chunked mesh requests a full game restart.
+// -----------------------------------------------------------------------------
+class ModelHotReloader
+{
+public:
+	ModelHotReloader(std::string const& metaDataFile, std::string const& meshFile, ModelFileFormat meshFormat,
+		std::vector<std::string> const& materialLibraryFiles, std::vector<std::string> const& textureFiles);
+	~ModelHotReloader();
+
+	void Start();
+	void Stop();
+	void SetBakeTransform(Mat44 const& bakeTransform);
+
+	bool ConsumeReloadedModel(ModelData& out_model);
+	bool ConsumeChangedTextures(std::vector<std::string>& out_textureFiles);
+	bool ConsumeMetaDataChange();
+	bool ConsumeRestartRequest();
+
+private:
+	void AddWatchedFile(std::string const& filePath, WatchedFileType type);
+	void WatchThreadMain();
+	void PollWatchedFiles();
+
+private:
+	std::vector<WatchedFile>	m_watchedFiles;
+	std::string					m_meshFile;
+	ModelFileFormat				m_meshFormat = ModelFileFormat::UNKNOWN;
+	Mat44						m_bakeTransform;
+	bool						m_isBakingTransform = false;
+
+	std::thread					m_watchThread;
+	std::mutex					m_stopMutex;
+	std::condition_variable		m_stopCondition;
+	bool						m_isStopping = false;
+
+	std::mutex					m_pendingMeshMutex;
+	ModelData					m_pendingModel;
+	bool						m_hasPendingModel = false;
+	std::vector<std::string>	m_changedTextureFiles;
+	std::atomic<bool>			m_isMetaDataChanged = false;
+	std::atomic<bool>			m_isRestartRequested = false;
+};
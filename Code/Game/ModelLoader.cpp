@@ -0,0 +1,684 @@
+#include "Game/ModelLoader.hpp"
+#include "Game/BinaryMeshLoader.hpp"
+#include "Game/GLBLoader.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Math/MathUtils.h"
+#include "Engine/Math/Vec2.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string.h>
+#include <unordered_map>
+
+// -----------------------------------------------------------------------------
+// OBJ faces index positions, uvs and normals separately; each unique triple becomes one vertex
+struct OBJVertexKey
+{
+	int m_positionIndex = -1;
+	int m_uvIndex = -1;
+	int m_normalIndex = -1;
+
+	bool operator==(OBJVertexKey const& other) const
+	{
+		return m_positionIndex == other.m_positionIndex && m_uvIndex == other.m_uvIndex && m_normalIndex == other.m_normalIndex;
+	}
+};
+
+struct OBJVertexKeyHash
+{
+	size_t operator()(OBJVertexKey const& key) const
+	{
+		size_t hash = static_cast<size_t>(key.m_positionIndex) * 73856093u;
+		hash ^= static_cast<size_t>(key.m_uvIndex) * 19349663u;
+		hash ^= static_cast<size_t>(key.m_normalIndex) * 83492791u;
+		return hash;
+	}
+};
+
+// -----------------------------------------------------------------------------
+static char const* SkipSpaces(char const* text, char const* end)
+{
+	while (text < end && (*text == ' ' || *text == '\t'))
+	{
+		++text;
+	}
+	return text;
+}
+
+static char const* FindLineEnd(char const* text, char const* end)
+{
+	while (text < end && *text != '\n' && *text != '\r')
+	{
+		++text;
+	}
+	return text;
+}
+
+static std::string GetRestOfLine(char const* text, char const* lineEnd)
+{
+	char const* trimmedEnd = lineEnd;
+	while (trimmedEnd > text && (trimmedEnd[-1] == ' ' || trimmedEnd[-1] == '\t'))
+	{
+		--trimmedEnd;
+	}
+	return std::string(text, trimmedEnd);
+}
+
+// Map options such as "-s 1 1 1" or "-bm 1.0" come before the file name, which is always the last token
+static std::string GetMapFileArgument(char const* text, char const* lineEnd)
+{
+	std::string mapArguments = GetRestOfLine(text, lineEnd);
+	size_t lastSpace = mapArguments.find_last_of(" \t");
+	return (lastSpace == std::string::npos) ? mapArguments : mapArguments.substr(lastSpace + 1);
+}
+
+static bool IsKeyword(char const* text, char const* lineEnd, char const* keyword)
+{
+	int keywordLength = static_cast<int>(strlen(keyword));
+	if (lineEnd - text <= keywordLength)
+	{
+		return false;
+	}
+	return strncmp(text, keyword, keywordLength) == 0 && (text[keywordLength] == ' ' || text[keywordLength] == '\t');
+}
+
+static int ResolveOBJIndex(int objIndex, int numElements)
+{
+	// OBJ indices are 1-based, and negative indices count back from the most recent element
+	if (objIndex > 0)
+	{
+		return objIndex - 1;
+	}
+	if (objIndex < 0)
+	{
+		return numElements + objIndex;
+	}
+	return -1;
+}
+
+// Parses one "p", "p/t", "p//n" or "p/t/n" face corner and moves the cursor past it and the spaces after it
+static OBJVertexKey ParseOBJFaceCorner(char const*& cursor, char const* lineEnd, int numPositions, int numUVs, int numNormals)
+{
+	OBJVertexKey key;
+	char* parseEnd = nullptr;
+	key.m_positionIndex = ResolveOBJIndex(strtol(cursor, &parseEnd, 10), numPositions);
+	cursor = parseEnd;
+	if (cursor < lineEnd && *cursor == '/')
+	{
+		++cursor;
+		if (*cursor != '/')
+		{
+			key.m_uvIndex = ResolveOBJIndex(strtol(cursor, &parseEnd, 10), numUVs);
+			cursor = parseEnd;
+		}
+		if (cursor < lineEnd && *cursor == '/')
+		{
+			++cursor;
+			key.m_normalIndex = ResolveOBJIndex(strtol(cursor, &parseEnd, 10), numNormals);
+			cursor = parseEnd;
+		}
+	}
+	cursor = SkipSpaces(cursor, lineEnd);
+	return key;
+}
+
+// White vertex at the key's position; out_hasNormal is false when the corner names no valid normal
+static Vertex_PCUTBN MakeOBJVertex(OBJVertexKey const& key, std::vector<Vec3> const& positions, std::vector<Vec2> const& uvs, std::vector<Vec3> const& normals,
+	bool& out_hasNormal)
+{
+	Vertex_PCUTBN vertex;
+	vertex.m_position = positions[key.m_positionIndex];
+	vertex.m_color = Rgba8::WHITE;
+	if (key.m_uvIndex >= 0 && key.m_uvIndex < static_cast<int>(uvs.size()))
+	{
+		vertex.m_uvTexCoords = uvs[key.m_uvIndex];
+	}
+	out_hasNormal = (key.m_normalIndex >= 0 && key.m_normalIndex < static_cast<int>(normals.size()));
+	if (out_hasNormal)
+	{
+		vertex.m_normal = normals[key.m_normalIndex];
+	}
+	return vertex;
+}
+
+static Vec3 ParseOBJVec3(char const* text)
+{
+	char* cursor = const_cast<char*>(text);
+	Vec3 vector;
+	vector.x = strtof(cursor, &cursor);
+	vector.y = strtof(cursor, &cursor);
+	vector.z = strtof(cursor, &cursor);
+	return vector;
+}
+
+static Vec2 ParseOBJVec2(char const* text)
+{
+	char* cursor = const_cast<char*>(text);
+	Vec2 vector;
+	vector.x = strtof(cursor, &cursor);
+	vector.y = strtof(cursor, &cursor);
+	return vector;
+}
+
+static std::string ResolveRelativePath(std::string const& referencingFile, std::string const& relativePath)
+{
+	std::filesystem::path resolvedPath = std::filesystem::path(referencingFile).parent_path() / relativePath;
+	return resolvedPath.lexically_normal().generic_string();
+}
+
+// -----------------------------------------------------------------------------
+void ModelData::Clear()
+{
+	m_verts.clear();
+	m_indices.clear();
+	m_materials.clear();
+	m_submeshes.clear();
+	m_materialLibraryFiles.clear();
+}
+
+// -----------------------------------------------------------------------------
+bool ReadFileToString(std::string& out_contents, std::string const& filePath)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	std::streamsize fileSize = file.tellg();
+	file.seekg(0, std::ios::beg);
+	out_contents.resize(static_cast<size_t>(fileSize));
+	return fileSize == 0 || static_cast<bool>(file.read(out_contents.data(), fileSize));
+}
+
+// -----------------------------------------------------------------------------
+ModelFileFormat GetModelFileFormat(std::string const& modelFilePath, std::string const& formatName)
+{
+	// An explicit format wins; otherwise go by the file extension
+	std::string format = formatName;
+	if (format.empty())
+	{
+		format = std::filesystem::path(modelFilePath).extension().string();
+		if (!format.empty() && format[0] == '.')
+		{
+			format.erase(0, 1);
+		}
+	}
+	for (int charIndex = 0; charIndex < static_cast<int>(format.size()); ++charIndex)
+	{
+		format[charIndex] = static_cast<char>(tolower(static_cast<unsigned char>(format[charIndex])));
+	}
+
+	if (format == "obj")	return ModelFileFormat::OBJ;
+	if (format == "ply")	return ModelFileFormat::PLY;
+	if (format == "stl")	return ModelFileFormat::STL;
+	if (format == "glb")	return ModelFileFormat::GLB;
+	if (format == "cmsh" || format == "chunked")	return ModelFileFormat::CHUNKED;
+	return ModelFileFormat::UNKNOWN;
+}
+
+// -----------------------------------------------------------------------------
+bool LoadModelFile(ModelData& out_model, std::string const& modelFilePath, ModelFileFormat format)
+{
+	switch (format)
+	{
+		case ModelFileFormat::OBJ:	return LoadOBJModel(out_model, modelFilePath);
+		case ModelFileFormat::PLY:	return LoadBinaryPLYModel(out_model, modelFilePath);
+		case ModelFileFormat::STL:	return LoadBinarySTLModel(out_model, modelFilePath);
+		case ModelFileFormat::GLB:	return LoadGLBModel(out_model, modelFilePath);
+		case ModelFileFormat::CHUNKED:
+			DebuggerPrintf("WARNING: Chunked mesh \"%s\" is streamed, not loaded whole\n", modelFilePath.c_str());
+			return false;
+		default:
+			DebuggerPrintf("WARNING: Unknown model format for \"%s\"\n", modelFilePath.c_str());
+			return false;
+	}
+}
+
+// -----------------------------------------------------------------------------
+bool LoadMTLFile(std::vector<ModelMaterial>& out_materials, std::string const& mtlFilePath)
+{
+	std::string contents;
+	if (!ReadFileToString(contents, mtlFilePath))
+	{
+		DebuggerPrintf("WARNING: Failed to load material library \"%s\"\n", mtlFilePath.c_str());
+		return false;
+	}
+
+	char const* text = contents.data();
+	char const* end = text + contents.size();
+	ModelMaterial* currentMaterial = nullptr;
+
+	while (text < end)
+	{
+		text = SkipSpaces(text, end);
+		char const* lineEnd = FindLineEnd(text, end);
+
+		if (IsKeyword(text, lineEnd, "newmtl"))
+		{
+			out_materials.emplace_back();
+			currentMaterial = &out_materials.back();
+			currentMaterial->m_name = GetRestOfLine(SkipSpaces(text + 6, lineEnd), lineEnd);
+		}
+		else if (currentMaterial && IsKeyword(text, lineEnd, "map_Kd"))
+		{
+			currentMaterial->m_diffuseMapFile = ResolveRelativePath(mtlFilePath, GetMapFileArgument(SkipSpaces(text + 6, lineEnd), lineEnd));
+		}
+		else if (currentMaterial && (IsKeyword(text, lineEnd, "map_Bump") || IsKeyword(text, lineEnd, "map_bump") || IsKeyword(text, lineEnd, "norm")))
+		{
+			currentMaterial->m_normalMapFile = ResolveRelativePath(mtlFilePath, GetMapFileArgument(SkipSpaces(text + (text[0] == 'n' ? 4 : 8), lineEnd), lineEnd));
+		}
+
+		text = lineEnd;
+		while (text < end && (*text == '\n' || *text == '\r'))
+		{
+			++text;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+bool LoadOBJModel(ModelData& out_model, std::string const& objFilePath)
+{
+	out_model.Clear();
+
+	std::string contents;
+	if (!ReadFileToString(contents, objFilePath))
+	{
+		return false;
+	}
+
+	std::vector<Vec3> positions;
+	std::vector<Vec2> uvs;
+	std::vector<Vec3> normals;
+	std::unordered_map<OBJVertexKey, unsigned int, OBJVertexKeyHash> vertexIndexByKey;
+
+	// Triangles are gathered per material and laid out contiguously once parsing is done
+	std::vector<std::vector<unsigned int>> materialTriangleIndices;
+	std::unordered_map<std::string, int> materialIndexByName;
+	int currentMaterialIndex = -1;
+	bool isMissingNormals = false;
+
+	char const* text = contents.data();
+	char const* end = text + contents.size();
+	std::vector<unsigned int> faceVertexIndices;
+
+	while (text < end)
+	{
+		text = SkipSpaces(text, end);
+		char const* lineEnd = FindLineEnd(text, end);
+
+		if (IsKeyword(text, lineEnd, "v"))
+		{
+			positions.push_back(ParseOBJVec3(text + 1));
+		}
+		else if (IsKeyword(text, lineEnd, "vt"))
+		{
+			uvs.push_back(ParseOBJVec2(text + 2));
+		}
+		else if (IsKeyword(text, lineEnd, "vn"))
+		{
+			normals.push_back(ParseOBJVec3(text + 2));
+		}
+		else if (IsKeyword(text, lineEnd, "f"))
+		{
+			if (currentMaterialIndex < 0)
+			{
+				currentMaterialIndex = static_cast<int>(out_model.m_materials.size());
+				materialIndexByName[""] = currentMaterialIndex;
+				out_model.m_materials.emplace_back();
+				materialTriangleIndices.emplace_back();
+			}
+
+			faceVertexIndices.clear();
+			char const* cursor = SkipSpaces(text + 1, lineEnd);
+			while (cursor < lineEnd)
+			{
+				OBJVertexKey key = ParseOBJFaceCorner(cursor, lineEnd, static_cast<int>(positions.size()), static_cast<int>(uvs.size()), static_cast<int>(normals.size()));
+				if (key.m_positionIndex < 0 || key.m_positionIndex >= static_cast<int>(positions.size()))
+				{
+					DebuggerPrintf("WARNING: OBJ file \"%s\" has a face with an invalid position index\n", objFilePath.c_str());
+					return false;
+				}
+
+				auto found = vertexIndexByKey.find(key);
+				if (found != vertexIndexByKey.end())
+				{
+					faceVertexIndices.push_back(found->second);
+					continue;
+				}
+
+				bool hasNormal = false;
+				Vertex_PCUTBN vertex = MakeOBJVertex(key, positions, uvs, normals, hasNormal);
+				isMissingNormals = isMissingNormals || !hasNormal;
+
+				unsigned int vertexIndex = static_cast<unsigned int>(out_model.m_verts.size());
+				out_model.m_verts.push_back(vertex);
+				vertexIndexByKey[key] = vertexIndex;
+				faceVertexIndices.push_back(vertexIndex);
+			}
+
+			// Fan-triangulate polygons
+			std::vector<unsigned int>& triangleIndices = materialTriangleIndices[currentMaterialIndex];
+			for (int faceVertex = 1; faceVertex + 1 < static_cast<int>(faceVertexIndices.size()); ++faceVertex)
+			{
+				triangleIndices.push_back(faceVertexIndices[0]);
+				triangleIndices.push_back(faceVertexIndices[faceVertex]);
+				triangleIndices.push_back(faceVertexIndices[faceVertex + 1]);
+			}
+		}
+		else if (IsKeyword(text, lineEnd, "usemtl"))
+		{
+			std::string materialName = GetRestOfLine(SkipSpaces(text + 6, lineEnd), lineEnd);
+			auto found = materialIndexByName.find(materialName);
+			if (found != materialIndexByName.end())
+			{
+				currentMaterialIndex = found->second;
+			}
+			else
+			{
+				currentMaterialIndex = static_cast<int>(out_model.m_materials.size());
+				materialIndexByName[materialName] = currentMaterialIndex;
+				out_model.m_materials.emplace_back();
+				out_model.m_materials.back().m_name = materialName;
+				materialTriangleIndices.emplace_back();
+			}
+		}
+		else if (IsKeyword(text, lineEnd, "mtllib"))
+		{
+			std::string libraryFile = GetRestOfLine(SkipSpaces(text + 6, lineEnd), lineEnd);
+			out_model.m_materialLibraryFiles.push_back(ResolveRelativePath(objFilePath, libraryFile));
+		}
+
+		text = lineEnd;
+		while (text < end && (*text == '\n' || *text == '\r'))
+		{
+			++text;
+		}
+	}
+
+	// Fill in texture file names from the material libraries
+	std::vector<ModelMaterial> libraryMaterials;
+	for (int libraryIndex = 0; libraryIndex < static_cast<int>(out_model.m_materialLibraryFiles.size()); ++libraryIndex)
+	{
+		LoadMTLFile(libraryMaterials, out_model.m_materialLibraryFiles[libraryIndex]);
+	}
+	for (int libraryMaterialIndex = 0; libraryMaterialIndex < static_cast<int>(libraryMaterials.size()); ++libraryMaterialIndex)
+	{
+		ModelMaterial const& libraryMaterial = libraryMaterials[libraryMaterialIndex];
+		auto found = materialIndexByName.find(libraryMaterial.m_name);
+		if (found != materialIndexByName.end())
+		{
+			out_model.m_materials[found->second] = libraryMaterial;
+		}
+	}
+
+	// Lay out each material's triangles as one contiguous index range
+	for (int materialIndex = 0; materialIndex < static_cast<int>(materialTriangleIndices.size()); ++materialIndex)
+	{
+		std::vector<unsigned int> const& triangleIndices = materialTriangleIndices[materialIndex];
+		if (triangleIndices.empty())
+		{
+			continue;
+		}
+
+		ModelSubmesh submesh;
+		submesh.m_materialIndex = materialIndex;
+		submesh.m_startIndex = static_cast<unsigned int>(out_model.m_indices.size());
+		submesh.m_indexCount = static_cast<unsigned int>(triangleIndices.size());
+		out_model.m_submeshes.push_back(submesh);
+		out_model.m_indices.insert(out_model.m_indices.end(), triangleIndices.begin(), triangleIndices.end());
+	}
+
+	if (isMissingNormals)
+	{
+		CalculateModelNormals(out_model);
+	}
+	CalculateModelTangents(out_model);
+	return !out_model.m_indices.empty();
+}
+
+// -----------------------------------------------------------------------------
+bool ForEachOBJTriangle(std::string const& objFilePath, std::function<void(Vertex_PCUTBN const* corners)> const& visitTriangle)
+{
+	std::ifstream file(objFilePath, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+
+	// Only the attribute arrays faces index into are kept; the text passes through a fixed block, whole lines at a time
+	constexpr size_t OBJ_STREAM_BLOCK_BYTES = 4 * 1024 * 1024;
+	std::vector<char> block(OBJ_STREAM_BLOCK_BYTES + 1);
+	std::vector<Vec3> positions;
+	std::vector<Vec2> uvs;
+	std::vector<Vec3> normals;
+	std::vector<Vertex_PCUTBN> faceVerts;
+	std::vector<unsigned char> faceHasNormals;
+	uint64_t numTriangles = 0;
+	size_t numCarriedBytes = 0;
+	bool isLastBlock = false;
+	while (!isLastBlock)
+	{
+		file.read(block.data() + numCarriedBytes, static_cast<std::streamsize>(OBJ_STREAM_BLOCK_BYTES - numCarriedBytes));
+		size_t numBlockBytes = numCarriedBytes + static_cast<size_t>(file.gcount());
+		isLastBlock = (numBlockBytes < OBJ_STREAM_BLOCK_BYTES);
+		block[numBlockBytes] = '\0';
+
+		// A line cut off by the end of the block is carried into the next one
+		size_t numParsedBytes = numBlockBytes;
+		if (!isLastBlock)
+		{
+			while (numParsedBytes > 0 && block[numParsedBytes - 1] != '\n')
+			{
+				--numParsedBytes;
+			}
+			if (numParsedBytes == 0)
+			{
+				DebuggerPrintf("WARNING: OBJ file \"%s\" has a line longer than %u bytes\n", objFilePath.c_str(), static_cast<unsigned int>(OBJ_STREAM_BLOCK_BYTES));
+				return false;
+			}
+		}
+
+		char const* text = block.data();
+		char const* end = text + numParsedBytes;
+		while (text < end)
+		{
+			text = SkipSpaces(text, end);
+			char const* lineEnd = FindLineEnd(text, end);
+
+			if (IsKeyword(text, lineEnd, "v"))
+			{
+				positions.push_back(ParseOBJVec3(text + 1));
+			}
+			else if (IsKeyword(text, lineEnd, "vt"))
+			{
+				uvs.push_back(ParseOBJVec2(text + 2));
+			}
+			else if (IsKeyword(text, lineEnd, "vn"))
+			{
+				normals.push_back(ParseOBJVec3(text + 2));
+			}
+			else if (IsKeyword(text, lineEnd, "f"))
+			{
+				faceVerts.clear();
+				faceHasNormals.clear();
+				char const* cursor = SkipSpaces(text + 1, lineEnd);
+				while (cursor < lineEnd)
+				{
+					OBJVertexKey key = ParseOBJFaceCorner(cursor, lineEnd, static_cast<int>(positions.size()), static_cast<int>(uvs.size()), static_cast<int>(normals.size()));
+					if (key.m_positionIndex < 0 || key.m_positionIndex >= static_cast<int>(positions.size()))
+					{
+						DebuggerPrintf("WARNING: OBJ file \"%s\" has a face with an invalid position index\n", objFilePath.c_str());
+						return false;
+					}
+
+					bool hasNormal = false;
+					faceVerts.push_back(MakeOBJVertex(key, positions, uvs, normals, hasNormal));
+					faceHasNormals.push_back(hasNormal ? 1 : 0);
+				}
+
+				// Fan-triangulate; with no neighbours in view, corners without a normal take their triangle's face normal
+				Vertex_PCUTBN corners[3];
+				for (int faceVertex = 1; faceVertex + 1 < static_cast<int>(faceVerts.size()); ++faceVertex)
+				{
+					int const cornerFaceVerts[3] = { 0, faceVertex, faceVertex + 1 };
+					for (int corner = 0; corner < 3; ++corner)
+					{
+						corners[corner] = faceVerts[cornerFaceVerts[corner]];
+					}
+					Vec3 faceNormal = CrossProduct3D(corners[1].m_position - corners[0].m_position, corners[2].m_position - corners[0].m_position).GetNormalized();
+					for (int corner = 0; corner < 3; ++corner)
+					{
+						if (faceHasNormals[cornerFaceVerts[corner]] == 0)
+						{
+							corners[corner].m_normal = faceNormal;
+						}
+					}
+					visitTriangle(corners);
+					++numTriangles;
+				}
+			}
+
+			text = lineEnd;
+			while (text < end && (*text == '\n' || *text == '\r'))
+			{
+				++text;
+			}
+		}
+
+		numCarriedBytes = numBlockBytes - numParsedBytes;
+		memmove(block.data(), block.data() + numParsedBytes, numCarriedBytes);
+	}
+	return numTriangles > 0;
+}
+
+// -----------------------------------------------------------------------------
+void BuildModelClusters(std::vector<ModelCluster>& out_clusters, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices,
+	std::vector<ModelSubmesh> const& submeshes, int trianglesPerCluster)
+{
+	out_clusters.clear();
+	unsigned int indicesPerCluster = static_cast<unsigned int>(trianglesPerCluster > 0 ? trianglesPerCluster : 1) * 3;
+
+	// Loaders emit faces in file order, which is usually spatially coherent, so fixed-size runs make reasonable clusters
+	for (int submeshIndex = 0; submeshIndex < static_cast<int>(submeshes.size()); ++submeshIndex)
+	{
+		ModelSubmesh const& submesh = submeshes[submeshIndex];
+		unsigned int submeshEndIndex = submesh.m_startIndex + submesh.m_indexCount;
+		for (unsigned int startIndex = submesh.m_startIndex; startIndex < submeshEndIndex; startIndex += indicesPerCluster)
+		{
+			ModelCluster cluster;
+			cluster.m_submeshIndex = submeshIndex;
+			cluster.m_startIndex = startIndex;
+			cluster.m_indexCount = (submeshEndIndex - startIndex < indicesPerCluster) ? submeshEndIndex - startIndex : indicesPerCluster;
+
+			Vec3 const& firstPosition = verts[indices[startIndex]].m_position;
+			cluster.m_bounds.m_mins = firstPosition;
+			cluster.m_bounds.m_maxs = firstPosition;
+			for (unsigned int index = startIndex; index < startIndex + cluster.m_indexCount; ++index)
+			{
+				Vec3 const& position = verts[indices[index]].m_position;
+				cluster.m_bounds.m_mins.x = (position.x < cluster.m_bounds.m_mins.x) ? position.x : cluster.m_bounds.m_mins.x;
+				cluster.m_bounds.m_mins.y = (position.y < cluster.m_bounds.m_mins.y) ? position.y : cluster.m_bounds.m_mins.y;
+				cluster.m_bounds.m_mins.z = (position.z < cluster.m_bounds.m_mins.z) ? position.z : cluster.m_bounds.m_mins.z;
+				cluster.m_bounds.m_maxs.x = (position.x > cluster.m_bounds.m_maxs.x) ? position.x : cluster.m_bounds.m_maxs.x;
+				cluster.m_bounds.m_maxs.y = (position.y > cluster.m_bounds.m_maxs.y) ? position.y : cluster.m_bounds.m_maxs.y;
+				cluster.m_bounds.m_maxs.z = (position.z > cluster.m_bounds.m_maxs.z) ? position.z : cluster.m_bounds.m_maxs.z;
+			}
+			out_clusters.push_back(cluster);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+void CalculateModelNormals(ModelData& model)
+{
+	int numVerts = static_cast<int>(model.m_verts.size());
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		model.m_verts[vertIndex].m_normal = Vec3::ZERO;
+	}
+
+	// Area-weighted face normals, accumulated on every vertex of the face
+	for (int index = 0; index + 2 < static_cast<int>(model.m_indices.size()); index += 3)
+	{
+		Vertex_PCUTBN& vertA = model.m_verts[model.m_indices[index]];
+		Vertex_PCUTBN& vertB = model.m_verts[model.m_indices[index + 1]];
+		Vertex_PCUTBN& vertC = model.m_verts[model.m_indices[index + 2]];
+		Vec3 faceNormal = CrossProduct3D(vertB.m_position - vertA.m_position, vertC.m_position - vertA.m_position);
+		vertA.m_normal += faceNormal;
+		vertB.m_normal += faceNormal;
+		vertC.m_normal += faceNormal;
+	}
+
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		model.m_verts[vertIndex].m_normal = model.m_verts[vertIndex].m_normal.GetNormalized();
+	}
+}
+
+// -----------------------------------------------------------------------------
+void CalculateModelTangents(ModelData& model)
+{
+	int numVerts = static_cast<int>(model.m_verts.size());
+	std::vector<Vec3> tangents(numVerts, Vec3::ZERO);
+	std::vector<Vec3> bitangents(numVerts, Vec3::ZERO);
+
+	for (int index = 0; index + 2 < static_cast<int>(model.m_indices.size()); index += 3)
+	{
+		unsigned int indexA = model.m_indices[index];
+		unsigned int indexB = model.m_indices[index + 1];
+		unsigned int indexC = model.m_indices[index + 2];
+		Vertex_PCUTBN const& vertA = model.m_verts[indexA];
+		Vertex_PCUTBN const& vertB = model.m_verts[indexB];
+		Vertex_PCUTBN const& vertC = model.m_verts[indexC];
+
+		Vec3 edgeAB = vertB.m_position - vertA.m_position;
+		Vec3 edgeAC = vertC.m_position - vertA.m_position;
+		Vec2 uvAB = vertB.m_uvTexCoords - vertA.m_uvTexCoords;
+		Vec2 uvAC = vertC.m_uvTexCoords - vertA.m_uvTexCoords;
+
+		float uvDeterminant = uvAB.x * uvAC.y - uvAC.x * uvAB.y;
+		if (fabsf(uvDeterminant) < 1e-12f)
+		{
+			continue;
+		}
+
+		float inverseDeterminant = 1.f / uvDeterminant;
+		Vec3 faceTangent = (edgeAB * uvAC.y - edgeAC * uvAB.y) * inverseDeterminant;
+		Vec3 faceBitangent = (edgeAC * uvAB.x - edgeAB * uvAC.x) * inverseDeterminant;
+
+		tangents[indexA] += faceTangent;
+		tangents[indexB] += faceTangent;
+		tangents[indexC] += faceTangent;
+		bitangents[indexA] += faceBitangent;
+		bitangents[indexB] += faceBitangent;
+		bitangents[indexC] += faceBitangent;
+	}
+
+	for (int vertIndex = 0; vertIndex < numVerts; ++vertIndex)
+	{
+		Vertex_PCUTBN& vertex = model.m_verts[vertIndex];
+		Vec3 normal = vertex.m_normal;
+
+		// Gram-Schmidt against the normal; vertices without usable UVs get any perpendicular axis
+		Vec3 tangent = tangents[vertIndex] - normal * DotProduct3D(normal, tangents[vertIndex]);
+		if (tangent.GetLengthSquared() < 1e-12f)
+		{
+			Vec3 referenceAxis = (fabsf(normal.z) < 0.9f) ? Vec3::ZAXE : Vec3::XAXE;
+			tangent = CrossProduct3D(referenceAxis, normal);
+		}
+		tangent = tangent.GetNormalized();
+
+		Vec3 bitangent = CrossProduct3D(normal, tangent);
+		if (DotProduct3D(bitangent, bitangents[vertIndex]) < 0.f)
+		{
+			bitangent = -bitangent;
+		}
+
+		vertex.m_tangent = tangent;
+		vertex.m_bitangent = bitangent;
+	}
+}
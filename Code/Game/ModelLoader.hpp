@@ -0,0 +1,73 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include <functional>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+class Texture;
+// -----------------------------------------------------------------------------
+struct ModelMaterial
+{
+	std::string m_name;
+	std::string m_diffuseMapFile;
+	std::string m_normalMapFile;
+	Texture*	m_diffuseTexture = nullptr;
+	Texture*	m_normalTexture = nullptr;
+};
+// -----------------------------------------------------------------------------
+// A contiguous range of the shared index buffer that is drawn with a single material
+struct ModelSubmesh
+{
+	int				m_materialIndex = 0;
+	unsigned int	m_startIndex = 0;
+	unsigned int	m_indexCount = 0;
+};
+// -----------------------------------------------------------------------------
+// A spatially local slice of a submesh, used for culling. Adjacent clusters of one submesh are
+// contiguous in the index buffer, so visible neighbours can still be drawn as one range.
+struct ModelCluster
+{
+	int				m_submeshIndex = 0;
+	unsigned int	m_startIndex = 0;
+	unsigned int	m_indexCount = 0;
+	AABB3			m_bounds;
+};
+// -----------------------------------------------------------------------------
+struct ModelData
+{
+	std::vector<Vertex_PCUTBN>	m_verts;
+	std::vector<unsigned int>	m_indices;
+	std::vector<ModelMaterial>	m_materials;
+	std::vector<ModelSubmesh>	m_submeshes;
+	std::vector<std::string>	m_materialLibraryFiles;
+
+	void Clear();
+	int  GetNumTriangles() const { return static_cast<int>(m_indices.size()) / 3; }
+};
+// -----------------------------------------------------------------------------
+enum class ModelFileFormat
+{
+	UNKNOWN,
+	OBJ,
+	PLY,
+	STL,
+	GLB,
+	CHUNKED,
+};
+// -----------------------------------------------------------------------------
+ModelFileFormat GetModelFileFormat(std::string const& modelFilePath, std::string const& formatName = "");
+bool LoadModelFile(ModelData& out_model, std::string const& modelFilePath, ModelFileFormat format);
+bool LoadOBJModel(ModelData& out_model, std::string const& objFilePath);
+bool LoadMTLFile(std::vector<ModelMaterial>& out_materials, std::string const& mtlFilePath);
+
+// Streams an OBJ's faces as fan-triangulated corners through a fixed text buffer, keeping only the position, uv and normal
+// arrays; materials are ignored and tangents left zero. Corners without a normal get their triangle's face normal.
+bool ForEachOBJTriangle(std::string const& objFilePath, std::function<void(Vertex_PCUTBN const* corners)> const& visitTriangle);
+bool ReadFileToString(std::string& out_contents, std::string const& filePath);
+
+void BuildModelClusters(std::vector<ModelCluster>& out_clusters, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices,
+	std::vector<ModelSubmesh> const& submeshes, int trianglesPerCluster);
+
+void CalculateModelNormals(ModelData& model);
+void CalculateModelTangents(ModelData& model);
@@ -0,0 +1,146 @@
+#include "Game/ModelTransform.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Math/MathUtils.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define MODEL_TRANSFORM_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+static bool GetOrientationAxis(std::string const& orientationName, Vec3& out_axis)
+{
+	if (orientationName == "forward")	{ out_axis = Vec3::XAXE;  return true; }
+	if (orientationName == "backward")	{ out_axis = -Vec3::XAXE; return true; }
+	if (orientationName == "left")		{ out_axis = Vec3::YAXE;  return true; }
+	if (orientationName == "right")		{ out_axis = -Vec3::YAXE; return true; }
+	if (orientationName == "up")		{ out_axis = Vec3::ZAXE;  return true; }
+	if (orientationName == "down")		{ out_axis = -Vec3::ZAXE; return true; }
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+bool MakeModelOrientation(Mat44& out_orientation, std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ, std::string& out_errorMessage)
+{
+	std::string const* orientationNames[3] = { &orientationX, &orientationY, &orientationZ };
+	char const* axisNames[3] = { "x", "y", "z" };
+	Vec3 axes[3];
+
+	for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		if (!GetOrientationAxis(*orientationNames[axisIndex], axes[axisIndex]))
+		{
+			out_errorMessage = Stringf("Model orientation %s=\"%s\" is invalid; expected forward, backward, left, right, up, or down",
+				axisNames[axisIndex], orientationNames[axisIndex]->c_str());
+			return false;
+		}
+	}
+
+	for (int axisIndex = 0; axisIndex < 3; ++axisIndex)
+	{
+		int otherAxisIndex = (axisIndex + 1) % 3;
+		if (DotProduct3D(axes[axisIndex], axes[otherAxisIndex]) != 0.f)
+		{
+			out_errorMessage = Stringf("Model orientation %s=\"%s\" and %s=\"%s\" map onto the same world axis",
+				axisNames[axisIndex], orientationNames[axisIndex]->c_str(), axisNames[otherAxisIndex], orientationNames[otherAxisIndex]->c_str());
+			return false;
+		}
+	}
+
+	out_orientation = Mat44();
+	out_orientation.m_values[Mat44::Ix] = axes[0].x;
+	out_orientation.m_values[Mat44::Iy] = axes[0].y;
+	out_orientation.m_values[Mat44::Iz] = axes[0].z;
+
+	out_orientation.m_values[Mat44::Jx] = axes[1].x;
+	out_orientation.m_values[Mat44::Jy] = axes[1].y;
+	out_orientation.m_values[Mat44::Jz] = axes[1].z;
+
+	out_orientation.m_values[Mat44::Kx] = axes[2].x;
+	out_orientation.m_values[Mat44::Ky] = axes[2].y;
+	out_orientation.m_values[Mat44::Kz] = axes[2].z;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+static float GetUniformScale(Mat44 const& transform)
+{
+	Vec3 iBasis(transform.m_values[Mat44::Ix], transform.m_values[Mat44::Iy], transform.m_values[Mat44::Iz]);
+	return iBasis.GetLength();
+}
+
+// -----------------------------------------------------------------------------
+void BakeModelTransformScalar(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform)
+{
+	float const* m = transform.m_values;
+	float scale = GetUniformScale(transform);
+	float inverseScale = (scale > 0.f) ? 1.f / scale : 0.f;
+
+	auto transformVector = [m](Vec3 const& v, float w) -> Vec3
+	{
+		return Vec3(
+			m[Mat44::Ix] * v.x + m[Mat44::Jx] * v.y + m[Mat44::Kx] * v.z + m[Mat44::Tx] * w,
+			m[Mat44::Iy] * v.x + m[Mat44::Jy] * v.y + m[Mat44::Ky] * v.z + m[Mat44::Ty] * w,
+			m[Mat44::Iz] * v.x + m[Mat44::Jz] * v.y + m[Mat44::Kz] * v.z + m[Mat44::Tz] * w);
+	};
+
+	for (int vertIndex = 0; vertIndex < static_cast<int>(verts.size()); ++vertIndex)
+	{
+		Vertex_PCUTBN& vertex = verts[vertIndex];
+		vertex.m_position = transformVector(vertex.m_position, 1.f);
+		vertex.m_tangent = transformVector(vertex.m_tangent, 0.f) * inverseScale;
+		vertex.m_bitangent = transformVector(vertex.m_bitangent, 0.f) * inverseScale;
+		vertex.m_normal = transformVector(vertex.m_normal, 0.f) * inverseScale;
+	}
+}
+
+// -----------------------------------------------------------------------------
+#if defined(MODEL_TRANSFORM_USE_SSE)
+static inline __m128 TransformVec3SSE(Vec3 const& v, __m128 columnI, __m128 columnJ, __m128 columnK)
+{
+	__m128 result = _mm_mul_ps(columnI, _mm_set1_ps(v.x));
+	result = _mm_add_ps(result, _mm_mul_ps(columnJ, _mm_set1_ps(v.y)));
+	result = _mm_add_ps(result, _mm_mul_ps(columnK, _mm_set1_ps(v.z)));
+	return result;
+}
+
+static inline void StoreVec3SSE(Vec3& out_v, __m128 value)
+{
+	alignas(16) float lanes[4];
+	_mm_store_ps(lanes, value);
+	out_v.x = lanes[0];
+	out_v.y = lanes[1];
+	out_v.z = lanes[2];
+}
+#endif
+
+void BakeModelTransform(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform)
+{
+#if defined(MODEL_TRANSFORM_USE_SSE)
+	float const* m = transform.m_values;
+	float scale = GetUniformScale(transform);
+	float inverseScale = (scale > 0.f) ? 1.f / scale : 0.f;
+
+	// Columns of the 3x4 transform, plus a rotation-only copy (scale divided out) for the TBN frame
+	__m128 columnI = _mm_setr_ps(m[Mat44::Ix], m[Mat44::Iy], m[Mat44::Iz], 0.f);
+	__m128 columnJ = _mm_setr_ps(m[Mat44::Jx], m[Mat44::Jy], m[Mat44::Jz], 0.f);
+	__m128 columnK = _mm_setr_ps(m[Mat44::Kx], m[Mat44::Ky], m[Mat44::Kz], 0.f);
+	__m128 columnT = _mm_setr_ps(m[Mat44::Tx], m[Mat44::Ty], m[Mat44::Tz], 0.f);
+	__m128 inverseScale4 = _mm_set1_ps(inverseScale);
+	__m128 rotationI = _mm_mul_ps(columnI, inverseScale4);
+	__m128 rotationJ = _mm_mul_ps(columnJ, inverseScale4);
+	__m128 rotationK = _mm_mul_ps(columnK, inverseScale4);
+
+	Vertex_PCUTBN* vertex = verts.data();
+	Vertex_PCUTBN* vertexEnd = vertex + verts.size();
+	for (; vertex < vertexEnd; ++vertex)
+	{
+		StoreVec3SSE(vertex->m_position, _mm_add_ps(TransformVec3SSE(vertex->m_position, columnI, columnJ, columnK), columnT));
+		StoreVec3SSE(vertex->m_tangent, TransformVec3SSE(vertex->m_tangent, rotationI, rotationJ, rotationK));
+		StoreVec3SSE(vertex->m_bitangent, TransformVec3SSE(vertex->m_bitangent, rotationI, rotationJ, rotationK));
+		StoreVec3SSE(vertex->m_normal, TransformVec3SSE(vertex->m_normal, rotationI, rotationJ, rotationK));
+	}
+#else
+	BakeModelTransformScalar(verts, transform);
+#endif
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Maps the model's x/y/z orientation names ("forward", "left", "up", ...) onto our world axes
+// (X forward, Y left, Z up). Fails unless each name is known and the three axes are distinct.
+// -----------------------------------------------------------------------------
+bool MakeModelOrientation(Mat44& out_orientation, std::string const& orientationX, std::string const& orientationY, std::string const& orientationZ, std::string& out_errorMessage);
+
+// Transforms positions by the full matrix and the TBN frame by its rotation, in place.
+// The matrix is expected to be a uniform scale times a (possibly mirrored) axis remap.
+void BakeModelTransform(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform);
+void BakeModelTransformScalar(std::vector<Vertex_PCUTBN>& verts, Mat44 const& transform);
@@ -0,0 +1,394 @@
+#include "Game/OutOfCoreMesh.hpp"
+#include "Game/PerfStats.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <string.h>
+
+static PerfStatId const s_pageInMillisecondsStat = GetPerfStats().Register("page_in_ms", PerfStatType::HISTOGRAM);
+
+// -----------------------------------------------------------------------------
+static float GetDistanceToBox(Vec3 const& position, AABB3 const& box)
+{
+	Vec3 nearestPoint(std::max(box.m_mins.x, std::min(position.x, box.m_maxs.x)),
+		std::max(box.m_mins.y, std::min(position.y, box.m_maxs.y)),
+		std::max(box.m_mins.z, std::min(position.z, box.m_maxs.z)));
+	return (position - nearestPoint).GetLength();
+}
+
+// -----------------------------------------------------------------------------
+struct ChunkRank
+{
+	bool	m_isPrefetch = false;
+	float	m_distance = 0.f;
+	int		m_chunkIndex = 0;
+
+	bool operator<(ChunkRank const& other) const
+	{
+		if (m_isPrefetch != other.m_isPrefetch)
+		{
+			return !m_isPrefetch;
+		}
+		return m_distance < other.m_distance;
+	}
+};
+
+// -----------------------------------------------------------------------------
+OutOfCoreMesh::~OutOfCoreMesh()
+{
+	Close();
+}
+
+bool OutOfCoreMesh::Open(std::string const& chunkedFile, uint64_t budgetBytes, std::string& out_errorMessage)
+{
+	Close();
+
+	ChunkedMeshHeader header;
+	std::vector<ChunkedMeshChunkInfo> chunkInfos;
+	if (!ReadChunkedMeshTable(chunkedFile, header, chunkInfos, out_errorMessage))
+	{
+		return false;
+	}
+
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, chunkedFile.c_str(), "rb") != 0)
+	{
+		file = nullptr;
+	}
+#else
+	file = fopen(chunkedFile.c_str(), "rb");
+#endif
+	if (file == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\"", chunkedFile.c_str());
+		return false;
+	}
+
+	m_chunkedFile = chunkedFile;
+	m_chunks.resize(chunkInfos.size());
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(chunkInfos.size()); ++chunkIndex)
+	{
+		StreamedChunk& chunk = m_chunks[chunkIndex];
+		chunk.m_info = chunkInfos[chunkIndex];
+		chunk.m_bounds = chunk.m_info.GetBounds();
+		chunk.m_pageBytes = chunk.m_info.GetPageBytes();
+	}
+	m_bounds = AABB3(header.m_boundsMins[0], header.m_boundsMins[1], header.m_boundsMins[2], header.m_boundsMaxs[0], header.m_boundsMaxs[1], header.m_boundsMaxs[2]);
+	m_numTriangles = header.m_numTriangles;
+	m_budgetBytes = budgetBytes;
+	m_stats.m_numChunks = static_cast<int>(m_chunks.size());
+
+	m_loaderThread = std::thread(&OutOfCoreMesh::LoaderThreadMain, this, file);
+	return true;
+}
+
+void OutOfCoreMesh::Close()
+{
+	if (m_loaderThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_queueMutex);
+			m_isStopping = true;
+		}
+		m_queueCondition.notify_all();
+		m_loaderThread.join();
+	}
+
+	m_isStopping = false;
+	m_requestQueue.clear();
+	m_loadedChunks.clear();
+	m_chunks.clear();
+	m_rankedChunks.clear();
+	m_drawableChunks.clear();
+	m_chunkedFile.clear();
+	m_numTriangles = 0;
+	m_committedBytes = 0;
+	m_frameNumber = 0;
+	m_isRankingDirty = true;
+	m_stats = OutOfCoreStats();
+}
+
+// -----------------------------------------------------------------------------
+void OutOfCoreMesh::Update(ViewFrustum const& view, Mat44 const& modelToWorld, std::vector<int>& out_pagedInChunks, std::vector<int>& out_evictedChunks)
+{
+	out_pagedInChunks.clear();
+	out_evictedChunks.clear();
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	// Residency changes hands under this lock; the loader only holds it to pop and push indices
+	double startTime = GetCurrentTimeSeconds();
+	std::lock_guard<std::mutex> lock(m_queueMutex);
+
+	// A still camera keeps its ranking, so a static view only costs the page-in check below
+	ClipTransform modelToClip = view.GetModelToClip(modelToWorld);
+	bool isRanked = m_isRankingDirty || memcmp(&modelToClip, &m_rankedModelToClip, sizeof(ClipTransform)) != 0;
+	if (isRanked)
+	{
+		m_rankedModelToClip = modelToClip;
+		m_isRankingDirty = false;
+		RankChunks(view, modelToWorld, modelToClip, out_evictedChunks);
+	}
+
+	// Finished pages are taken after ranking, so a page cannot arrive and be evicted in the same update
+	TakeLoadedChunks(out_pagedInChunks);
+	if (isRanked || !out_pagedInChunks.empty())
+	{
+		RebuildDrawableChunks();
+	}
+
+	m_stats.m_numResidentChunks = 0;
+	m_stats.m_numPendingChunks = 0;
+	m_stats.m_residentBytes = 0;
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_chunks.size()); ++chunkIndex)
+	{
+		StreamedChunk const& chunk = m_chunks[chunkIndex];
+		if (chunk.m_residency == ChunkResidency::RESIDENT)
+		{
+			++m_stats.m_numResidentChunks;
+			m_stats.m_residentBytes += chunk.m_pageBytes;
+		}
+		else if (chunk.m_residency != ChunkResidency::NOT_RESIDENT)
+		{
+			++m_stats.m_numPendingChunks;
+		}
+	}
+	m_stats.m_budgetBytes = m_budgetBytes;
+	m_stats.m_numDrawableChunks = static_cast<int>(m_drawableChunks.size());
+	m_stats.m_updateSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+void OutOfCoreMesh::TakeLoadedChunks(std::vector<int>& out_pagedInChunks)
+{
+	double now = GetCurrentTimeSeconds();
+	for (int loadedIndex = 0; loadedIndex < static_cast<int>(m_loadedChunks.size()); ++loadedIndex)
+	{
+		int chunkIndex = m_loadedChunks[loadedIndex];
+		StreamedChunk& chunk = m_chunks[chunkIndex];
+		if (chunk.m_hasLoadFailed)
+		{
+			// A failed page is never requested again, so a bad chunk costs one warning rather than one per frame
+			DebuggerPrintf("WARNING: chunk %d of \"%s\" could not be read\n", chunkIndex, m_chunkedFile.c_str());
+			chunk.m_residency = ChunkResidency::NOT_RESIDENT;
+			std::vector<Vertex_PCUTBN>().swap(chunk.m_verts);
+			std::vector<unsigned int>().swap(chunk.m_indices);
+			m_committedBytes -= chunk.m_pageBytes;
+			continue;
+		}
+
+		double pageInSeconds = now - chunk.m_requestTime;
+		chunk.m_residency = ChunkResidency::RESIDENT;
+		chunk.m_requestTime = 0.0;
+		++m_stats.m_numPageIns;
+		m_stats.m_totalPageInSeconds += pageInSeconds;
+		m_stats.m_maxPageInSeconds = std::max(m_stats.m_maxPageInSeconds, pageInSeconds);
+		GetPerfStats().Sample(s_pageInMillisecondsStat, pageInSeconds * 1000.0);
+		out_pagedInChunks.push_back(chunkIndex);
+	}
+	m_loadedChunks.clear();
+}
+
+void OutOfCoreMesh::RankChunks(ViewFrustum const& view, Mat44 const& modelToWorld, ClipTransform const& modelToClip, std::vector<int>& out_evictedChunks)
+{
+	++m_frameNumber;
+
+	// The model matrix is a uniform scale times a rotation, so its transpose over scale squared inverts it
+	Vec3 iBasis = modelToWorld.GetIBasis3D();
+	Vec3 jBasis = modelToWorld.GetJBasis3D();
+	Vec3 kBasis = modelToWorld.GetKBasis3D();
+	float scale = iBasis.GetLength();
+	float inverseScaleSquared = (scale > 0.f) ? 1.f / (scale * scale) : 1.f;
+	Vec3 cameraOffset = view.m_position - modelToWorld.GetTranslation3D();
+	Vec3 cameraModelPosition = Vec3(DotProduct3D(iBasis, cameraOffset), DotProduct3D(jBasis, cameraOffset), DotProduct3D(kBasis, cameraOffset)) * inverseScaleSquared;
+	float prefetchModelDistance = (scale > 0.f) ? m_prefetchDistance / scale : m_prefetchDistance;
+
+	// Visible chunks come first, nearest first; nearby chunks outside the frustum follow as prefetch
+	std::vector<ChunkRank> rankedChunks;
+	m_stats.m_numVisibleChunks = 0;
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_chunks.size()); ++chunkIndex)
+	{
+		StreamedChunk& chunk = m_chunks[chunkIndex];
+		chunk.m_isVisible = !chunk.m_hasLoadFailed && !modelToClip.IsBoxOutsideClipVolume(chunk.m_bounds);
+		float distance = GetDistanceToBox(cameraModelPosition, chunk.m_bounds);
+		if (chunk.m_isVisible)
+		{
+			++m_stats.m_numVisibleChunks;
+			if (chunk.m_residency == ChunkResidency::RESIDENT)
+			{
+				++m_stats.m_numHits;
+			}
+			else
+			{
+				++m_stats.m_numMisses;
+			}
+			rankedChunks.push_back(ChunkRank{ false, distance, chunkIndex });
+		}
+		else if (!chunk.m_hasLoadFailed && distance <= prefetchModelDistance)
+		{
+			rankedChunks.push_back(ChunkRank{ true, distance, chunkIndex });
+		}
+	}
+	std::sort(rankedChunks.begin(), rankedChunks.end());
+
+	// Queued requests are re-issued below in the new order; pages being read or waiting to be taken have to finish
+	std::vector<int> cancelledChunks(m_requestQueue.begin(), m_requestQueue.end());
+	for (int cancelledIndex = 0; cancelledIndex < static_cast<int>(cancelledChunks.size()); ++cancelledIndex)
+	{
+		StreamedChunk& chunk = m_chunks[cancelledChunks[cancelledIndex]];
+		chunk.m_residency = ChunkResidency::NOT_RESIDENT;
+		m_committedBytes -= chunk.m_pageBytes;
+	}
+	m_requestQueue.clear();
+
+	uint64_t keptBytes = 0;
+	for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_chunks.size()); ++chunkIndex)
+	{
+		if (m_chunks[chunkIndex].m_residency == ChunkResidency::LOADING || m_chunks[chunkIndex].m_residency == ChunkResidency::LOADED)
+		{
+			keptBytes += m_chunks[chunkIndex].m_pageBytes;
+		}
+	}
+
+	// Keep the best-ranked chunks that fit the budget
+	m_rankedChunks.clear();
+	std::vector<int> requestedChunks;
+	uint64_t requestedBytes = 0;
+	for (int rankIndex = 0; rankIndex < static_cast<int>(rankedChunks.size()); ++rankIndex)
+	{
+		int chunkIndex = rankedChunks[rankIndex].m_chunkIndex;
+		StreamedChunk& chunk = m_chunks[chunkIndex];
+		m_rankedChunks.push_back(chunkIndex);
+		if (chunk.m_residency == ChunkResidency::LOADING || chunk.m_residency == ChunkResidency::LOADED)
+		{
+			chunk.m_lastUsedFrame = m_frameNumber;
+			continue;
+		}
+		if (keptBytes + chunk.m_pageBytes > m_budgetBytes)
+		{
+			break;
+		}
+
+		keptBytes += chunk.m_pageBytes;
+		chunk.m_lastUsedFrame = m_frameNumber;
+		if (chunk.m_residency == ChunkResidency::NOT_RESIDENT)
+		{
+			requestedChunks.push_back(chunkIndex);
+			requestedBytes += chunk.m_pageBytes;
+		}
+	}
+
+	// Make room by evicting whatever this ranking did not keep, least recently used first
+	if (m_committedBytes + requestedBytes > m_budgetBytes)
+	{
+		std::vector<std::pair<unsigned int, int>> evictionCandidates;
+		for (int chunkIndex = 0; chunkIndex < static_cast<int>(m_chunks.size()); ++chunkIndex)
+		{
+			StreamedChunk const& chunk = m_chunks[chunkIndex];
+			if (chunk.m_residency == ChunkResidency::RESIDENT && chunk.m_lastUsedFrame != m_frameNumber)
+			{
+				evictionCandidates.emplace_back(chunk.m_lastUsedFrame, chunkIndex);
+			}
+		}
+		std::sort(evictionCandidates.begin(), evictionCandidates.end());
+		for (int candidateIndex = 0; candidateIndex < static_cast<int>(evictionCandidates.size()) && m_committedBytes + requestedBytes > m_budgetBytes; ++candidateIndex)
+		{
+			EvictChunk(evictionCandidates[candidateIndex].second, out_evictedChunks);
+		}
+	}
+
+	double now = GetCurrentTimeSeconds();
+	for (int requestIndex = 0; requestIndex < static_cast<int>(requestedChunks.size()); ++requestIndex)
+	{
+		StreamedChunk& chunk = m_chunks[requestedChunks[requestIndex]];
+		chunk.m_residency = ChunkResidency::QUEUED;
+		if (chunk.m_requestTime == 0.0)
+		{
+			chunk.m_requestTime = now;
+		}
+		m_committedBytes += chunk.m_pageBytes;
+		m_requestQueue.push_back(requestedChunks[requestIndex]);
+	}
+
+	// Page-in latency runs from the first request, so a re-queued chunk keeps its time and a dropped one resets
+	for (int cancelledIndex = 0; cancelledIndex < static_cast<int>(cancelledChunks.size()); ++cancelledIndex)
+	{
+		StreamedChunk& chunk = m_chunks[cancelledChunks[cancelledIndex]];
+		if (chunk.m_residency == ChunkResidency::NOT_RESIDENT)
+		{
+			chunk.m_requestTime = 0.0;
+		}
+	}
+
+	if (!m_requestQueue.empty())
+	{
+		m_queueCondition.notify_one();
+	}
+}
+
+void OutOfCoreMesh::EvictChunk(int chunkIndex, std::vector<int>& out_evictedChunks)
+{
+	StreamedChunk& chunk = m_chunks[chunkIndex];
+	chunk.m_residency = ChunkResidency::NOT_RESIDENT;
+	std::vector<Vertex_PCUTBN>().swap(chunk.m_verts);
+	std::vector<unsigned int>().swap(chunk.m_indices);
+	m_committedBytes -= chunk.m_pageBytes;
+	++m_stats.m_numEvictions;
+	out_evictedChunks.push_back(chunkIndex);
+}
+
+void OutOfCoreMesh::RebuildDrawableChunks()
+{
+	// Ranked order is front to back, which also suits early depth rejection
+	m_drawableChunks.clear();
+	for (int rankIndex = 0; rankIndex < static_cast<int>(m_rankedChunks.size()); ++rankIndex)
+	{
+		StreamedChunk const& chunk = m_chunks[m_rankedChunks[rankIndex]];
+		if (chunk.m_isVisible && chunk.m_residency == ChunkResidency::RESIDENT)
+		{
+			m_drawableChunks.push_back(m_rankedChunks[rankIndex]);
+		}
+	}
+}
+
+void OutOfCoreMesh::ReleaseChunkPageData(int chunkIndex)
+{
+	StreamedChunk& chunk = m_chunks[chunkIndex];
+	if (chunk.m_residency == ChunkResidency::RESIDENT)
+	{
+		std::vector<Vertex_PCUTBN>().swap(chunk.m_verts);
+		std::vector<unsigned int>().swap(chunk.m_indices);
+	}
+}
+
+// -----------------------------------------------------------------------------
+void OutOfCoreMesh::LoaderThreadMain(FILE* file)
+{
+	for (;;)
+	{
+		int chunkIndex = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_queueMutex);
+			m_queueCondition.wait(lock, [this]() { return m_isStopping || !m_requestQueue.empty(); });
+			if (m_isStopping)
+			{
+				break;
+			}
+			chunkIndex = m_requestQueue.front();
+			m_requestQueue.pop_front();
+			m_chunks[chunkIndex].m_residency = ChunkResidency::LOADING;
+		}
+
+		StreamedChunk& chunk = m_chunks[chunkIndex];
+		bool isPageRead = ReadChunkedMeshPage(file, chunk.m_info, chunk.m_verts, chunk.m_indices);
+
+		std::lock_guard<std::mutex> lock(m_queueMutex);
+		chunk.m_residency = ChunkResidency::LOADED;
+		chunk.m_hasLoadFailed = !isPageRead;
+		m_loadedChunks.push_back(chunkIndex);
+	}
+	fclose(file);
+}
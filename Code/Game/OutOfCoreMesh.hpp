@@ -0,0 +1,115 @@
+#pragma once
+#include "Game/ChunkedMeshFile.hpp"
+#include "Game/ViewFrustum.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+// -----------------------------------------------------------------------------
+enum class ChunkResidency
+{
+	NOT_RESIDENT,
+	QUEUED,
+	LOADING,
+	LOADED,
+	RESIDENT,
+};
+// -----------------------------------------------------------------------------
+// While a chunk is QUEUED, LOADING, or LOADED its page data belongs to the loader thread;
+// the main thread only reads it again after taking it back as RESIDENT.
+struct StreamedChunk
+{
+	ChunkedMeshChunkInfo		m_info;
+	AABB3						m_bounds;
+	uint64_t					m_pageBytes = 0;
+	ChunkResidency				m_residency = ChunkResidency::NOT_RESIDENT;
+	std::vector<Vertex_PCUTBN>	m_verts;
+	std::vector<unsigned int>	m_indices;
+	bool						m_isVisible = false;
+	bool						m_hasLoadFailed = false;
+	unsigned int				m_lastUsedFrame = 0;
+	double						m_requestTime = 0.0;
+};
+// -----------------------------------------------------------------------------
+struct OutOfCoreStats
+{
+	int			m_numChunks = 0;
+	int			m_numResidentChunks = 0;
+	int			m_numVisibleChunks = 0;
+	int			m_numDrawableChunks = 0;
+	int			m_numPendingChunks = 0;
+	uint64_t	m_residentBytes = 0;
+	uint64_t	m_budgetBytes = 0;
+	uint64_t	m_numHits = 0;
+	uint64_t	m_numMisses = 0;
+	uint64_t	m_numPageIns = 0;
+	uint64_t	m_numEvictions = 0;
+	double		m_totalPageInSeconds = 0.0;
+	double		m_maxPageInSeconds = 0.0;
+	double		m_updateSeconds = 0.0;
+
+	double GetHitRate() const { return (m_numHits + m_numMisses > 0) ? static_cast<double>(m_numHits) / static_cast<double>(m_numHits + m_numMisses) : 1.0; }
+	double GetAveragePageInSeconds() const { return (m_numPageIns > 0) ? m_totalPageInSeconds / static_cast<double>(m_numPageIns) : 0.0; }
+};
+// -----------------------------------------------------------------------------
+// Views a chunked mesh file without loading it whole. Each update ranks chunks in the view
+// frustum nearest-first, then chunks near the camera as prefetch; the ranked chunks that fit
+// the memory budget are paged in by a loader thread, and anything else is evicted least
+// recently used first once the budget is exceeded.
+// -----------------------------------------------------------------------------
+class OutOfCoreMesh
+{
+public:
+	OutOfCoreMesh() = default;
+	~OutOfCoreMesh();
+
+	bool Open(std::string const& chunkedFile, uint64_t budgetBytes, std::string& out_errorMessage);
+	void Close();
+	bool IsOpen() const { return m_loaderThread.joinable(); }
+
+	void SetBudgetBytes(uint64_t budgetBytes) { m_budgetBytes = budgetBytes; m_isRankingDirty = true; }
+	void SetPrefetchDistance(float prefetchDistance) { m_prefetchDistance = prefetchDistance; m_isRankingDirty = true; }
+
+	// Takes in finished pages and, when the view moved, re-ranks every chunk. Paged-in chunks are
+	// RESIDENT with their verts and indices filled in; evicted chunks have already been freed.
+	void Update(ViewFrustum const& view, Mat44 const& modelToWorld, std::vector<int>& out_pagedInChunks, std::vector<int>& out_evictedChunks);
+
+	// Drops the CPU copy of a resident page once it lives somewhere else (e.g. on the GPU); it still counts against the budget
+	void ReleaseChunkPageData(int chunkIndex);
+
+	int									GetNumChunks() const { return static_cast<int>(m_chunks.size()); }
+	StreamedChunk const&				GetChunk(int chunkIndex) const { return m_chunks[chunkIndex]; }
+	std::vector<int> const&				GetDrawableChunks() const { return m_drawableChunks; }
+	AABB3								GetBounds() const { return m_bounds; }
+	uint64_t							GetNumTriangles() const { return m_numTriangles; }
+	OutOfCoreStats const&				GetStats() const { return m_stats; }
+
+private:
+	void LoaderThreadMain(FILE* file);
+	void TakeLoadedChunks(std::vector<int>& out_pagedInChunks);
+	void RankChunks(ViewFrustum const& view, Mat44 const& modelToWorld, ClipTransform const& modelToClip, std::vector<int>& out_evictedChunks);
+	void EvictChunk(int chunkIndex, std::vector<int>& out_evictedChunks);
+	void RebuildDrawableChunks();
+
+private:
+	std::string					m_chunkedFile;
+	std::vector<StreamedChunk>	m_chunks;
+	AABB3						m_bounds;
+	uint64_t					m_numTriangles = 0;
+	uint64_t					m_budgetBytes = 0;
+	uint64_t					m_committedBytes = 0;
+	float						m_prefetchDistance = 0.f;
+	unsigned int				m_frameNumber = 0;
+	bool						m_isRankingDirty = true;
+	ClipTransform				m_rankedModelToClip;
+	std::vector<int>			m_rankedChunks;
+	std::vector<int>			m_drawableChunks;
+	OutOfCoreStats				m_stats;
+
+	std::thread					m_loaderThread;
+	std::mutex					m_queueMutex;
+	std::condition_variable		m_queueCondition;
+	std::deque<int>				m_requestQueue;
+	std::vector<int>			m_loadedChunks;
+	bool						m_isStopping = false;
+};
@@ -0,0 +1,359 @@
+#include "Game/PNGWriter.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -----------------------------------------------------------------------------
+struct CRCTable
+{
+	CRCTable()
+	{
+		for (unsigned int tableIndex = 0; tableIndex < 256; ++tableIndex)
+		{
+			unsigned int crc = tableIndex;
+			for (int bit = 0; bit < 8; ++bit)
+			{
+				crc = (crc & 1) ? (0xEDB88320u ^ (crc >> 1)) : (crc >> 1);
+			}
+			m_entries[tableIndex] = crc;
+		}
+	}
+
+	unsigned int m_entries[256];
+};
+
+static unsigned int UpdateCRC(unsigned int crc, unsigned char const* bytes, size_t numBytes)
+{
+	static CRCTable const s_crcTable;
+	unsigned int const* crcTable = s_crcTable.m_entries;
+	for (size_t byteIndex = 0; byteIndex < numBytes; ++byteIndex)
+	{
+		crc = crcTable[(crc ^ bytes[byteIndex]) & 0xFF] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+static unsigned int GetAdler32(unsigned char const* bytes, size_t numBytes)
+{
+	unsigned int a = 1;
+	unsigned int b = 0;
+	while (numBytes > 0)
+	{
+		// 5552 is the longest run before b can overflow 32 bits
+		size_t runLength = (numBytes < 5552) ? numBytes : 5552;
+		numBytes -= runLength;
+		for (size_t byteIndex = 0; byteIndex < runLength; ++byteIndex)
+		{
+			a += *bytes++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+// -----------------------------------------------------------------------------
+// Deflate
+// -----------------------------------------------------------------------------
+class DeflateBitWriter
+{
+public:
+	explicit DeflateBitWriter(std::vector<unsigned char>& out_bytes)
+		: m_bytes(out_bytes)
+	{
+	}
+
+	void WriteBits(unsigned int value, int numBits)
+	{
+		m_bitBuffer |= static_cast<unsigned long long>(value) << m_numBits;
+		m_numBits += numBits;
+		while (m_numBits >= 8)
+		{
+			m_bytes.push_back(static_cast<unsigned char>(m_bitBuffer & 0xFF));
+			m_bitBuffer >>= 8;
+			m_numBits -= 8;
+		}
+	}
+
+	// Huffman codes are defined MSB-first but packed LSB-first
+	void WriteCode(unsigned int code, int numBits)
+	{
+		unsigned int reversed = 0;
+		for (int bit = 0; bit < numBits; ++bit)
+		{
+			reversed = (reversed << 1) | ((code >> bit) & 1);
+		}
+		WriteBits(reversed, numBits);
+	}
+
+	void Flush()
+	{
+		if (m_numBits > 0)
+		{
+			m_bytes.push_back(static_cast<unsigned char>(m_bitBuffer & 0xFF));
+		}
+		m_bitBuffer = 0;
+		m_numBits = 0;
+	}
+
+private:
+	std::vector<unsigned char>& m_bytes;
+	unsigned long long			m_bitBuffer = 0;
+	int							m_numBits = 0;
+};
+
+static unsigned short const s_lengthBases[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static unsigned char const s_lengthExtraBits[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static unsigned short const s_distanceBases[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static unsigned char const s_distanceExtraBits[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static void WriteFixedLiteralOrLength(DeflateBitWriter& writer, int symbol)
+{
+	if (symbol < 144)		writer.WriteCode(0x30 + symbol, 8);
+	else if (symbol < 256)	writer.WriteCode(0x190 + (symbol - 144), 9);
+	else if (symbol < 280)	writer.WriteCode(symbol - 256, 7);
+	else					writer.WriteCode(0xC0 + (symbol - 280), 8);
+}
+
+static void WriteMatch(DeflateBitWriter& writer, int length, int distance)
+{
+	int lengthCode = 28;
+	while (s_lengthBases[lengthCode] > length)
+	{
+		--lengthCode;
+	}
+	WriteFixedLiteralOrLength(writer, 257 + lengthCode);
+	writer.WriteBits(static_cast<unsigned int>(length - s_lengthBases[lengthCode]), s_lengthExtraBits[lengthCode]);
+
+	int distanceCode = 29;
+	while (s_distanceBases[distanceCode] > distance)
+	{
+		--distanceCode;
+	}
+	writer.WriteCode(static_cast<unsigned int>(distanceCode), 5);
+	writer.WriteBits(static_cast<unsigned int>(distance - s_distanceBases[distanceCode]), s_distanceExtraBits[distanceCode]);
+}
+
+static void DeflateFixedHuffman(std::vector<unsigned char>& out_bytes, unsigned char const* data, int numBytes)
+{
+	constexpr int HASH_BITS = 15;
+	constexpr int WINDOW_SIZE = 32768;
+	constexpr int MIN_MATCH = 3;
+	constexpr int MAX_MATCH = 258;
+	constexpr int MAX_CHAIN_LENGTH = 32;
+
+	std::vector<int> hashHeads(1 << HASH_BITS, -1);
+	std::vector<int> previousInChain(WINDOW_SIZE, -1);
+	auto getHash = [data](int position)
+	{
+		unsigned int key = (static_cast<unsigned int>(data[position]) << 16) | (static_cast<unsigned int>(data[position + 1]) << 8) | data[position + 2];
+		return static_cast<int>((key * 2654435761u) >> (32 - HASH_BITS));
+	};
+	auto insertPosition = [&](int position)
+	{
+		int hash = getHash(position);
+		previousInChain[position & (WINDOW_SIZE - 1)] = hashHeads[hash];
+		hashHeads[hash] = position;
+	};
+
+	DeflateBitWriter writer(out_bytes);
+	writer.WriteBits(1, 1);	// BFINAL
+	writer.WriteBits(1, 2);	// BTYPE = fixed Huffman
+
+	int position = 0;
+	while (position < numBytes)
+	{
+		int bestLength = 0;
+		int bestDistance = 0;
+		if (position + MIN_MATCH <= numBytes)
+		{
+			int maxLength = (numBytes - position < MAX_MATCH) ? (numBytes - position) : MAX_MATCH;
+			int candidate = hashHeads[getHash(position)];
+			for (int chainIndex = 0; chainIndex < MAX_CHAIN_LENGTH && candidate >= 0 && position - candidate <= WINDOW_SIZE; ++chainIndex)
+			{
+				if (data[candidate + bestLength] == data[position + bestLength])
+				{
+					int length = 0;
+					while (length < maxLength && data[candidate + length] == data[position + length])
+					{
+						++length;
+					}
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = position - candidate;
+						if (length == maxLength)
+						{
+							break;
+						}
+					}
+				}
+				candidate = previousInChain[candidate & (WINDOW_SIZE - 1)];
+			}
+		}
+
+		if (bestLength >= MIN_MATCH)
+		{
+			WriteMatch(writer, bestLength, bestDistance);
+			int matchEnd = position + bestLength;
+			for (; position < matchEnd; ++position)
+			{
+				if (position + MIN_MATCH <= numBytes)
+				{
+					insertPosition(position);
+				}
+			}
+		}
+		else
+		{
+			WriteFixedLiteralOrLength(writer, data[position]);
+			if (position + MIN_MATCH <= numBytes)
+			{
+				insertPosition(position);
+			}
+			++position;
+		}
+	}
+
+	WriteFixedLiteralOrLength(writer, 256);
+	writer.Flush();
+}
+
+// -----------------------------------------------------------------------------
+// PNG
+// -----------------------------------------------------------------------------
+static unsigned char GetPaethPredictor(int left, int above, int aboveLeft)
+{
+	int estimate = left + above - aboveLeft;
+	int leftDistance = abs(estimate - left);
+	int aboveDistance = abs(estimate - above);
+	int aboveLeftDistance = abs(estimate - aboveLeft);
+	if (leftDistance <= aboveDistance && leftDistance <= aboveLeftDistance)
+	{
+		return static_cast<unsigned char>(left);
+	}
+	return static_cast<unsigned char>((aboveDistance <= aboveLeftDistance) ? above : aboveLeft);
+}
+
+// Tries each filter type and keeps the one with the smallest sum of absolute signed residuals
+static void FilterRow(unsigned char* out_filteredRow, unsigned char const* row, unsigned char const* previousRow, int rowBytes, unsigned char* candidate)
+{
+	constexpr int BYTES_PER_PIXEL = 4;
+	unsigned int bestScore = 0xFFFFFFFFu;
+	for (int filterType = 0; filterType < 5; ++filterType)
+	{
+		unsigned int score = 0;
+		for (int byteIndex = 0; byteIndex < rowBytes; ++byteIndex)
+		{
+			int left = (byteIndex >= BYTES_PER_PIXEL) ? row[byteIndex - BYTES_PER_PIXEL] : 0;
+			int above = (previousRow != nullptr) ? previousRow[byteIndex] : 0;
+			int aboveLeft = (previousRow != nullptr && byteIndex >= BYTES_PER_PIXEL) ? previousRow[byteIndex - BYTES_PER_PIXEL] : 0;
+			int prediction = 0;
+			switch (filterType)
+			{
+				case 1:	prediction = left; break;
+				case 2:	prediction = above; break;
+				case 3:	prediction = (left + above) / 2; break;
+				case 4:	prediction = GetPaethPredictor(left, above, aboveLeft); break;
+				default: break;
+			}
+			unsigned char residual = static_cast<unsigned char>(row[byteIndex] - prediction);
+			candidate[byteIndex] = residual;
+			score += (residual < 128) ? residual : (256 - residual);
+		}
+
+		if (score < bestScore)
+		{
+			bestScore = score;
+			out_filteredRow[0] = static_cast<unsigned char>(filterType);
+			memcpy(out_filteredRow + 1, candidate, rowBytes);
+		}
+	}
+}
+
+static void AppendBigEndian32(std::vector<unsigned char>& out_bytes, unsigned int value)
+{
+	out_bytes.push_back(static_cast<unsigned char>(value >> 24));
+	out_bytes.push_back(static_cast<unsigned char>(value >> 16));
+	out_bytes.push_back(static_cast<unsigned char>(value >> 8));
+	out_bytes.push_back(static_cast<unsigned char>(value));
+}
+
+static void AppendChunk(std::vector<unsigned char>& out_png, char const* chunkType, unsigned char const* chunkData, size_t chunkSize)
+{
+	AppendBigEndian32(out_png, static_cast<unsigned int>(chunkSize));
+	size_t typeOffset = out_png.size();
+	out_png.insert(out_png.end(), chunkType, chunkType + 4);
+	out_png.insert(out_png.end(), chunkData, chunkData + chunkSize);
+	unsigned int crc = UpdateCRC(0xFFFFFFFFu, out_png.data() + typeOffset, chunkSize + 4) ^ 0xFFFFFFFFu;
+	AppendBigEndian32(out_png, crc);
+}
+
+// -----------------------------------------------------------------------------
+void EncodePNG(std::vector<unsigned char>& out_png, unsigned char const* rgbaPixels, int width, int height)
+{
+	int rowBytes = width * 4;
+	std::vector<unsigned char> filtered(static_cast<size_t>(rowBytes + 1) * height);
+	std::vector<unsigned char> candidateRow(rowBytes);
+	for (int y = 0; y < height; ++y)
+	{
+		unsigned char const* row = rgbaPixels + static_cast<size_t>(y) * rowBytes;
+		unsigned char const* previousRow = (y > 0) ? row - rowBytes : nullptr;
+		FilterRow(&filtered[static_cast<size_t>(y) * (rowBytes + 1)], row, previousRow, rowBytes, candidateRow.data());
+	}
+
+	// zlib stream: header, deflate data, Adler-32 of the uncompressed bytes
+	std::vector<unsigned char> zlibStream;
+	zlibStream.reserve(filtered.size() / 2);
+	zlibStream.push_back(0x78);
+	zlibStream.push_back(0x01);
+	DeflateFixedHuffman(zlibStream, filtered.data(), static_cast<int>(filtered.size()));
+	AppendBigEndian32(zlibStream, GetAdler32(filtered.data(), filtered.size()));
+
+	static unsigned char const s_signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	out_png.assign(s_signature, s_signature + 8);
+
+	std::vector<unsigned char> header;
+	AppendBigEndian32(header, static_cast<unsigned int>(width));
+	AppendBigEndian32(header, static_cast<unsigned int>(height));
+	unsigned char const headerTail[5] = { 8, 6, 0, 0, 0 };	// 8 bits per channel, RGBA, deflate, adaptive filtering, no interlace
+	header.insert(header.end(), headerTail, headerTail + 5);
+
+	AppendChunk(out_png, "IHDR", header.data(), header.size());
+	AppendChunk(out_png, "IDAT", zlibStream.data(), zlibStream.size());
+	AppendChunk(out_png, "IEND", nullptr, 0);
+}
+
+bool WritePNGFile(std::string const& filePath, unsigned char const* rgbaPixels, int width, int height, std::string& out_errorMessage, size_t* out_fileSize)
+{
+	std::vector<unsigned char> png;
+	EncodePNG(png, rgbaPixels, width, height);
+
+	FILE* file = nullptr;
+#if defined(_MSC_VER)
+	if (fopen_s(&file, filePath.c_str(), "wb") != 0)
+	{
+		file = nullptr;
+	}
+#else
+	file = fopen(filePath.c_str(), "wb");
+#endif
+	if (file == nullptr)
+	{
+		out_errorMessage = "could not open \"" + filePath + "\" for writing";
+		return false;
+	}
+	size_t numWritten = fwrite(png.data(), 1, png.size(), file);
+	fclose(file);
+	if (numWritten != png.size())
+	{
+		out_errorMessage = "could not write \"" + filePath + "\"";
+		return false;
+	}
+	if (out_fileSize != nullptr)
+	{
+		*out_fileSize = png.size();
+	}
+	return true;
+}
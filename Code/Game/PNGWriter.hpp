@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+// Minimal PNG encoder for 8-bit RGBA images: per-row adaptive filtering and a single
+// fixed-Huffman deflate block with hash-chain LZ77. Self-contained and thread-safe, so
+// captures can be encoded on worker threads without pulling in an image library.
+// -----------------------------------------------------------------------------
+void EncodePNG(std::vector<unsigned char>& out_png, unsigned char const* rgbaPixels, int width, int height);
+bool WritePNGFile(std::string const& filePath, unsigned char const* rgbaPixels, int width, int height, std::string& out_errorMessage, size_t* out_fileSize = nullptr);
@@ -0,0 +1,153 @@
+#include "Game/ParallelFor.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+class ParallelForPool
+{
+public:
+	ParallelForPool()
+	{
+		unsigned int numHardwareThreads = std::thread::hardware_concurrency();
+		int numWorkers = (numHardwareThreads > 1) ? static_cast<int>(numHardwareThreads) - 1 : 0;
+		for (int workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+		{
+			m_workers.emplace_back(&ParallelForPool::WorkerMain, this);
+		}
+	}
+
+	~ParallelForPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_isQuitting = true;
+		}
+		m_workAvailable.notify_all();
+		for (int workerIndex = 0; workerIndex < static_cast<int>(m_workers.size()); ++workerIndex)
+		{
+			m_workers[workerIndex].join();
+		}
+	}
+
+	int GetNumThreads() const
+	{
+		return static_cast<int>(m_workers.size()) + 1;
+	}
+
+	void Run(int numItems, int chunkSize, std::function<void(int, int)> const& task)
+	{
+		std::unique_lock<std::mutex> dispatchLock(m_dispatchMutex, std::try_to_lock);
+		if (!dispatchLock.owns_lock() || m_workers.empty() || numItems <= chunkSize)
+		{
+			task(0, numItems);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_task = &task;
+			m_numItems = numItems;
+			m_chunkSize = chunkSize;
+			m_nextItem = 0;
+			m_numActiveWorkers = static_cast<int>(m_workers.size());
+			++m_generation;
+		}
+		m_workAvailable.notify_all();
+
+		RunChunks();
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_workFinished.wait(lock, [this]() { return m_numActiveWorkers == 0; });
+		m_task = nullptr;
+	}
+
+private:
+	void RunChunks()
+	{
+		for (;;)
+		{
+			int beginIndex = m_nextItem.fetch_add(m_chunkSize);
+			if (beginIndex >= m_numItems)
+			{
+				return;
+			}
+			int endIndex = (beginIndex + m_chunkSize < m_numItems) ? beginIndex + m_chunkSize : m_numItems;
+			(*m_task)(beginIndex, endIndex);
+		}
+	}
+
+	void WorkerMain()
+	{
+		unsigned long long lastGeneration = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_workAvailable.wait(lock, [this, lastGeneration]() { return m_isQuitting || m_generation != lastGeneration; });
+				if (m_isQuitting)
+				{
+					return;
+				}
+				lastGeneration = m_generation;
+			}
+
+			RunChunks();
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				--m_numActiveWorkers;
+			}
+			m_workFinished.notify_one();
+		}
+	}
+
+private:
+	std::vector<std::thread>				m_workers;
+	std::mutex								m_dispatchMutex;
+	std::mutex								m_mutex;
+	std::condition_variable					m_workAvailable;
+	std::condition_variable					m_workFinished;
+	std::function<void(int, int)> const*	m_task = nullptr;
+	int										m_numItems = 0;
+	int										m_chunkSize = 1;
+	std::atomic<int>						m_nextItem = 0;
+	int										m_numActiveWorkers = 0;
+	unsigned long long						m_generation = 0;
+	bool									m_isQuitting = false;
+};
+
+// -----------------------------------------------------------------------------
+static ParallelForPool& GetParallelForPool()
+{
+	static ParallelForPool s_pool;
+	return s_pool;
+}
+
+void ParallelFor(int numItems, int minItemsPerTask, std::function<void(int beginIndex, int endIndex)> const& task)
+{
+	if (numItems <= 0)
+	{
+		return;
+	}
+
+	// Aim for a few chunks per thread so uneven chunks still balance out
+	ParallelForPool& pool = GetParallelForPool();
+	int chunkSize = numItems / (pool.GetNumThreads() * 4);
+	if (chunkSize < minItemsPerTask)
+	{
+		chunkSize = minItemsPerTask;
+	}
+	if (chunkSize < 1)
+	{
+		chunkSize = 1;
+	}
+	pool.Run(numItems, chunkSize, task);
+}
+
+int GetParallelForNumThreads()
+{
+	return GetParallelForPool().GetNumThreads();
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <functional>
+// -----------------------------------------------------------------------------
+// Splits [0, numItems) into chunks of at least minItemsPerTask and runs them on a persistent pool
+// of worker threads, with the calling thread helping out. Returns once every chunk has finished.
+// If the pool is already busy (e.g. a nested call from inside a task), the range runs serially.
+// -----------------------------------------------------------------------------
+void ParallelFor(int numItems, int minItemsPerTask, std::function<void(int beginIndex, int endIndex)> const& task);
+int  GetParallelForNumThreads();
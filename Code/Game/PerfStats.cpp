@@ -0,0 +1,370 @@
+#include "Game/PerfStats.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+PerfStats& GetPerfStats()
+{
+	static PerfStats s_perfStats;
+	return s_perfStats;
+}
+
+unsigned long long GetProcessMemoryBytes()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS memoryCounters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters)))
+	{
+		return 0;
+	}
+	return static_cast<unsigned long long>(memoryCounters.WorkingSetSize);
+#else
+	unsigned long long numPages = 0;
+	unsigned long long numResidentPages = 0;
+	FILE* statmFile = fopen("/proc/self/statm", "r");
+	if (statmFile == nullptr)
+	{
+		return 0;
+	}
+	int numRead = fscanf(statmFile, "%llu %llu", &numPages, &numResidentPages);
+	fclose(statmFile);
+	return (numRead == 2) ? numResidentPages * static_cast<unsigned long long>(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+PerfStats::PerfStats()
+{
+	m_stats.reserve(PERF_MAX_STATS);
+}
+
+PerfStatId PerfStats::Register(char const* name, PerfStatType type)
+{
+	std::lock_guard<std::mutex> lock(m_registryMutex);
+	for (int statIndex = 0; statIndex < static_cast<int>(m_stats.size()); ++statIndex)
+	{
+		if (m_stats[statIndex].m_name == name)
+		{
+			return statIndex;
+		}
+	}
+
+	GUARANTEE_OR_DIE(static_cast<int>(m_stats.size()) < PERF_MAX_STATS, Stringf("Too many perf stats registered (\"%s\")", name));
+	StatInfo stat;
+	stat.m_name = name;
+	stat.m_type = type;
+	m_stats.push_back(stat);
+	return static_cast<int>(m_stats.size()) - 1;
+}
+
+int PerfStats::GetNumStats() const
+{
+	std::lock_guard<std::mutex> lock(m_registryMutex);
+	return static_cast<int>(m_stats.size());
+}
+
+PerfStats::ThreadBuffer& PerfStats::GetThreadBuffer()
+{
+	// Marks the buffer retired when its thread exits; EndFrame merges what is left and frees it
+	struct ThreadBufferOwner
+	{
+		ThreadBuffer* m_threadBuffer = nullptr;
+		~ThreadBufferOwner()
+		{
+			if (m_threadBuffer != nullptr)
+			{
+				m_threadBuffer->m_isRetired.store(true, std::memory_order_release);
+			}
+		}
+	};
+
+	thread_local ThreadBufferOwner t_threadBufferOwner;
+	if (t_threadBufferOwner.m_threadBuffer == nullptr)
+	{
+		ThreadBuffer* threadBuffer = new ThreadBuffer();
+		for (int frameIndex = 0; frameIndex < 2; ++frameIndex)
+		{
+			ThreadFrame& threadFrame = threadBuffer->m_frames[frameIndex];
+			threadFrame.m_sums.resize(PERF_MAX_STATS, 0.0);
+			threadFrame.m_gauges.resize(PERF_MAX_STATS, 0.0);
+			threadFrame.m_isGaugeSet.resize(PERF_MAX_STATS, 0);
+			threadFrame.m_samples.resize(PERF_MAX_STATS);
+		}
+
+		std::lock_guard<std::mutex> lock(m_registryMutex);
+		m_threadBuffers.push_back(threadBuffer);
+		t_threadBufferOwner.m_threadBuffer = threadBuffer;
+	}
+	return *t_threadBufferOwner.m_threadBuffer;
+}
+
+PerfStats::ThreadFrame& PerfStats::BeginThreadWrite(ThreadBuffer& threadBuffer)
+{
+	// Announce the frame, then confirm EndFrame has not flipped away from it; EndFrame flips, then
+	// waits out any write announced on the old frame, so one of the two always sees the other
+	int frameIndex = threadBuffer.m_writeFrame.load();
+	for (;;)
+	{
+		threadBuffer.m_writingFrame.store(frameIndex);
+		int currentFrameIndex = threadBuffer.m_writeFrame.load();
+		if (currentFrameIndex == frameIndex)
+		{
+			return threadBuffer.m_frames[frameIndex];
+		}
+		frameIndex = currentFrameIndex;
+	}
+}
+
+void PerfStats::Add(PerfStatId statId, double amount)
+{
+	ThreadBuffer& threadBuffer = GetThreadBuffer();
+	BeginThreadWrite(threadBuffer).m_sums[statId] += amount;
+	threadBuffer.m_writingFrame.store(-1);
+}
+
+void PerfStats::Set(PerfStatId statId, double value)
+{
+	ThreadBuffer& threadBuffer = GetThreadBuffer();
+	ThreadFrame& threadFrame = BeginThreadWrite(threadBuffer);
+	threadFrame.m_gauges[statId] = value;
+	threadFrame.m_isGaugeSet[statId] = 1;
+	threadBuffer.m_writingFrame.store(-1);
+}
+
+void PerfStats::Sample(PerfStatId statId, double value)
+{
+	ThreadBuffer& threadBuffer = GetThreadBuffer();
+	BeginThreadWrite(threadBuffer).m_samples[statId].push_back(static_cast<float>(value));
+	threadBuffer.m_writingFrame.store(-1);
+}
+
+// -----------------------------------------------------------------------------
+void PerfStats::EndFrame()
+{
+	std::unique_lock<std::mutex> registryLock(m_registryMutex);
+	int numStats = static_cast<int>(m_stats.size());
+
+	// Counters and histograms start the frame empty; gauges keep their value until set again
+	for (int statIndex = 0; statIndex < numStats; ++statIndex)
+	{
+		StatInfo& stat = m_stats[statIndex];
+		if (stat.m_type != PerfStatType::GAUGE)
+		{
+			stat.m_frameValue = PerfStatFrameValue();
+		}
+	}
+
+	for (int bufferIndex = 0; bufferIndex < static_cast<int>(m_threadBuffers.size()); )
+	{
+		ThreadBuffer* threadBuffer = m_threadBuffers[bufferIndex];
+
+		// A retired thread writes nothing more, so its last frame is merged and the buffer freed; the
+		// other frame was emptied when this frame was flipped in
+		if (threadBuffer->m_isRetired.load(std::memory_order_acquire))
+		{
+			MergeThreadFrame(threadBuffer->m_frames[threadBuffer->m_writeFrame.load()], numStats);
+			delete threadBuffer;
+			m_threadBuffers[bufferIndex] = m_threadBuffers.back();
+			m_threadBuffers.pop_back();
+			continue;
+		}
+
+		int mergeFrame = threadBuffer->m_writeFrame.load();
+		threadBuffer->m_writeFrame.store(1 - mergeFrame);
+		while (threadBuffer->m_writingFrame.load() == mergeFrame)
+		{
+			std::this_thread::yield();
+		}
+		MergeThreadFrame(threadBuffer->m_frames[mergeFrame], numStats);
+		++bufferIndex;
+	}
+
+	for (int statIndex = 0; statIndex < numStats; ++statIndex)
+	{
+		StatInfo& stat = m_stats[statIndex];
+		if (stat.m_type == PerfStatType::HISTOGRAM)
+		{
+			if (stat.m_frameValue.m_numSamples > 0)
+			{
+				stat.m_frameValue.m_value /= static_cast<double>(stat.m_frameValue.m_numSamples);
+			}
+			UpdatePercentiles(stat);
+		}
+	}
+
+	++m_frameNumber;
+	registryLock.unlock();
+
+	if (m_streamFile != nullptr)
+	{
+		WriteStreamFrame();
+	}
+}
+
+void PerfStats::MergeThreadFrame(ThreadFrame& threadFrame, int numStats)
+{
+	for (int statIndex = 0; statIndex < numStats; ++statIndex)
+	{
+		StatInfo& stat = m_stats[statIndex];
+		PerfStatFrameValue& frameValue = stat.m_frameValue;
+		if (stat.m_type == PerfStatType::COUNTER)
+		{
+			frameValue.m_value += threadFrame.m_sums[statIndex];
+			threadFrame.m_sums[statIndex] = 0.0;
+		}
+		else if (stat.m_type == PerfStatType::GAUGE)
+		{
+			if (threadFrame.m_isGaugeSet[statIndex])
+			{
+				frameValue.m_value = threadFrame.m_gauges[statIndex];
+				threadFrame.m_isGaugeSet[statIndex] = 0;
+			}
+		}
+		else
+		{
+			std::vector<float>& samples = threadFrame.m_samples[statIndex];
+			for (int sampleIndex = 0; sampleIndex < static_cast<int>(samples.size()); ++sampleIndex)
+			{
+				double sample = static_cast<double>(samples[sampleIndex]);
+				frameValue.m_min = (frameValue.m_numSamples == 0 || sample < frameValue.m_min) ? sample : frameValue.m_min;
+				frameValue.m_max = (frameValue.m_numSamples == 0 || sample > frameValue.m_max) ? sample : frameValue.m_max;
+				frameValue.m_value += sample;
+				++frameValue.m_numSamples;
+
+				if (static_cast<int>(stat.m_recentSamples.size()) < PERF_HISTOGRAM_WINDOW)
+				{
+					stat.m_recentSamples.push_back(samples[sampleIndex]);
+				}
+				else
+				{
+					stat.m_recentSamples[stat.m_nextRecentSample] = samples[sampleIndex];
+				}
+				stat.m_nextRecentSample = (stat.m_nextRecentSample + 1) % PERF_HISTOGRAM_WINDOW;
+			}
+			samples.clear();
+		}
+	}
+}
+
+void PerfStats::UpdatePercentiles(StatInfo& stat) const
+{
+	if (stat.m_recentSamples.empty())
+	{
+		return;
+	}
+
+	std::vector<float> sortedSamples = stat.m_recentSamples;
+	int numSamples = static_cast<int>(sortedSamples.size());
+	int medianIndex = numSamples / 2;
+	int p95Index = (numSamples * 95) / 100;
+	p95Index = (p95Index < numSamples) ? p95Index : numSamples - 1;
+	std::nth_element(sortedSamples.begin(), sortedSamples.begin() + medianIndex, sortedSamples.end());
+	stat.m_frameValue.m_p50 = sortedSamples[medianIndex];
+	std::nth_element(sortedSamples.begin(), sortedSamples.begin() + p95Index, sortedSamples.end());
+	stat.m_frameValue.m_p95 = sortedSamples[p95Index];
+}
+
+// -----------------------------------------------------------------------------
+bool PerfStats::StartStream(std::string const& filePath, PerfStreamFormat format, std::string& out_errorMessage)
+{
+	StopStream();
+
+#if defined(_MSC_VER)
+	if (fopen_s(&m_streamFile, filePath.c_str(), "w") != 0)
+	{
+		m_streamFile = nullptr;
+	}
+#else
+	m_streamFile = fopen(filePath.c_str(), "w");
+#endif
+	if (m_streamFile == nullptr)
+	{
+		out_errorMessage = Stringf("could not open \"%s\" for writing", filePath.c_str());
+		return false;
+	}
+
+	m_streamFilePath = filePath;
+	m_streamFormat = format;
+	m_numStreamedStats = GetNumStats();
+
+	// CSV columns are fixed when the stream starts; stats registered later only appear in JSON streams
+	if (m_streamFormat == PerfStreamFormat::CSV)
+	{
+		fprintf(m_streamFile, "frame");
+		for (int statIndex = 0; statIndex < m_numStreamedStats; ++statIndex)
+		{
+			StatInfo const& stat = m_stats[statIndex];
+			if (stat.m_type == PerfStatType::HISTOGRAM)
+			{
+				fprintf(m_streamFile, ",%s_mean,%s_max,%s_p95", stat.m_name.c_str(), stat.m_name.c_str(), stat.m_name.c_str());
+			}
+			else
+			{
+				fprintf(m_streamFile, ",%s", stat.m_name.c_str());
+			}
+		}
+		fprintf(m_streamFile, "\n");
+	}
+	return true;
+}
+
+void PerfStats::StopStream()
+{
+	if (m_streamFile != nullptr)
+	{
+		fclose(m_streamFile);
+		m_streamFile = nullptr;
+	}
+	m_streamFilePath.clear();
+}
+
+void PerfStats::WriteStreamFrame()
+{
+	int numStats = (m_streamFormat == PerfStreamFormat::CSV) ? m_numStreamedStats : GetNumStats();
+	if (m_streamFormat == PerfStreamFormat::CSV)
+	{
+		fprintf(m_streamFile, "%d", m_frameNumber);
+		for (int statIndex = 0; statIndex < numStats; ++statIndex)
+		{
+			StatInfo const& stat = m_stats[statIndex];
+			PerfStatFrameValue const& frameValue = stat.m_frameValue;
+			if (stat.m_type == PerfStatType::HISTOGRAM)
+			{
+				fprintf(m_streamFile, ",%.6g,%.6g,%.6g", frameValue.m_value, frameValue.m_max, frameValue.m_p95);
+			}
+			else
+			{
+				fprintf(m_streamFile, ",%.6g", frameValue.m_value);
+			}
+		}
+		fprintf(m_streamFile, "\n");
+		return;
+	}
+
+	fprintf(m_streamFile, "{\"frame\":%d", m_frameNumber);
+	for (int statIndex = 0; statIndex < numStats; ++statIndex)
+	{
+		StatInfo const& stat = m_stats[statIndex];
+		PerfStatFrameValue const& frameValue = stat.m_frameValue;
+		if (stat.m_type == PerfStatType::HISTOGRAM)
+		{
+			fprintf(m_streamFile, ",\"%s\":{\"count\":%d,\"mean\":%.6g,\"min\":%.6g,\"max\":%.6g,\"p50\":%.6g,\"p95\":%.6g}", stat.m_name.c_str(),
+				frameValue.m_numSamples, frameValue.m_value, frameValue.m_min, frameValue.m_max, frameValue.m_p50, frameValue.m_p95);
+		}
+		else
+		{
+			fprintf(m_streamFile, ",\"%s\":%.6g", stat.m_name.c_str(), frameValue.m_value);
+		}
+	}
+	fprintf(m_streamFile, "}\n");
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class PerfStatType
+{
+	COUNTER,	// Summed over the frame, then reset
+	GAUGE,		// Holds the last value set
+	HISTOGRAM,	// Per-frame samples; reports count, mean, min, max and rolling percentiles
+};
+// -----------------------------------------------------------------------------
+enum class PerfStreamFormat
+{
+	CSV,
+	JSON_LINES,
+};
+// -----------------------------------------------------------------------------
+typedef int PerfStatId;
+
+constexpr int PERF_MAX_STATS = 256;
+constexpr int PERF_HISTOGRAM_WINDOW = 240;
+// -----------------------------------------------------------------------------
+struct PerfStatFrameValue
+{
+	double	m_value = 0.0;		// Counter total, gauge value, or histogram mean
+	double	m_min = 0.0;
+	double	m_max = 0.0;
+	int		m_numSamples = 0;
+	double	m_p50 = 0.0;		// Histograms only, over the last PERF_HISTOGRAM_WINDOW samples
+	double	m_p95 = 0.0;
+};
+// -----------------------------------------------------------------------------
+// Frame stats registry. Add/Set/Sample write without locking to a buffer owned by the calling thread,
+// which holds two frames: the thread writes one while EndFrame flips it and merges the other, then
+// optionally streams the frame to a CSV or JSON-lines file. A thread's buffer is registered on its
+// first write and freed by the first EndFrame after the thread exits.
+//
+// Register once and keep the id, e.g. static PerfStatId const s_stat = GetPerfStats().Register(...)
+// -----------------------------------------------------------------------------
+class PerfStats
+{
+public:
+	PerfStats();
+
+	PerfStatId Register(char const* name, PerfStatType type);
+	void Add(PerfStatId statId, double amount);
+	void Set(PerfStatId statId, double value);
+	void Sample(PerfStatId statId, double value);
+
+	void EndFrame();
+	int  GetFrameNumber() const { return m_frameNumber; }
+	int  GetNumStats() const;
+	std::string const& GetName(PerfStatId statId) const { return m_stats[statId].m_name; }
+	PerfStatType GetType(PerfStatId statId) const { return m_stats[statId].m_type; }
+	PerfStatFrameValue const& GetFrameValue(PerfStatId statId) const { return m_stats[statId].m_frameValue; }
+
+	bool StartStream(std::string const& filePath, PerfStreamFormat format, std::string& out_errorMessage);
+	void StopStream();
+	bool IsStreaming() const { return m_streamFile != nullptr; }
+	std::string const& GetStreamFilePath() const { return m_streamFilePath; }
+
+private:
+	struct ThreadFrame
+	{
+		std::vector<double>				m_sums;
+		std::vector<double>				m_gauges;
+		std::vector<unsigned char>		m_isGaugeSet;
+		std::vector<std::vector<float>>	m_samples;
+	};
+
+	struct ThreadBuffer
+	{
+		ThreadFrame			m_frames[2];
+		std::atomic<int>	m_writeFrame { 0 };			// The frame the owning thread writes; EndFrame flips it
+		std::atomic<int>	m_writingFrame { -1 };		// The frame a write is in progress on, or -1
+		std::atomic<bool>	m_isRetired { false };		// The owning thread has exited
+	};
+
+	struct StatInfo
+	{
+		std::string			m_name;
+		PerfStatType		m_type = PerfStatType::COUNTER;
+		PerfStatFrameValue	m_frameValue;
+		std::vector<float>	m_recentSamples;
+		int					m_nextRecentSample = 0;
+	};
+
+	ThreadBuffer& GetThreadBuffer();
+	ThreadFrame& BeginThreadWrite(ThreadBuffer& threadBuffer);
+	void MergeThreadFrame(ThreadFrame& threadFrame, int numStats);
+	void UpdatePercentiles(StatInfo& stat) const;
+	void WriteStreamFrame();
+
+private:
+	// m_stats is reserved up front and never reallocates, so readers need no lock
+	mutable std::mutex			m_registryMutex;
+	std::vector<StatInfo>		m_stats;
+	std::vector<ThreadBuffer*>	m_threadBuffers;
+	int							m_frameNumber = 0;
+
+	FILE*						m_streamFile = nullptr;
+	std::string					m_streamFilePath;
+	PerfStreamFormat			m_streamFormat = PerfStreamFormat::CSV;
+	int							m_numStreamedStats = 0;
+};
+// -----------------------------------------------------------------------------
+PerfStats& GetPerfStats();
+unsigned long long GetProcessMemoryBytes();
@@ -1,153 +1,256 @@
-#include "Game/Player.hpp"
-#include "Engine/Core/EngineCommon.h"
-#include "Engine/Input/InputSystem.h"
-#include "Engine/Math/MathUtils.h"
-#include <Engine/Core/DevConsole.hpp>
-#include <Engine/Core/DebugRender.hpp>
-
-Player::Player(Game* owner, Vec3 const& position)
-	:m_theGame(owner),
-	 m_position(position)
-{
-	m_position = position;
-	m_orientation = EulerAngles(0.f, 0.f, 0.f);
-	Mat44 cameraToRender(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.f, 0.f, 0.f));
-	m_playerCamera.SetCameraToRenderTransform(cameraToRender);
-}
-
-Player::~Player()
-{
-}
-
-void Player::Update(float deltaSeconds)
-{
-	CameraKeyPresses(deltaSeconds);
-	CameraControllerPresses(deltaSeconds);
-
-	m_orientation.m_pitchDegrees = GetClamped(m_orientation.m_pitchDegrees, -85.f, 85.f);
-	m_orientation.m_rollDegrees = GetClamped(m_orientation.m_rollDegrees, -45.f, 45.f);
-
-	m_playerCamera.SetPositionAndOrientation(m_position, m_orientation);
-
-	m_playerCamera.SetPerspectiveView(2.f, 60.f, 0.1f, 300.f);
-}
-
-void Player::Render() const
-{
-}
-
-Vec3 Player::GetForwardNormal() const
-{
-	return Vec3::MakeFromPolarDegrees(m_orientation.m_pitchDegrees, m_orientation.m_yawDegrees, 2.f);
-}
-
-Camera Player::GetPlayerCamera() const
-{
-	return m_playerCamera;
-}
-
-Mat44 Player::GetModelToWorldTransform() const
-{
-	Mat44 modelToWorldMatrix;
-	modelToWorldMatrix.SetTranslation3D(m_position);
-	EulerAngles orientation;
-	modelToWorldMatrix.Append(orientation.GetAsMatrix_IFwd_JLeft_KUp());
-	return modelToWorldMatrix;
-}
-
-void Player::CameraKeyPresses(float deltaSeconds)
-{
-	// Yaw and Pitch with mouse
-	m_orientation.m_yawDegrees += 0.08f * g_theInput->GetCursorClientDelta().x;
-	m_orientation.m_pitchDegrees -= 0.08f * g_theInput->GetCursorClientDelta().y;
-
-	float movementSpeed = 2.f;
-	// Increase speed by a factor of 10
-	if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
-	{
-		movementSpeed *= 10.f;
-	}
-
-	// Move left or right
-	if (g_theInput->IsKeyDown('A'))
-	{
-		m_position += movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds;
-	}
-	if (g_theInput->IsKeyDown('D'))
-	{
-		m_position += -movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds;
-	}
-
-	// Move Forward and Backward
-	if (g_theInput->IsKeyDown('W'))
-	{
-		m_position += movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds;
-	}
-	if (g_theInput->IsKeyDown('S'))
-	{
-		m_position += -movementSpeed * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds;
-	}
-
-	// Move Up and Down
-	if (g_theInput->IsKeyDown('Z'))
-	{
-		m_position += -movementSpeed * Vec3::ZAXE * deltaSeconds;
-	}
-	if (g_theInput->IsKeyDown('C'))
-	{
-		m_position += movementSpeed * Vec3::ZAXE * deltaSeconds;
-	}
-
-	// Reset position and orientation to zero
-	if (g_theInput->WasKeyJustPressed('H'))
-	{
-		m_position = Vec3::ZERO;
-		m_orientation = EulerAngles(0.f, 0.f, 0.f);
-	}
-}
-
-void Player::CameraControllerPresses(float deltaSeconds)
-{
-	XboxController const& controller = g_theInput->GetController(0);
-	float movementSpeed = 2.f;
-
-	// Increase speed by a factor of 10
-	if (controller.IsButtonDown(XBOX_BUTTON_A))
-	{
-		movementSpeed *= 10.f;
-	}
-
-	// Rolling
-	if (controller.GetLeftTrigger())
-	{
-		m_orientation.m_rollDegrees = -90.f * deltaSeconds;
-	}
-	if (controller.GetRightTrigger())
-	{
-		m_orientation.m_rollDegrees = 90.f * deltaSeconds;
-	}
-
-	//// Move left, right, forward, and backward
-	if (controller.GetLeftStick().GetMagnitude() > 0.f)
-	{
-		m_position += (-movementSpeed * controller.GetLeftStick().GetPosition().x * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetJBasis3D() * deltaSeconds);
-		m_position += (movementSpeed * controller.GetLeftStick().GetPosition().y * m_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D() * deltaSeconds);
-	}
-
-	//// Move Up and Down
-	if (controller.IsButtonDown(XBOX_BUTTON_LSHOULDER))
-	{
-		m_position += -movementSpeed * Vec3::ZAXE * deltaSeconds;
-	}
-	if (controller.IsButtonDown(XBOX_BUTTON_RSHOULDER))
-	{
-		m_position += movementSpeed * Vec3::ZAXE * deltaSeconds;
-	}
-
-	//// Reset position and orientation to zero
-	if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
-	{
-		m_position = Vec3::ZERO;
-		m_orientation = EulerAngles(0.f, 0.f, 0.f);
-	}
-}
+#include "Game/Player.hpp"
+#include "Game/GameCommon.h"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Input/InputSystem.h"
+#include "Engine/Math/MathUtils.h"
+#include <Engine/Core/DevConsole.hpp>
+#include <Engine/Core/DebugRender.hpp>
+
+Player::Player(Game* owner, Vec3 const& position)
+	:m_theGame(owner),
+	 m_position(position)
+{
+	m_position = position;
+	m_orientation = EulerAngles(0.f, 0.f, 0.f);
+	m_previousPosition = m_position;
+	m_previousOrientation = m_orientation;
+	m_renderPosition = m_position;
+	m_renderOrientation = m_orientation;
+	Mat44 cameraToRender(Vec3(0.0f, 0.0f, 1.0f), Vec3(-1.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f), Vec3(0.f, 0.f, 0.f));
+	m_playerCamera.SetCameraToRenderTransform(cameraToRender);
+}
+
+Player::~Player()
+{
+}
+
+void Player::SampleInput()
+{
+	PlayerInputState inputState;
+	SampleKeyboardAndMouse(inputState);
+	SampleController(inputState);
+	m_inputState = inputState;
+
+	if (m_unpresentedInputTime < 0.0 && (inputState.m_localVelocity != Vec3::ZERO || inputState.m_rollDegreesPerSecond != 0.f ||
+		g_theInput->GetCursorClientDelta() != Vec2::ZERO))
+	{
+		m_unpresentedInputTime = GetCurrentTimeSeconds();
+	}
+}
+
+void Player::Update(float deltaSeconds)
+{
+	SampleInput();
+
+	// Simulate in fixed steps; if we fall too far behind, drop the backlog rather than spiral
+	m_stepAccumulatorSeconds += deltaSeconds;
+	int numSteps = 0;
+	while (m_stepAccumulatorSeconds >= PLAYER_FIXED_STEP_SECONDS && numSteps < PLAYER_MAX_STEPS_PER_FRAME)
+	{
+		FixedStep(PLAYER_FIXED_STEP_SECONDS);
+		m_stepAccumulatorSeconds -= PLAYER_FIXED_STEP_SECONDS;
+		++numSteps;
+	}
+	if (m_stepAccumulatorSeconds >= PLAYER_FIXED_STEP_SECONDS)
+	{
+		m_stepAccumulatorSeconds = 0.f;
+	}
+
+	// Render the pose part-way between the last two steps
+	float blend = m_stepAccumulatorSeconds / PLAYER_FIXED_STEP_SECONDS;
+	m_renderPosition = m_previousPosition + (m_position - m_previousPosition) * blend;
+	m_renderOrientation.m_yawDegrees = Interpolate(m_previousOrientation.m_yawDegrees, m_orientation.m_yawDegrees, blend);
+	m_renderOrientation.m_pitchDegrees = Interpolate(m_previousOrientation.m_pitchDegrees, m_orientation.m_pitchDegrees, blend);
+	m_renderOrientation.m_rollDegrees = Interpolate(m_previousOrientation.m_rollDegrees, m_orientation.m_rollDegrees, blend);
+
+	m_playerCamera.SetPositionAndOrientation(m_renderPosition, m_renderOrientation);
+
+	m_playerCamera.SetPerspectiveView(CAMERA_ASPECT, CAMERA_FOV_DEGREES, CAMERA_NEAR_Z, CAMERA_FAR_Z);
+}
+
+void Player::Render() const
+{
+}
+
+void Player::OnFramePresented()
+{
+	if (m_unpresentedInputTime < 0.0)
+	{
+		return;
+	}
+
+	m_lastInputLatencySeconds = static_cast<float>(GetCurrentTimeSeconds() - m_unpresentedInputTime);
+	m_averageInputLatencySeconds = (m_averageInputLatencySeconds == 0.f) ? m_lastInputLatencySeconds : 0.9f * m_averageInputLatencySeconds + 0.1f * m_lastInputLatencySeconds;
+	m_unpresentedInputTime = -1.0;
+}
+
+void Player::SetPose(Vec3 const& position, EulerAngles const& orientation)
+{
+	// Jump straight to the pose, with nothing to interpolate from
+	m_position = position;
+	m_orientation = orientation;
+	m_previousPosition = position;
+	m_previousOrientation = orientation;
+	m_renderPosition = position;
+	m_renderOrientation = orientation;
+	m_stepAccumulatorSeconds = 0.f;
+	m_playerCamera.SetPositionAndOrientation(m_renderPosition, m_renderOrientation);
+}
+
+Vec3 Player::GetForwardNormal() const
+{
+	return Vec3::MakeFromPolarDegrees(m_orientation.m_pitchDegrees, m_orientation.m_yawDegrees, 2.f);
+}
+
+Camera Player::GetPlayerCamera() const
+{
+	return m_playerCamera;
+}
+
+ViewFrustum Player::GetViewFrustum() const
+{
+	// Same pose and projection as m_playerCamera, in a form the CPU culling passes can use
+	Mat44 orientation = m_renderOrientation.GetAsMatrix_IFwd_JLeft_KUp();
+	return ViewFrustum(m_renderPosition, orientation.GetIBasis3D(), orientation.GetJBasis3D(), orientation.GetKBasis3D(),
+		CAMERA_FOV_DEGREES, CAMERA_ASPECT, CAMERA_NEAR_Z, CAMERA_FAR_Z);
+}
+
+Mat44 Player::GetModelToWorldTransform() const
+{
+	Mat44 modelToWorldMatrix;
+	modelToWorldMatrix.SetTranslation3D(m_position);
+	EulerAngles orientation;
+	modelToWorldMatrix.Append(orientation.GetAsMatrix_IFwd_JLeft_KUp());
+	return modelToWorldMatrix;
+}
+
+void Player::FixedStep(float stepSeconds)
+{
+	m_previousPosition = m_position;
+	m_previousOrientation = m_orientation;
+
+	// One orientation matrix per step
+	Mat44 orientationMatrix = m_orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	m_position += orientationMatrix.GetIBasis3D() * (m_inputState.m_localVelocity.x * stepSeconds);
+	m_position += orientationMatrix.GetJBasis3D() * (m_inputState.m_localVelocity.y * stepSeconds);
+	m_position += Vec3::ZAXE * (m_inputState.m_localVelocity.z * stepSeconds);
+
+	m_orientation.m_rollDegrees += m_inputState.m_rollDegreesPerSecond * stepSeconds;
+	ClampOrientation(m_orientation);
+}
+
+void Player::ResetPose()
+{
+	m_position = Vec3::ZERO;
+	m_orientation = EulerAngles(0.f, 0.f, 0.f);
+	m_previousPosition = m_position;
+	m_previousOrientation = m_orientation;
+}
+
+void Player::ClampOrientation(EulerAngles& orientation) const
+{
+	orientation.m_pitchDegrees = GetClamped(orientation.m_pitchDegrees, -85.f, 85.f);
+	orientation.m_rollDegrees = GetClamped(orientation.m_rollDegrees, -45.f, 45.f);
+}
+
+void Player::SampleKeyboardAndMouse(PlayerInputState& inputState)
+{
+	// Mouse look is applied as soon as it is sampled, to both step poses, so it never waits on the next step
+	float yawDelta = 0.08f * g_theInput->GetCursorClientDelta().x;
+	float pitchDelta = -0.08f * g_theInput->GetCursorClientDelta().y;
+	m_orientation.m_yawDegrees += yawDelta;
+	m_orientation.m_pitchDegrees += pitchDelta;
+	m_previousOrientation.m_yawDegrees += yawDelta;
+	m_previousOrientation.m_pitchDegrees += pitchDelta;
+	ClampOrientation(m_orientation);
+	ClampOrientation(m_previousOrientation);
+
+	float movementSpeed = 2.f;
+	// Increase speed by a factor of 10
+	if (g_theInput->IsKeyDown(KEYCODE_SHIFT))
+	{
+		movementSpeed *= 10.f;
+	}
+
+	// Move left or right
+	if (g_theInput->IsKeyDown('A'))
+	{
+		inputState.m_localVelocity.y += movementSpeed;
+	}
+	if (g_theInput->IsKeyDown('D'))
+	{
+		inputState.m_localVelocity.y -= movementSpeed;
+	}
+
+	// Move Forward and Backward
+	if (g_theInput->IsKeyDown('W'))
+	{
+		inputState.m_localVelocity.x += movementSpeed;
+	}
+	if (g_theInput->IsKeyDown('S'))
+	{
+		inputState.m_localVelocity.x -= movementSpeed;
+	}
+
+	// Move Up and Down
+	if (g_theInput->IsKeyDown('Z'))
+	{
+		inputState.m_localVelocity.z -= movementSpeed;
+	}
+	if (g_theInput->IsKeyDown('C'))
+	{
+		inputState.m_localVelocity.z += movementSpeed;
+	}
+
+	// Reset position and orientation to zero
+	if (g_theInput->WasKeyJustPressed('H'))
+	{
+		ResetPose();
+	}
+}
+
+void Player::SampleController(PlayerInputState& inputState)
+{
+	XboxController const& controller = g_theInput->GetController(0);
+	float movementSpeed = 2.f;
+
+	// Increase speed by a factor of 10
+	if (controller.IsButtonDown(XBOX_BUTTON_A))
+	{
+		movementSpeed *= 10.f;
+	}
+
+	// Rolling accumulates over the steps at 90 degrees per second
+	if (controller.GetLeftTrigger())
+	{
+		inputState.m_rollDegreesPerSecond -= 90.f;
+	}
+	if (controller.GetRightTrigger())
+	{
+		inputState.m_rollDegreesPerSecond += 90.f;
+	}
+
+	//// Move left, right, forward, and backward
+	if (controller.GetLeftStick().GetMagnitude() > 0.f)
+	{
+		inputState.m_localVelocity.y -= movementSpeed * controller.GetLeftStick().GetPosition().x;
+		inputState.m_localVelocity.x += movementSpeed * controller.GetLeftStick().GetPosition().y;
+	}
+
+	//// Move Up and Down
+	if (controller.IsButtonDown(XBOX_BUTTON_LSHOULDER))
+	{
+		inputState.m_localVelocity.z -= movementSpeed;
+	}
+	if (controller.IsButtonDown(XBOX_BUTTON_RSHOULDER))
+	{
+		inputState.m_localVelocity.z += movementSpeed;
+	}
+
+	//// Reset position and orientation to zero
+	if (controller.WasButtonJustPressed(XBOX_BUTTON_START))
+	{
+		ResetPose();
+	}
+}
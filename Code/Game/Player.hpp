@@ -1,27 +1,65 @@
-#pragma once
-#include "Engine/Renderer/Camera.h"
-// -----------------------------------------------------------------------------
-class Game;
-// -----------------------------------------------------------------------------
-class Player
-{
-public:
-	Player(Game* owner, Vec3 const& position);
-	~Player();
-
-	void Update(float deltaSeconds);
-	void Render() const;
-	Vec3 GetForwardNormal() const;
-
-	Camera GetPlayerCamera() const;
-	Mat44  GetModelToWorldTransform() const;
-
-	Vec3 m_position = Vec3::ZERO;
-	EulerAngles m_orientation = EulerAngles::ZERO;
-
-private:
-	void CameraKeyPresses(float deltaSeconds);
-	void CameraControllerPresses(float deltaSeconds);
-	Camera m_playerCamera;
-	Game* m_theGame = nullptr;
-};
\ No newline at end of file
+#pragma once
+#include "Engine/Renderer/Camera.h"
+#include "Game/ViewFrustum.hpp"
+// -----------------------------------------------------------------------------
+class Game;
+// -----------------------------------------------------------------------------
+constexpr float PLAYER_FIXED_STEP_SECONDS = 1.f / 120.f;
+constexpr int	PLAYER_MAX_STEPS_PER_FRAME = 8;
+// -----------------------------------------------------------------------------
+// Held movement input from the most recent sample; velocities are in the player's local frame
+// (x forward, y left) except z, which is along world up
+struct PlayerInputState
+{
+	Vec3  m_localVelocity = Vec3::ZERO;
+	float m_rollDegreesPerSecond = 0.f;
+};
+// -----------------------------------------------------------------------------
+class Player
+{
+public:
+	Player(Game* owner, Vec3 const& position);
+	~Player();
+
+	// Call once after every InputSystem::BeginFrame; may run several times per rendered frame
+	void SampleInput();
+	void Update(float deltaSeconds);
+	void Render() const;
+	void OnFramePresented();
+	void SetPose(Vec3 const& position, EulerAngles const& orientation);
+	Vec3 GetForwardNormal() const;
+
+	Camera GetPlayerCamera() const;
+	ViewFrustum GetViewFrustum() const;
+	Mat44  GetModelToWorldTransform() const;
+	Vec3 const&		   GetRenderPosition() const { return m_renderPosition; }
+	EulerAngles const& GetRenderOrientation() const { return m_renderOrientation; }
+	float  GetLastInputLatencySeconds() const { return m_lastInputLatencySeconds; }
+	float  GetAverageInputLatencySeconds() const { return m_averageInputLatencySeconds; }
+
+	Vec3 m_position = Vec3::ZERO;
+	EulerAngles m_orientation = EulerAngles::ZERO;
+
+private:
+	void SampleKeyboardAndMouse(PlayerInputState& inputState);
+	void SampleController(PlayerInputState& inputState);
+	void FixedStep(float stepSeconds);
+	void ResetPose();
+	void ClampOrientation(EulerAngles& orientation) const;
+
+	Game* m_theGame = nullptr;
+	Camera m_playerCamera;
+
+	// Fixed-step simulation; the camera renders between the previous and current step
+	PlayerInputState m_inputState;
+	float		m_stepAccumulatorSeconds = 0.f;
+	Vec3		m_previousPosition = Vec3::ZERO;
+	EulerAngles m_previousOrientation = EulerAngles::ZERO;
+	Vec3		m_renderPosition = Vec3::ZERO;
+	EulerAngles m_renderOrientation = EulerAngles::ZERO;
+
+	// Time of the first input sample not yet shown on screen, or negative if none
+	double m_unpresentedInputTime = -1.0;
+	float  m_lastInputLatencySeconds = 0.f;
+	float  m_averageInputLatencySeconds = 0.f;
+};
@@ -0,0 +1,141 @@
+#include "Game/SectionPlane.hpp"
+#include "Engine/Math/MathUtils.h"
+
+// -----------------------------------------------------------------------------
+static char const* s_sectionAxisNames[static_cast<int>(SectionAxis::COUNT)] = { "off", "x", "y", "z" };
+
+// -----------------------------------------------------------------------------
+char const* GetSectionAxisName(SectionAxis axis)
+{
+	return s_sectionAxisNames[static_cast<int>(axis)];
+}
+
+SectionAxis GetSectionAxisFromName(std::string const& axisName)
+{
+	for (int axisIndex = 0; axisIndex < static_cast<int>(SectionAxis::COUNT); ++axisIndex)
+	{
+		if (axisName == s_sectionAxisNames[axisIndex])
+		{
+			return static_cast<SectionAxis>(axisIndex);
+		}
+	}
+	return SectionAxis::COUNT;
+}
+
+// -----------------------------------------------------------------------------
+Vec3 SectionPlane::GetWorldNormal() const
+{
+	switch (m_axis)
+	{
+	case SectionAxis::X:	return Vec3(1.f, 0.f, 0.f);
+	case SectionAxis::Y:	return Vec3(0.f, 1.f, 0.f);
+	case SectionAxis::Z:	return Vec3(0.f, 0.f, 1.f);
+	default:				return Vec3(0.f, 0.f, 0.f);
+	}
+}
+
+void SectionPlane::GetModelPlane(Mat44 const& modelToWorld, Vec3& out_normal, float& out_distance) const
+{
+	// dot(n, M p) == d  becomes  dot(M^T n, p) == d - dot(n, t) for the model's linear part M and translation t
+	Vec3 worldNormal = GetWorldNormal();
+	out_normal = Vec3(DotProduct3D(worldNormal, modelToWorld.GetIBasis3D()), DotProduct3D(worldNormal, modelToWorld.GetJBasis3D()), DotProduct3D(worldNormal, modelToWorld.GetKBasis3D()));
+	out_distance = m_offset - DotProduct3D(worldNormal, modelToWorld.GetTranslation3D());
+}
+
+// -----------------------------------------------------------------------------
+static unsigned char InterpolateChannel(unsigned char start, unsigned char end, float fraction)
+{
+	return static_cast<unsigned char>(GetClamped(Interpolate(static_cast<float>(start), static_cast<float>(end), fraction) + 0.5f, 0.f, 255.f));
+}
+
+static Vertex_PCUTBN InterpolateVertex(Vertex_PCUTBN const& start, Vertex_PCUTBN const& end, float fraction)
+{
+	Vertex_PCUTBN vertex;
+	vertex.m_position = start.m_position + (end.m_position - start.m_position) * fraction;
+	vertex.m_color = Rgba8(InterpolateChannel(start.m_color.r, end.m_color.r, fraction), InterpolateChannel(start.m_color.g, end.m_color.g, fraction),
+		InterpolateChannel(start.m_color.b, end.m_color.b, fraction), InterpolateChannel(start.m_color.a, end.m_color.a, fraction));
+	vertex.m_uvTexCoords = start.m_uvTexCoords + (end.m_uvTexCoords - start.m_uvTexCoords) * fraction;
+	vertex.m_tangent = start.m_tangent + (end.m_tangent - start.m_tangent) * fraction;
+	vertex.m_bitangent = start.m_bitangent + (end.m_bitangent - start.m_bitangent) * fraction;
+	vertex.m_normal = start.m_normal + (end.m_normal - start.m_normal) * fraction;
+	return vertex;
+}
+
+void ClipTrianglesToSectionPlane(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, unsigned int startIndex, unsigned int indexCount,
+	Vec3 const& modelNormal, float modelDistance, std::vector<unsigned int>& out_keptIndices, std::vector<Vertex_PCUTBN>& out_splitVerts)
+{
+	unsigned int endIndex = startIndex + indexCount - (indexCount % 3);
+	for (unsigned int triangleStart = startIndex; triangleStart < endIndex; triangleStart += 3)
+	{
+		Vertex_PCUTBN const* corners[3];
+		float distances[3];
+		int numKept = 0;
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			corners[cornerIndex] = &verts[indices[triangleStart + cornerIndex]];
+			distances[cornerIndex] = DotProduct3D(modelNormal, corners[cornerIndex]->m_position) - modelDistance;
+			numKept += (distances[cornerIndex] <= 0.f) ? 1 : 0;
+		}
+
+		if (numKept == 0)
+		{
+			continue;
+		}
+		if (numKept == 3)
+		{
+			out_keptIndices.insert(out_keptIndices.end(), indices.begin() + triangleStart, indices.begin() + triangleStart + 3);
+			continue;
+		}
+
+		// One plane cuts a triangle into a triangle or a quad on the kept side; walking the edges in order keeps the winding
+		Vertex_PCUTBN polygon[4];
+		int numPolygonVerts = 0;
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			int nextIndex = (cornerIndex + 1) % 3;
+			bool isKept = (distances[cornerIndex] <= 0.f);
+			if (isKept)
+			{
+				polygon[numPolygonVerts++] = *corners[cornerIndex];
+			}
+			if (isKept != (distances[nextIndex] <= 0.f))
+			{
+				float fraction = distances[cornerIndex] / (distances[cornerIndex] - distances[nextIndex]);
+				polygon[numPolygonVerts++] = InterpolateVertex(*corners[cornerIndex], *corners[nextIndex], fraction);
+			}
+		}
+
+		for (int fanIndex = 1; fanIndex + 1 < numPolygonVerts; ++fanIndex)
+		{
+			out_splitVerts.push_back(polygon[0]);
+			out_splitVerts.push_back(polygon[fanIndex]);
+			out_splitVerts.push_back(polygon[fanIndex + 1]);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+void AddVertsForSectionOutline(std::vector<Vertex_PCU>& verts, std::vector<Vec3> const& segmentPoints, Mat44 const& modelToWorld, Vec3 const& worldNormal,
+	float thickness, Rgba8 const& color)
+{
+	verts.reserve(verts.size() + segmentPoints.size() * 3);
+	for (int pointIndex = 0; pointIndex + 1 < static_cast<int>(segmentPoints.size()); pointIndex += 2)
+	{
+		Vec3 start = modelToWorld.TransformPosition3D(segmentPoints[pointIndex]);
+		Vec3 end = modelToWorld.TransformPosition3D(segmentPoints[pointIndex + 1]);
+		Vec3 side = CrossProduct3D(end - start, worldNormal);
+		float sideLength = side.GetLength();
+		if (sideLength <= 0.f)
+		{
+			continue;
+		}
+		side = side * (0.5f * thickness / sideLength);
+
+		verts.push_back(Vertex_PCU(start - side, color));
+		verts.push_back(Vertex_PCU(end - side, color));
+		verts.push_back(Vertex_PCU(end + side, color));
+		verts.push_back(Vertex_PCU(start - side, color));
+		verts.push_back(Vertex_PCU(end + side, color));
+		verts.push_back(Vertex_PCU(start + side, color));
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/Vertex_PCU.h"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include <string>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class SectionAxis
+{
+	NONE,
+	X,
+	Y,
+	Z,
+	COUNT
+};
+// -----------------------------------------------------------------------------
+// World axis-aligned section plane at m_offset along m_axis. The model is cut away on the side the
+// normal points to, and where the plane cuts it is outlined
+// -----------------------------------------------------------------------------
+struct SectionPlane
+{
+	SectionAxis	m_axis = SectionAxis::NONE;
+	float		m_offset = 0.f;
+
+	bool				  IsEnabled() const { return m_axis != SectionAxis::NONE; }
+	Vec3				  GetWorldNormal() const;
+
+	// The same plane in the model space of modelToWorld, as dot(out_normal, p) == out_distance.
+	// The normal keeps the model transform's scale, so distances along it are not in world units.
+	void GetModelPlane(Mat44 const& modelToWorld, Vec3& out_normal, float& out_distance) const;
+};
+
+char const* GetSectionAxisName(SectionAxis axis);
+SectionAxis GetSectionAxisFromName(std::string const& axisName);		// COUNT when the name is not one of "off", "x", "y", "z"
+
+// -----------------------------------------------------------------------------
+// One material's share of a cut model: whole kept triangles index the model's own vertex buffer,
+// and the triangles the plane crosses are clipped into new, unindexed verts
+struct SectionClipRange
+{
+	int				m_materialIndex = 0;
+	unsigned int	m_startIndex = 0;
+	unsigned int	m_indexCount = 0;
+	unsigned int	m_startVertex = 0;
+	unsigned int	m_vertexCount = 0;
+};
+
+// Keeps the part of triangles [startIndex, startIndex + indexCount) behind the model plane dot(normal, p) == distance,
+// appending the indices of wholly kept triangles to out_keptIndices and the clipped pieces of crossed ones to out_splitVerts
+void ClipTrianglesToSectionPlane(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, unsigned int startIndex, unsigned int indexCount,
+	Vec3 const& modelNormal, float modelDistance, std::vector<unsigned int>& out_keptIndices, std::vector<Vertex_PCUTBN>& out_splitVerts);
+
+// Lays each cut segment (pairs of model-space points) down as a thin world-space quad in the plane, so the whole outline draws in one call
+void AddVertsForSectionOutline(std::vector<Vertex_PCU>& verts, std::vector<Vec3> const& segmentPoints, Mat44 const& modelToWorld, Vec3 const& worldNormal,
+	float thickness, Rgba8 const& color);
@@ -0,0 +1,141 @@
+#include "Game/ShadowCascades.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+float ShadowCascades::GetSplitDepth(int splitIndex, float nearZ, float farZ, float splitLambda)
+{
+	float fraction = static_cast<float>(splitIndex) / static_cast<float>(NUM_SHADOW_CASCADES);
+	float logarithmicSplit = nearZ * powf(farZ / nearZ, fraction);
+	float uniformSplit = nearZ + (farZ - nearZ) * fraction;
+	return splitLambda * logarithmicSplit + (1.f - splitLambda) * uniformSplit;
+}
+
+// -----------------------------------------------------------------------------
+static float SnapToGrid(float value, float gridSize)
+{
+	return floorf(value / gridSize + 0.5f) * gridSize;
+}
+
+// -----------------------------------------------------------------------------
+void ShadowCascades::Fit(ViewFrustum const& view, Vec3 const& sunDirection, AABB3 const& sceneBounds)
+{
+	double fitStartTime = GetCurrentTimeSeconds();
+
+	// Light basis: forward is the direction the light travels
+	Vec3 lightForward = sunDirection.GetNormalized();
+	Vec3 referenceUp = (fabsf(lightForward.z) < 0.99f) ? Vec3(0.f, 0.f, 1.f) : Vec3(1.f, 0.f, 0.f);
+	Vec3 lightLeft = CrossProduct3D(referenceUp, lightForward).GetNormalized();
+	Vec3 lightUp = CrossProduct3D(lightForward, lightLeft);
+
+	// Casters anywhere in the scene may shadow the view, so depth starts at the scene's nearest corner to the light
+	float sceneMinDepth = 0.f;
+	for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		Vec3 corner((cornerIndex & 1) ? sceneBounds.m_maxs.x : sceneBounds.m_mins.x,
+			(cornerIndex & 2) ? sceneBounds.m_maxs.y : sceneBounds.m_mins.y,
+			(cornerIndex & 4) ? sceneBounds.m_maxs.z : sceneBounds.m_mins.z);
+		float cornerDepth = DotProduct3D(corner, lightForward);
+		sceneMinDepth = (cornerIndex == 0) ? cornerDepth : std::min(sceneMinDepth, cornerDepth);
+	}
+
+	// Slice corners sit at distance depth * sqrt(k) from the view axis
+	float tanHalfFov = tanf(0.5f * ConvertDegreesToRadians(view.m_fovDegrees));
+	float cornerSlopeSquared = tanHalfFov * tanHalfFov * (1.f + view.m_aspect * view.m_aspect);
+
+	for (int cascadeIndex = 0; cascadeIndex < NUM_SHADOW_CASCADES; ++cascadeIndex)
+	{
+		ShadowCascade& cascade = m_cascades[cascadeIndex];
+		float splitNear = GetSplitDepth(cascadeIndex, view.m_near, view.m_far, m_splitLambda);
+		float splitFar = GetSplitDepth(cascadeIndex + 1, view.m_near, view.m_far, m_splitLambda);
+		cascade.m_splitNear = splitNear;
+		cascade.m_splitFar = splitFar;
+
+		// Smallest sphere on the view axis through both the near and far slice corners; for wide
+		// slices the center would land past the far plane, so the far cap circle bounds it instead
+		float centerDepth = 0.5f * (splitNear + splitFar) * (1.f + cornerSlopeSquared);
+		float radius = 0.f;
+		if (centerDepth >= splitFar)
+		{
+			centerDepth = splitFar;
+			radius = splitFar * sqrtf(cornerSlopeSquared);
+		}
+		else
+		{
+			float nearOffset = centerDepth - splitNear;
+			radius = sqrtf(nearOffset * nearOffset + splitNear * splitNear * cornerSlopeSquared);
+		}
+
+		// Snap the center across the light's image plane to whole texels
+		float worldUnitsPerTexel = 2.f * radius / static_cast<float>(m_resolution);
+		Vec3 center = view.m_position + view.m_forward * centerDepth;
+		float centerLeft = SnapToGrid(DotProduct3D(center, lightLeft), worldUnitsPerTexel);
+		float centerUp = SnapToGrid(DotProduct3D(center, lightUp), worldUnitsPerTexel);
+		float centerDepthAlongLight = DotProduct3D(center, lightForward);
+		cascade.m_center = lightLeft * centerLeft + lightUp * centerUp + lightForward * centerDepthAlongLight;
+		cascade.m_radius = radius;
+		cascade.m_worldUnitsPerTexel = worldUnitsPerTexel;
+
+		float minDepth = std::min(sceneMinDepth, centerDepthAlongLight - radius);
+		float maxDepth = centerDepthAlongLight + radius;
+		float inverseRadius = 1.f / radius;
+		float inverseDepthRange = 1.f / (maxDepth - minDepth);
+
+		// Shadow map x to the right (-left), y up, z from the light
+		Vec3 const axes[3] = { -lightLeft * inverseRadius, lightUp * inverseRadius, lightForward * inverseDepthRange };
+		float const offsets[3] = { centerLeft * inverseRadius, -centerUp * inverseRadius, -minDepth * inverseDepthRange };
+		ClipTransform& worldToShadowClip = cascade.m_worldToShadowClip;
+		for (int rowIndex = 0; rowIndex < 3; ++rowIndex)
+		{
+			worldToShadowClip.m_rows[rowIndex][0] = axes[rowIndex].x;
+			worldToShadowClip.m_rows[rowIndex][1] = axes[rowIndex].y;
+			worldToShadowClip.m_rows[rowIndex][2] = axes[rowIndex].z;
+			worldToShadowClip.m_rows[rowIndex][3] = offsets[rowIndex];
+		}
+		worldToShadowClip.m_rows[3][0] = 0.f;
+		worldToShadowClip.m_rows[3][1] = 0.f;
+		worldToShadowClip.m_rows[3][2] = 0.f;
+		worldToShadowClip.m_rows[3][3] = 1.f;
+	}
+
+	m_stats.m_fitSeconds = GetCurrentTimeSeconds() - fitStartTime;
+}
+
+// -----------------------------------------------------------------------------
+void ShadowCascades::CullCasters(std::vector<ModelCluster> const& clusters, Mat44 const& modelToWorld)
+{
+	int numClusters = static_cast<int>(clusters.size());
+	m_isClusterInCascade.resize(numClusters);
+
+	for (int cascadeIndex = 0; cascadeIndex < NUM_SHADOW_CASCADES; ++cascadeIndex)
+	{
+		double cullStartTime = GetCurrentTimeSeconds();
+		ClipTransform modelToShadowClip = m_cascades[cascadeIndex].m_worldToShadowClip.GetAppended(modelToWorld);
+		ParallelFor(numClusters, 256, [&](int beginIndex, int endIndex)
+		{
+			for (int clusterIndex = beginIndex; clusterIndex < endIndex; ++clusterIndex)
+			{
+				m_isClusterInCascade[clusterIndex] = modelToShadowClip.IsBoxOutsideClipVolume(clusters[clusterIndex].m_bounds) ? 0 : 1;
+			}
+		});
+
+		std::vector<int>& casterClusters = m_casterClusters[cascadeIndex];
+		casterClusters.clear();
+		int numCasterTriangles = 0;
+		for (int clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+		{
+			if (m_isClusterInCascade[clusterIndex] != 0)
+			{
+				casterClusters.push_back(clusterIndex);
+				numCasterTriangles += static_cast<int>(clusters[clusterIndex].m_indexCount / 3);
+			}
+		}
+
+		m_stats.m_numCasters[cascadeIndex] = static_cast<int>(casterClusters.size());
+		m_stats.m_numCasterTriangles[cascadeIndex] = numCasterTriangles;
+		m_stats.m_cullSeconds[cascadeIndex] = GetCurrentTimeSeconds() - cullStartTime;
+	}
+}
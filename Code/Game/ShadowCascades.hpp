@@ -0,0 +1,61 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Game/ViewFrustum.hpp"
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int NUM_SHADOW_CASCADES = 4;
+constexpr int SHADOW_MAP_RESOLUTION = 2048;		// Cascades are texel-snapped for a map this size
+// -----------------------------------------------------------------------------
+struct ShadowCascade
+{
+	float			m_splitNear = 0.f;
+	float			m_splitFar = 0.f;
+	Vec3			m_center = Vec3::ZERO;		// Bounding sphere of the view slice, snapped to the texel grid
+	float			m_radius = 0.f;
+	float			m_worldUnitsPerTexel = 0.f;
+	ClipTransform	m_worldToShadowClip;		// Orthographic; x, y in [-1, 1], z in [0, 1]
+};
+// -----------------------------------------------------------------------------
+struct ShadowCascadeStats
+{
+	int		m_numCasters[NUM_SHADOW_CASCADES] = {};
+	int		m_numCasterTriangles[NUM_SHADOW_CASCADES] = {};
+	double	m_cullSeconds[NUM_SHADOW_CASCADES] = {};
+	double	m_fitSeconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+// Cascade fitting and caster culling for the directional sun. The view depth range is split with the
+// practical split scheme (a blend of logarithmic and uniform), and each cascade is fit to the
+// bounding sphere of its view slice. The sphere keeps the cascade's size fixed as the camera
+// turns, and snapping its center to whole shadow texels keeps edges from shimmering as it moves.
+// Caster clusters are culled per cascade against the light-space box, which reaches back to
+// the scene bounds so casters outside the view still shadow it.
+//
+// This is cascade fitting only: nothing renders a depth pass into a shadow map, and the lit
+// shaders do not sample one, so the model is drawn without sun shadows. The matrices and caster
+// lists are what a depth pass would consume. Renderer-free, so fitting and culling can be run and
+// checked headless.
+// -----------------------------------------------------------------------------
+class ShadowCascades
+{
+public:
+	void Fit(ViewFrustum const& view, Vec3 const& sunDirection, AABB3 const& sceneBounds);
+	void CullCasters(std::vector<ModelCluster> const& clusters, Mat44 const& modelToWorld);
+
+	void SetSplitLambda(float splitLambda) { m_splitLambda = splitLambda; }
+	void SetResolution(int resolution) { m_resolution = resolution; }
+
+	ShadowCascade const&		GetCascade(int cascadeIndex) const { return m_cascades[cascadeIndex]; }
+	std::vector<int> const&		GetCasterClusters(int cascadeIndex) const { return m_casterClusters[cascadeIndex]; }
+	ShadowCascadeStats const&	GetStats() const { return m_stats; }
+
+	static float GetSplitDepth(int splitIndex, float nearZ, float farZ, float splitLambda);
+
+private:
+	float						m_splitLambda = 0.95f;
+	int							m_resolution = SHADOW_MAP_RESOLUTION;
+	ShadowCascade				m_cascades[NUM_SHADOW_CASCADES];
+	std::vector<int>			m_casterClusters[NUM_SHADOW_CASCADES];
+	std::vector<unsigned char>	m_isClusterInCascade;
+	ShadowCascadeStats			m_stats;
+};
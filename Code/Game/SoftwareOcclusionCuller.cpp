@@ -0,0 +1,407 @@
+#include "Game/SoftwareOcclusionCuller.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Game/PerfStats.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <math.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define OCCLUSION_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+static PerfStatId const s_occluderTriangleBandsStat = GetPerfStats().Register("occluder_triangle_bands", PerfStatType::COUNTER);
+
+// -----------------------------------------------------------------------------
+SoftwareOcclusionCuller::SoftwareOcclusionCuller(int width, int height)
+	: m_width((width + 3) & ~3)
+	, m_height(height)
+{
+	// Rows are a multiple of four floats so SIMD loops never need a scalar tail
+	m_depthBuffer.resize(static_cast<size_t>(m_width) * static_cast<size_t>(m_height), 1.f);
+}
+
+void SoftwareOcclusionCuller::BeginFrame(ClipTransform const& modelToClip)
+{
+	m_modelToClip = modelToClip;
+	m_stats = OcclusionStats();
+	std::fill(m_depthBuffer.begin(), m_depthBuffer.end(), 1.f);
+}
+
+// -----------------------------------------------------------------------------
+// Clips against the near plane (z >= 0) and projects to pixels; returns 0, 1 or 2 triangles
+int SoftwareOcclusionCuller::SetupTriangle(float const clip0[4], float const clip1[4], float const clip2[4], ScreenTriangle* out_triangles) const
+{
+	float const* input[3] = { clip0, clip1, clip2 };
+	float polygon[4][4];
+	int numPolygonVerts = 0;
+	for (int vertIndex = 0; vertIndex < 3; ++vertIndex)
+	{
+		float const* current = input[vertIndex];
+		float const* next = input[(vertIndex + 1) % 3];
+		if (current[2] >= 0.f)
+		{
+			for (int component = 0; component < 4; ++component)
+			{
+				polygon[numPolygonVerts][component] = current[component];
+			}
+			++numPolygonVerts;
+		}
+		if ((current[2] >= 0.f) != (next[2] >= 0.f))
+		{
+			float t = current[2] / (current[2] - next[2]);
+			for (int component = 0; component < 4; ++component)
+			{
+				polygon[numPolygonVerts][component] = current[component] + t * (next[component] - current[component]);
+			}
+			++numPolygonVerts;
+		}
+	}
+	if (numPolygonVerts < 3)
+	{
+		return 0;
+	}
+
+	float screenX[4];
+	float screenY[4];
+	float screenZ[4];
+	for (int vertIndex = 0; vertIndex < numPolygonVerts; ++vertIndex)
+	{
+		float w = (polygon[vertIndex][3] > 1.0e-6f) ? polygon[vertIndex][3] : 1.0e-6f;
+		float inverseW = 1.f / w;
+		screenX[vertIndex] = (polygon[vertIndex][0] * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width);
+		screenY[vertIndex] = (0.5f - polygon[vertIndex][1] * inverseW * 0.5f) * static_cast<float>(m_height);
+		screenZ[vertIndex] = polygon[vertIndex][2] * inverseW;
+	}
+
+	int numTriangles = 0;
+	for (int fanIndex = 1; fanIndex + 1 < numPolygonVerts; ++fanIndex)
+	{
+		ScreenTriangle& triangle = out_triangles[numTriangles];
+		int const corners[3] = { 0, fanIndex, fanIndex + 1 };
+		float minY = screenY[0];
+		float maxY = screenY[0];
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			triangle.m_x[cornerIndex] = screenX[corners[cornerIndex]];
+			triangle.m_y[cornerIndex] = screenY[corners[cornerIndex]];
+			triangle.m_z[cornerIndex] = screenZ[corners[cornerIndex]];
+			minY = (triangle.m_y[cornerIndex] < minY) ? triangle.m_y[cornerIndex] : minY;
+			maxY = (triangle.m_y[cornerIndex] > maxY) ? triangle.m_y[cornerIndex] : maxY;
+		}
+
+		// Occluders are drawn double-sided, so wind every triangle the same way
+		float area = (triangle.m_x[1] - triangle.m_x[0]) * (triangle.m_y[2] - triangle.m_y[0]) - (triangle.m_x[2] - triangle.m_x[0]) * (triangle.m_y[1] - triangle.m_y[0]);
+		if (area == 0.f || minY >= static_cast<float>(m_height) || maxY < 0.f)
+		{
+			continue;
+		}
+		if (area < 0.f)
+		{
+			std::swap(triangle.m_x[1], triangle.m_x[2]);
+			std::swap(triangle.m_y[1], triangle.m_y[2]);
+			std::swap(triangle.m_z[1], triangle.m_z[2]);
+		}
+		triangle.m_minY = static_cast<int>(floorf(minY > 0.f ? minY : 0.f));
+		triangle.m_maxY = static_cast<int>(ceilf(maxY < static_cast<float>(m_height - 1) ? maxY : static_cast<float>(m_height - 1)));
+		++numTriangles;
+	}
+	return numTriangles;
+}
+
+// -----------------------------------------------------------------------------
+void SoftwareOcclusionCuller::RasterizeTriangle(ScreenTriangle const& triangle, int bandMinY, int bandMaxY)
+{
+	float const* x = triangle.m_x;
+	float const* y = triangle.m_y;
+	float const* z = triangle.m_z;
+
+	int minY = (triangle.m_minY > bandMinY) ? triangle.m_minY : bandMinY;
+	int maxY = (triangle.m_maxY < bandMaxY) ? triangle.m_maxY : bandMaxY;
+	float minXf = (x[0] < x[1]) ? ((x[0] < x[2]) ? x[0] : x[2]) : ((x[1] < x[2]) ? x[1] : x[2]);
+	float maxXf = (x[0] > x[1]) ? ((x[0] > x[2]) ? x[0] : x[2]) : ((x[1] > x[2]) ? x[1] : x[2]);
+	if (minXf >= static_cast<float>(m_width) || maxXf < 0.f || minY > maxY)
+	{
+		return;
+	}
+	int minX = static_cast<int>(floorf(minXf > 0.f ? minXf : 0.f)) & ~3;
+	int maxX = static_cast<int>(ceilf(maxXf < static_cast<float>(m_width - 1) ? maxXf : static_cast<float>(m_width - 1)));
+
+	// Edge functions E(px, py) = a * px + b * py + c, positive inside; edge i is opposite vertex i
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	for (int edgeIndex = 0; edgeIndex < 3; ++edgeIndex)
+	{
+		int from = (edgeIndex + 1) % 3;
+		int to = (edgeIndex + 2) % 3;
+		edgeA[edgeIndex] = -(y[to] - y[from]);
+		edgeB[edgeIndex] = x[to] - x[from];
+		edgeC[edgeIndex] = (y[to] - y[from]) * x[from] - (x[to] - x[from]) * y[from];
+	}
+
+	// z / w is affine in screen space, so depth is a plane over the pixels
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	float depthDX = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	float depthDY = ((z[2] - z[0]) * (x[1] - x[0]) - (z[1] - z[0]) * (x[2] - x[0])) / area;
+	float depthC = z[0] - depthDX * x[0] - depthDY * y[0];
+
+#if defined(OCCLUSION_USE_SSE)
+	__m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	__m128 zero = _mm_setzero_ps();
+	__m128 edgeA0 = _mm_set1_ps(edgeA[0]);
+	__m128 edgeA1 = _mm_set1_ps(edgeA[1]);
+	__m128 edgeA2 = _mm_set1_ps(edgeA[2]);
+	__m128 depthDX4 = _mm_set1_ps(depthDX);
+	for (int pixelY = minY; pixelY <= maxY; ++pixelY)
+	{
+		float centerY = static_cast<float>(pixelY) + 0.5f;
+		__m128 edgeRow0 = _mm_set1_ps(edgeB[0] * centerY + edgeC[0]);
+		__m128 edgeRow1 = _mm_set1_ps(edgeB[1] * centerY + edgeC[1]);
+		__m128 edgeRow2 = _mm_set1_ps(edgeB[2] * centerY + edgeC[2]);
+		__m128 depthRow = _mm_set1_ps(depthDY * centerY + depthC);
+		float* depthRowPixels = &m_depthBuffer[static_cast<size_t>(pixelY) * m_width];
+
+		for (int pixelX = minX; pixelX <= maxX; pixelX += 4)
+		{
+			__m128 centerX = _mm_add_ps(_mm_set1_ps(static_cast<float>(pixelX)), laneOffsets);
+			__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, centerX), edgeRow0), zero);
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, centerX), edgeRow1), zero));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, centerX), edgeRow2), zero));
+			if (_mm_movemask_ps(inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthDX4, centerX), depthRow);
+			__m128 current = _mm_loadu_ps(depthRowPixels + pixelX);
+			__m128 closer = _mm_min_ps(current, depth);
+			_mm_storeu_ps(depthRowPixels + pixelX, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, current)));
+		}
+	}
+#else
+	for (int pixelY = minY; pixelY <= maxY; ++pixelY)
+	{
+		float centerY = static_cast<float>(pixelY) + 0.5f;
+		float* depthRowPixels = &m_depthBuffer[static_cast<size_t>(pixelY) * m_width];
+		for (int pixelX = minX; pixelX <= maxX; ++pixelX)
+		{
+			float centerX = static_cast<float>(pixelX) + 0.5f;
+			if (edgeA[0] * centerX + edgeB[0] * centerY + edgeC[0] < 0.f ||
+				edgeA[1] * centerX + edgeB[1] * centerY + edgeC[1] < 0.f ||
+				edgeA[2] * centerX + edgeB[2] * centerY + edgeC[2] < 0.f)
+			{
+				continue;
+			}
+			float depth = depthDX * centerX + depthDY * centerY + depthC;
+			if (depth < depthRowPixels[pixelX])
+			{
+				depthRowPixels[pixelX] = depth;
+			}
+		}
+	}
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void SoftwareOcclusionCuller::RasterizeOccluders(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, std::vector<ModelCluster> const& occluders)
+{
+	double startTime = GetCurrentTimeSeconds();
+
+	// Flatten the occluder ranges into a triangle list; each triangle may split in two at the near plane
+	std::vector<unsigned int> firstIndices;
+	for (int occluderIndex = 0; occluderIndex < static_cast<int>(occluders.size()); ++occluderIndex)
+	{
+		ModelCluster const& occluder = occluders[occluderIndex];
+		unsigned int endIndex = occluder.m_startIndex + occluder.m_indexCount;
+		for (unsigned int index = occluder.m_startIndex; index + 3 <= endIndex && index + 3 <= static_cast<unsigned int>(indices.size()); index += 3)
+		{
+			firstIndices.push_back(index);
+		}
+	}
+	int numTriangles = static_cast<int>(firstIndices.size());
+	m_stats.m_numOccluderTriangles = numTriangles;
+	m_screenTriangles.resize(static_cast<size_t>(numTriangles) * 2);
+
+	ParallelFor(numTriangles, 1024, [&](int beginIndex, int endIndex)
+	{
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; ++triangleIndex)
+		{
+			unsigned int firstIndex = firstIndices[triangleIndex];
+			float clip[3][4];
+			for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+			{
+				m_modelToClip.TransformPosition(verts[indices[firstIndex + cornerIndex]].m_position, clip[cornerIndex]);
+			}
+
+			ScreenTriangle* slots = &m_screenTriangles[static_cast<size_t>(triangleIndex) * 2];
+			int numScreenTriangles = SetupTriangle(clip[0], clip[1], clip[2], slots);
+			for (int slotIndex = numScreenTriangles; slotIndex < 2; ++slotIndex)
+			{
+				slots[slotIndex].m_minY = 1;
+				slots[slotIndex].m_maxY = 0;
+			}
+		}
+	});
+
+	// Each band of rows is owned by one task, so depth writes never race
+	constexpr int ROWS_PER_BAND = 8;
+	int numBands = (m_height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ParallelFor(numBands, 1, [&](int beginBand, int endBand)
+	{
+		int bandMinY = beginBand * ROWS_PER_BAND;
+		int bandMaxY = (endBand * ROWS_PER_BAND < m_height) ? endBand * ROWS_PER_BAND - 1 : m_height - 1;
+		int numRasterized = 0;
+		for (int screenTriangleIndex = 0; screenTriangleIndex < static_cast<int>(m_screenTriangles.size()); ++screenTriangleIndex)
+		{
+			ScreenTriangle const& triangle = m_screenTriangles[screenTriangleIndex];
+			if (triangle.m_minY <= bandMaxY && triangle.m_maxY >= bandMinY)
+			{
+				RasterizeTriangle(triangle, bandMinY, bandMaxY);
+				++numRasterized;
+			}
+		}
+		GetPerfStats().Add(s_occluderTriangleBandsStat, static_cast<double>(numRasterized));
+	});
+
+	m_stats.m_rasterSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t SoftwareOcclusionCuller::GetNumBufferBytes() const
+{
+	return static_cast<uint64_t>(m_depthBuffer.capacity()) * sizeof(float) + static_cast<uint64_t>(m_screenTriangles.capacity()) * sizeof(ScreenTriangle);
+}
+
+OcclusionResult SoftwareOcclusionCuller::TestBox(AABB3 const& bounds) const
+{
+	if (m_modelToClip.IsBoxOutsideClipVolume(bounds))
+	{
+		return OcclusionResult::OUTSIDE_FRUSTUM;
+	}
+
+	float minX = 1.f;
+	float maxX = -1.f;
+	float minY = 1.f;
+	float maxY = -1.f;
+	float minDepth = 1.f;
+	for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+	{
+		Vec3 corner((cornerIndex & 1) ? bounds.m_maxs.x : bounds.m_mins.x, (cornerIndex & 2) ? bounds.m_maxs.y : bounds.m_mins.y, (cornerIndex & 4) ? bounds.m_maxs.z : bounds.m_mins.z);
+		float clip[4];
+		m_modelToClip.TransformPosition(corner, clip);
+		if (clip[2] <= 0.f)
+		{
+			// Straddles the near plane, so it covers the camera and cannot be hidden
+			return OcclusionResult::VISIBLE;
+		}
+		float inverseW = 1.f / clip[3];
+		float ndcX = clip[0] * inverseW;
+		float ndcY = clip[1] * inverseW;
+		float depth = clip[2] * inverseW;
+		minX = (ndcX < minX) ? ndcX : minX;
+		maxX = (ndcX > maxX) ? ndcX : maxX;
+		minY = (ndcY < minY) ? ndcY : minY;
+		maxY = (ndcY > maxY) ? ndcY : maxY;
+		minDepth = (depth < minDepth) ? depth : minDepth;
+	}
+
+	// Conservative pixel rectangle; screen rows run top to bottom
+	int pixelMinX = static_cast<int>(floorf((minX * 0.5f + 0.5f) * static_cast<float>(m_width)));
+	int pixelMaxX = static_cast<int>(ceilf((maxX * 0.5f + 0.5f) * static_cast<float>(m_width)));
+	int pixelMinY = static_cast<int>(floorf((0.5f - maxY * 0.5f) * static_cast<float>(m_height)));
+	int pixelMaxY = static_cast<int>(ceilf((0.5f - minY * 0.5f) * static_cast<float>(m_height)));
+	pixelMinX = (pixelMinX > 0) ? (pixelMinX & ~3) : 0;
+	pixelMaxX = (pixelMaxX < m_width - 1) ? pixelMaxX : m_width - 1;
+	pixelMinY = (pixelMinY > 0) ? pixelMinY : 0;
+	pixelMaxY = (pixelMaxY < m_height - 1) ? pixelMaxY : m_height - 1;
+	if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY)
+	{
+		return OcclusionResult::OUTSIDE_FRUSTUM;
+	}
+
+	// Visible as soon as any covered pixel is at least as far as the box's nearest point
+#if defined(OCCLUSION_USE_SSE)
+	__m128 minDepth4 = _mm_set1_ps(minDepth);
+	for (int pixelY = pixelMinY; pixelY <= pixelMaxY; ++pixelY)
+	{
+		float const* depthRowPixels = &m_depthBuffer[static_cast<size_t>(pixelY) * m_width];
+		for (int pixelX = pixelMinX; pixelX <= pixelMaxX; pixelX += 4)
+		{
+			if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(depthRowPixels + pixelX), minDepth4)) != 0)
+			{
+				return OcclusionResult::VISIBLE;
+			}
+		}
+	}
+#else
+	for (int pixelY = pixelMinY; pixelY <= pixelMaxY; ++pixelY)
+	{
+		float const* depthRowPixels = &m_depthBuffer[static_cast<size_t>(pixelY) * m_width];
+		for (int pixelX = pixelMinX; pixelX <= pixelMaxX; ++pixelX)
+		{
+			if (depthRowPixels[pixelX] >= minDepth)
+			{
+				return OcclusionResult::VISIBLE;
+			}
+		}
+	}
+#endif
+	return OcclusionResult::OCCLUDED;
+}
+
+void SoftwareOcclusionCuller::TestClusters(std::vector<ModelCluster> const& clusters, std::vector<OcclusionResult>& out_results)
+{
+	double startTime = GetCurrentTimeSeconds();
+
+	int numClusters = static_cast<int>(clusters.size());
+	out_results.resize(clusters.size());
+	ParallelFor(numClusters, 64, [&](int beginIndex, int endIndex)
+	{
+		for (int clusterIndex = beginIndex; clusterIndex < endIndex; ++clusterIndex)
+		{
+			out_results[clusterIndex] = TestBox(clusters[clusterIndex].m_bounds);
+		}
+	});
+
+	m_stats.m_numTested = numClusters;
+	m_stats.m_numOccluded = 0;
+	m_stats.m_numOutsideFrustum = 0;
+	for (int clusterIndex = 0; clusterIndex < numClusters; ++clusterIndex)
+	{
+		m_stats.m_numOccluded += (out_results[clusterIndex] == OcclusionResult::OCCLUDED) ? 1 : 0;
+		m_stats.m_numOutsideFrustum += (out_results[clusterIndex] == OcclusionResult::OUTSIDE_FRUSTUM) ? 1 : 0;
+	}
+	m_stats.m_testSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+// -----------------------------------------------------------------------------
+static float GetBoundsVolume(AABB3 const& bounds)
+{
+	Vec3 size = bounds.m_maxs - bounds.m_mins;
+	return size.x * size.y * size.z;
+}
+
+void SoftwareOcclusionCuller::SelectOccluders(std::vector<ModelCluster>& out_occluders, std::vector<ModelCluster> const& clusters, int triangleBudget)
+{
+	std::vector<int> order(clusters.size());
+	for (int clusterIndex = 0; clusterIndex < static_cast<int>(clusters.size()); ++clusterIndex)
+	{
+		order[clusterIndex] = clusterIndex;
+	}
+	std::sort(order.begin(), order.end(), [&clusters](int a, int b) { return GetBoundsVolume(clusters[a].m_bounds) > GetBoundsVolume(clusters[b].m_bounds); });
+
+	out_occluders.clear();
+	int numTriangles = 0;
+	for (int orderIndex = 0; orderIndex < static_cast<int>(order.size()); ++orderIndex)
+	{
+		ModelCluster const& cluster = clusters[order[orderIndex]];
+		int clusterTriangles = static_cast<int>(cluster.m_indexCount / 3);
+		if (numTriangles + clusterTriangles > triangleBudget)
+		{
+			continue;
+		}
+		out_occluders.push_back(cluster);
+		numTriangles += clusterTriangles;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Game/ViewFrustum.hpp"
+#include <stdint.h>
+#include <vector>
+// -----------------------------------------------------------------------------
+enum class OcclusionResult : unsigned char
+{
+	VISIBLE,
+	OCCLUDED,
+	OUTSIDE_FRUSTUM,
+};
+// -----------------------------------------------------------------------------
+struct OcclusionStats
+{
+	int		m_numOccluderTriangles = 0;
+	int		m_numTested = 0;
+	int		m_numOccluded = 0;
+	int		m_numOutsideFrustum = 0;
+	double	m_rasterSeconds = 0.0;
+	double	m_testSeconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+// Coarse CPU occlusion culling. Occluder triangles are rasterized into a small depth buffer
+// (depth 0 near, 1 far) and cluster bounds are tested against it before drawing. Both passes
+// run on the ParallelFor pool and use SSE for the per-pixel work. Nothing here touches the
+// renderer, so it can run headless.
+// -----------------------------------------------------------------------------
+class SoftwareOcclusionCuller
+{
+public:
+	explicit SoftwareOcclusionCuller(int width = 256, int height = 128);
+
+	void BeginFrame(ClipTransform const& modelToClip);
+	void RasterizeOccluders(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, std::vector<ModelCluster> const& occluders);
+	void TestClusters(std::vector<ModelCluster> const& clusters, std::vector<OcclusionResult>& out_results);
+	OcclusionResult TestBox(AABB3 const& bounds) const;
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	float GetDepth(int x, int y) const { return m_depthBuffer[y * m_width + x]; }
+	OcclusionStats const& GetStats() const { return m_stats; }
+	uint64_t GetNumBufferBytes() const;
+
+	// Picks the clusters with the largest bounds until the triangle budget is spent
+	static void SelectOccluders(std::vector<ModelCluster>& out_occluders, std::vector<ModelCluster> const& clusters, int triangleBudget);
+
+private:
+	struct ScreenTriangle
+	{
+		float	m_x[3];
+		float	m_y[3];
+		float	m_z[3];
+		int		m_minY = 1;
+		int		m_maxY = 0;
+	};
+
+	int  SetupTriangle(float const clip0[4], float const clip1[4], float const clip2[4], ScreenTriangle* out_triangles) const;
+	void RasterizeTriangle(ScreenTriangle const& triangle, int bandMinY, int bandMaxY);
+
+private:
+	int							m_width = 0;
+	int							m_height = 0;
+	std::vector<float>			m_depthBuffer;
+	std::vector<ScreenTriangle>	m_screenTriangles;
+	ClipTransform				m_modelToClip;
+	OcclusionStats				m_stats;
+};
@@ -0,0 +1,212 @@
+#include "Game/SoftwareRenderer.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+void SoftwareRenderer::Resize(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_colorBuffer.resize(static_cast<size_t>(width) * height * 4);
+	m_depthBuffer.resize(static_cast<size_t>(width) * height);
+}
+
+uint64_t SoftwareRenderer::GetNumBufferBytes() const
+{
+	return static_cast<uint64_t>(m_colorBuffer.capacity()) + static_cast<uint64_t>(m_depthBuffer.capacity()) * sizeof(float)
+		+ static_cast<uint64_t>(m_shadedVerts.capacity()) * sizeof(ShadedVertex) + static_cast<uint64_t>(m_screenTriangles.capacity()) * sizeof(ScreenTriangle);
+}
+
+void SoftwareRenderer::Clear(Rgba8 const& clearColor)
+{
+	for (int pixelIndex = 0; pixelIndex < m_width * m_height; ++pixelIndex)
+	{
+		unsigned char* pixel = &m_colorBuffer[static_cast<size_t>(pixelIndex) * 4];
+		pixel[0] = clearColor.r;
+		pixel[1] = clearColor.g;
+		pixel[2] = clearColor.b;
+		pixel[3] = clearColor.a;
+	}
+	std::fill(m_depthBuffer.begin(), m_depthBuffer.end(), 1.f);
+}
+
+// -----------------------------------------------------------------------------
+int SoftwareRenderer::SetupTriangle(ShadedVertex const& vert0, ShadedVertex const& vert1, ShadedVertex const& vert2, ScreenTriangle* out_triangles) const
+{
+	// Clip against the near plane (z >= 0); a triangle becomes at most a quad
+	constexpr int NUM_ATTRIBUTES = 7;
+	float const* input[3] = { vert0.m_attributes, vert1.m_attributes, vert2.m_attributes };
+	float polygon[4][NUM_ATTRIBUTES];
+	int numPolygonVerts = 0;
+	for (int vertIndex = 0; vertIndex < 3; ++vertIndex)
+	{
+		float const* current = input[vertIndex];
+		float const* next = input[(vertIndex + 1) % 3];
+		if (current[2] >= 0.f)
+		{
+			std::copy(current, current + NUM_ATTRIBUTES, polygon[numPolygonVerts]);
+			++numPolygonVerts;
+		}
+		if ((current[2] >= 0.f) != (next[2] >= 0.f))
+		{
+			float t = current[2] / (current[2] - next[2]);
+			for (int attribute = 0; attribute < NUM_ATTRIBUTES; ++attribute)
+			{
+				polygon[numPolygonVerts][attribute] = current[attribute] + t * (next[attribute] - current[attribute]);
+			}
+			++numPolygonVerts;
+		}
+	}
+	if (numPolygonVerts < 3)
+	{
+		return 0;
+	}
+
+	int numTriangles = 0;
+	for (int fanIndex = 1; fanIndex + 1 < numPolygonVerts; ++fanIndex)
+	{
+		ScreenTriangle& triangle = out_triangles[numTriangles];
+		int const corners[3] = { 0, fanIndex, fanIndex + 1 };
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			float const* corner = polygon[corners[cornerIndex]];
+			float inverseW = 1.f / std::max(corner[3], 1.0e-6f);
+			triangle.m_x[cornerIndex] = (corner[0] * inverseW * 0.5f + 0.5f) * static_cast<float>(m_width);
+			triangle.m_y[cornerIndex] = (0.5f - corner[1] * inverseW * 0.5f) * static_cast<float>(m_height);
+			triangle.m_z[cornerIndex] = corner[2] * inverseW;
+			triangle.m_inverseW[cornerIndex] = inverseW;
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				triangle.m_colorOverW[cornerIndex][channel] = corner[4 + channel] * inverseW;
+			}
+		}
+
+		float minY = std::min(triangle.m_y[0], std::min(triangle.m_y[1], triangle.m_y[2]));
+		float maxY = std::max(triangle.m_y[0], std::max(triangle.m_y[1], triangle.m_y[2]));
+		float area = (triangle.m_x[1] - triangle.m_x[0]) * (triangle.m_y[2] - triangle.m_y[0]) - (triangle.m_x[2] - triangle.m_x[0]) * (triangle.m_y[1] - triangle.m_y[0]);
+		if (area == 0.f || minY >= static_cast<float>(m_height) || maxY < 0.f)
+		{
+			continue;
+		}
+		if (area < 0.f)
+		{
+			std::swap(triangle.m_x[1], triangle.m_x[2]);
+			std::swap(triangle.m_y[1], triangle.m_y[2]);
+			std::swap(triangle.m_z[1], triangle.m_z[2]);
+			std::swap(triangle.m_inverseW[1], triangle.m_inverseW[2]);
+			std::swap(triangle.m_colorOverW[1], triangle.m_colorOverW[2]);
+		}
+		triangle.m_minY = static_cast<int>(floorf(std::max(minY, 0.f)));
+		triangle.m_maxY = static_cast<int>(ceilf(std::min(maxY, static_cast<float>(m_height - 1))));
+		++numTriangles;
+	}
+	return numTriangles;
+}
+
+// -----------------------------------------------------------------------------
+void SoftwareRenderer::RasterizeTriangle(ScreenTriangle const& triangle, int bandMinY, int bandMaxY)
+{
+	float const* x = triangle.m_x;
+	float const* y = triangle.m_y;
+	int minX = std::max(static_cast<int>(floorf(std::min(x[0], std::min(x[1], x[2])))), 0);
+	int maxX = std::min(static_cast<int>(ceilf(std::max(x[0], std::max(x[1], x[2])))), m_width - 1);
+	int minY = std::max(triangle.m_minY, bandMinY);
+	int maxY = std::min(triangle.m_maxY, bandMaxY);
+
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	float inverseArea = 1.f / area;
+	for (int pixelY = minY; pixelY <= maxY; ++pixelY)
+	{
+		float sampleY = static_cast<float>(pixelY) + 0.5f;
+		for (int pixelX = minX; pixelX <= maxX; ++pixelX)
+		{
+			// Barycentric weights at the pixel center from the three edge functions
+			float sampleX = static_cast<float>(pixelX) + 0.5f;
+			float weight0 = ((x[2] - x[1]) * (sampleY - y[1]) - (y[2] - y[1]) * (sampleX - x[1])) * inverseArea;
+			float weight1 = ((x[0] - x[2]) * (sampleY - y[2]) - (y[0] - y[2]) * (sampleX - x[2])) * inverseArea;
+			float weight2 = 1.f - weight0 - weight1;
+			if (weight0 < 0.f || weight1 < 0.f || weight2 < 0.f)
+			{
+				continue;
+			}
+
+			size_t pixelIndex = static_cast<size_t>(pixelY) * m_width + pixelX;
+			float depth = weight0 * triangle.m_z[0] + weight1 * triangle.m_z[1] + weight2 * triangle.m_z[2];
+			if (depth >= m_depthBuffer[pixelIndex])
+			{
+				continue;
+			}
+			m_depthBuffer[pixelIndex] = depth;
+
+			float w = 1.f / (weight0 * triangle.m_inverseW[0] + weight1 * triangle.m_inverseW[1] + weight2 * triangle.m_inverseW[2]);
+			unsigned char* pixel = &m_colorBuffer[pixelIndex * 4];
+			for (int channel = 0; channel < 3; ++channel)
+			{
+				float color = (weight0 * triangle.m_colorOverW[0][channel] + weight1 * triangle.m_colorOverW[1][channel] + weight2 * triangle.m_colorOverW[2][channel]) * w;
+				pixel[channel] = static_cast<unsigned char>(GetClamped(color, 0.f, 1.f) * 255.f + 0.5f);
+			}
+			pixel[3] = 255;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+void SoftwareRenderer::DrawMesh(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, ClipTransform const& modelToClip,
+	Mat44 const& modelToWorld, SoftwareLighting const& lighting)
+{
+	Vec3 toSun = -lighting.m_sunDirection.GetNormalized();
+	int numVerts = static_cast<int>(verts.size());
+	m_shadedVerts.resize(numVerts);
+	ParallelFor(numVerts, 1024, [&](int beginIndex, int endIndex)
+	{
+		for (int vertIndex = beginIndex; vertIndex < endIndex; ++vertIndex)
+		{
+			Vertex_PCUTBN const& vertex = verts[vertIndex];
+			ShadedVertex& shaded = m_shadedVerts[vertIndex];
+			modelToClip.TransformPosition(vertex.m_position, shaded.m_attributes);
+
+			Vec3 worldNormal = modelToWorld.TransformVectorQuantity3D(vertex.m_normal).GetNormalized();
+			float light = lighting.m_ambientIntensity + lighting.m_sunIntensity * std::max(DotProduct3D(worldNormal, toSun), 0.f);
+			shaded.m_attributes[4] = static_cast<float>(vertex.m_color.r) / 255.f * light;
+			shaded.m_attributes[5] = static_cast<float>(vertex.m_color.g) / 255.f * light;
+			shaded.m_attributes[6] = static_cast<float>(vertex.m_color.b) / 255.f * light;
+		}
+	});
+
+	// Two slots per triangle, since near-plane clipping can split one into two
+	int numTriangles = static_cast<int>(indices.size() / 3);
+	m_screenTriangles.resize(static_cast<size_t>(numTriangles) * 2);
+	ParallelFor(numTriangles, 1024, [&](int beginIndex, int endIndex)
+	{
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; ++triangleIndex)
+		{
+			unsigned int const* triangleIndices = &indices[static_cast<size_t>(triangleIndex) * 3];
+			ScreenTriangle* slots = &m_screenTriangles[static_cast<size_t>(triangleIndex) * 2];
+			int numScreenTriangles = SetupTriangle(m_shadedVerts[triangleIndices[0]], m_shadedVerts[triangleIndices[1]], m_shadedVerts[triangleIndices[2]], slots);
+			for (int slotIndex = numScreenTriangles; slotIndex < 2; ++slotIndex)
+			{
+				slots[slotIndex].m_minY = 1;
+				slots[slotIndex].m_maxY = 0;
+			}
+		}
+	});
+
+	// Each band of rows is owned by one task, so color and depth writes never race
+	constexpr int ROWS_PER_BAND = 8;
+	int numBands = (m_height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+	ParallelFor(numBands, 1, [&](int beginBand, int endBand)
+	{
+		int bandMinY = beginBand * ROWS_PER_BAND;
+		int bandMaxY = std::min(endBand * ROWS_PER_BAND, m_height) - 1;
+		for (int screenTriangleIndex = 0; screenTriangleIndex < static_cast<int>(m_screenTriangles.size()); ++screenTriangleIndex)
+		{
+			ScreenTriangle const& triangle = m_screenTriangles[screenTriangleIndex];
+			if (triangle.m_minY <= bandMaxY && triangle.m_maxY >= bandMinY)
+			{
+				RasterizeTriangle(triangle, bandMinY, bandMaxY);
+			}
+		}
+	});
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Game/ViewFrustum.hpp"
+#include "Engine/Core/Rgba8.h"
+#include "Engine/Core/Vertex_PCUTBN.hpp"
+#include <stdint.h>
+#include <vector>
+// -----------------------------------------------------------------------------
+struct SoftwareLighting
+{
+	Vec3  m_sunDirection = Vec3(3.f, 1.f, -2.f);
+	float m_sunIntensity = 0.35f;
+	float m_ambientIntensity = 0.25f;
+};
+// -----------------------------------------------------------------------------
+// CPU reference renderer: vertex color lit by the sun with per-vertex Lambert and ambient,
+// perspective-correct interpolation, and a float depth buffer. Triangles are set up in parallel
+// and rasterized in parallel bands of rows. It ignores textures and draws double-sided. Turntable
+// and screenshot captures always use it, since the engine renderer has no readback.
+// -----------------------------------------------------------------------------
+class SoftwareRenderer
+{
+public:
+	void Resize(int width, int height);
+	void Clear(Rgba8 const& clearColor);
+	void DrawMesh(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, ClipTransform const& modelToClip,
+		Mat44 const& modelToWorld, SoftwareLighting const& lighting);
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+	unsigned char const* GetPixels() const { return m_colorBuffer.data(); }	// RGBA8, top row first
+	uint64_t GetNumBufferBytes() const;
+
+private:
+	struct ShadedVertex
+	{
+		float m_attributes[7];	// Clip x, y, z, w, then lit r, g, b
+	};
+
+	struct ScreenTriangle
+	{
+		float	m_x[3];
+		float	m_y[3];
+		float	m_z[3];
+		float	m_inverseW[3];
+		float	m_colorOverW[3][3];
+		int		m_minY = 1;
+		int		m_maxY = 0;
+	};
+
+	int  SetupTriangle(ShadedVertex const& vert0, ShadedVertex const& vert1, ShadedVertex const& vert2, ScreenTriangle* out_triangles) const;
+	void RasterizeTriangle(ScreenTriangle const& triangle, int bandMinY, int bandMaxY);
+
+private:
+	int							m_width = 0;
+	int							m_height = 0;
+	std::vector<unsigned char>	m_colorBuffer;
+	std::vector<float>			m_depthBuffer;
+	std::vector<ShadedVertex>	m_shadedVerts;
+	std::vector<ScreenTriangle>	m_screenTriangles;
+};
@@ -0,0 +1,683 @@
+#include "Game/TriangleBVH.hpp"
+#include "Game/ParallelFor.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+// Deeper ranges become leaves whatever their size, which bounds the traversal stacks below
+constexpr int BVH_MAX_DEPTH = 64;
+
+// Ranges up to this size are left as leaves when the SAH finds no split cheaper than testing them all
+constexpr uint32_t BVH_MAX_SAH_LEAF_TRIANGLES = 16;
+
+// The top of the tree is split serially until ranges are small enough to hand out as parallel subtrees
+constexpr int BVH_SUBTREES_PER_THREAD = 8;
+constexpr uint32_t BVH_MIN_SUBTREE_TRIANGLES = 16384;
+
+// Plane cuts fan out over this many straddling nodes per thread before traversing them in parallel
+constexpr int SECTION_TASKS_PER_THREAD = 16;
+
+constexpr uint32_t INVALID_BUILD_TRIANGLE = 0xFFFFFFFFu;
+
+// -----------------------------------------------------------------------------
+static float GetHalfSurfaceArea(float const mins[3], float const maxs[3])
+{
+	float dx = maxs[0] - mins[0];
+	float dy = maxs[1] - mins[1];
+	float dz = maxs[2] - mins[2];
+	return dx * dy + dy * dz + dz * dx;
+}
+
+// Entry distance of the ray into the box, or FLT_MAX when it misses or starts beyond maxDistance
+static float GetRayBoxEntryDistance(TriangleBVHNode const& node, float const start[3], float const inverseDirection[3], float maxDistance)
+{
+	float entry = 0.f;
+	float exit = maxDistance;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		float nearDistance = (node.m_mins[axis] - start[axis]) * inverseDirection[axis];
+		float farDistance = (node.m_maxs[axis] - start[axis]) * inverseDirection[axis];
+		if (nearDistance > farDistance)
+		{
+			std::swap(nearDistance, farDistance);
+		}
+		entry = std::max(entry, nearDistance);
+		exit = std::min(exit, farDistance);
+	}
+	return (entry <= exit) ? entry : FLT_MAX;
+}
+
+// The box's extreme corners are measured with the same expression as a triangle corner, so rounding cannot
+// skip a node holding a triangle that only touches the plane
+static bool DoesNodeStraddlePlane(TriangleBVHNode const& node, float const planeNormal[3], float planeDistance)
+{
+	float minCorner[3];
+	float maxCorner[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		minCorner[axis] = (planeNormal[axis] >= 0.f) ? node.m_mins[axis] : node.m_maxs[axis];
+		maxCorner[axis] = (planeNormal[axis] >= 0.f) ? node.m_maxs[axis] : node.m_mins[axis];
+	}
+	float minDistance = planeNormal[0] * minCorner[0] + planeNormal[1] * minCorner[1] + planeNormal[2] * minCorner[2] - planeDistance;
+	float maxDistance = planeNormal[0] * maxCorner[0] + planeNormal[1] * maxCorner[1] + planeNormal[2] * maxCorner[2] - planeDistance;
+	return minDistance < 0.f && maxDistance >= 0.f;
+}
+
+// -----------------------------------------------------------------------------
+void TriangleBVH::Clear()
+{
+	// Swapped out rather than cleared, so a BVH dropped with its mesh gives its memory back
+	std::vector<TriangleBVHNode>().swap(m_nodes);
+	std::vector<uint32_t>().swap(m_triangles);
+	std::vector<BuildTriangle>().swap(m_buildTriangles);
+	m_stats = TriangleBVHStats();
+}
+
+void TriangleBVH::Build(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices)
+{
+	double startTime = GetCurrentTimeSeconds();
+	Clear();
+
+	int numTriangles = static_cast<int>(indices.size() / 3);
+	unsigned int numVerts = static_cast<unsigned int>(verts.size());
+	m_buildTriangles.resize(numTriangles);
+	ParallelFor(numTriangles, 4096, [&](int beginIndex, int endIndex)
+	{
+		for (int triangleIndex = beginIndex; triangleIndex < endIndex; ++triangleIndex)
+		{
+			BuildTriangle& buildTriangle = m_buildTriangles[triangleIndex];
+			buildTriangle.m_triangle = INVALID_BUILD_TRIANGLE;
+			unsigned int const* corners = &indices[static_cast<size_t>(triangleIndex) * 3];
+			if (corners[0] >= numVerts || corners[1] >= numVerts || corners[2] >= numVerts)
+			{
+				continue;
+			}
+
+			bool isFinite = true;
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				buildTriangle.m_mins[axis] = FLT_MAX;
+				buildTriangle.m_maxs[axis] = -FLT_MAX;
+			}
+			for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+			{
+				Vec3 const& position = verts[corners[cornerIndex]].m_position;
+				float const components[3] = { position.x, position.y, position.z };
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					isFinite = isFinite && isfinite(components[axis]);
+					buildTriangle.m_mins[axis] = std::min(buildTriangle.m_mins[axis], components[axis]);
+					buildTriangle.m_maxs[axis] = std::max(buildTriangle.m_maxs[axis], components[axis]);
+				}
+			}
+
+			// Triangles with non-finite corners could never be hit and would poison the bounds above them
+			if (isFinite)
+			{
+				buildTriangle.m_triangle = static_cast<uint32_t>(triangleIndex);
+			}
+		}
+	});
+
+	m_buildTriangles.erase(std::remove_if(m_buildTriangles.begin(), m_buildTriangles.end(), [](BuildTriangle const& buildTriangle)
+	{
+		return buildTriangle.m_triangle == INVALID_BUILD_TRIANGLE;
+	}), m_buildTriangles.end());
+	uint32_t numUsableTriangles = static_cast<uint32_t>(m_buildTriangles.size());
+	if (numUsableTriangles == 0)
+	{
+		std::vector<BuildTriangle>().swap(m_buildTriangles);
+		return;
+	}
+
+	m_nodes.reserve(2 * (numUsableTriangles / BVH_MAX_LEAF_TRIANGLES + 1));
+	m_nodes.resize(1);
+	uint32_t subtreeTriangles = std::max(BVH_MIN_SUBTREE_TRIANGLES, numUsableTriangles / static_cast<uint32_t>(GetParallelForNumThreads() * BVH_SUBTREES_PER_THREAD));
+
+	int maxDepth = 0;
+	std::vector<BuildRange> pendingRanges;
+	std::vector<BuildRange> subtreeRanges;
+	BuildRange rootRange;
+	rootRange.m_end = numUsableTriangles;
+	FitBuildRange(rootRange);
+	pendingRanges.push_back(rootRange);
+	while (!pendingRanges.empty())
+	{
+		BuildRange range = pendingRanges.back();
+		pendingRanges.pop_back();
+		if (range.m_end - range.m_begin <= subtreeTriangles)
+		{
+			subtreeRanges.push_back(range);
+			continue;
+		}
+		SplitNode(m_nodes, range, pendingRanges, maxDepth);
+	}
+
+	// Each subtree is built into its own node list, then spliced in with its root at the reserved node
+	std::vector<std::vector<TriangleBVHNode>> subtreeNodes(subtreeRanges.size());
+	std::vector<int> subtreeDepths(subtreeRanges.size(), 0);
+	ParallelFor(static_cast<int>(subtreeRanges.size()), 1, [&](int beginIndex, int endIndex)
+	{
+		for (int subtreeIndex = beginIndex; subtreeIndex < endIndex; ++subtreeIndex)
+		{
+			BuildSubtree(subtreeNodes[subtreeIndex], subtreeRanges[subtreeIndex], subtreeDepths[subtreeIndex]);
+		}
+	});
+
+	for (int subtreeIndex = 0; subtreeIndex < static_cast<int>(subtreeRanges.size()); ++subtreeIndex)
+	{
+		std::vector<TriangleBVHNode>& nodes = subtreeNodes[subtreeIndex];
+		uint32_t baseIndex = static_cast<uint32_t>(m_nodes.size());
+		for (int nodeIndex = 0; nodeIndex < static_cast<int>(nodes.size()); ++nodeIndex)
+		{
+			if (nodes[nodeIndex].m_numTriangles == 0)
+			{
+				nodes[nodeIndex].m_first = baseIndex + nodes[nodeIndex].m_first - 1;
+			}
+		}
+		m_nodes[subtreeRanges[subtreeIndex].m_nodeIndex] = nodes[0];
+		m_nodes.insert(m_nodes.end(), nodes.begin() + 1, nodes.end());
+		maxDepth = std::max(maxDepth, subtreeDepths[subtreeIndex]);
+		std::vector<TriangleBVHNode>().swap(nodes);
+	}
+
+	m_triangles.resize(numUsableTriangles);
+	for (uint32_t triangleSlot = 0; triangleSlot < numUsableTriangles; ++triangleSlot)
+	{
+		m_triangles[triangleSlot] = m_buildTriangles[triangleSlot].m_triangle;
+	}
+	std::vector<BuildTriangle>().swap(m_buildTriangles);
+	m_stats.m_numTriangles = static_cast<int>(numUsableTriangles);
+	m_stats.m_numNodes = static_cast<int>(m_nodes.size());
+	for (int nodeIndex = 0; nodeIndex < static_cast<int>(m_nodes.size()); ++nodeIndex)
+	{
+		m_stats.m_numLeaves += (m_nodes[nodeIndex].m_numTriangles > 0) ? 1 : 0;
+	}
+	m_stats.m_maxDepth = maxDepth;
+	m_stats.m_buildSeconds = GetCurrentTimeSeconds() - startTime;
+}
+
+void TriangleBVH::BuildSubtree(std::vector<TriangleBVHNode>& nodes, BuildRange const& rootRange, int& out_maxDepth)
+{
+	nodes.reserve(2 * ((rootRange.m_end - rootRange.m_begin) / BVH_MAX_LEAF_TRIANGLES + 1));
+	nodes.resize(1);
+	BuildRange localRootRange = rootRange;
+	localRootRange.m_nodeIndex = 0;
+
+	std::vector<BuildRange> pendingRanges;
+	pendingRanges.push_back(localRootRange);
+	while (!pendingRanges.empty())
+	{
+		BuildRange range = pendingRanges.back();
+		pendingRanges.pop_back();
+		SplitNode(nodes, range, pendingRanges, out_maxDepth);
+	}
+}
+
+void TriangleBVH::FitBuildRange(BuildRange& range) const
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		range.m_mins[axis] = FLT_MAX;
+		range.m_maxs[axis] = -FLT_MAX;
+	}
+	for (uint32_t triangleSlot = range.m_begin; triangleSlot < range.m_end; ++triangleSlot)
+	{
+		BuildTriangle const& buildTriangle = m_buildTriangles[triangleSlot];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			range.m_mins[axis] = std::min(range.m_mins[axis], buildTriangle.m_mins[axis]);
+			range.m_maxs[axis] = std::max(range.m_maxs[axis], buildTriangle.m_maxs[axis]);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Either makes the range's node a leaf or splits the range at the cheapest of the binned SAH planes
+// along the longest centroid axis and queues the two children, already fit to their triangles
+void TriangleBVH::SplitNode(std::vector<TriangleBVHNode>& nodes, BuildRange const& range, std::vector<BuildRange>& out_childRanges, int& inout_maxDepth)
+{
+	float centroidMins[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float centroidMaxs[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	BuildTriangle* buildTriangles = m_buildTriangles.data();
+	for (uint32_t triangleSlot = range.m_begin; triangleSlot < range.m_end; ++triangleSlot)
+	{
+		BuildTriangle const& buildTriangle = buildTriangles[triangleSlot];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			// Centroids are kept doubled (mins + maxs) throughout; only their ordering matters
+			float centroid = buildTriangle.m_mins[axis] + buildTriangle.m_maxs[axis];
+			centroidMins[axis] = std::min(centroidMins[axis], centroid);
+			centroidMaxs[axis] = std::max(centroidMaxs[axis], centroid);
+		}
+	}
+
+	TriangleBVHNode node;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		node.m_mins[axis] = range.m_mins[axis];
+		node.m_maxs[axis] = range.m_maxs[axis];
+	}
+	node.m_first = range.m_begin;
+	node.m_numTriangles = range.m_end - range.m_begin;
+	inout_maxDepth = std::max(inout_maxDepth, range.m_depth);
+
+	uint32_t numTriangles = range.m_end - range.m_begin;
+	int splitAxis = 0;
+	for (int axis = 1; axis < 3; ++axis)
+	{
+		if (centroidMaxs[axis] - centroidMins[axis] > centroidMaxs[splitAxis] - centroidMins[splitAxis])
+		{
+			splitAxis = axis;
+		}
+	}
+	float centroidExtent = centroidMaxs[splitAxis] - centroidMins[splitAxis];
+	if (numTriangles <= static_cast<uint32_t>(BVH_MAX_LEAF_TRIANGLES) || range.m_depth >= BVH_MAX_DEPTH - 1)
+	{
+		nodes[range.m_nodeIndex] = node;
+		return;
+	}
+
+	BuildTriangle* splitSlot = buildTriangles + range.m_begin + numTriangles / 2;
+	BuildRange leftRange;
+	BuildRange rightRange;
+	bool areChildrenFit = false;
+	if (centroidExtent > 0.f)
+	{
+		struct Bin
+		{
+			float		m_mins[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+			float		m_maxs[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			uint32_t	m_count = 0;
+		};
+		Bin bins[BVH_NUM_SPLIT_BINS];
+		float binScale = static_cast<float>(BVH_NUM_SPLIT_BINS) / centroidExtent;
+		float binMin = centroidMins[splitAxis];
+		auto getBinIndex = [splitAxis, binScale, binMin](BuildTriangle const& buildTriangle)
+		{
+			int binIndex = static_cast<int>((buildTriangle.m_mins[splitAxis] + buildTriangle.m_maxs[splitAxis] - binMin) * binScale);
+			return std::min(binIndex, BVH_NUM_SPLIT_BINS - 1);
+		};
+
+		for (uint32_t triangleSlot = range.m_begin; triangleSlot < range.m_end; ++triangleSlot)
+		{
+			BuildTriangle const& buildTriangle = buildTriangles[triangleSlot];
+			Bin& bin = bins[getBinIndex(buildTriangle)];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				bin.m_mins[axis] = std::min(bin.m_mins[axis], buildTriangle.m_mins[axis]);
+				bin.m_maxs[axis] = std::max(bin.m_maxs[axis], buildTriangle.m_maxs[axis]);
+			}
+			++bin.m_count;
+		}
+
+		// Sweep from the right to get the bounds and cost of everything above each split, then from the left
+		Bin rightBounds[BVH_NUM_SPLIT_BINS];
+		float rightCosts[BVH_NUM_SPLIT_BINS] = {};
+		for (int binIndex = BVH_NUM_SPLIT_BINS - 1; binIndex > 0; --binIndex)
+		{
+			Bin const& bin = bins[binIndex];
+			Bin const& aboveBounds = (binIndex < BVH_NUM_SPLIT_BINS - 1) ? rightBounds[binIndex + 1] : Bin();
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				rightBounds[binIndex].m_mins[axis] = std::min(aboveBounds.m_mins[axis], bin.m_mins[axis]);
+				rightBounds[binIndex].m_maxs[axis] = std::max(aboveBounds.m_maxs[axis], bin.m_maxs[axis]);
+			}
+			rightBounds[binIndex].m_count = aboveBounds.m_count + bin.m_count;
+			rightCosts[binIndex] = (rightBounds[binIndex].m_count > 0) ? GetHalfSurfaceArea(rightBounds[binIndex].m_mins, rightBounds[binIndex].m_maxs) * static_cast<float>(rightBounds[binIndex].m_count) : 0.f;
+		}
+
+		int bestSplitBin = -1;
+		float bestCost = FLT_MAX;
+		Bin leftBounds;
+		Bin bestLeftBounds;
+		for (int binIndex = 0; binIndex < BVH_NUM_SPLIT_BINS - 1; ++binIndex)
+		{
+			Bin const& bin = bins[binIndex];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				leftBounds.m_mins[axis] = std::min(leftBounds.m_mins[axis], bin.m_mins[axis]);
+				leftBounds.m_maxs[axis] = std::max(leftBounds.m_maxs[axis], bin.m_maxs[axis]);
+			}
+			leftBounds.m_count += bin.m_count;
+			if (leftBounds.m_count == 0 || leftBounds.m_count == numTriangles)
+			{
+				continue;
+			}
+			float cost = GetHalfSurfaceArea(leftBounds.m_mins, leftBounds.m_maxs) * static_cast<float>(leftBounds.m_count) + rightCosts[binIndex + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestSplitBin = binIndex;
+				bestLeftBounds = leftBounds;
+			}
+		}
+
+		float leafCost = GetHalfSurfaceArea(range.m_mins, range.m_maxs) * static_cast<float>(numTriangles);
+		if (numTriangles <= BVH_MAX_SAH_LEAF_TRIANGLES && bestCost >= leafCost)
+		{
+			nodes[range.m_nodeIndex] = node;
+			return;
+		}
+		if (bestSplitBin >= 0)
+		{
+			splitSlot = std::partition(buildTriangles + range.m_begin, buildTriangles + range.m_end,
+				[&getBinIndex, bestSplitBin](BuildTriangle const& buildTriangle) { return getBinIndex(buildTriangle) <= bestSplitBin; });
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				leftRange.m_mins[axis] = bestLeftBounds.m_mins[axis];
+				leftRange.m_maxs[axis] = bestLeftBounds.m_maxs[axis];
+				rightRange.m_mins[axis] = rightBounds[bestSplitBin + 1].m_mins[axis];
+				rightRange.m_maxs[axis] = rightBounds[bestSplitBin + 1].m_maxs[axis];
+			}
+			areChildrenFit = true;
+		}
+	}
+
+	// Stacked or coincident centroids give the binning nothing to separate; split those by count
+	if (splitSlot == buildTriangles + range.m_begin || splitSlot == buildTriangles + range.m_end || centroidExtent <= 0.f)
+	{
+		splitSlot = buildTriangles + range.m_begin + numTriangles / 2;
+		if (centroidExtent > 0.f)
+		{
+			std::nth_element(buildTriangles + range.m_begin, splitSlot, buildTriangles + range.m_end, [splitAxis](BuildTriangle const& triangleA, BuildTriangle const& triangleB)
+			{
+				return triangleA.m_mins[splitAxis] + triangleA.m_maxs[splitAxis] < triangleB.m_mins[splitAxis] + triangleB.m_maxs[splitAxis];
+			});
+		}
+		areChildrenFit = false;
+	}
+
+	uint32_t childIndex = static_cast<uint32_t>(nodes.size());
+	node.m_first = childIndex;
+	node.m_numTriangles = 0;
+	nodes.resize(nodes.size() + 2);
+	nodes[range.m_nodeIndex] = node;
+
+	uint32_t splitIndex = static_cast<uint32_t>(splitSlot - buildTriangles);
+	rightRange.m_nodeIndex = childIndex + 1;
+	rightRange.m_begin = splitIndex;
+	rightRange.m_end = range.m_end;
+	rightRange.m_depth = range.m_depth + 1;
+	leftRange.m_nodeIndex = childIndex;
+	leftRange.m_begin = range.m_begin;
+	leftRange.m_end = splitIndex;
+	leftRange.m_depth = range.m_depth + 1;
+	if (!areChildrenFit)
+	{
+		FitBuildRange(leftRange);
+		FitBuildRange(rightRange);
+	}
+	out_childRanges.push_back(rightRange);
+	out_childRanges.push_back(leftRange);
+}
+
+// -----------------------------------------------------------------------------
+uint64_t TriangleBVH::GetNumBytes() const
+{
+	return static_cast<uint64_t>(m_nodes.capacity()) * sizeof(TriangleBVHNode) + static_cast<uint64_t>(m_triangles.capacity()) * sizeof(uint32_t)
+		+ static_cast<uint64_t>(m_buildTriangles.capacity()) * sizeof(BuildTriangle);
+}
+
+AABB3 TriangleBVH::GetBounds() const
+{
+	if (m_nodes.empty())
+	{
+		return AABB3(Vec3(), Vec3());
+	}
+	TriangleBVHNode const& root = m_nodes[0];
+	return AABB3(root.m_mins[0], root.m_mins[1], root.m_mins[2], root.m_maxs[0], root.m_maxs[1], root.m_maxs[2]);
+}
+
+// -----------------------------------------------------------------------------
+bool TriangleBVH::Raycast(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& start, Vec3 const& direction, float maxDistance,
+	TriangleRaycastResult& out_result, TriangleQueryStats* out_stats) const
+{
+	double startTime = GetCurrentTimeSeconds();
+	out_result = TriangleRaycastResult();
+	TriangleQueryStats stats;
+	if (m_nodes.empty())
+	{
+		if (out_stats != nullptr)
+		{
+			*out_stats = stats;
+		}
+		return false;
+	}
+
+	float const rayStart[3] = { start.x, start.y, start.z };
+	float const rayDirection[3] = { direction.x, direction.y, direction.z };
+	float inverseDirection[3];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		// Keeps 0 * infinity out of the slab test when the ray starts exactly on a box face
+		float component = (fabsf(rayDirection[axis]) > 1e-30f) ? rayDirection[axis] : copysignf(1e-30f, rayDirection[axis]);
+		inverseDirection[axis] = 1.f / component;
+	}
+
+	float closestDistance = maxDistance;
+	uint32_t closestTriangle = 0xFFFFFFFFu;
+	uint32_t nodeStack[2 * BVH_MAX_DEPTH];
+	int stackSize = 0;
+	if (GetRayBoxEntryDistance(m_nodes[0], rayStart, inverseDirection, closestDistance) != FLT_MAX)
+	{
+		nodeStack[stackSize++] = 0;
+	}
+
+	while (stackSize > 0)
+	{
+		TriangleBVHNode const& node = m_nodes[nodeStack[--stackSize]];
+		++stats.m_numNodesVisited;
+		if (node.m_numTriangles > 0)
+		{
+			for (uint32_t triangleSlot = node.m_first; triangleSlot < node.m_first + node.m_numTriangles; ++triangleSlot)
+			{
+				// Moller-Trumbore, accepting either winding
+				uint32_t triangle = m_triangles[triangleSlot];
+				Vec3 const& corner0 = verts[indices[static_cast<size_t>(triangle) * 3]].m_position;
+				Vec3 const& corner1 = verts[indices[static_cast<size_t>(triangle) * 3 + 1]].m_position;
+				Vec3 const& corner2 = verts[indices[static_cast<size_t>(triangle) * 3 + 2]].m_position;
+				++stats.m_numTrianglesTested;
+
+				float edge1[3] = { corner1.x - corner0.x, corner1.y - corner0.y, corner1.z - corner0.z };
+				float edge2[3] = { corner2.x - corner0.x, corner2.y - corner0.y, corner2.z - corner0.z };
+				float p[3] = { rayDirection[1] * edge2[2] - rayDirection[2] * edge2[1], rayDirection[2] * edge2[0] - rayDirection[0] * edge2[2], rayDirection[0] * edge2[1] - rayDirection[1] * edge2[0] };
+				float determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+				if (fabsf(determinant) < 1e-20f)
+				{
+					continue;
+				}
+				float inverseDeterminant = 1.f / determinant;
+				float s[3] = { rayStart[0] - corner0.x, rayStart[1] - corner0.y, rayStart[2] - corner0.z };
+				float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inverseDeterminant;
+				if (u < 0.f || u > 1.f)
+				{
+					continue;
+				}
+				float q[3] = { s[1] * edge1[2] - s[2] * edge1[1], s[2] * edge1[0] - s[0] * edge1[2], s[0] * edge1[1] - s[1] * edge1[0] };
+				float v = (rayDirection[0] * q[0] + rayDirection[1] * q[1] + rayDirection[2] * q[2]) * inverseDeterminant;
+				if (v < 0.f || u + v > 1.f)
+				{
+					continue;
+				}
+				float distance = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverseDeterminant;
+				if (distance >= 0.f && distance < closestDistance)
+				{
+					closestDistance = distance;
+					closestTriangle = triangle;
+				}
+			}
+			continue;
+		}
+
+		// Push the farther child first so the nearer one is searched first and tightens the distance
+		float firstEntry = GetRayBoxEntryDistance(m_nodes[node.m_first], rayStart, inverseDirection, closestDistance);
+		float secondEntry = GetRayBoxEntryDistance(m_nodes[node.m_first + 1], rayStart, inverseDirection, closestDistance);
+		uint32_t nearChild = (firstEntry <= secondEntry) ? node.m_first : node.m_first + 1;
+		uint32_t farChild = (firstEntry <= secondEntry) ? node.m_first + 1 : node.m_first;
+		if (std::max(firstEntry, secondEntry) != FLT_MAX)
+		{
+			nodeStack[stackSize++] = farChild;
+		}
+		if (std::min(firstEntry, secondEntry) != FLT_MAX)
+		{
+			nodeStack[stackSize++] = nearChild;
+		}
+	}
+
+	if (closestTriangle != 0xFFFFFFFFu)
+	{
+		Vec3 const& corner0 = verts[indices[static_cast<size_t>(closestTriangle) * 3]].m_position;
+		Vec3 const& corner1 = verts[indices[static_cast<size_t>(closestTriangle) * 3 + 1]].m_position;
+		Vec3 const& corner2 = verts[indices[static_cast<size_t>(closestTriangle) * 3 + 2]].m_position;
+		Vec3 normal = CrossProduct3D(corner1 - corner0, corner2 - corner0).GetNormalized();
+		out_result.m_didHit = true;
+		out_result.m_distance = closestDistance;
+		out_result.m_position = start + direction * closestDistance;
+		out_result.m_normal = (DotProduct3D(normal, direction) > 0.f) ? normal * -1.f : normal;
+		out_result.m_triangleIndex = static_cast<int>(closestTriangle);
+	}
+
+	stats.m_seconds = GetCurrentTimeSeconds() - startTime;
+	if (out_stats != nullptr)
+	{
+		*out_stats = stats;
+	}
+	return out_result.m_didHit;
+}
+
+// -----------------------------------------------------------------------------
+void TriangleBVH::IntersectPlane(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& planeNormal, float planeDistance,
+	std::vector<Vec3>& out_segmentPoints, TriangleQueryStats* out_stats) const
+{
+	double startTime = GetCurrentTimeSeconds();
+	TriangleQueryStats stats;
+	float const normal[3] = { planeNormal.x, planeNormal.y, planeNormal.z };
+	if (m_nodes.empty() || !DoesNodeStraddlePlane(m_nodes[0], normal, planeDistance))
+	{
+		if (out_stats != nullptr)
+		{
+			*out_stats = stats;
+		}
+		return;
+	}
+
+	// Widen breadth-first into a frontier of straddling nodes, one parallel task each
+	int targetNumTasks = GetParallelForNumThreads() * SECTION_TASKS_PER_THREAD;
+	std::vector<uint32_t> frontier(1, 0);
+	std::vector<uint32_t> nextFrontier;
+	bool hasInteriorNodes = true;
+	while (hasInteriorNodes && static_cast<int>(frontier.size()) < targetNumTasks)
+	{
+		hasInteriorNodes = false;
+		nextFrontier.clear();
+		for (int frontierIndex = 0; frontierIndex < static_cast<int>(frontier.size()); ++frontierIndex)
+		{
+			TriangleBVHNode const& node = m_nodes[frontier[frontierIndex]];
+			if (node.m_numTriangles > 0)
+			{
+				nextFrontier.push_back(frontier[frontierIndex]);
+				continue;
+			}
+			++stats.m_numNodesVisited;
+			for (uint32_t childIndex = node.m_first; childIndex < node.m_first + 2; ++childIndex)
+			{
+				if (DoesNodeStraddlePlane(m_nodes[childIndex], normal, planeDistance))
+				{
+					nextFrontier.push_back(childIndex);
+					hasInteriorNodes |= (m_nodes[childIndex].m_numTriangles == 0);
+				}
+			}
+		}
+		frontier.swap(nextFrontier);
+	}
+
+	std::vector<std::vector<Vec3>> taskSegmentPoints(frontier.size());
+	std::vector<TriangleQueryStats> taskStats(frontier.size());
+	ParallelFor(static_cast<int>(frontier.size()), 1, [&](int beginIndex, int endIndex)
+	{
+		for (int taskIndex = beginIndex; taskIndex < endIndex; ++taskIndex)
+		{
+			std::vector<Vec3>& segmentPoints = taskSegmentPoints[taskIndex];
+			TriangleQueryStats& taskStat = taskStats[taskIndex];
+			uint32_t nodeStack[2 * BVH_MAX_DEPTH];
+			int stackSize = 0;
+			nodeStack[stackSize++] = frontier[taskIndex];
+			while (stackSize > 0)
+			{
+				TriangleBVHNode const& node = m_nodes[nodeStack[--stackSize]];
+				++taskStat.m_numNodesVisited;
+				if (node.m_numTriangles == 0)
+				{
+					// Second child pushed first, so the output follows the node order
+					for (uint32_t childIndex = node.m_first + 2; childIndex-- > node.m_first; )
+					{
+						if (DoesNodeStraddlePlane(m_nodes[childIndex], normal, planeDistance))
+						{
+							nodeStack[stackSize++] = childIndex;
+						}
+					}
+					continue;
+				}
+
+				for (uint32_t triangleSlot = node.m_first; triangleSlot < node.m_first + node.m_numTriangles; ++triangleSlot)
+				{
+					uint32_t triangle = m_triangles[triangleSlot];
+					Vec3 const* corners[3] =
+					{
+						&verts[indices[static_cast<size_t>(triangle) * 3]].m_position,
+						&verts[indices[static_cast<size_t>(triangle) * 3 + 1]].m_position,
+						&verts[indices[static_cast<size_t>(triangle) * 3 + 2]].m_position,
+					};
+					++taskStat.m_numTrianglesTested;
+
+					// Corners exactly on the plane count as in front, so a cut through a vertex yields one segment, not two
+					float distances[3];
+					int numInFront = 0;
+					for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+					{
+						distances[cornerIndex] = normal[0] * corners[cornerIndex]->x + normal[1] * corners[cornerIndex]->y + normal[2] * corners[cornerIndex]->z - planeDistance;
+						numInFront += (distances[cornerIndex] >= 0.f) ? 1 : 0;
+					}
+					if (numInFront == 0 || numInFront == 3)
+					{
+						continue;
+					}
+
+					for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+					{
+						int nextCornerIndex = (cornerIndex + 1) % 3;
+						if ((distances[cornerIndex] >= 0.f) != (distances[nextCornerIndex] >= 0.f))
+						{
+							float fraction = distances[cornerIndex] / (distances[cornerIndex] - distances[nextCornerIndex]);
+							segmentPoints.push_back(*corners[cornerIndex] + (*corners[nextCornerIndex] - *corners[cornerIndex]) * fraction);
+						}
+					}
+				}
+			}
+		}
+	});
+
+	size_t numPoints = out_segmentPoints.size();
+	for (int taskIndex = 0; taskIndex < static_cast<int>(frontier.size()); ++taskIndex)
+	{
+		numPoints += taskSegmentPoints[taskIndex].size();
+	}
+	out_segmentPoints.reserve(numPoints);
+	for (int taskIndex = 0; taskIndex < static_cast<int>(frontier.size()); ++taskIndex)
+	{
+		out_segmentPoints.insert(out_segmentPoints.end(), taskSegmentPoints[taskIndex].begin(), taskSegmentPoints[taskIndex].end());
+		stats.m_numNodesVisited += taskStats[taskIndex].m_numNodesVisited;
+		stats.m_numTrianglesTested += taskStats[taskIndex].m_numTrianglesTested;
+	}
+
+	stats.m_seconds = GetCurrentTimeSeconds() - startTime;
+	if (out_stats != nullptr)
+	{
+		*out_stats = stats;
+	}
+}
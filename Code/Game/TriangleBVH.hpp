@@ -0,0 +1,99 @@
+#pragma once
+#include "Game/ModelLoader.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include <stdint.h>
+#include <vector>
+// -----------------------------------------------------------------------------
+constexpr int BVH_MAX_LEAF_TRIANGLES = 4;
+constexpr int BVH_NUM_SPLIT_BINS = 16;
+// -----------------------------------------------------------------------------
+// 32 bytes; a leaf holds m_numTriangles triangles from m_first in the BVH triangle order,
+// an interior node (m_numTriangles == 0) has its two children at m_first and m_first + 1
+struct TriangleBVHNode
+{
+	float		m_mins[3];
+	uint32_t	m_first;
+	float		m_maxs[3];
+	uint32_t	m_numTriangles;
+};
+// -----------------------------------------------------------------------------
+struct TriangleRaycastResult
+{
+	bool	m_didHit = false;
+	float	m_distance = 0.f;			// In units of the ray direction's length
+	Vec3	m_position;
+	Vec3	m_normal;					// Geometric normal, flipped to face the ray
+	int		m_triangleIndex = -1;
+};
+// -----------------------------------------------------------------------------
+struct TriangleQueryStats
+{
+	int		m_numNodesVisited = 0;
+	int		m_numTrianglesTested = 0;
+	double	m_seconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+struct TriangleBVHStats
+{
+	int		m_numTriangles = 0;
+	int		m_numNodes = 0;
+	int		m_numLeaves = 0;
+	int		m_maxDepth = 0;
+	double	m_buildSeconds = 0.0;
+};
+// -----------------------------------------------------------------------------
+// Bounding volume hierarchy over a triangle mesh, built with binned SAH splits. The top of the
+// tree is split on the calling thread and the subtrees below it are built in parallel. The BVH
+// stores only triangle numbers, so queries take the same verts and indices it was built from;
+// rebuild it whenever they change. Nothing here touches the renderer, so it can run headless.
+// -----------------------------------------------------------------------------
+class TriangleBVH
+{
+public:
+	void Build(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices);
+	void Clear();
+	bool IsBuilt() const { return !m_nodes.empty(); }
+
+	// Nearest hit of start + t * direction for t in [0, maxDistance], from either side of a triangle
+	bool Raycast(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& start, Vec3 const& direction, float maxDistance,
+		TriangleRaycastResult& out_result, TriangleQueryStats* out_stats = nullptr) const;
+
+	// Cuts the mesh with the plane dot(planeNormal, p) == planeDistance, visiting only nodes whose bounds
+	// straddle it. Appends one pair of points per cut triangle, in a fixed order however many threads ran.
+	void IntersectPlane(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& planeNormal, float planeDistance,
+		std::vector<Vec3>& out_segmentPoints, TriangleQueryStats* out_stats = nullptr) const;
+
+	AABB3					GetBounds() const;
+	TriangleBVHStats const& GetStats() const { return m_stats; }
+	uint64_t				GetNumBytes() const;
+
+private:
+	// Build-time copy of a triangle's bounds, moved along with it as ranges are partitioned so splits read memory in order
+	struct BuildTriangle
+	{
+		float		m_mins[3];
+		float		m_maxs[3];
+		uint32_t	m_triangle;
+	};
+
+	// Node bounds come down from the parent's split, so a range only scans its triangles for centroid bounds
+	struct BuildRange
+	{
+		uint32_t	m_nodeIndex = 0;
+		uint32_t	m_begin = 0;
+		uint32_t	m_end = 0;
+		int			m_depth = 0;
+		float		m_mins[3] = {};
+		float		m_maxs[3] = {};
+	};
+
+	void FitBuildRange(BuildRange& range) const;
+	void SplitNode(std::vector<TriangleBVHNode>& nodes, BuildRange const& range, std::vector<BuildRange>& out_childRanges, int& inout_maxDepth);
+	void BuildSubtree(std::vector<TriangleBVHNode>& nodes, BuildRange const& rootRange, int& out_maxDepth);
+
+private:
+	std::vector<TriangleBVHNode>	m_nodes;
+	std::vector<uint32_t>			m_triangles;		// Mesh triangle numbers in leaf order
+	std::vector<BuildTriangle>		m_buildTriangles;	// Only held during Build
+	TriangleBVHStats				m_stats;
+};
@@ -0,0 +1,225 @@
+#include "Game/TurntableCapture.hpp"
+#include "Game/GameCommon.h"
+#include "Game/PNGWriter.hpp"
+#include "Engine/Core/EngineCommon.h"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <filesystem>
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+TurntableCapture::~TurntableCapture()
+{
+	Finish();
+}
+
+// -----------------------------------------------------------------------------
+bool TurntableCapture::Start(TurntableSettings const& settings, AABB3 const& bounds, std::string& out_errorMessage)
+{
+	if (m_isCapturing)
+	{
+		out_errorMessage = "a capture is already running";
+		return false;
+	}
+	if (settings.m_numFrames <= 0 || settings.m_width <= 0 || settings.m_height <= 0 || settings.m_ringSize <= 0)
+	{
+		out_errorMessage = Stringf("invalid capture settings: %d frames at %dx%d with %d ring slots", settings.m_numFrames, settings.m_width, settings.m_height, settings.m_ringSize);
+		return false;
+	}
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(settings.m_outputDirectory, errorCode);
+	if (errorCode)
+	{
+		out_errorMessage = Stringf("could not create \"%s\": %s", settings.m_outputDirectory.c_str(), errorCode.message().c_str());
+		return false;
+	}
+
+	m_settings = settings;
+	m_bounds = bounds;
+	m_nextFrameIndex = 0;
+	m_isStopping = false;
+	m_stats = TurntableCaptureStats();
+	m_stats.m_numFrames = settings.m_numFrames;
+
+	m_ring.assign(settings.m_ringSize, CaptureFrame());
+	m_freeSlots.clear();
+	m_pendingSlots.clear();
+	for (int slotIndex = 0; slotIndex < settings.m_ringSize; ++slotIndex)
+	{
+		m_ring[slotIndex].m_width = settings.m_width;
+		m_ring[slotIndex].m_height = settings.m_height;
+		m_ring[slotIndex].m_rgba.resize(static_cast<size_t>(settings.m_width) * settings.m_height * 4);
+		m_freeSlots.push_back(slotIndex);
+	}
+
+	int numEncoderThreads = settings.m_numEncoderThreads;
+	if (numEncoderThreads <= 0)
+	{
+		numEncoderThreads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+	}
+	numEncoderThreads = std::min(numEncoderThreads, settings.m_ringSize);
+	for (int threadIndex = 0; threadIndex < numEncoderThreads; ++threadIndex)
+	{
+		m_encoderThreads.emplace_back(&TurntableCapture::EncoderThreadMain, this);
+	}
+
+	m_startTime = GetCurrentTimeSeconds();
+	m_isCapturing = true;
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+void TurntableCapture::GetOrbitPose(AABB3 const& bounds, float fovDegrees, float aspect, float elevationDegrees, float turnFraction, Vec3& out_position, EulerAngles& out_orientation)
+{
+	Vec3 boundsSize = bounds.m_maxs - bounds.m_mins;
+	Vec3 center = bounds.m_mins + boundsSize * 0.5f;
+	float radius = std::max(boundsSize.GetLength() * 0.5f, 0.01f);
+
+	// The narrower of the two field-of-view angles decides how far back the sphere fits
+	float halfFovRadians = 0.5f * ConvertDegreesToRadians(fovDegrees);
+	float halfHorizontalFovRadians = atanf(tanf(halfFovRadians) * aspect);
+	float distance = radius / sinf(std::min(halfFovRadians, halfHorizontalFovRadians));
+
+	out_orientation = EulerAngles(360.f * turnFraction, elevationDegrees, 0.f);
+	Vec3 forward = out_orientation.GetAsMatrix_IFwd_JLeft_KUp().GetIBasis3D();
+	out_position = center - forward * distance;
+}
+
+void TurntableCapture::GetNextPose(Vec3& out_position, EulerAngles& out_orientation) const
+{
+	float aspect = static_cast<float>(m_settings.m_width) / static_cast<float>(m_settings.m_height);
+	float turnFraction = static_cast<float>(m_nextFrameIndex) / static_cast<float>(m_settings.m_numFrames);
+	GetOrbitPose(m_bounds, CAMERA_FOV_DEGREES, aspect, m_settings.m_elevationDegrees, turnFraction, out_position, out_orientation);
+}
+
+// -----------------------------------------------------------------------------
+bool TurntableCapture::CaptureNextFrame(std::function<void(ViewFrustum const&, CaptureFrame&)> const& renderFrame)
+{
+	if (!m_isCapturing || m_nextFrameIndex >= m_settings.m_numFrames)
+	{
+		return false;
+	}
+
+	Vec3 position;
+	EulerAngles orientation;
+	GetNextPose(position, orientation);
+	Mat44 orientationMatrix = orientation.GetAsMatrix_IFwd_JLeft_KUp();
+	float aspect = static_cast<float>(m_settings.m_width) / static_cast<float>(m_settings.m_height);
+	ViewFrustum view(position, orientationMatrix.GetIBasis3D(), orientationMatrix.GetJBasis3D(), orientationMatrix.GetKBasis3D(),
+		CAMERA_FOV_DEGREES, aspect, CAMERA_NEAR_Z, CAMERA_FAR_Z);
+
+	CaptureFrame* frame = AcquireFrame();
+	double renderStartTime = GetCurrentTimeSeconds();
+	frame->m_frameIndex = m_nextFrameIndex;
+	renderFrame(view, *frame);
+	double renderSeconds = GetCurrentTimeSeconds() - renderStartTime;
+	SubmitFrame(frame);
+
+	{
+		std::lock_guard<std::mutex> lock(m_ringMutex);
+		m_stats.m_renderSeconds += renderSeconds;
+	}
+	++m_nextFrameIndex;
+	return m_nextFrameIndex < m_settings.m_numFrames;
+}
+
+CaptureFrame* TurntableCapture::AcquireFrame()
+{
+	std::unique_lock<std::mutex> lock(m_ringMutex);
+	if (m_freeSlots.empty())
+	{
+		double stallStartTime = GetCurrentTimeSeconds();
+		m_slotFreedCondition.wait(lock, [this]() { return !m_freeSlots.empty(); });
+		m_stats.m_stallSeconds += GetCurrentTimeSeconds() - stallStartTime;
+	}
+	int slotIndex = m_freeSlots.front();
+	m_freeSlots.pop_front();
+	return &m_ring[slotIndex];
+}
+
+void TurntableCapture::SubmitFrame(CaptureFrame* frame)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_ringMutex);
+		m_pendingSlots.push_back(static_cast<int>(frame - m_ring.data()));
+		++m_stats.m_numFramesSubmitted;
+	}
+	m_frameReadyCondition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+void TurntableCapture::EncoderThreadMain()
+{
+	for (;;)
+	{
+		int slotIndex = -1;
+		{
+			std::unique_lock<std::mutex> lock(m_ringMutex);
+			m_frameReadyCondition.wait(lock, [this]() { return !m_pendingSlots.empty() || m_isStopping; });
+			if (m_pendingSlots.empty())
+			{
+				return;
+			}
+			slotIndex = m_pendingSlots.front();
+			m_pendingSlots.pop_front();
+		}
+
+		// The slot is ours until it goes back on the free list, so encode without the lock
+		CaptureFrame const& frame = m_ring[slotIndex];
+		double encodeStartTime = GetCurrentTimeSeconds();
+		std::string filePath = Stringf("%s/frame_%04d.png", m_settings.m_outputDirectory.c_str(), frame.m_frameIndex);
+		std::string errorMessage;
+		size_t fileSize = 0;
+		bool wasWritten = WritePNGFile(filePath, frame.m_rgba.data(), frame.m_width, frame.m_height, errorMessage, &fileSize);
+		double encodeSeconds = GetCurrentTimeSeconds() - encodeStartTime;
+
+		{
+			std::lock_guard<std::mutex> lock(m_ringMutex);
+			m_stats.m_encodeSeconds += encodeSeconds;
+			if (wasWritten)
+			{
+				++m_stats.m_numFramesWritten;
+				m_stats.m_bytesWritten += fileSize;
+			}
+			else
+			{
+				++m_stats.m_numWriteFailures;
+			}
+			m_freeSlots.push_back(slotIndex);
+		}
+		m_slotFreedCondition.notify_one();
+	}
+}
+
+// -----------------------------------------------------------------------------
+void TurntableCapture::Finish()
+{
+	if (!m_isCapturing)
+	{
+		return;
+	}
+
+	// Encoders drain the pending frames before they see the stop flag
+	{
+		std::lock_guard<std::mutex> lock(m_ringMutex);
+		m_isStopping = true;
+	}
+	m_frameReadyCondition.notify_all();
+	for (int threadIndex = 0; threadIndex < static_cast<int>(m_encoderThreads.size()); ++threadIndex)
+	{
+		m_encoderThreads[threadIndex].join();
+	}
+	m_encoderThreads.clear();
+
+	std::lock_guard<std::mutex> lock(m_ringMutex);
+	m_stats.m_elapsedSeconds = GetCurrentTimeSeconds() - m_startTime;
+	m_isCapturing = false;
+}
+
+TurntableCaptureStats TurntableCapture::GetStats() const
+{
+	std::lock_guard<std::mutex> lock(m_ringMutex);
+	return m_stats;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "Game/ViewFrustum.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// -----------------------------------------------------------------------------
+struct TurntableSettings
+{
+	int			m_numFrames = 120;
+	int			m_width = 960;
+	int			m_height = 480;
+	int			m_ringSize = 4;
+	int			m_numEncoderThreads = 0;	// 0 uses one per hardware thread, less the main thread
+	float		m_elevationDegrees = 20.f;
+	std::string	m_outputDirectory = "Captures/Turntable";
+};
+// -----------------------------------------------------------------------------
+// One slot of the frame ring: filled by the render callback, then encoded and written by a worker
+struct CaptureFrame
+{
+	int							m_frameIndex = -1;
+	int							m_width = 0;
+	int							m_height = 0;
+	std::vector<unsigned char>	m_rgba;
+};
+// -----------------------------------------------------------------------------
+struct TurntableCaptureStats
+{
+	int		m_numFrames = 0;
+	int		m_numFramesSubmitted = 0;
+	int		m_numFramesWritten = 0;
+	int		m_numWriteFailures = 0;
+	double	m_elapsedSeconds = 0.0;
+	double	m_renderSeconds = 0.0;
+	double	m_stallSeconds = 0.0;		// Time the renderer waited for a free ring slot
+	double	m_encodeSeconds = 0.0;		// Summed across encoder threads
+	size_t	m_bytesWritten = 0;
+
+	double GetFramesPerSecond() const { return (m_elapsedSeconds > 0.0) ? static_cast<double>(m_numFramesWritten) / m_elapsedSeconds : 0.0; }
+};
+// -----------------------------------------------------------------------------
+// Orbits the camera around a bounding box for N frames and writes each frame as a PNG.
+// Frames go through a fixed ring of CPU pixel buffers: the render callback fills a free slot and
+// hands it to the encoder threads, so rendering only waits when every slot is still being encoded.
+// The game's callback is the software renderer, which ignores textures and lights per vertex, so
+// frames show the model's shape rather than the live view. The engine renderer has no texture
+// readback to copy the swap chain from, so there is no GPU capture path.
+// -----------------------------------------------------------------------------
+class TurntableCapture
+{
+public:
+	~TurntableCapture();
+
+	bool Start(TurntableSettings const& settings, AABB3 const& bounds, std::string& out_errorMessage);
+	void GetNextPose(Vec3& out_position, EulerAngles& out_orientation) const;
+	bool CaptureNextFrame(std::function<void(ViewFrustum const&, CaptureFrame&)> const& renderFrame);
+	void Finish();
+
+	bool IsCapturing() const { return m_isCapturing; }
+	TurntableCaptureStats GetStats() const;
+
+	// Pose on a circle around the bounds, pulled back until the bounding sphere fills the view
+	static void GetOrbitPose(AABB3 const& bounds, float fovDegrees, float aspect, float elevationDegrees, float turnFraction, Vec3& out_position, EulerAngles& out_orientation);
+
+private:
+	CaptureFrame* AcquireFrame();
+	void SubmitFrame(CaptureFrame* frame);
+	void EncoderThreadMain();
+
+private:
+	TurntableSettings			m_settings;
+	AABB3						m_bounds;
+	bool						m_isCapturing = false;
+	int							m_nextFrameIndex = 0;
+	double						m_startTime = 0.0;
+
+	std::vector<CaptureFrame>	m_ring;
+	std::deque<int>				m_freeSlots;
+	std::deque<int>				m_pendingSlots;
+	std::vector<std::thread>	m_encoderThreads;
+	mutable std::mutex			m_ringMutex;
+	std::condition_variable		m_slotFreedCondition;
+	std::condition_variable		m_frameReadyCondition;
+	bool						m_isStopping = false;
+	TurntableCaptureStats		m_stats;
+};
@@ -0,0 +1,104 @@
+#include "Game/ViewFrustum.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+void ClipTransform::TransformPosition(Vec3 const& position, float out_clip[4]) const
+{
+	for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+	{
+		float const* row = m_rows[rowIndex];
+		out_clip[rowIndex] = row[0] * position.x + row[1] * position.y + row[2] * position.z + row[3];
+	}
+}
+
+bool ClipTransform::IsBoxOutsideClipVolume(AABB3 const& bounds) const
+{
+	// Clip planes as combinations of rows: w+x, w-x, w+y, w-y, z, w-z must all be >= 0 inside
+	static float const s_planeSigns[6][4] =
+	{
+		{ 1.f, 0.f, 0.f, 1.f }, { -1.f, 0.f, 0.f, 1.f },
+		{ 0.f, 1.f, 0.f, 1.f }, { 0.f, -1.f, 0.f, 1.f },
+		{ 0.f, 0.f, 1.f, 0.f }, { 0.f, 0.f, -1.f, 1.f },
+	};
+
+	for (int planeIndex = 0; planeIndex < 6; ++planeIndex)
+	{
+		float plane[4] = {};
+		for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				plane[column] += s_planeSigns[planeIndex][rowIndex] * m_rows[rowIndex][column];
+			}
+		}
+
+		// The box corner furthest along the plane normal; if even that is behind, the whole box is
+		float x = (plane[0] >= 0.f) ? bounds.m_maxs.x : bounds.m_mins.x;
+		float y = (plane[1] >= 0.f) ? bounds.m_maxs.y : bounds.m_mins.y;
+		float z = (plane[2] >= 0.f) ? bounds.m_maxs.z : bounds.m_mins.z;
+		if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.f)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+ClipTransform ClipTransform::GetAppended(Mat44 const& modelToWorld) const
+{
+	float const* m = modelToWorld.m_values;
+
+	ClipTransform modelToClip;
+	for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+	{
+		float const* row = m_rows[rowIndex];
+		for (int column = 0; column < 4; ++column)
+		{
+			// Mat44 is column-major: element (r, c) lives at m_values[c * 4 + r]
+			float const* matrixColumn = &m[column * 4];
+			modelToClip.m_rows[rowIndex][column] = row[0] * matrixColumn[0] + row[1] * matrixColumn[1] + row[2] * matrixColumn[2] + row[3] * matrixColumn[3];
+		}
+	}
+	return modelToClip;
+}
+
+// -----------------------------------------------------------------------------
+ViewFrustum::ViewFrustum(Vec3 const& position, Vec3 const& forward, Vec3 const& left, Vec3 const& up, float fovDegrees, float aspect, float nearZ, float farZ)
+	: m_position(position)
+	, m_forward(forward)
+	, m_left(left)
+	, m_up(up)
+	, m_fovDegrees(fovDegrees)
+	, m_aspect(aspect)
+	, m_near(nearZ)
+	, m_far(farZ)
+{
+}
+
+ClipTransform ViewFrustum::GetWorldToClip() const
+{
+	float scaleY = 1.f / tanf(ConvertDegreesToRadians(0.5f * m_fovDegrees));
+	float scaleX = scaleY / m_aspect;
+	float depthScale = m_far / (m_far - m_near);
+
+	// Camera space: depth along forward, screen x to the right (-left), screen y up
+	Vec3 const axes[4] = { -m_left * scaleX, m_up * scaleY, m_forward * depthScale, m_forward };
+	float const offsets[4] = { 0.f, 0.f, -m_near * depthScale, 0.f };
+
+	ClipTransform worldToClip;
+	for (int rowIndex = 0; rowIndex < 4; ++rowIndex)
+	{
+		Vec3 const& axis = axes[rowIndex];
+		worldToClip.m_rows[rowIndex][0] = axis.x;
+		worldToClip.m_rows[rowIndex][1] = axis.y;
+		worldToClip.m_rows[rowIndex][2] = axis.z;
+		worldToClip.m_rows[rowIndex][3] = offsets[rowIndex] - DotProduct3D(axis, m_position);
+	}
+	return worldToClip;
+}
+
+ClipTransform ViewFrustum::GetModelToClip(Mat44 const& modelToWorld) const
+{
+	return GetWorldToClip().GetAppended(modelToWorld);
+}
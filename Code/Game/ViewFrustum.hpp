@@ -0,0 +1,38 @@
+#pragma once
+#include "Engine/Math/Vec3.h"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/AABB3.hpp"
+// -----------------------------------------------------------------------------
+// Rows of a 4x4 transform into D3D-style clip space (x, y in [-w, w], z in [0, w]), laid out
+// for dotting against (x, y, z, 1). Kept separate from Mat44 so CPU-side passes can run headless.
+// -----------------------------------------------------------------------------
+struct ClipTransform
+{
+	float m_rows[4][4] = {};
+
+	void TransformPosition(Vec3 const& position, float out_clip[4]) const;
+	bool IsBoxOutsideClipVolume(AABB3 const& bounds) const;
+	ClipTransform GetAppended(Mat44 const& modelToWorld) const;
+};
+// -----------------------------------------------------------------------------
+// A perspective view in our world convention (X forward, Y left, Z up), matching the camera's
+// SetPerspectiveView(aspect, fovDegrees, near, far).
+// -----------------------------------------------------------------------------
+class ViewFrustum
+{
+public:
+	ViewFrustum() = default;
+	ViewFrustum(Vec3 const& position, Vec3 const& forward, Vec3 const& left, Vec3 const& up, float fovDegrees, float aspect, float nearZ, float farZ);
+
+	ClipTransform GetWorldToClip() const;
+	ClipTransform GetModelToClip(Mat44 const& modelToWorld) const;
+
+	Vec3	m_position = Vec3::ZERO;
+	Vec3	m_forward = Vec3(1.f, 0.f, 0.f);
+	Vec3	m_left = Vec3(0.f, 1.f, 0.f);
+	Vec3	m_up = Vec3(0.f, 0.f, 1.f);
+	float	m_fovDegrees = 60.f;
+	float	m_aspect = 2.f;
+	float	m_near = 0.1f;
+	float	m_far = 300.f;
+};
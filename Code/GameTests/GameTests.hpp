@@ -0,0 +1,22 @@
+#pragma once
+// -----------------------------------------------------------------------------
+// Counts one suite's checks and prints each failure; suites return how many of their checks failed
+// -----------------------------------------------------------------------------
+class TestSuite
+{
+public:
+	explicit TestSuite(char const* name);
+
+	bool Check(bool condition, char const* format, ...);
+	int  Finish() const;
+
+private:
+	char const*	m_name = "";
+	int			m_numChecks = 0;
+	int			m_numFailures = 0;
+};
+// -----------------------------------------------------------------------------
+int RunSectionPlaneTests();
+int RunShadowCascadesTests();
+int RunSoftwareOcclusionCullerTests();
+int RunTriangleBVHTests();
@@ -0,0 +1,58 @@
+#include "GameTests/GameTests.hpp"
+#include <stdarg.h>
+#include <stdio.h>
+
+// -----------------------------------------------------------------------------
+TestSuite::TestSuite(char const* name)
+	: m_name(name)
+{
+}
+
+// -----------------------------------------------------------------------------
+bool TestSuite::Check(bool condition, char const* format, ...)
+{
+	++m_numChecks;
+	if (condition)
+	{
+		return true;
+	}
+
+	++m_numFailures;
+	printf("  FAILED [%s] ", m_name);
+	va_list arguments;
+	va_start(arguments, format);
+	vprintf(format, arguments);
+	va_end(arguments);
+	printf("\n");
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+int TestSuite::Finish() const
+{
+	printf("%-24s %d/%d checks passed\n", m_name, m_numChecks - m_numFailures, m_numChecks);
+	return m_numFailures;
+}
+
+// -----------------------------------------------------------------------------
+// Headless checks of the renderer-free game modules. Exits with the number of failed checks,
+// so a build step or script can run it and stop on anything nonzero.
+// -----------------------------------------------------------------------------
+int main(int, char**)
+{
+	int numFailures = 0;
+	numFailures += RunSectionPlaneTests();
+	numFailures += RunShadowCascadesTests();
+	numFailures += RunSoftwareOcclusionCullerTests();
+	numFailures += RunTriangleBVHTests();
+
+	if (numFailures == 0)
+	{
+		printf("All tests passed\n");
+	}
+	else
+	{
+		printf("%d checks failed\n", numFailures);
+	}
+	return numFailures;
+}
@@ -0,0 +1,144 @@
+#include "GameTests/GameTests.hpp"
+#include "Game/SectionPlane.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <math.h>
+#include <random>
+
+// -----------------------------------------------------------------------------
+static Vec3 GetTriangleAreaVector(Vec3 const& a, Vec3 const& b, Vec3 const& c)
+{
+	return CrossProduct3D(b - a, c - a) * 0.5f;
+}
+
+// -----------------------------------------------------------------------------
+// Summed area of the kept output, plus the worst distance past the plane and whether every piece kept its source's facing
+struct ClippedSide
+{
+	double	m_area = 0.0;
+	float	m_maxDistancePastPlane = 0.f;
+	bool	m_isWindingKept = true;
+	int		m_numKeptTriangles = 0;
+	int		m_numSplitTriangles = 0;
+};
+
+static ClippedSide ClipAndMeasure(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& normal, float distance)
+{
+	std::vector<unsigned int> keptIndices;
+	std::vector<Vertex_PCUTBN> splitVerts;
+	ClipTrianglesToSectionPlane(verts, indices, 0, static_cast<unsigned int>(indices.size()), normal, distance, keptIndices, splitVerts);
+
+	// Every test triangle faces +z, so the pieces must too
+	ClippedSide side;
+	side.m_numKeptTriangles = static_cast<int>(keptIndices.size() / 3);
+	side.m_numSplitTriangles = static_cast<int>(splitVerts.size() / 3);
+	for (int index = 0; index + 2 < static_cast<int>(keptIndices.size()); index += 3)
+	{
+		Vec3 areaVector = GetTriangleAreaVector(verts[keptIndices[index]].m_position, verts[keptIndices[index + 1]].m_position, verts[keptIndices[index + 2]].m_position);
+		side.m_area += static_cast<double>(areaVector.GetLength());
+		side.m_isWindingKept = side.m_isWindingKept && (areaVector.z >= 0.f);
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			side.m_maxDistancePastPlane = std::max(side.m_maxDistancePastPlane, DotProduct3D(normal, verts[keptIndices[index + cornerIndex]].m_position) - distance);
+		}
+	}
+	for (int vertIndex = 0; vertIndex + 2 < static_cast<int>(splitVerts.size()); vertIndex += 3)
+	{
+		Vec3 areaVector = GetTriangleAreaVector(splitVerts[vertIndex].m_position, splitVerts[vertIndex + 1].m_position, splitVerts[vertIndex + 2].m_position);
+		side.m_area += static_cast<double>(areaVector.GetLength());
+		side.m_isWindingKept = side.m_isWindingKept && (areaVector.z >= -1e-6f);
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			side.m_maxDistancePastPlane = std::max(side.m_maxDistancePastPlane, DotProduct3D(normal, splitVerts[vertIndex + cornerIndex].m_position) - distance);
+		}
+	}
+	return side;
+}
+
+// -----------------------------------------------------------------------------
+int RunSectionPlaneTests()
+{
+	TestSuite suite("SectionPlane");
+	std::mt19937 random(777);
+	std::uniform_real_distribution<float> coordinate(-10.f, 10.f);
+
+	// Counter-clockwise triangles in z = 0 planes, so each one's area vector points up
+	std::vector<Vertex_PCUTBN> verts;
+	std::vector<unsigned int> indices;
+	double totalArea = 0.0;
+	for (int triangleIndex = 0; triangleIndex < 2000; ++triangleIndex)
+	{
+		Vec3 corners[3];
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			corners[cornerIndex] = Vec3(coordinate(random), coordinate(random), 0.f);
+		}
+		if (GetTriangleAreaVector(corners[0], corners[1], corners[2]).z < 0.f)
+		{
+			Vec3 swapped = corners[1];
+			corners[1] = corners[2];
+			corners[2] = swapped;
+		}
+		totalArea += static_cast<double>(GetTriangleAreaVector(corners[0], corners[1], corners[2]).GetLength());
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			Vertex_PCUTBN vert;
+			vert.m_position = corners[cornerIndex];
+			indices.push_back(static_cast<unsigned int>(verts.size()));
+			verts.push_back(vert);
+		}
+	}
+
+	// The two sides of a plane split the mesh's area between them, and neither reaches past its plane
+	for (int planeIndex = 0; planeIndex < 20; ++planeIndex)
+	{
+		Vec3 normal(coordinate(random), coordinate(random), 0.f);
+		if (normal.GetLength() < 0.1f)
+		{
+			continue;
+		}
+		normal = normal * (1.f / normal.GetLength());
+		float distance = 0.5f * coordinate(random);
+
+		ClippedSide back = ClipAndMeasure(verts, indices, normal, distance);
+		ClippedSide front = ClipAndMeasure(verts, indices, normal * -1.f, -distance);
+		double areaError = fabs(back.m_area + front.m_area - totalArea) / totalArea;
+		suite.Check(areaError < 1e-4, "plane %d: sides hold %.6f of the area", planeIndex, (back.m_area + front.m_area) / totalArea);
+		suite.Check(back.m_maxDistancePastPlane <= 1e-4f && front.m_maxDistancePastPlane <= 1e-4f, "plane %d: geometry %.6f past the cut",
+			planeIndex, std::max(back.m_maxDistancePastPlane, front.m_maxDistancePastPlane));
+		suite.Check(back.m_isWindingKept && front.m_isWindingKept, "plane %d: a clipped piece flipped its winding", planeIndex);
+		suite.Check(back.m_numSplitTriangles > 0, "plane %d: no triangle was split", planeIndex);
+	}
+
+	// Planes past the mesh keep it whole and untouched, or cut all of it away
+	ClippedSide whole = ClipAndMeasure(verts, indices, Vec3(1.f, 0.f, 0.f), 20.f);
+	suite.Check(whole.m_numKeptTriangles == 2000 && whole.m_numSplitTriangles == 0, "plane past the mesh kept %d whole and split %d", whole.m_numKeptTriangles, whole.m_numSplitTriangles);
+	ClippedSide none = ClipAndMeasure(verts, indices, Vec3(1.f, 0.f, 0.f), -20.f);
+	suite.Check(none.m_numKeptTriangles == 0 && none.m_numSplitTriangles == 0, "plane before the mesh kept %d triangles", none.m_numKeptTriangles + none.m_numSplitTriangles);
+
+	// Split corners interpolate every attribute along the cut edge
+	std::vector<Vertex_PCUTBN> edgeVerts(3);
+	edgeVerts[0].m_position = Vec3(0.f, 0.f, 0.f);
+	edgeVerts[1].m_position = Vec3(4.f, 0.f, 0.f);
+	edgeVerts[2].m_position = Vec3(0.f, 4.f, 0.f);
+	edgeVerts[1].m_uvTexCoords = Vec2(1.f, 0.f);
+	edgeVerts[1].m_color = Rgba8(200, 0, 0, 255);
+	edgeVerts[0].m_color = Rgba8(0, 0, 0, 255);
+	std::vector<unsigned int> edgeIndices = { 0, 1, 2 };
+	std::vector<unsigned int> keptIndices;
+	std::vector<Vertex_PCUTBN> splitVerts;
+	ClipTrianglesToSectionPlane(edgeVerts, edgeIndices, 0, 3, Vec3(1.f, 0.f, 0.f), 1.f, keptIndices, splitVerts);
+	bool isCutCornerFound = false;
+	for (int vertIndex = 0; vertIndex < static_cast<int>(splitVerts.size()); ++vertIndex)
+	{
+		Vertex_PCUTBN const& vert = splitVerts[vertIndex];
+		if (fabsf(vert.m_position.x - 1.f) < 1e-5f && fabsf(vert.m_position.y) < 1e-5f)
+		{
+			isCutCornerFound = fabsf(vert.m_uvTexCoords.x - 0.25f) < 1e-5f && vert.m_color.r == 50;
+		}
+	}
+	suite.Check(keptIndices.empty() && splitVerts.size() == 6, "single cut: %d kept indices and %d split verts", static_cast<int>(keptIndices.size()), static_cast<int>(splitVerts.size()));
+	suite.Check(isCutCornerFound, "single cut: the corner on the cut edge was not interpolated");
+
+	return suite.Finish();
+}
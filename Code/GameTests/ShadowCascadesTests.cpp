@@ -0,0 +1,217 @@
+#include "GameTests/GameTests.hpp"
+#include "Game/ShadowCascades.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+#include <random>
+
+// -----------------------------------------------------------------------------
+// The corner of the view slice at depth along the view axis, with signs picking the side
+static Vec3 GetSliceCorner(ViewFrustum const& view, float depth, float leftSign, float upSign)
+{
+	float tanHalfFov = tanf(0.5f * ConvertDegreesToRadians(view.m_fovDegrees));
+	return view.m_position + view.m_forward * depth + view.m_left * (leftSign * depth * tanHalfFov * view.m_aspect) + view.m_up * (upSign * depth * tanHalfFov);
+}
+
+// -----------------------------------------------------------------------------
+static bool IsInShadowClipVolume(ShadowCascade const& cascade, Vec3 const& position, float tolerance)
+{
+	float clip[4];
+	cascade.m_worldToShadowClip.TransformPosition(position, clip);
+	return fabsf(clip[0]) <= 1.f + tolerance && fabsf(clip[1]) <= 1.f + tolerance && clip[2] >= -tolerance && clip[2] <= 1.f + tolerance && clip[3] == 1.f;
+}
+
+// -----------------------------------------------------------------------------
+static ViewFrustum MakeRandomView(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> angleDistribution(0.f, 360.f);
+	std::uniform_real_distribution<float> pitchDistribution(-80.f, 80.f);
+	std::uniform_real_distribution<float> fovDistribution(30.f, 100.f);
+	std::uniform_real_distribution<float> aspectDistribution(0.5f, 2.5f);
+	std::uniform_real_distribution<float> positionDistribution(-50.f, 50.f);
+
+	float yaw = ConvertDegreesToRadians(angleDistribution(random));
+	float pitch = ConvertDegreesToRadians(pitchDistribution(random));
+	Vec3 forward(cosf(pitch) * cosf(yaw), cosf(pitch) * sinf(yaw), -sinf(pitch));
+	Vec3 left = CrossProduct3D(Vec3(0.f, 0.f, 1.f), forward).GetNormalized();
+	Vec3 up = CrossProduct3D(forward, left);
+	Vec3 position(positionDistribution(random), positionDistribution(random), positionDistribution(random));
+	return ViewFrustum(position, forward, left, up, fovDistribution(random), aspectDistribution(random), 0.1f, 300.f);
+}
+
+// -----------------------------------------------------------------------------
+static Vec3 MakeRandomSunDirection(std::mt19937& random)
+{
+	std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+	Vec3 direction(distribution(random), distribution(random), -1.f);
+
+	// Straight down exercises the light basis's fallback reference axis
+	return (random() % 4 == 0) ? Vec3(0.f, 0.f, -1.f) : direction.GetNormalized();
+}
+
+// -----------------------------------------------------------------------------
+static void CheckSplitDepths(TestSuite& suite)
+{
+	float const nearZ = 0.1f;
+	float const farZ = 300.f;
+	float const lambdas[] = { 0.f, 0.5f, 0.95f, 1.f };
+	for (float lambda : lambdas)
+	{
+		suite.Check(fabsf(ShadowCascades::GetSplitDepth(0, nearZ, farZ, lambda) - nearZ) <= 1e-5f, "lambda %.2f: first split is not the near plane", lambda);
+		suite.Check(fabsf(ShadowCascades::GetSplitDepth(NUM_SHADOW_CASCADES, nearZ, farZ, lambda) - farZ) <= 1e-3f, "lambda %.2f: last split is not the far plane", lambda);
+		for (int splitIndex = 0; splitIndex < NUM_SHADOW_CASCADES; ++splitIndex)
+		{
+			float splitNear = ShadowCascades::GetSplitDepth(splitIndex, nearZ, farZ, lambda);
+			float splitFar = ShadowCascades::GetSplitDepth(splitIndex + 1, nearZ, farZ, lambda);
+			suite.Check(splitFar > splitNear, "lambda %.2f: split %d (%f) does not pass split %d (%f)", lambda, splitIndex + 1, splitFar, splitIndex, splitNear);
+		}
+	}
+
+	// Lambda 0 is uniform and 1 is logarithmic
+	float uniformSplit = ShadowCascades::GetSplitDepth(2, nearZ, farZ, 0.f);
+	float logarithmicSplit = ShadowCascades::GetSplitDepth(2, nearZ, farZ, 1.f);
+	suite.Check(fabsf(uniformSplit - 0.5f * (nearZ + farZ)) <= 1e-3f, "uniform middle split is %f", uniformSplit);
+	suite.Check(fabsf(logarithmicSplit - sqrtf(nearZ * farZ)) <= 1e-3f, "logarithmic middle split is %f", logarithmicSplit);
+}
+
+// -----------------------------------------------------------------------------
+static void CheckFitContainment(TestSuite& suite, std::mt19937& random)
+{
+	AABB3 sceneBounds(-60.f, -60.f, -60.f, 60.f, 60.f, 60.f);
+	std::uniform_real_distribution<float> unitDistribution(0.f, 1.f);
+	int numOutside = 0;
+	int numSplitMismatches = 0;
+	int numBoundsMismatches = 0;
+	for (int viewIndex = 0; viewIndex < 200; ++viewIndex)
+	{
+		ViewFrustum view = MakeRandomView(random);
+		ShadowCascades cascades;
+		cascades.Fit(view, MakeRandomSunDirection(random), sceneBounds);
+
+		for (int cascadeIndex = 0; cascadeIndex < NUM_SHADOW_CASCADES; ++cascadeIndex)
+		{
+			ShadowCascade const& cascade = cascades.GetCascade(cascadeIndex);
+			float expectedNear = (cascadeIndex == 0) ? view.m_near : cascades.GetCascade(cascadeIndex - 1).m_splitFar;
+			numSplitMismatches += (cascade.m_splitNear == expectedNear) ? 0 : 1;
+
+			// Every slice corner, and random points inside the slice, land inside the shadow clip volume
+			for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+			{
+				float depth = (cornerIndex & 1) ? cascade.m_splitFar : cascade.m_splitNear;
+				Vec3 corner = GetSliceCorner(view, depth, (cornerIndex & 2) ? 1.f : -1.f, (cornerIndex & 4) ? 1.f : -1.f);
+				if (!IsInShadowClipVolume(cascade, corner, 1e-4f) && numOutside++ < 5)
+				{
+					suite.Check(false, "view %d cascade %d: slice corner %d is outside the shadow clip volume", viewIndex, cascadeIndex, cornerIndex);
+				}
+			}
+			for (int pointIndex = 0; pointIndex < 20; ++pointIndex)
+			{
+				float depth = cascade.m_splitNear + (cascade.m_splitFar - cascade.m_splitNear) * unitDistribution(random);
+				Vec3 point = GetSliceCorner(view, depth, 2.f * unitDistribution(random) - 1.f, 2.f * unitDistribution(random) - 1.f);
+				if (!IsInShadowClipVolume(cascade, point, 1e-4f) && numOutside++ < 5)
+				{
+					suite.Check(false, "view %d cascade %d: slice point at depth %f is outside the shadow clip volume", viewIndex, cascadeIndex, depth);
+				}
+			}
+
+			// Casters between the light and the slice must not be clipped off the near plane
+			for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+			{
+				Vec3 corner((cornerIndex & 1) ? sceneBounds.m_maxs.x : sceneBounds.m_mins.x,
+					(cornerIndex & 2) ? sceneBounds.m_maxs.y : sceneBounds.m_mins.y,
+					(cornerIndex & 4) ? sceneBounds.m_maxs.z : sceneBounds.m_mins.z);
+				float clip[4];
+				cascade.m_worldToShadowClip.TransformPosition(corner, clip);
+				numBoundsMismatches += (clip[2] >= -1e-4f) ? 0 : 1;
+			}
+		}
+		numSplitMismatches += (cascades.GetCascade(NUM_SHADOW_CASCADES - 1).m_splitFar == view.m_far) ? 0 : 1;
+	}
+	suite.Check(numOutside == 0, "%d slice points fell outside their cascade", numOutside);
+	suite.Check(numSplitMismatches == 0, "%d cascades do not tile the view depth range", numSplitMismatches);
+	suite.Check(numBoundsMismatches == 0, "%d scene corners sit in front of a cascade's near plane", numBoundsMismatches);
+}
+
+// -----------------------------------------------------------------------------
+// Size depends only on the slice, and the texel grid stays put in light space as the camera moves
+static void CheckFitStability(TestSuite& suite, std::mt19937& random)
+{
+	AABB3 sceneBounds(-60.f, -60.f, -60.f, 60.f, 60.f, 60.f);
+	Vec3 sunDirection(0.3f, 0.4f, -1.f);
+	std::uniform_real_distribution<float> offsetDistribution(-3.f, 3.f);
+	for (int viewIndex = 0; viewIndex < 50; ++viewIndex)
+	{
+		ViewFrustum view = MakeRandomView(random);
+		ViewFrustum movedView = MakeRandomView(random);
+		movedView.m_fovDegrees = view.m_fovDegrees;
+		movedView.m_aspect = view.m_aspect;
+		movedView.m_position = view.m_position + Vec3(offsetDistribution(random), offsetDistribution(random), offsetDistribution(random));
+
+		ShadowCascades cascades;
+		cascades.Fit(view, sunDirection, sceneBounds);
+		ShadowCascades movedCascades;
+		movedCascades.Fit(movedView, sunDirection, sceneBounds);
+		for (int cascadeIndex = 0; cascadeIndex < NUM_SHADOW_CASCADES; ++cascadeIndex)
+		{
+			ShadowCascade const& cascade = cascades.GetCascade(cascadeIndex);
+			ShadowCascade const& movedCascade = movedCascades.GetCascade(cascadeIndex);
+			suite.Check(cascade.m_radius == movedCascade.m_radius, "view %d cascade %d: radius changed from %f to %f as the camera turned", viewIndex, cascadeIndex,
+				cascade.m_radius, movedCascade.m_radius);
+
+			// A fixed world point moves across the map by whole texels only
+			float clip[4];
+			float movedClip[4];
+			cascade.m_worldToShadowClip.TransformPosition(Vec3::ZERO, clip);
+			movedCascade.m_worldToShadowClip.TransformPosition(Vec3::ZERO, movedClip);
+			float texelsPerClipUnit = 0.5f * static_cast<float>(SHADOW_MAP_RESOLUTION);
+			float shiftX = (movedClip[0] - clip[0]) * texelsPerClipUnit;
+			float shiftY = (movedClip[1] - clip[1]) * texelsPerClipUnit;
+			suite.Check(fabsf(shiftX - roundf(shiftX)) <= 0.02f && fabsf(shiftY - roundf(shiftY)) <= 0.02f, "view %d cascade %d: shifted by a fraction of a texel (%f, %f)",
+				viewIndex, cascadeIndex, shiftX, shiftY);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+static void CheckCasterCulling(TestSuite& suite)
+{
+	ViewFrustum view(Vec3::ZERO, Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f), 60.f, 16.f / 9.f, 0.1f, 300.f);
+	AABB3 sceneBounds(-500.f, -500.f, -50.f, 500.f, 500.f, 50.f);
+	ShadowCascades cascades;
+	cascades.Fit(view, Vec3(0.f, 0.f, -1.f), sceneBounds);
+
+	// In front of the camera inside the first slice, far off to the side, and overhead between the sun and the first slice
+	float firstSliceDepth = 0.5f * (cascades.GetCascade(0).m_splitNear + cascades.GetCascade(0).m_splitFar);
+	std::vector<ModelCluster> clusters(3);
+	clusters[0].m_bounds = AABB3(firstSliceDepth - 0.1f, -0.1f, -0.1f, firstSliceDepth + 0.1f, 0.1f, 0.1f);
+	clusters[1].m_bounds = AABB3(firstSliceDepth - 0.1f, 400.f, -0.1f, firstSliceDepth + 0.1f, 400.2f, 0.1f);
+	clusters[2].m_bounds = AABB3(firstSliceDepth - 0.1f, -0.1f, 45.f, firstSliceDepth + 0.1f, 0.1f, 45.2f);
+	cascades.CullCasters(clusters, Mat44());
+
+	std::vector<int> const& casters = cascades.GetCasterClusters(0);
+	bool hasInView = false;
+	bool hasOffToSide = false;
+	bool hasOverhead = false;
+	for (int casterIndex = 0; casterIndex < static_cast<int>(casters.size()); ++casterIndex)
+	{
+		hasInView |= (casters[casterIndex] == 0);
+		hasOffToSide |= (casters[casterIndex] == 1);
+		hasOverhead |= (casters[casterIndex] == 2);
+	}
+	suite.Check(hasInView, "cluster inside the first slice was culled");
+	suite.Check(!hasOffToSide, "cluster far outside the first slice was kept");
+	suite.Check(hasOverhead, "cluster between the sun and the first slice was culled");
+}
+
+// -----------------------------------------------------------------------------
+int RunShadowCascadesTests()
+{
+	TestSuite suite("ShadowCascades");
+	std::mt19937 random(6789);
+
+	CheckSplitDepths(suite);
+	CheckFitContainment(suite, random);
+	CheckFitStability(suite, random);
+	CheckCasterCulling(suite);
+
+	return suite.Finish();
+}
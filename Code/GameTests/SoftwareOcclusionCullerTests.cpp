@@ -0,0 +1,225 @@
+#include "GameTests/GameTests.hpp"
+#include "Game/SoftwareOcclusionCuller.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <math.h>
+#include <random>
+
+// -----------------------------------------------------------------------------
+// Camera at the origin looking down +x; occluders are axis-aligned rectangles facing it
+struct OccluderRectangle
+{
+	int		m_normalAxis = 0;		// 0 for a wall at constant x, 2 for a floor at constant z
+	float	m_planeOffset = 0.f;
+	AABB3	m_bounds;
+};
+
+// -----------------------------------------------------------------------------
+static float GetAxis(Vec3 const& vector, int axis)
+{
+	return (axis == 0) ? vector.x : ((axis == 1) ? vector.y : vector.z);
+}
+
+// -----------------------------------------------------------------------------
+static void AddRectangle(OccluderRectangle const& rectangle, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices, std::vector<ModelCluster>& out_occluders)
+{
+	ModelCluster occluder;
+	occluder.m_startIndex = static_cast<unsigned int>(out_indices.size());
+	occluder.m_indexCount = 6;
+	occluder.m_bounds = rectangle.m_bounds;
+	out_occluders.push_back(occluder);
+
+	unsigned int firstVert = static_cast<unsigned int>(out_verts.size());
+	AABB3 const& bounds = rectangle.m_bounds;
+	for (int cornerIndex = 0; cornerIndex < 4; ++cornerIndex)
+	{
+		bool isFirstMax = (cornerIndex == 1 || cornerIndex == 2);
+		bool isSecondMax = (cornerIndex >= 2);
+		Vertex_PCUTBN vert;
+		if (rectangle.m_normalAxis == 0)
+		{
+			vert.m_position = Vec3(rectangle.m_planeOffset, isFirstMax ? bounds.m_maxs.y : bounds.m_mins.y, isSecondMax ? bounds.m_maxs.z : bounds.m_mins.z);
+		}
+		else
+		{
+			vert.m_position = Vec3(isFirstMax ? bounds.m_maxs.x : bounds.m_mins.x, isSecondMax ? bounds.m_maxs.y : bounds.m_mins.y, rectangle.m_planeOffset);
+		}
+		out_verts.push_back(vert);
+	}
+	out_indices.insert(out_indices.end(), { firstVert, firstVert + 1, firstVert + 2, firstVert, firstVert + 2, firstVert + 3 });
+}
+
+// -----------------------------------------------------------------------------
+// Camera depth of the nearest rectangle along the ray through view-space point (1, left, up), or 0 for none
+static float GetNearestHitDepth(std::vector<OccluderRectangle> const& rectangles, float left, float up)
+{
+	Vec3 direction(1.f, left, up);
+	float nearestDepth = 0.f;
+	for (int rectangleIndex = 0; rectangleIndex < static_cast<int>(rectangles.size()); ++rectangleIndex)
+	{
+		OccluderRectangle const& rectangle = rectangles[rectangleIndex];
+		float directionAlongNormal = GetAxis(direction, rectangle.m_normalAxis);
+		if (fabsf(directionAlongNormal) < 1e-12f)
+		{
+			continue;
+		}
+		float depth = rectangle.m_planeOffset / directionAlongNormal;
+		if (depth <= 0.f || (nearestDepth > 0.f && depth >= nearestDepth))
+		{
+			continue;
+		}
+		Vec3 hit = direction * depth;
+		bool isInside = true;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (axis != rectangle.m_normalAxis)
+			{
+				isInside = isInside && GetAxis(hit, axis) >= GetAxis(rectangle.m_bounds.m_mins, axis) && GetAxis(hit, axis) <= GetAxis(rectangle.m_bounds.m_maxs, axis);
+			}
+		}
+		nearestDepth = isInside ? depth : nearestDepth;
+	}
+	return nearestDepth;
+}
+
+// -----------------------------------------------------------------------------
+static float GetBufferDepth(ViewFrustum const& view, float cameraDepth)
+{
+	return (cameraDepth > 0.f) ? (cameraDepth - view.m_near) * view.m_far / ((view.m_far - view.m_near) * cameraDepth) : 1.f;
+}
+
+// -----------------------------------------------------------------------------
+// Every pixel whose neighbourhood sees one surface (or none) must hold that surface's depth
+static void CheckDepthBuffer(TestSuite& suite, char const* sceneName, SoftwareOcclusionCuller const& culler, ViewFrustum const& view, std::vector<OccluderRectangle> const& rectangles)
+{
+	float tanHalfFovY = tanf(0.5f * ConvertDegreesToRadians(view.m_fovDegrees));
+	float tanHalfFovX = tanHalfFovY * view.m_aspect;
+	int numChecked = 0;
+	int numCovered = 0;
+	int numMismatches = 0;
+	for (int pixelY = 0; pixelY < culler.GetHeight(); ++pixelY)
+	{
+		for (int pixelX = 0; pixelX < culler.GetWidth(); ++pixelX)
+		{
+			float const sampleOffsets[5][2] = { { 0.5f, 0.5f }, { -0.5f, -0.5f }, { 1.5f, -0.5f }, { -0.5f, 1.5f }, { 1.5f, 1.5f } };
+			float sampleDepths[5];
+			bool isInterior = true;
+			for (int sampleIndex = 0; sampleIndex < 5; ++sampleIndex)
+			{
+				float ndcX = 2.f * (static_cast<float>(pixelX) + sampleOffsets[sampleIndex][0]) / static_cast<float>(culler.GetWidth()) - 1.f;
+				float ndcY = 1.f - 2.f * (static_cast<float>(pixelY) + sampleOffsets[sampleIndex][1]) / static_cast<float>(culler.GetHeight());
+				sampleDepths[sampleIndex] = GetBufferDepth(view, GetNearestHitDepth(rectangles, -ndcX * tanHalfFovX, ndcY * tanHalfFovY));
+				isInterior = isInterior && ((sampleDepths[sampleIndex] == 1.f) == (sampleDepths[0] == 1.f));
+			}
+			if (!isInterior)
+			{
+				continue;
+			}
+
+			// Depth varies across a tilted surface's pixel, so any value the pixel's neighbourhood spans is right
+			float minDepth = sampleDepths[0];
+			float maxDepth = sampleDepths[0];
+			for (int sampleIndex = 1; sampleIndex < 5; ++sampleIndex)
+			{
+				minDepth = fminf(minDepth, sampleDepths[sampleIndex]);
+				maxDepth = fmaxf(maxDepth, sampleDepths[sampleIndex]);
+			}
+			float depth = culler.GetDepth(pixelX, pixelY);
+			++numChecked;
+			numCovered += (sampleDepths[0] < 1.f) ? 1 : 0;
+			if ((depth < minDepth - 1e-5f || depth > maxDepth + 1e-5f) && numMismatches++ < 5)
+			{
+				suite.Check(false, "%s pixel (%d, %d): depth %f, expected %f to %f", sceneName, pixelX, pixelY, depth, minDepth, maxDepth);
+			}
+		}
+	}
+	suite.Check(numMismatches == 0, "%s: %d of %d pixels hold the wrong depth", sceneName, numMismatches, numChecked);
+	suite.Check(numCovered > 100 && numCovered < numChecked, "%s: %d of %d pixels covered, the scene does not exercise the buffer", sceneName, numCovered, numChecked);
+}
+
+// -----------------------------------------------------------------------------
+// Culling is conservative: a box reported occluded must be hidden behind the wall, and a box well behind it must be reported
+static void CheckBoxes(TestSuite& suite, std::mt19937& random, SoftwareOcclusionCuller const& culler, OccluderRectangle const& wall)
+{
+	std::uniform_real_distribution<float> depthDistribution(2.f, 40.f);
+	std::uniform_real_distribution<float> lateralDistribution(-1.2f, 1.2f);
+	std::uniform_real_distribution<float> sizeDistribution(0.05f, 3.f);
+	int numWronglyOccluded = 0;
+	int numMissed = 0;
+	int numOccluded = 0;
+	for (int boxIndex = 0; boxIndex < 5000; ++boxIndex)
+	{
+		float depth = depthDistribution(random);
+		Vec3 center(depth, lateralDistribution(random) * depth, lateralDistribution(random) * depth * 0.5f);
+		Vec3 halfSize(sizeDistribution(random), sizeDistribution(random), sizeDistribution(random));
+		AABB3 bounds(center.x - halfSize.x, center.y - halfSize.y, center.z - halfSize.z, center.x + halfSize.x, center.y + halfSize.y, center.z + halfSize.z);
+		OcclusionResult result = culler.TestBox(bounds);
+		numOccluded += (result == OcclusionResult::OCCLUDED) ? 1 : 0;
+
+		// The wall's projection is convex, so the box is hidden when every corner's ray crosses the wall before reaching it
+		bool isHidden = bounds.m_mins.x > wall.m_planeOffset;
+		bool isWellHidden = bounds.m_mins.x > wall.m_planeOffset + 0.5f;
+		for (int cornerIndex = 0; cornerIndex < 8; ++cornerIndex)
+		{
+			Vec3 corner((cornerIndex & 1) ? bounds.m_maxs.x : bounds.m_mins.x, (cornerIndex & 2) ? bounds.m_maxs.y : bounds.m_mins.y, (cornerIndex & 4) ? bounds.m_maxs.z : bounds.m_mins.z);
+			float wallY = corner.y * wall.m_planeOffset / corner.x;
+			float wallZ = corner.z * wall.m_planeOffset / corner.x;
+			isHidden = isHidden && wallY >= wall.m_bounds.m_mins.y && wallY <= wall.m_bounds.m_maxs.y && wallZ >= wall.m_bounds.m_mins.z && wallZ <= wall.m_bounds.m_maxs.z;
+			isWellHidden = isWellHidden && wallY >= wall.m_bounds.m_mins.y + 1.f && wallY <= wall.m_bounds.m_maxs.y - 1.f && wallZ >= wall.m_bounds.m_mins.z + 1.f && wallZ <= wall.m_bounds.m_maxs.z - 1.f;
+		}
+
+		if (result == OcclusionResult::OCCLUDED && !isHidden && numWronglyOccluded++ < 5)
+		{
+			suite.Check(false, "box %d at (%f, %f, %f) is visible but was culled", boxIndex, center.x, center.y, center.z);
+		}
+		if (result != OcclusionResult::OCCLUDED && isWellHidden && numMissed++ < 5)
+		{
+			suite.Check(false, "box %d at (%f, %f, %f) is well behind the wall but was not culled", boxIndex, center.x, center.y, center.z);
+		}
+	}
+	suite.Check(numWronglyOccluded == 0, "%d visible boxes were culled", numWronglyOccluded);
+	suite.Check(numMissed == 0, "%d boxes well behind the wall were not culled", numMissed);
+	suite.Check(numOccluded > 100, "only %d boxes were culled, too few to exercise the test", numOccluded);
+
+	// Behind the camera, and straddling the near plane
+	suite.Check(culler.TestBox(AABB3(-5.f, -1.f, -1.f, -4.f, 1.f, 1.f)) == OcclusionResult::OUTSIDE_FRUSTUM, "box behind the camera was not outside the frustum");
+	suite.Check(culler.TestBox(AABB3(-0.5f, -0.2f, -0.2f, 0.5f, 0.2f, 0.2f)) == OcclusionResult::VISIBLE, "box around the camera was not visible");
+}
+
+// -----------------------------------------------------------------------------
+int RunSoftwareOcclusionCullerTests()
+{
+	TestSuite suite("SoftwareOcclusionCuller");
+	std::mt19937 random(24680);
+
+	ViewFrustum view(Vec3::ZERO, Vec3(1.f, 0.f, 0.f), Vec3(0.f, 1.f, 0.f), Vec3(0.f, 0.f, 1.f), 60.f, 2.f, 0.1f, 300.f);
+	SoftwareOcclusionCuller culler(256, 128);
+
+	// A wall across the middle of the view
+	OccluderRectangle wall;
+	wall.m_normalAxis = 0;
+	wall.m_planeOffset = 10.f;
+	wall.m_bounds = AABB3(10.f, -5.f, -4.f, 10.f, 6.f, 3.f);
+	std::vector<OccluderRectangle> wallScene(1, wall);
+	std::vector<Vertex_PCUTBN> verts;
+	std::vector<unsigned int> indices;
+	std::vector<ModelCluster> occluders;
+	AddRectangle(wall, verts, indices, occluders);
+	culler.BeginFrame(view.GetWorldToClip());
+	culler.RasterizeOccluders(verts, indices, occluders);
+	CheckDepthBuffer(suite, "wall", culler, view, wallScene);
+	CheckBoxes(suite, random, culler, wall);
+
+	// Adds a floor that starts behind the camera, so its triangles are clipped at the near plane
+	OccluderRectangle floor;
+	floor.m_normalAxis = 2;
+	floor.m_planeOffset = -2.f;
+	floor.m_bounds = AABB3(-5.f, -30.f, -2.f, 60.f, 30.f, -2.f);
+	std::vector<OccluderRectangle> floorScene = wallScene;
+	floorScene.push_back(floor);
+	AddRectangle(floor, verts, indices, occluders);
+	culler.BeginFrame(view.GetWorldToClip());
+	culler.RasterizeOccluders(verts, indices, occluders);
+	CheckDepthBuffer(suite, "wall and floor", culler, view, floorScene);
+
+	return suite.Finish();
+}
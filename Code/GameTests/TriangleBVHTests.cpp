@@ -0,0 +1,278 @@
+#include "GameTests/GameTests.hpp"
+#include "Game/TriangleBVH.hpp"
+#include "Engine/Math/MathUtils.h"
+#include <algorithm>
+#include <array>
+#include <math.h>
+#include <random>
+
+// -----------------------------------------------------------------------------
+static Vec3 GetRandomPoint(std::mt19937& random, float extent)
+{
+	std::uniform_real_distribution<float> distribution(-extent, extent);
+	float x = distribution(random);
+	float y = distribution(random);
+	float z = distribution(random);
+	return Vec3(x, y, z);
+}
+
+// -----------------------------------------------------------------------------
+// Overlapping triangles of mixed sizes, so nodes overlap and rays cross several candidates
+static void MakeTriangleSoup(std::mt19937& random, int numTriangles, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices)
+{
+	std::uniform_real_distribution<float> sizeDistribution(0.05f, 2.f);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		Vec3 center = GetRandomPoint(random, 10.f);
+		float size = sizeDistribution(random);
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			Vertex_PCUTBN vert;
+			vert.m_position = center + GetRandomPoint(random, size);
+			out_indices.push_back(static_cast<unsigned int>(out_verts.size()));
+			out_verts.push_back(vert);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Indexed grid on the sphere, so neighbouring triangles share edges and corners exactly
+static void MakeSphere(float radius, int numSlices, int numStacks, std::vector<Vertex_PCUTBN>& out_verts, std::vector<unsigned int>& out_indices)
+{
+	float const pi = 3.14159265f;
+	for (int stackIndex = 0; stackIndex <= numStacks; ++stackIndex)
+	{
+		float latitude = pi * (static_cast<float>(stackIndex) / static_cast<float>(numStacks) - 0.5f);
+		for (int sliceIndex = 0; sliceIndex <= numSlices; ++sliceIndex)
+		{
+			float longitude = 2.f * pi * static_cast<float>(sliceIndex) / static_cast<float>(numSlices);
+			Vertex_PCUTBN vert;
+			vert.m_position = Vec3(cosf(latitude) * cosf(longitude), cosf(latitude) * sinf(longitude), sinf(latitude)) * radius;
+			out_verts.push_back(vert);
+		}
+	}
+	for (int stackIndex = 0; stackIndex < numStacks; ++stackIndex)
+	{
+		for (int sliceIndex = 0; sliceIndex < numSlices; ++sliceIndex)
+		{
+			unsigned int bottomLeft = static_cast<unsigned int>(stackIndex * (numSlices + 1) + sliceIndex);
+			unsigned int topLeft = bottomLeft + static_cast<unsigned int>(numSlices + 1);
+			out_indices.insert(out_indices.end(), { bottomLeft, bottomLeft + 1, topLeft + 1 });
+			out_indices.insert(out_indices.end(), { bottomLeft, topLeft + 1, topLeft });
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Every triangle in mesh order, with the same acceptance rules the BVH documents
+static bool RaycastBruteForce(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& start, Vec3 const& direction, float maxDistance,
+	float& out_distance, int& out_triangleIndex)
+{
+	out_distance = maxDistance;
+	out_triangleIndex = -1;
+	int numTriangles = static_cast<int>(indices.size() / 3);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		Vec3 const& corner0 = verts[indices[triangleIndex * 3]].m_position;
+		Vec3 const& corner1 = verts[indices[triangleIndex * 3 + 1]].m_position;
+		Vec3 const& corner2 = verts[indices[triangleIndex * 3 + 2]].m_position;
+		Vec3 edge1 = corner1 - corner0;
+		Vec3 edge2 = corner2 - corner0;
+		Vec3 p = CrossProduct3D(direction, edge2);
+		float determinant = DotProduct3D(edge1, p);
+		if (fabsf(determinant) < 1e-20f)
+		{
+			continue;
+		}
+		Vec3 s = start - corner0;
+		float u = DotProduct3D(s, p) / determinant;
+		if (u < 0.f || u > 1.f)
+		{
+			continue;
+		}
+		Vec3 q = CrossProduct3D(s, edge1);
+		float v = DotProduct3D(direction, q) / determinant;
+		if (v < 0.f || u + v > 1.f)
+		{
+			continue;
+		}
+		float distance = DotProduct3D(edge2, q) / determinant;
+		if (distance >= 0.f && distance < out_distance)
+		{
+			out_distance = distance;
+			out_triangleIndex = triangleIndex;
+		}
+	}
+	return out_triangleIndex >= 0;
+}
+
+// -----------------------------------------------------------------------------
+typedef std::array<float, 6> PlaneSegment;
+
+// -----------------------------------------------------------------------------
+static void IntersectPlaneBruteForce(std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices, Vec3 const& planeNormal, float planeDistance,
+	std::vector<Vec3>& out_segmentPoints)
+{
+	int numTriangles = static_cast<int>(indices.size() / 3);
+	for (int triangleIndex = 0; triangleIndex < numTriangles; ++triangleIndex)
+	{
+		Vec3 corners[3];
+		float distances[3];
+		int numInFront = 0;
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			corners[cornerIndex] = verts[indices[triangleIndex * 3 + cornerIndex]].m_position;
+			distances[cornerIndex] = DotProduct3D(corners[cornerIndex], planeNormal) - planeDistance;
+			numInFront += (distances[cornerIndex] >= 0.f) ? 1 : 0;
+		}
+		if (numInFront == 0 || numInFront == 3)
+		{
+			continue;
+		}
+		for (int cornerIndex = 0; cornerIndex < 3; ++cornerIndex)
+		{
+			int nextCornerIndex = (cornerIndex + 1) % 3;
+			if ((distances[cornerIndex] >= 0.f) != (distances[nextCornerIndex] >= 0.f))
+			{
+				float fraction = distances[cornerIndex] / (distances[cornerIndex] - distances[nextCornerIndex]);
+				out_segmentPoints.push_back(corners[cornerIndex] + (corners[nextCornerIndex] - corners[cornerIndex]) * fraction);
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// The BVH reports segments in leaf order, so both sides are compared as sorted sets
+static std::vector<PlaneSegment> GetSortedSegments(std::vector<Vec3> const& segmentPoints)
+{
+	std::vector<PlaneSegment> segments;
+	for (int pointIndex = 0; pointIndex + 1 < static_cast<int>(segmentPoints.size()); pointIndex += 2)
+	{
+		Vec3 const& start = segmentPoints[pointIndex];
+		Vec3 const& end = segmentPoints[pointIndex + 1];
+		segments.push_back({ start.x, start.y, start.z, end.x, end.y, end.z });
+	}
+	std::sort(segments.begin(), segments.end());
+	return segments;
+}
+
+// -----------------------------------------------------------------------------
+static void CheckRaycasts(TestSuite& suite, char const* meshName, std::mt19937& random, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices,
+	TriangleBVH const& bvh)
+{
+	int numHits = 0;
+	int numMismatches = 0;
+	std::uniform_real_distribution<float> maxDistanceDistribution(1.f, 40.f);
+	for (int rayIndex = 0; rayIndex < 2000; ++rayIndex)
+	{
+		// Half the rays start inside the mesh bounds, half outside aimed back through them
+		Vec3 start = GetRandomPoint(random, (rayIndex % 2 == 0) ? 8.f : 25.f);
+		Vec3 direction = (rayIndex % 2 == 0) ? GetRandomPoint(random, 1.f) : (GetRandomPoint(random, 5.f) - start);
+		if (direction.GetLengthSquared() < 1e-6f)
+		{
+			continue;
+		}
+		direction = direction.GetNormalized();
+		float maxDistance = (rayIndex % 4 < 2) ? 100.f : maxDistanceDistribution(random);
+
+		TriangleRaycastResult result;
+		bool didHit = bvh.Raycast(verts, indices, start, direction, maxDistance, result);
+		float expectedDistance = 0.f;
+		int expectedTriangle = -1;
+		bool expectedHit = RaycastBruteForce(verts, indices, start, direction, maxDistance, expectedDistance, expectedTriangle);
+		numHits += expectedHit ? 1 : 0;
+
+		// Hits within rounding of each other may pick either triangle; the distance has to agree regardless
+		bool isMatch = (didHit == expectedHit) && (didHit == result.m_didHit);
+		if (isMatch && expectedHit)
+		{
+			isMatch = fabsf(result.m_distance - expectedDistance) <= 1e-4f * (1.f + expectedDistance);
+			isMatch = isMatch && (result.m_triangleIndex == expectedTriangle || fabsf(result.m_distance - expectedDistance) <= 1e-5f);
+			Vec3 expectedPosition = start + direction * result.m_distance;
+			isMatch = isMatch && (result.m_position - expectedPosition).GetLengthSquared() <= 1e-6f;
+		}
+		if (!isMatch && numMismatches++ < 5)
+		{
+			suite.Check(false, "%s ray %d: BVH hit=%d distance=%f triangle=%d, brute force hit=%d distance=%f triangle=%d", meshName, rayIndex,
+				didHit ? 1 : 0, result.m_distance, result.m_triangleIndex, expectedHit ? 1 : 0, expectedDistance, expectedTriangle);
+		}
+	}
+	suite.Check(numMismatches == 0, "%s: %d rays disagree with brute force", meshName, numMismatches);
+	suite.Check(numHits > 100, "%s: only %d rays hit, too few to exercise the tree", meshName, numHits);
+}
+
+// -----------------------------------------------------------------------------
+static void CheckPlaneCuts(TestSuite& suite, char const* meshName, std::mt19937& random, std::vector<Vertex_PCUTBN> const& verts, std::vector<unsigned int> const& indices,
+	TriangleBVH const& bvh)
+{
+	std::uniform_real_distribution<float> distanceDistribution(-8.f, 8.f);
+	for (int planeIndex = 0; planeIndex < 50; ++planeIndex)
+	{
+		// Every fifth plane is axis-aligned through a vertex, so corners land exactly on it
+		Vec3 planeNormal = GetRandomPoint(random, 1.f).GetNormalized();
+		float planeDistance = distanceDistribution(random);
+		if (planeIndex % 5 == 0)
+		{
+			planeNormal = Vec3(0.f, 0.f, 1.f);
+			planeDistance = verts[(planeIndex * 7919) % verts.size()].m_position.z;
+		}
+
+		std::vector<Vec3> segmentPoints;
+		bvh.IntersectPlane(verts, indices, planeNormal, planeDistance, segmentPoints);
+		std::vector<Vec3> expectedPoints;
+		IntersectPlaneBruteForce(verts, indices, planeNormal, planeDistance, expectedPoints);
+		if (!suite.Check(segmentPoints.size() == expectedPoints.size(), "%s plane %d: BVH gave %d points, brute force %d", meshName, planeIndex,
+			static_cast<int>(segmentPoints.size()), static_cast<int>(expectedPoints.size())))
+		{
+			continue;
+		}
+
+		std::vector<PlaneSegment> segments = GetSortedSegments(segmentPoints);
+		std::vector<PlaneSegment> expectedSegments = GetSortedSegments(expectedPoints);
+		bool isMatch = true;
+		for (int segmentIndex = 0; segmentIndex < static_cast<int>(segments.size()) && isMatch; ++segmentIndex)
+		{
+			for (int component = 0; component < 6; ++component)
+			{
+				isMatch = isMatch && fabsf(segments[segmentIndex][component] - expectedSegments[segmentIndex][component]) <= 1e-5f;
+			}
+		}
+		suite.Check(isMatch, "%s plane %d: segments differ from brute force", meshName, planeIndex);
+	}
+
+	// A plane past the bounds cuts nothing
+	std::vector<Vec3> segmentPoints;
+	bvh.IntersectPlane(verts, indices, Vec3(1.f, 0.f, 0.f), 1000.f, segmentPoints);
+	suite.Check(segmentPoints.empty(), "%s: plane outside the bounds gave %d points", meshName, static_cast<int>(segmentPoints.size()));
+}
+
+// -----------------------------------------------------------------------------
+int RunTriangleBVHTests()
+{
+	TestSuite suite("TriangleBVH");
+	std::mt19937 random(12345);
+
+	std::vector<Vertex_PCUTBN> soupVerts;
+	std::vector<unsigned int> soupIndices;
+	MakeTriangleSoup(random, 5000, soupVerts, soupIndices);
+	TriangleBVH soupBVH;
+	soupBVH.Build(soupVerts, soupIndices);
+	suite.Check(soupBVH.GetStats().m_numTriangles == 5000, "soup: BVH holds %d of 5000 triangles", soupBVH.GetStats().m_numTriangles);
+	CheckRaycasts(suite, "soup", random, soupVerts, soupIndices, soupBVH);
+	CheckPlaneCuts(suite, "soup", random, soupVerts, soupIndices, soupBVH);
+
+	std::vector<Vertex_PCUTBN> sphereVerts;
+	std::vector<unsigned int> sphereIndices;
+	MakeSphere(6.f, 64, 32, sphereVerts, sphereIndices);
+	TriangleBVH sphereBVH;
+	sphereBVH.Build(sphereVerts, sphereIndices);
+	CheckRaycasts(suite, "sphere", random, sphereVerts, sphereIndices, sphereBVH);
+	CheckPlaneCuts(suite, "sphere", random, sphereVerts, sphereIndices, sphereBVH);
+
+	// An empty tree misses everything
+	TriangleBVH emptyBVH;
+	TriangleRaycastResult result;
+	suite.Check(!emptyBVH.Raycast(soupVerts, soupIndices, Vec3(-20.f, 0.f, 0.f), Vec3(1.f, 0.f, 0.f), 100.f, result), "unbuilt BVH reported a hit");
+
+	return suite.Finish();
+}